@@ -35,7 +35,8 @@ using namespace std;
 MainVisual::MainVisual(MythUIVideo *visualizer)
     : QObject(NULL), MythTV::Visual(), m_visualizerVideo(visualizer),
       m_vis(NULL), m_playing(false), m_fps(20), m_samples(SAMPLES_DEFAULT_SIZE),
-      m_updateTimer(NULL)
+      m_updateTimer(NULL), m_frames(0), m_processTime(0), m_drawTime(0),
+      m_maxFrameTime(0)
 {
     setObjectName("MainVisual");
 
@@ -50,9 +51,15 @@ MainVisual::MainVisual(MythUIVideo *visualizer)
 
     resize(m_visualizerVideo->GetArea().size());
 
+    // Frames are produced at a fixed rate whatever the time taken to
+    // draw them, a frame that is late is skipped rather than delaying
+    // the following ones
     m_updateTimer = new QTimer(this);
     m_updateTimer->setInterval(1000 / m_fps);
-    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setSingleShot(false);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    m_updateTimer->setTimerType(Qt::PreciseTimer);
+#endif
     connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(timeout()));
 }
 
@@ -73,6 +80,7 @@ MainVisual::~MainVisual()
 void MainVisual::stop(void)
 {
     m_updateTimer->stop();
+    logFrameTimes();
 
     if (m_vis)
     {
@@ -84,6 +92,7 @@ void MainVisual::stop(void)
 void MainVisual::setVisual(const QString &name)
 {
     m_updateTimer->stop();
+    logFrameTimes();
 
     int index = m_visualizers.indexOf(name);
 
@@ -134,7 +143,13 @@ void MainVisual::setVisual(const QString &name)
     }
 
     // force an update
+    startUpdateTimer();
+}
+
+void MainVisual::startUpdateTimer(void)
+{
     m_updateTimer->start(1000 / m_fps);
+    m_statsTimer.start();
 }
 
 // Caller holds mutex() lock
@@ -230,10 +245,15 @@ void MainVisual::timeout()
             node = m_nodes.first();
     }
 
+    QElapsedTimer frameTime;
+    frameTime.start();
+
     bool stop = true;
     if (m_vis)
         stop = m_vis->process(node);
 
+    qint64 processTime = frameTime.nsecsElapsed();
+
     if (m_vis && !stop)
     {
         QPainter p(&m_pixmap);
@@ -241,8 +261,48 @@ void MainVisual::timeout()
             m_visualizerVideo->UpdateFrame(&m_pixmap);
     }
 
-    if (m_playing && !stop)
-        m_updateTimer->start();
+    qint64 totalTime = frameTime.nsecsElapsed();
+
+    m_frames++;
+    m_processTime += processTime;
+    m_drawTime += totalTime - processTime;
+    m_maxFrameTime = max(m_maxFrameTime, totalTime);
+
+    if (m_statsTimer.isValid() && m_statsTimer.elapsed() > 30000)
+        logFrameTimes();
+
+    if (!m_playing || stop)
+        m_updateTimer->stop();
+}
+
+// Logs the average time spent per frame by the visualizer since the last
+// call, with -v playback:debug
+void MainVisual::logFrameTimes(void)
+{
+    if (m_frames > 0 && m_statsTimer.isValid() &&
+        VERBOSE_LEVEL_CHECK(VB_PLAYBACK, LOG_DEBUG))
+    {
+        double secs = m_statsTimer.elapsed() / 1000.0;
+        QString name = m_visualizers.value(m_currentVisualizer);
+
+        LOG(VB_PLAYBACK, LOG_DEBUG,
+            QString("MainVisual: %1 drew %2 frames in %3s (%4 fps), "
+                    "process %5 ms, draw %6 ms per frame, max %7 ms, "
+                    "%8% of the UI thread")
+                .arg(name).arg(m_frames).arg(secs, 0, 'f', 1)
+                .arg(secs > 0 ? m_frames / secs : 0, 0, 'f', 1)
+                .arg(m_processTime / m_frames / 1000000.0, 0, 'f', 3)
+                .arg(m_drawTime / m_frames / 1000000.0, 0, 'f', 3)
+                .arg(m_maxFrameTime / 1000000.0, 0, 'f', 3)
+                .arg(secs > 0 ? (m_processTime + m_drawTime) /
+                     (secs * 10000000.0) : 0, 0, 'f', 1));
+    }
+
+    m_frames = 0;
+    m_processTime = 0;
+    m_drawTime = 0;
+    m_maxFrameTime = 0;
+    m_statsTimer.restart();
 }
 
 void MainVisual::resize(const QSize &size)
@@ -263,7 +323,7 @@ void MainVisual::customEvent(QEvent *event)
     {
         m_playing = true;
         if (!m_updateTimer->isActive())
-            m_updateTimer->start();
+            startUpdateTimer();
     }
     else if ((event->type() == OutputEvent::Stopped) ||
              (event->type() == OutputEvent::Error))
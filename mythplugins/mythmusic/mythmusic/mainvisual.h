@@ -18,6 +18,7 @@ using namespace std;
 #include <QHideEvent>
 #include <QWidget>
 #include <QPixmap>
+#include <QElapsedTimer>
 #include <QTimer>
 #include <QList>
 
@@ -61,6 +62,9 @@ class MainVisual :  public QObject, public MythTV::Visual
     void timeout();
 
   private:
+    void startUpdateTimer(void);
+    void logFrameTimes(void);
+
     MythUIVideo *m_visualizerVideo;
     QStringList m_visualizers;
     int m_currentVisualizer;
@@ -71,6 +75,13 @@ class MainVisual :  public QObject, public MythTV::Visual
     int m_fps;
     unsigned long m_samples;
     QTimer *m_updateTimer;
+
+    // Time spent analysing and drawing the frames of the visualizer
+    QElapsedTimer m_statsTimer;
+    int m_frames;
+    qint64 m_processTime;
+    qint64 m_drawTime;
+    qint64 m_maxFrameTime;
 };
 
 #endif // __mainvisual_h
@@ -45,14 +45,14 @@ HEADERS += playlistview.h playlisteditorview.h
 HEADERS += visualizerview.h searchview.h streamview.h
 HEADERS += generalsettings.h visualizationsettings.h
 HEADERS += importsettings.h playersettings.h ratingsettings.h
-HEADERS += remoteavformatcontext.h
+HEADERS += remoteavformatcontext.h visualspectrum.h
 
 SOURCES += decoder.cpp
 SOURCES += flacencoder.cpp main.cpp
 SOURCES += mainvisual.cpp playlist.cpp
 SOURCES += encoder.cpp dbcheck.cpp
 SOURCES += synaesthesia.cpp lameencoder.cpp
-SOURCES += vorbisencoder.cpp visualize.cpp bumpscope.cpp
+SOURCES += vorbisencoder.cpp visualize.cpp visualspectrum.cpp bumpscope.cpp
 SOURCES += genres.cpp importmusic.cpp
 SOURCES += goom/filters.c goom/goom_core.c goom/graphic.c goom/tentacle3d.c
 SOURCES += goom/ifs.c goom/ifs_display.c goom/lines.c goom/surf3d.c
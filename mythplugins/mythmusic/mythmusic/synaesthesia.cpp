@@ -52,7 +52,6 @@ Synaesthesia::Synaesthesia(void) :
 {
     m_fps = 29;
 
-    coreInit();              // init cosTable, negSinTable, bitReverse
     setStarSize(m_starSize); // init scaleDown, maxStarRadius
     setupPalette();          // init palette
 }
@@ -174,43 +173,6 @@ void Synaesthesia::resize(const QSize &newsize)
 #endif
 }
 
-int Synaesthesia::bitReverser(int i)
-{
-    int sum = 0;
-    for (int j = 0; j < LogSize; j++)
-    {
-        sum = (i & 1) + sum * 2;
-        i >>= 1;
-    }
-    
-    return sum;
-}
-
-void Synaesthesia::fft(double *x, double *y)
-{
-    int n2 = NumSamples, n1;
-    for (int twoToTheK = 1; twoToTheK < NumSamples; twoToTheK *= 2)
-    {
-        n1 = n2;
-        n2 /= 2;
-        for (int j = 0; j < n2; j++)
-        {
-            double c = m_cosTable[j * twoToTheK & (NumSamples - 1)],
-                   s = m_negSinTable[j * twoToTheK & (NumSamples - 1)];
-            for (int i = j; i < NumSamples; i += n1)
-            {
-                int l = i + n2;
-                double xt = x[i] - x[l];
-                x[i] = (x[i] + x[l]);
-                double yt = y[i] - y[l];
-                y[i] = (y[i] + y[l]);
-                x[l] = xt * c - yt * s;
-                y[l] = xt * s + yt * c;
-            }
-        }
-    }
-}
-
 void Synaesthesia::setStarSize(double lsize)
 {
     double fadeModeFudge = (m_fadeMode == Wave ? 0.4 :
@@ -233,16 +195,6 @@ void Synaesthesia::setStarSize(double lsize)
         m_maxStarRadius++;
 }
 
-void Synaesthesia::coreInit(void)
-{
-    for (int i = 0; i < NumSamples; i++)
-    {
-        m_negSinTable[i] = -sin(3.141592 * 2.0 / NumSamples * i);
-        m_cosTable[i] = cos(3.141592 * 2.0 / NumSamples * i);
-        m_bitReverse[i] = bitReverser(i);
-    }
-}
-
 #define output ((unsigned char*)m_outputBmp.data)
 #define lastOutput ((unsigned char*)m_lastOutputBmp.data)
 #define lastLastOutput ((unsigned char*)m_lastLastOutputBmp.data)
@@ -469,7 +421,6 @@ bool Synaesthesia::process(VisualNode *node)
     if (!node)
         return false;
 
-    double x[NumSamples], y[NumSamples];
     double a[NumSamples], b[NumSamples];
     double energy;
     int clarity[NumSamples];
@@ -477,38 +428,23 @@ bool Synaesthesia::process(VisualNode *node)
 
     int brightFactor = int(Brightness * m_brightnessTwiddler / (m_starSize + 0.01));
 
-    int numSamps = NumSamples;
-    if (node->length < NumSamples)
-        numSamps = node->length;
-
-    memset(x, 0, sizeof(x));
-    memset(y, 0, sizeof(y));
-
-    for (i = 0; i < numSamps; i++) 
-    {
-        x[i] = node->left[i];
-        if (node->right)
-            y[i] = node->right[i];
-        else
-            y[i] = x[i];
-    }
-
-    fft(x, y);
+    const VisualSpectrum *spectrum = VisualSpectrum::Get(node, NumSamples);
+    const float *lre = spectrum->leftReal(),  *lim = spectrum->leftImag();
+    const float *rre = spectrum->rightReal(), *rim = spectrum->rightImag();
 
     energy = 0.0;
 
     for (i = 0 + 1; i < NumSamples / 2; i++)
     {
-        double x1 = x[m_bitReverse[i]], 
-               y1 = y[m_bitReverse[i]],
-               x2 = x[m_bitReverse[NumSamples - i]],
-               y2 = y[m_bitReverse[NumSamples - i]],
+        // The sum and difference of the packed transform bins k and N - k,
+        // 2 * L[k] and 2i * R[k]
+        double x1 = 2.0 * lre[i], y1 = 2.0 * lim[i],
+               x2 = -2.0 * rim[i], y2 = 2.0 * rre[i],
                aa, bb;
-        a[i] = sqrt(aa = (x1 + x2) * (x1 + x2) + (y1 - y2) * (y1 - y2));
-        b[i] = sqrt(bb = (x1 - x2) * (x1 - x2) + (y2 + y2) * (y1 + y2));
+        a[i] = sqrt(aa = x1 * x1 + y1 * y1);
+        b[i] = sqrt(bb = x2 * x2 + y2 * y2);
         if (aa + bb != 0.0)
-            clarity[i] = (int)(((x1 + x2) * (x1 - x2) + (y1 + y2) * (y1 - y2)) /
-                         (aa + bb) * 256);
+            clarity[i] = (int)((x1 * x2 + y1 * y2) / (aa + bb) * 256);
         else
             clarity[i] = 0;
 
@@ -29,9 +29,6 @@ public:
 
 private:
     void setupPalette(void);
-    void coreInit(void);
-    int bitReverser(int i);
-    void fft(double *x, double *y);
     void setStarSize(double lsize);
 
     inline void addPixel(int x, int y, int br1, int br2);
@@ -47,9 +44,6 @@ private:
 
     QSize m_size;
 
-    double m_cosTable[NumSamples];
-    double m_negSinTable[NumSamples];
-    int m_bitReverse[NumSamples];
     int m_scaleDown[256];
     int m_maxStarRadius;
     int m_fadeMode;
@@ -35,8 +35,8 @@ using namespace std;
 #include "decoder.h"
 #include "musicplayer.h"
 
-#define FFTW_N 512
-// static_assert(FFTW_N==SAMPLES_DEFAULT_SIZE)
+#define SPECTRUM_N 512
+// static_assert(SPECTRUM_N==SAMPLES_DEFAULT_SIZE)
 
 
 VisFactory* VisFactory::g_pVisFactories = 0;
@@ -578,52 +578,20 @@ static class MonoScopeFactory : public VisFactory
 
 ///////////////////////////////////////////////////////////////////////////////
 // Spectrum
-//
-// NOTE: This visualiser requires mythplugins to be compiled with --enable-fft
 
-#if FFTW3_SUPPORT
 Spectrum::Spectrum()
-    : lin(NULL), rin(NULL), lout(NULL), rout(NULL)
 {
-    // Setup the "magical" audio data transformations
-    // provided by the Fast Fourier Transforms library
     analyzerBarWidth = 6;
     scaleFactor = 2.0;
     falloff = 10.0;
     m_fps = 15;
 
-    lin = (myth_fftw_float*) av_malloc(sizeof(myth_fftw_float)*FFTW_N);
-    memset(lin, 0, sizeof(myth_fftw_float)*FFTW_N);
-
-    rin = (myth_fftw_float*) av_malloc(sizeof(myth_fftw_float)*FFTW_N);
-    memset(rin, 0, sizeof(myth_fftw_float)*FFTW_N);
-
-    lout = (myth_fftw_complex*) av_malloc(sizeof(myth_fftw_complex)*(FFTW_N/2+1));
-    memset(lout, 0, sizeof(myth_fftw_complex)*(FFTW_N/2+1));
-
-    rout = (myth_fftw_complex*) av_malloc(sizeof(myth_fftw_complex)*(FFTW_N/2+1));
-    memset(rout, 0, sizeof(myth_fftw_complex)*(FFTW_N/2+1));
-
-    lplan = fftw_plan_dft_r2c_1d(FFTW_N, lin, (myth_fftw_complex_cast*)lout, FFTW_MEASURE);
-    rplan = fftw_plan_dft_r2c_1d(FFTW_N, rin, (myth_fftw_complex_cast*)rout, FFTW_MEASURE);
-
     startColor = QColor(0,0,255);
     targetColor = QColor(255,0,0);
 }
 
 Spectrum::~Spectrum()
 {
-    if (lin)
-        av_free(lin);
-    if (rin)
-        av_free(rin);
-    if (lout)
-        av_free(lout);
-    if (rout)
-        av_free(rout);
-
-    fftw_destroy_plan(lplan);
-    fftw_destroy_plan(rplan);
 }
 
 void Spectrum::resize(const QSize &newsize)
@@ -658,11 +626,9 @@ void Spectrum::resize(const QSize &newsize)
         magnitudes[os] = 0.0;
     }
 
-    scaleFactor = double( size.height() / 2 ) / log( (double)(FFTW_N) );
+    scaleFactor = double( size.height() / 2 ) / log( (double)(SPECTRUM_N) );
 }
 
-template<typename T> T sq(T a) { return a*a; };
-
 bool Spectrum::process(VisualNode *node)
 {
     // Take a bunch of data in *node
@@ -676,34 +642,27 @@ bool Spectrum::process(VisualNode *node)
     double *magnitudesp = magnitudes.data();
     double magL, magR, tmp;
 
-    if (node)
+    // Silence when there is no node
+    static const float silence[SPECTRUM_N / 2 + 1] = { 0.0f };
+    const float *lpower = silence, *rpower = silence;
+
+    const VisualSpectrum *spectrum = VisualSpectrum::Get(node, SPECTRUM_N);
+    if (spectrum)
     {
-        i = node->length;
-        if (i > FFTW_N)
-            i = FFTW_N;
-        fast_real_set_from_short(lin, node->left, i);
-        if (node->right)
-            fast_real_set_from_short(rin, node->right, i);
+        lpower = spectrum->leftPower();
+        rpower = spectrum->rightPower();
     }
-    else
-        i = 0;
-
-    fast_reals_set(lin + i, rin + i, 0, FFTW_N - i);
-
-    fftw_execute(lplan);
-    fftw_execute(rplan);
 
     index = 1;
 
     for (i = 0; (int)i < rects.size(); i++, w += analyzerBarWidth)
     {
-        // The 1D output is Hermitian symmetric (Yk = Yn-k) so Yn = Y0 etc.
-        // The dft_r2c_1d plan doesn't output these redundant values
-        // and furthermore they're not allocated in the ctor
-        tmp = 2 * sq(real(lout[index])); // + sq(real(lout[FFTW_N - index]));
+        // Bins are the squared magnitude, the mirrored upper half of the
+        // transform of a real signal holds the same energy again
+        tmp = 2 * lpower[index];
         magL = (tmp > 1.) ? (log(tmp) - 22.0) * scaleFactor : 0.;
 
-        tmp = 2 * sq(real(rout[index])); // + sq(real(rout[FFTW_N - index]));
+        tmp = 2 * rpower[index];
         magR = (tmp > 1.) ? (log(tmp) - 22.0) * scaleFactor : 0.;
 
         if (magL > size.height() / 2)
@@ -827,8 +786,6 @@ static class SpectrumFactory : public VisFactory
 
 ///////////////////////////////////////////////////////////////////////////////
 // Squares
-//
-// NOTE: This visualiser requires mythplugins to be compiled with --enable-fftw
 
 Squares::Squares() :
     actualSize(0,0), pParent(NULL), fake_height(0), number_of_squares(16)
@@ -917,8 +874,6 @@ static class SquaresFactory : public VisFactory
     }
 }SquaresFactory;
 
-#endif // FFTW3_SUPPORT
-
 Piano::Piano()
     : piano_data(NULL), audio_data(NULL)
 {
@@ -27,21 +27,7 @@
 // MythMusic headers
 #include "constants.h"
 #include "config.h"
-
-#include <complex>
-extern "C" {
-#ifdef FFTW3_SUPPORT
-#include <fftw3.h>
-#define myth_fftw_float double /* need to use different plan function to change */
-#define fftw_real myth_fftw_float
-#define myth_fftw_complex std::complex<myth_fftw_float>
-#if (myth_fftw_float == double)
-#define myth_fftw_complex_cast fftw_complex
-#elif (myth_fftw_float == float)
-#define myth_fftw_complex_cast fftwf_complex
-#endif
-#endif
-}
+#include "visualspectrum.h"
 
 #define SAMPLES_DEFAULT_SIZE 512
 
@@ -51,7 +37,7 @@ class VisualNode
 {
   public:
     VisualNode(short *l, short *r, unsigned long n, unsigned long o)
-        : left(l), right(r), length(n), offset(o)
+        : left(l), right(r), length(n), offset(o), spectrum(NULL)
     {
         // left and right are allocated and then passed to this class
         // the code that allocated left and right should give up all ownership
@@ -61,10 +47,13 @@ class VisualNode
     {
         delete [] left;
         delete [] right;
+        delete spectrum;
     }
 
     short *left, *right;
     unsigned long length, offset;
+    /// Filled in by VisualSpectrum::Get()
+    VisualSpectrum *spectrum;
 };
 
 class VisualBase
@@ -159,7 +148,6 @@ class LogScale
     int s, r;
 };
 
-#ifdef FFTW3_SUPPORT
 class Spectrum : public VisualBase
 {
     // This class draws bars (up and down)
@@ -185,10 +173,6 @@ class Spectrum : public VisualBase
     LogScale scale;
     double scaleFactor, falloff;
     int analyzerBarWidth;
-
-    fftw_plan lplan, rplan;
-    myth_fftw_float *lin, *rin;
-    myth_fftw_complex *lout, *rout;
 };
 
 class Squares : public Spectrum
@@ -209,8 +193,6 @@ class Squares : public Spectrum
     int number_of_squares;
 };
 
-#endif // FFTW3_SUPPORT
-
 class Piano : public VisualBase
 {
     // This class draws bars (up and down)
@@ -0,0 +1,220 @@
+// C
+#include <cmath>
+#include <cstring>
+
+// Qt
+#include <QMutexLocker>
+#include <QMutex>
+#include <QHash>
+
+// MythTV
+#include <mythconfig.h>
+extern "C" {
+#include <libavutil/mem.h>
+}
+
+// mythmusic
+#include "visualspectrum.h"
+#include "visualize.h"
+
+#if ARCH_X86 && defined(__SSE__)
+#include <xmmintrin.h>
+#define SPECTRUM_SSE 1
+#endif
+
+/*
+ Radix 2 decimation in time FFT on split real / imaginary arrays.
+ The twiddles of each pass are stored contiguously, pass h (h butterflies
+ per group) uses twiddle[h - 1 .. 2h - 2], so the butterflies of a group
+ are straight loops over consecutive floats.
+ */
+class FFTPlan
+{
+  public:
+    explicit FFTPlan(int size) : m_size(size)
+    {
+        int bits = 0;
+        while ((1 << bits) < size)
+            bits++;
+
+        m_reverse = new int[size];
+        for (int i = 0; i < size; i++)
+        {
+            int r = 0;
+            for (int j = 0, v = i; j < bits; j++, v >>= 1)
+                r = (r << 1) | (v & 1);
+            m_reverse[i] = r;
+        }
+
+        m_twiddleRe = (float*) av_malloc(sizeof(float) * size);
+        m_twiddleIm = (float*) av_malloc(sizeof(float) * size);
+        for (int h = 1; h < size; h <<= 1)
+        {
+            for (int j = 0; j < h; j++)
+            {
+                m_twiddleRe[h - 1 + j] = cos(M_PI * j / h);
+                m_twiddleIm[h - 1 + j] = -sin(M_PI * j / h);
+            }
+        }
+
+        m_re = (float*) av_malloc(sizeof(float) * size);
+        m_im = (float*) av_malloc(sizeof(float) * size);
+    }
+
+    ~FFTPlan()
+    {
+        delete [] m_reverse;
+        av_free(m_twiddleRe);
+        av_free(m_twiddleIm);
+        av_free(m_re);
+        av_free(m_im);
+    }
+
+    // Loads left + i * right in bit reversed order
+    void Load(const short *left, const short *right, int length)
+    {
+        memset(m_re, 0, sizeof(float) * m_size);
+        memset(m_im, 0, sizeof(float) * m_size);
+        for (int i = 0; i < length; i++)
+        {
+            m_re[m_reverse[i]] = left[i];
+            m_im[m_reverse[i]] = right[i];
+        }
+    }
+
+    void Execute(void)
+    {
+        for (int h = 1; h < m_size; h <<= 1)
+        {
+            const float *wr = m_twiddleRe + h - 1;
+            const float *wi = m_twiddleIm + h - 1;
+
+            for (int k = 0; k < m_size; k += h << 1)
+            {
+                float *ar = m_re + k, *ai = m_im + k;
+                float *br = ar + h,   *bi = ai + h;
+                int j = 0;
+#if SPECTRUM_SSE
+                for (; j + 4 <= h; j += 4)
+                {
+                    __m128 c  = _mm_loadu_ps(wr + j);
+                    __m128 s  = _mm_loadu_ps(wi + j);
+                    __m128 xr = _mm_loadu_ps(br + j);
+                    __m128 xi = _mm_loadu_ps(bi + j);
+                    __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, c), _mm_mul_ps(xi, s));
+                    __m128 ti = _mm_add_ps(_mm_mul_ps(xr, s), _mm_mul_ps(xi, c));
+                    __m128 yr = _mm_loadu_ps(ar + j);
+                    __m128 yi = _mm_loadu_ps(ai + j);
+                    _mm_storeu_ps(br + j, _mm_sub_ps(yr, tr));
+                    _mm_storeu_ps(bi + j, _mm_sub_ps(yi, ti));
+                    _mm_storeu_ps(ar + j, _mm_add_ps(yr, tr));
+                    _mm_storeu_ps(ai + j, _mm_add_ps(yi, ti));
+                }
+#endif
+                for (; j < h; j++)
+                {
+                    float tr = br[j] * wr[j] - bi[j] * wi[j];
+                    float ti = br[j] * wi[j] + bi[j] * wr[j];
+                    br[j] = ar[j] - tr;
+                    bi[j] = ai[j] - ti;
+                    ar[j] += tr;
+                    ai[j] += ti;
+                }
+            }
+        }
+    }
+
+    const float *re(void) const { return m_re; }
+    const float *im(void) const { return m_im; }
+
+  private:
+    int    m_size;
+    int   *m_reverse;
+    float *m_twiddleRe, *m_twiddleIm;
+    float *m_re, *m_im;
+};
+
+// Plans and their work buffers by size, the visualizers run in the UI
+// thread so the lock is normally uncontended
+static QMutex                s_planLock;
+static QHash<int, FFTPlan*>  s_plans;
+
+const VisualSpectrum *VisualSpectrum::Get(VisualNode *node, int size)
+{
+    if (!node)
+        return NULL;
+
+    int n = kMinSize;
+    while (n < size && n < kMaxSize)
+        n <<= 1;
+
+    if (node->spectrum && node->spectrum->size() == n)
+        return node->spectrum;
+
+    delete node->spectrum;
+    node->spectrum = new VisualSpectrum(n);
+
+    int length = (node->length < (unsigned long)n) ? node->length : n;
+    const short *right = node->right ? node->right : node->left;
+    if (!node->left)
+        length = 0;
+
+    node->spectrum->Analyse(node->left, right, length);
+    return node->spectrum;
+}
+
+VisualSpectrum::VisualSpectrum(int size) : m_size(size)
+{
+    int bins = size / 2 + 1;
+    m_leftRe     = (float*) av_malloc(sizeof(float) * bins);
+    m_leftIm     = (float*) av_malloc(sizeof(float) * bins);
+    m_rightRe    = (float*) av_malloc(sizeof(float) * bins);
+    m_rightIm    = (float*) av_malloc(sizeof(float) * bins);
+    m_leftPower  = (float*) av_malloc(sizeof(float) * bins);
+    m_rightPower = (float*) av_malloc(sizeof(float) * bins);
+}
+
+VisualSpectrum::~VisualSpectrum()
+{
+    av_free(m_leftRe);
+    av_free(m_leftIm);
+    av_free(m_rightRe);
+    av_free(m_rightIm);
+    av_free(m_leftPower);
+    av_free(m_rightPower);
+}
+
+void VisualSpectrum::Analyse(const short *left, const short *right,
+                             int length)
+{
+    QMutexLocker locker(&s_planLock);
+
+    FFTPlan *plan = s_plans.value(m_size);
+    if (!plan)
+    {
+        plan = new FFTPlan(m_size);
+        s_plans.insert(m_size, plan);
+    }
+
+    plan->Load(left, right, length);
+    plan->Execute();
+
+    // With z = l + i * r, L[k] = (Z[k] + conj(Z[N-k])) / 2
+    // and R[k] = (Z[k] - conj(Z[N-k])) / 2i
+    const float *re = plan->re();
+    const float *im = plan->im();
+    int bins = m_size / 2 + 1;
+    for (int k = 0; k < bins; k++)
+    {
+        int m = (m_size - k) & (m_size - 1);
+        m_leftRe[k]  = 0.5f * (re[k] + re[m]);
+        m_leftIm[k]  = 0.5f * (im[k] - im[m]);
+        m_rightRe[k] = 0.5f * (im[k] + im[m]);
+        m_rightIm[k] = 0.5f * (re[m] - re[k]);
+
+        m_leftPower[k]  = m_leftRe[k] * m_leftRe[k] +
+                          m_leftIm[k] * m_leftIm[k];
+        m_rightPower[k] = m_rightRe[k] * m_rightRe[k] +
+                          m_rightIm[k] * m_rightIm[k];
+    }
+}
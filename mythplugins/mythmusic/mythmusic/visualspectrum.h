@@ -0,0 +1,52 @@
+#ifndef VISUALSPECTRUM_H
+#define VISUALSPECTRUM_H
+
+class VisualNode;
+
+/** \class VisualSpectrum
+ *  \brief Frequency spectrum of the left and right channels of a VisualNode.
+ *
+ *  The spectrum is computed on first use by Get() and kept with the node,
+ *  so the analysis is done once per node whichever visualizer, and however
+ *  many of them, ask for it. Both channels are transformed together with a
+ *  single complex FFT of the left + i*right signal, using SSE on x86.
+ *
+ *  Bin k of a spectrum of size N is frequency k * samplerate / N, bins go
+ *  from 0 to N / 2. The values are not normalised, they scale with N like
+ *  the output of FFTW.
+ */
+class VisualSpectrum
+{
+  public:
+    static const int kMinSize = 16;
+    static const int kMaxSize = 8192;
+
+    /// Returns the spectrum of \p node for a transform of \p size samples,
+    /// a power of two. The node is truncated or zero padded to \p size.
+    static const VisualSpectrum *Get(VisualNode *node, int size);
+
+    ~VisualSpectrum();
+
+    int size(void) const { return m_size; }
+    int bins(void) const { return m_size / 2 + 1; }
+
+    const float *leftReal(void) const   { return m_leftRe; }
+    const float *leftImag(void) const   { return m_leftIm; }
+    const float *rightReal(void) const  { return m_rightRe; }
+    const float *rightImag(void) const  { return m_rightIm; }
+
+    /// Squared magnitude of each bin
+    const float *leftPower(void) const  { return m_leftPower; }
+    const float *rightPower(void) const { return m_rightPower; }
+
+  private:
+    explicit VisualSpectrum(int size);
+
+    void Analyse(const short *left, const short *right, int length);
+
+    int    m_size;
+    float *m_leftRe, *m_leftIm, *m_rightRe, *m_rightIm;
+    float *m_leftPower, *m_rightPower;
+};
+
+#endif // VISUALSPECTRUM_H
@@ -28,7 +28,6 @@ using namespace std;
 #define LOC QString("AOBase: ")
 
 #define WPOS audiobuffer + org_waud
-#define RPOS audiobuffer + raud
 #define ABUF audiobuffer
 #define STST soundtouch::SAMPLETYPE
 #define AOALIGN(x) (((long)&x + 15) & ~0xf);
@@ -344,7 +343,8 @@ void AudioOutputBase::SetStretchFactorLocked(float lstretchfactor)
             pSoundStretch = NULL;
             VBGENERAL(QString("Cancelling time stretch"));
             bytes_per_frame = m_previousbpf;
-            waud = raud = 0;
+            waud.storeRelease(0);
+            raud.storeRelease(0);
             reset_active.Ref();
         }
         else
@@ -373,7 +373,8 @@ void AudioOutputBase::SetStretchFactorLocked(float lstretchfactor)
             bytes_per_frame = source_channels *
                               AudioOutputSettings::SampleSize(FORMAT_FLT);
             audbuf_timecode = audiotime = frames_buffered = 0;
-            waud = raud = 0;
+            waud.storeRelease(0);
+            raud.storeRelease(0);
             reset_active.Ref();
             was_paused = pauseaudio;
             pauseaudio = true;
@@ -630,7 +631,8 @@ void AudioOutputBase::Reconfigure(const AudioSettings &orig_settings)
     QMutexLocker lock(&audio_buflock);
     QMutexLocker lockav(&avsync_lock);
 
-    waud = raud = 0;
+    waud.storeRelease(0);
+    raud.storeRelease(0);
     reset_active.Clear();
     actually_paused = processing = m_forcedprocessing = false;
 
@@ -959,12 +961,13 @@ void AudioOutputBase::Reset()
     audbuf_timecode = audiotime = frames_buffered = 0;
     if (encoder)
     {
-        waud = raud = 0;    // empty ring buffer
+        waud.storeRelease(0);    // empty ring buffer
+        raud.storeRelease(0);
         memset(audiobuffer, 0, kAudioRingBufferSize);
     }
     else
     {
-        waud = raud;        // empty ring buffer
+        waud.storeRelease(raud.loadAcquire()); // empty ring buffer
     }
     reset_active.Ref();
     current_seconds = -1;
@@ -1010,10 +1013,13 @@ void AudioOutputBase::SetEffDsp(int dsprate)
  */
 inline int AudioOutputBase::audiolen()
 {
-    if (waud >= raud)
-        return waud - raud;
+    int w = waud.loadAcquire();
+    int r = raud.loadAcquire();
+
+    if (w >= r)
+        return w - r;
     else
-        return kAudioRingBufferSize - (raud - waud);
+        return kAudioRingBufferSize - (r - w);
 }
 
 /**
@@ -1359,7 +1365,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
     // Don't write new samples if we're resetting the buffer or reconfiguring
     QMutexLocker lock(&audio_buflock);
 
-    uint org_waud = waud;
+    uint org_waud = waud.loadAcquire();
     int  afree    = audiofree();
     int  used     = kAudioRingBufferSize - afree;
 
@@ -1513,7 +1519,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
         frames = len / bpf;
         frames_final += frames;
 
-        bdiff = kAudioRingBufferSize - waud;
+        bdiff = kAudioRingBufferSize - waud.loadAcquire();
         if ((len % bpf) != 0 && bdiff < len)
         {
             VBERROR(QString("AddData: Corruption likely: len = %1 (bpf = %2)")
@@ -1530,7 +1536,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
         if (pSoundStretch)
         {
             // does not change the timecode, only the number of samples
-            org_waud     = waud;
+            org_waud     = waud.loadAcquire();
             int bdFrames = bdiff / bpf;
 
             if (bdiff < len)
@@ -1562,7 +1568,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
 
         if (internal_vol && SWVolume())
         {
-            org_waud    = waud;
+            org_waud    = waud.loadAcquire();
             int num     = len;
 
             if (bdiff <= num)
@@ -1580,7 +1586,7 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
 
         if (encoder)
         {
-            org_waud            = waud;
+            org_waud            = waud.loadAcquire();
             int to_get          = 0;
 
             if (bdiff < len)
@@ -1607,7 +1613,8 @@ bool AudioOutputBase::AddData(void *in_buffer, int in_len,
             org_waud = (org_waud + to_get) % kAudioRingBufferSize;
         }
 
-        waud = org_waud;
+        // publish the new samples to the output thread
+        waud.storeRelease(org_waud);
     }
 
     SetAudiotime(frames_final, timecode);
@@ -1717,14 +1724,14 @@ void AudioOutputBase::OutputAudioLoop(void)
         // delay setting raud until after phys buffer is filled
         // so GetAudiotime will be accurate without locking
         reset_active.TestAndDeref();
-        volatile uint next_raud = raud;
+        uint next_raud = raud.loadAcquire();
         if (GetAudioData(fragment, fragment_size, true, &next_raud))
         {
             if (!reset_active.TestAndDeref())
             {
                 WriteAudio(fragment, fragment_size);
                 if (!reset_active.TestAndDeref())
-                    raud = next_raud;
+                    raud.storeRelease(next_raud);
             }
         }
 #ifdef AUDIOTSTESTING
@@ -1749,18 +1756,19 @@ void AudioOutputBase::OutputAudioLoop(void)
  * available. Returns the number of bytes copied.
  */
 int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
-                                  volatile uint *local_raud)
+                                  uint *local_raud)
 {
 
-#define LRPOS audiobuffer + *local_raud
+#define LRPOS audiobuffer + read_pos
     // re-check audioready() in case things changed.
     // for example, ClearAfterSeek() might have run
     int avail_size   = audioready();
     int frag_size    = size;
     int written_size = size;
 
-    if (local_raud == NULL)
-        local_raud = &raud;
+    // Only the output thread advances raud, so work on a private copy
+    // and publish it once the samples have been consumed
+    uint read_pos    = local_raud ? *local_raud : raud.loadAcquire();
 
     if (!full_buffer && (size > avail_size))
     {
@@ -1772,7 +1780,7 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
     if (!avail_size || (frag_size > avail_size))
         return 0;
 
-    int bdiff = kAudioRingBufferSize - raud;
+    int bdiff = kAudioRingBufferSize - read_pos;
 
     int obytes = output_settings->SampleSize(output_format);
 
@@ -1799,7 +1807,7 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
         }
 
         frag_size -= bdiff;
-        *local_raud = 0;
+        read_pos = 0;
     }
     if (frag_size > 0)
     {
@@ -1810,7 +1818,12 @@ int AudioOutputBase::GetAudioData(uchar *buffer, int size, bool full_buffer,
             memcpy(buffer + off, LRPOS, frag_size);
     }
 
-    *local_raud += frag_size;
+    read_pos += frag_size;
+
+    if (local_raud)
+        *local_raud = read_pos;
+    else
+        raud.storeRelease(read_pos);
 
     // Mute individual channels through mono->stereo duplication
     MuteState mute_state = GetMuteState();
@@ -1838,7 +1851,8 @@ void AudioOutputBase::Drain()
         // Audio is paused and can't be drained, clear ringbuffer
         QMutexLocker lock(&audio_buflock);
 
-        waud = raud = 0;
+        waud.storeRelease(0);
+        raud.storeRelease(0);
     }
 }
 
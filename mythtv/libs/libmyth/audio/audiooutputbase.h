@@ -6,6 +6,7 @@
 
 // Qt headers
 #include <QString>
+#include <QAtomicInt>
 #include <QMutex>
 #include <QWaitCondition>
 
@@ -145,7 +146,7 @@ class AudioOutputBase : public AudioOutput, public MThread
     virtual void StopOutputThread(void);
 
     int GetAudioData(uchar *buffer, int buf_size, bool fill_buffer,
-                     volatile uint *local_raud = NULL);
+                     uint *local_raud = NULL);
 
     void OutputAudioLoop(void);
 
@@ -253,9 +254,11 @@ class AudioOutputBase : public AudioOutput, public MThread
     int64_t audiotime;
 
     /**
-     * Audio circular buffer
+     * Audio circular buffer, a single producer (AddData) single consumer
+     * (OutputAudioLoop) ring. Only the writer stores waud and only the
+     * reader stores raud, except while resetting under audio_buflock.
      */
-    volatile uint raud, waud;     // read and write positions
+    QAtomicInt raud, waud;        // read and write positions
     /**
      * timecode of audio most recently placed into buffer
      */
@@ -18,9 +18,15 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "audiooutputbase.h"
 #include "audiooutputdownmix.h"
+#include "audiooutpututil.h"
 
 #include "string.h"
 
+#if ARCH_X86 && defined(__SSE__)
+#include <xmmintrin.h>
+#define DOWNMIX_SSE 1
+#endif
+
 #define LOC QString("Downmixer: ")
 
 /*
@@ -164,12 +170,106 @@ static const float s51_matrix[3][8][6] =
     }
 };
 
+#if DOWNMIX_SSE
+/*
+ Downmix to stereo two frames at a time, the four outputs of a frame pair
+ (L0 R0 L1 R1) are accumulated in a single register.
+ Returns the number of frames processed, any remainder is left for the C code
+ */
+static int downmix_stereo_sse(const float (*matrix)[2], int channels_in,
+                              float *dst, const float *src, int frames)
+{
+    __m128 coef[8];
+    for (int j = 0; j < channels_in; j++)
+        coef[j] = _mm_setr_ps(matrix[j][0], matrix[j][1],
+                              matrix[j][0], matrix[j][1]);
+
+    int loops = frames >> 1;
+    for (int n = 0; n < loops; n++)
+    {
+        const float *src1 = src + channels_in;
+        __m128 acc = _mm_setzero_ps();
+        for (int j = 0; j < channels_in; j++)
+        {
+            __m128 in = _mm_setr_ps(src[j], src[j], src1[j], src1[j]);
+            acc = _mm_add_ps(acc, _mm_mul_ps(in, coef[j]));
+        }
+        _mm_storeu_ps(dst, acc);
+        dst += 4;
+        src += channels_in << 1;
+    }
+    return loops << 1;
+}
+
+/*
+ Downmix to 5.1, the six outputs of a frame are accumulated in one full
+ and one half register.
+ */
+static int downmix_51_sse(const float (*matrix)[6], int channels_in,
+                          float *dst, const float *src, int frames)
+{
+    __m128 coeflo[8], coefhi[8];
+    for (int j = 0; j < channels_in; j++)
+    {
+        coeflo[j] = _mm_loadu_ps(&matrix[j][0]);
+        coefhi[j] = _mm_setr_ps(matrix[j][4], matrix[j][5], 0.0f, 0.0f);
+    }
+
+    for (int n = 0; n < frames; n++)
+    {
+        __m128 acclo = _mm_setzero_ps();
+        __m128 acchi = _mm_setzero_ps();
+        for (int j = 0; j < channels_in; j++)
+        {
+            __m128 in = _mm_set1_ps(src[j]);
+            acclo = _mm_add_ps(acclo, _mm_mul_ps(in, coeflo[j]));
+            acchi = _mm_add_ps(acchi, _mm_mul_ps(in, coefhi[j]));
+        }
+        _mm_storeu_ps(dst, acclo);
+        _mm_storel_pi((__m64 *)(dst + 4), acchi);
+        dst += 6;
+        src += channels_in;
+    }
+    return frames;
+}
+#endif //DOWNMIX_SSE
+
 int AudioOutputDownmix::DownmixFrames(int channels_in, int  channels_out,
                                       float *dst, float *src, int frames)
 {
     if (channels_in < channels_out)
         return -1;
 
+    int n = 0;
+#if DOWNMIX_SSE
+    if (AudioOutputUtil::has_hardware_fpu())
+    {
+        if (channels_out == 2)
+            n = downmix_stereo_sse(stereo_matrix[channels_in - 1],
+                                   channels_in, dst, src, frames);
+        else if (channels_out == 6)
+            n = downmix_51_sse(s51_matrix[channels_in - 6],
+                               channels_in, dst, src, frames);
+    }
+#endif //DOWNMIX_SSE
+
+    // The frames left over by the SSE code, or all of them
+    if (DownmixFramesC(channels_in, channels_out, dst + n * channels_out,
+                       src + n * channels_in, frames - n) < 0)
+        return -1;
+
+    return frames;
+}
+
+/*
+ Plain C downmix, also the reference the SSE code is tested against
+ */
+int AudioOutputDownmix::DownmixFramesC(int channels_in, int  channels_out,
+                                       float *dst, float *src, int frames)
+{
+    if (channels_in < channels_out)
+        return -1;
+
     //VBAUDIO(LOC + QString("Downmixing %1 frames (in:%2 out:%3)")
     //    .arg(frames).arg(channels_in).arg(channels_out));
     if (channels_out == 2)
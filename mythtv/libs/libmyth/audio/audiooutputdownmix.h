@@ -1,11 +1,17 @@
 #ifndef AUDIOOUTPUTDOWNMIX
 #define AUDIOOUTPUTDOWNMIX
 
-class AudioOutputDownmix
+#include "mythexp.h"
+
+class MPUBLIC AudioOutputDownmix
 {
 public:
     static int DownmixFrames(int channels_in, int  channels_out,
                              float *dst, float *src, int frames);
+
+protected:
+    static int DownmixFramesC(int channels_in, int  channels_out,
+                              float *dst, float *src, int frames);
 };
 
 #endif
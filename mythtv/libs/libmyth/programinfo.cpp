@@ -12,6 +12,7 @@ using std::min;
 
 // Qt headers
 #include <QRegExp>
+#include <QHash>
 #include <QMap>
 #include <QUrl>
 #include <QFile>
@@ -5401,6 +5402,20 @@ QStringList ProgramInfo::LoadFromScheduler(
     return slist;
 }
 
+/// Returns the pooled copy of \p str, adding \p str if there is none yet
+QString ProgramStringPool::Intern(const QString &str)
+{
+    if (str.isEmpty())
+        return str;
+
+    QSet<QString>::const_iterator it = m_strings.constFind(str);
+    if (it != m_strings.constEnd())
+        return *it;
+
+    m_strings.insert(str);
+    return str;
+}
+
 // NOTE: This may look ugly, and in some ways it is, but it's designed this
 //       way for with two purposes in mind - Consistent behaviour and speed
 //       So if you do make changes then carefully test that it doesn't result
@@ -5570,25 +5585,48 @@ bool LoadFromProgram( ProgramList &destination,
     if (count == 0)
         count = query.size();
 
+    // Only the scheduled showings starting at the same time as a program
+    // can match it, so index them by start time rather than checking every
+    // program against the whole schedule.
+    QHash<uint, ProgramList*> schedByStart;
+    ProgramList::const_iterator sit = schedList.begin();
+    for (; sit != schedList.end(); ++sit)
+    {
+        uint start = (*sit)->GetScheduledStartTime().toTime_t();
+        ProgramList *matches = schedByStart.value(start);
+        if (!matches)
+        {
+            matches = new ProgramList(false);
+            schedByStart.insert(start, matches);
+        }
+        matches->push_back(*sit);
+    }
+    const ProgramList noMatches(false);
+
+    ProgramStringPool pool;
+
     while (query.next())
     {
+        QDateTime startts = MythDate::as_utc(query.value(1).toDateTime());
+        const ProgramList *matches = schedByStart.value(startts.toTime_t());
+
         destination.push_back(
             new ProgramInfo(
-                query.value(3).toString(), // title
+                pool.Intern(query.value(3).toString()), // title
                 query.value(4).toString(), // subtitle
                 query.value(5).toString(), // description
                 query.value(26).toString(), // syndicatedepisodenumber
-                query.value(6).toString(), // category
+                pool.Intern(query.value(6).toString()), // category
 
                 query.value(0).toUInt(), // chanid
-                query.value(7).toString(), // channum
-                query.value(8).toString(), // chansign
-                query.value(9).toString(), // channame
-                query.value(12).toString(), // chanplaybackfilters
+                pool.Intern(query.value(7).toString()), // channum
+                pool.Intern(query.value(8).toString()), // chansign
+                pool.Intern(query.value(9).toString()), // channame
+                pool.Intern(query.value(12).toString()), // chanplaybackfilters
 
-                MythDate::as_utc(query.value(1).toDateTime()), // startts
+                startts,
                 MythDate::as_utc(query.value(2).toDateTime()), // endts
-                MythDate::as_utc(query.value(1).toDateTime()), // recstartts
+                startts, // recstartts
                 MythDate::as_utc(query.value(2).toDateTime()), // recendts
 
                 query.value(13).toString(), // seriesid
@@ -5614,9 +5652,11 @@ bool LoadFromProgram( ProgramList &destination,
                 query.value(30).toUInt(), // episode
                 query.value(31).toUInt(), // totalepisodes
 
-                schedList));
+                matches ? *matches : noMatches));
     }
 
+    qDeleteAll(schedByStart);
+
     return true;
 }
 
@@ -5688,6 +5728,8 @@ bool LoadFromOldRecorded(
         return false;
     }
 
+    ProgramStringPool pool;
+
     while (query.next())
     {
         uint chanid = query.value(0).toUInt();
@@ -5702,17 +5744,18 @@ bool LoadFromOldRecorded(
         }
 
         destination.push_back(new ProgramInfo(
-            query.value(3).toString(),
+            pool.Intern(query.value(3).toString()),
             query.value(4).toString(),
             query.value(5).toString(),
             query.value(6).toUInt(),
             query.value(7).toUInt(),
-            query.value(8).toString(),
+            pool.Intern(query.value(8).toString()),
 
-            chanid, channum, chansign, channame,
+            chanid, pool.Intern(channum), pool.Intern(chansign),
+            pool.Intern(channame),
 
             query.value(9).toString(), query.value(10).toString(),
-            query.value(11).toString(),
+            pool.Intern(query.value(11).toString()),
 
             MythDate::as_utc(query.value(1).toDateTime()),
             MythDate::as_utc(query.value(2).toDateTime()),
@@ -5730,6 +5773,32 @@ bool LoadFromOldRecorded(
     return true;
 }
 
+/// Marks recordings left as being commercial flagged by a job which is no
+/// longer running as not flagged, with one UPDATE for all of them
+static void reset_commflagged(const QList<ProgramInfo*> &programs)
+{
+    QStringList ids;
+    QList<ProgramInfo*>::const_iterator it = programs.begin();
+    for (; it != programs.end(); ++it)
+        ids << QString::number((*it)->GetRecordingID());
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(QString("UPDATE recorded"
+                          " SET commflagged = :FLAG"
+                          " WHERE recordedid IN (%1)").arg(ids.join(",")));
+    query.bindValue(":FLAG", (int)COMM_FLAG_NOT_FLAGGED);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("Commercial Flagged status update", query);
+        return;
+    }
+
+    // The flags of the programs were already cleared by the caller
+    for (it = programs.begin(); it != programs.end(); ++it)
+        (*it)->SendUpdateEvent();
+}
+
 /** \fn ProgramInfo::LoadFromRecorded(void)
  *  \brief Load a ProgramList from the recorded table.
  *  \param destination     ProgramList to fill
@@ -5779,6 +5848,10 @@ bool LoadFromRecorded(
         return true;
     }
 
+    ProgramStringPool pool;
+    const QString localhost = gCoreContext->GetHostName();
+    QList<ProgramInfo*> notCommFlagged;
+
     while (query.next())
     {
         const uint chanid = query.value(6).toUInt();
@@ -5796,7 +5869,7 @@ bool LoadFromRecorded(
 
         QString hostname = query.value(15).toString();
         if (hostname.isEmpty())
-            hostname = gCoreContext->GetHostName();
+            hostname = localhost;
 
         RecStatus::Type recstatus = RecStatus::Recorded;
         QDateTime recstartts = MythDate::as_utc(query.value(24).toDateTime());
@@ -5858,25 +5931,28 @@ bool LoadFromRecorded(
         destination.push_back(
             new ProgramInfo(
                 query.value(55).toUInt(),
-                query.value(0).toString(),
+                pool.Intern(query.value(0).toString()),
                 query.value(1).toString(),
                 query.value(2).toString(),
                 season,
                 episode,
                 totalepisodes,
                 query.value(48).toString(), // syndicatedepisode
-                query.value(5).toString(), // category
+                pool.Intern(query.value(5).toString()), // category
 
-                chanid, channum, chansign, channame, chanfilt,
+                chanid, pool.Intern(channum), pool.Intern(chansign),
+                pool.Intern(channame), pool.Intern(chanfilt),
 
-                query.value(11).toString(), query.value(12).toString(),
+                pool.Intern(query.value(11).toString()), // recgroup
+                pool.Intern(query.value(12).toString()), // playgroup
 
                 query.value(14).toString(), // pathname
 
-                hostname, query.value(13).toString(),
+                pool.Intern(hostname),
+                pool.Intern(query.value(13).toString()), // storagegroup
 
                 query.value(17).toString(), query.value(18).toString(),
-                query.value(19).toString(), // inetref
+                pool.Intern(query.value(19).toString()), // inetref
                 string_to_myth_category_type(query.value(54).toString()), // category_type
 
                 query.value(16).toInt(),  // recpriority
@@ -5909,14 +5985,17 @@ bool LoadFromRecorded(
                 query.value(42).toUInt(), // audioproperties
                 query.value(43).toUInt(), // videoproperties
                 query.value(44).toUInt(), // subtitleType
-                query.value(56).toString(), // inputname
+                pool.Intern(query.value(56).toString()), // inputname
                 MythDate::as_utc(query.value(57)
                                  .toDateTime()))); // bookmarkupdate
 
         if (save_not_commflagged)
-            destination.back()->SaveCommFlagged(COMM_FLAG_NOT_FLAGGED);
+            notCommFlagged.push_back(destination.back());
     }
 
+    if (!notCommFlagged.empty())
+        reset_commflagged(notCommFlagged);
+
     return true;
 }
 
@@ -9,6 +9,7 @@
 
 #include <QStringList>
 #include <QDateTime>
+#include <QSet>
 
 // MythTV headers
 #include "autodeletedeque.h"
@@ -548,6 +549,8 @@ class MPUBLIC ProgramInfo
     void SetRecordingRuleType(RecordingType type) { rectype   = type;   }
     void SetPositionMapDBReplacement(PMapDBReplacement *pmap)
         { positionMapDBReplacement = pmap; }
+    bool HasPositionMapDBReplacement(void) const
+        { return positionMapDBReplacement; }
 
     // Slow DB gets
     QString     QueryBasename(void) const;
@@ -789,6 +792,25 @@ class MPUBLIC ProgramInfo
     static bool usingProgIDAuth;
 };
 
+/** \class ProgramStringPool
+ *  \brief Keeps a single copy of the strings repeated across a list.
+ *
+ *  The same titles, categories, channel and group names come back
+ *  thousands of times when loading large lists. The loaders below pass
+ *  them through Intern() so all the programs of a list share the data
+ *  of one QString instead of each holding its own copy.
+ */
+class MPUBLIC ProgramStringPool
+{
+  public:
+    QString Intern(const QString &str);
+    uint    size(void) const { return m_strings.size(); }
+    void    clear(void)      { m_strings.clear(); }
+
+  private:
+    QSet<QString> m_strings;
+};
+
 MPUBLIC bool LoadFromProgram(
     ProgramList        &destination,
     const QString      &sql,
@@ -22,6 +22,8 @@
 
 #include "mythcorecontext.h"
 #include "audioconvert.h"
+#include "audiooutpututil.h"
+#include "audiooutputdownmix.h"
 
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #define MSKIP(MSG) QSKIP(MSG, SkipSingle)
@@ -35,6 +37,17 @@
 
 #define ISIZEOF(type) ((int)sizeof(type))
 
+// one second of 7.1 audio at 48kHz, the size of the benchmark buffers
+#define BENCH_FRAMES   48000
+#define BENCH_CHANNELS 8
+
+// Gives access to the C downmix, to check the SSE code against it
+class TestDownmix : public AudioOutputDownmix
+{
+  public:
+    using AudioOutputDownmix::DownmixFramesC;
+};
+
 class TestAudioConvert: public QObject
 {
     Q_OBJECT
@@ -597,4 +610,136 @@ class TestAudioConvert: public QObject
         av_free(arrays2);
         av_free(arrayf1);
     }
+
+    void DownmixConsistency_data(void)
+    {
+        QTest::addColumn<int>("CHANNELS_IN");
+        QTest::addColumn<int>("CHANNELS_OUT");
+        QTest::newRow("7.1 to stereo") << 8 << 2;
+        QTest::newRow("5.1 to stereo") << 6 << 2;
+        QTest::newRow("7.1 to 5.1") << 8 << 6;
+    }
+
+    // The SSE code, where available, must give the same result as the
+    // C code, also for the frames left over by the SSE code
+    void DownmixConsistency(void)
+    {
+        QFETCH(int, CHANNELS_IN);
+        QFETCH(int, CHANNELS_OUT);
+
+        int    FRAMES  = 33; // odd, so the C code handles the last frame
+        float *src     = (float*)av_malloc(FRAMES * CHANNELS_IN * ISIZEOF(float));
+        float *dst1    = (float*)av_malloc(FRAMES * CHANNELS_OUT * ISIZEOF(float));
+        float *dst2    = (float*)av_malloc(FRAMES * CHANNELS_OUT * ISIZEOF(float));
+
+        for (int i = 0; i < FRAMES * CHANNELS_IN; i++)
+        {
+            src[i] = (float)((i * 7919) % 2001 - 1000) / 1000.0f;
+        }
+
+        int val1 = AudioOutputDownmix::DownmixFrames(CHANNELS_IN, CHANNELS_OUT,
+                                                     dst1, src, FRAMES);
+        QCOMPARE(val1, FRAMES);
+        int val2 = TestDownmix::DownmixFramesC(CHANNELS_IN, CHANNELS_OUT,
+                                               dst2, src, FRAMES);
+        QCOMPARE(val2, FRAMES);
+        for (int i = 0; i < FRAMES * CHANNELS_OUT; i++)
+        {
+            QCOMPARE(dst1[i], dst2[i]);
+        }
+
+        av_free(src);
+        av_free(dst1);
+        av_free(dst2);
+    }
+
+    /*
+     * Throughput benchmarks, each iteration processes one second of 7.1
+     * audio. Run with -tickcounter or -callgrind for more stable figures.
+     */
+    void S16ToFloatBenchmark(void)
+    {
+        int    SAMPLES = BENCH_FRAMES * BENCH_CHANNELS;
+        short *arrays  = (short*)av_mallocz(SAMPLES * ISIZEOF(short));
+        float *arrayf  = (float*)av_malloc(SAMPLES * ISIZEOF(float));
+
+        QBENCHMARK
+        {
+            AudioConvert::toFloat(FORMAT_S16, arrayf, arrays,
+                                  SAMPLES * ISIZEOF(short));
+        }
+
+        av_free(arrays);
+        av_free(arrayf);
+    }
+
+    void FloatToS16Benchmark(void)
+    {
+        int    SAMPLES = BENCH_FRAMES * BENCH_CHANNELS;
+        short *arrays  = (short*)av_malloc(SAMPLES * ISIZEOF(short));
+        float *arrayf  = (float*)av_mallocz(SAMPLES * ISIZEOF(float));
+
+        QBENCHMARK
+        {
+            AudioConvert::fromFloat(FORMAT_S16, arrays, arrayf,
+                                    SAMPLES * ISIZEOF(float));
+        }
+
+        av_free(arrays);
+        av_free(arrayf);
+    }
+
+    void FloatToS32Benchmark(void)
+    {
+        int    SAMPLES = BENCH_FRAMES * BENCH_CHANNELS;
+        int   *arrays  = (int*)av_malloc(SAMPLES * ISIZEOF(int));
+        float *arrayf  = (float*)av_mallocz(SAMPLES * ISIZEOF(float));
+
+        QBENCHMARK
+        {
+            AudioConvert::fromFloat(FORMAT_S32, arrays, arrayf,
+                                    SAMPLES * ISIZEOF(float));
+        }
+
+        av_free(arrays);
+        av_free(arrayf);
+    }
+
+    void VolumeBenchmark(void)
+    {
+        int    SAMPLES = BENCH_FRAMES * BENCH_CHANNELS;
+        float *arrayf  = (float*)av_mallocz(SAMPLES * ISIZEOF(float));
+
+        QBENCHMARK
+        {
+            AudioOutputUtil::AdjustVolume(arrayf, SAMPLES * ISIZEOF(float),
+                                          80, false, false);
+        }
+
+        av_free(arrayf);
+    }
+
+    void DownmixBenchmark_data(void)
+    {
+        QTest::addColumn<int>("CHANNELS_OUT");
+        QTest::newRow("7.1 to stereo") << 2;
+        QTest::newRow("7.1 to 5.1") << 6;
+    }
+
+    void DownmixBenchmark(void)
+    {
+        QFETCH(int, CHANNELS_OUT);
+
+        float *src = (float*)av_mallocz(BENCH_FRAMES * BENCH_CHANNELS * ISIZEOF(float));
+        float *dst = (float*)av_malloc(BENCH_FRAMES * CHANNELS_OUT * ISIZEOF(float));
+
+        QBENCHMARK
+        {
+            AudioOutputDownmix::DownmixFrames(BENCH_CHANNELS, CHANNELS_OUT,
+                                              dst, src, BENCH_FRAMES);
+        }
+
+        av_free(src);
+        av_free(dst);
+    }
 };
@@ -0,0 +1,484 @@
+/*
+ *  Class TestProgramInfoLoad
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QVector>
+
+#include "mythcorecontext.h"
+#include "mythdb.h"
+#include "mthreadpool.h"
+#include "programinfo.h"
+#include "programtypes.h"
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+#define MSKIP(MSG) QSKIP(MSG, SkipSingle)
+#else
+#define MSKIP(MSG) QSKIP(MSG)
+#endif
+
+/// Fixture rows use chanids and recordedids from here up
+#define FIXTURE_ID 99000
+
+/**
+ * Benchmarks assembling the ProgramList of LoadFromRecorded() from
+ * synthetic rows, with and without the string pool it uses.
+ *
+ * Each row holds the UTF-8 bytes of the columns, and every value is
+ * converted to a new QString like the database driver does, so the
+ * pooled runs pay for the lookups and keep a single copy of each
+ * repeated string.
+ *
+ * The loader tests run LoadFromRecorded() and LoadFromProgram() against
+ * fixture rows. They need a scratch MythTV database, named by
+ * MYTHTV_TEST_DB_NAME and reached with MYTHTV_TEST_DB_HOST,
+ * MYTHTV_TEST_DB_USER and MYTHTV_TEST_DB_PASSWORD, and are skipped
+ * without one. Fixture rows are removed before and after the run.
+ */
+class TestProgramInfoLoad : public QObject
+{
+    Q_OBJECT
+
+    bool m_haveDB;
+
+    struct Row
+    {
+        uint       recordedid;
+        uint       chanid;
+        QByteArray title, subtitle, description, category;
+        QByteArray channum, callsign, channame;
+        QByteArray recgroup, playgroup, pathname, hostname, storagegroup;
+        QByteArray inetref, inputname;
+        QDateTime  startts, endts;
+    };
+
+    QVector<Row> makeRows(int count)
+    {
+        static const char *categories[] =
+            { "Comedy", "Drama", "News", "Documentary", "Sports", "Kids" };
+        static const char *recgroups[] =
+            { "Default", "Kids", "Movies", "LiveTV" };
+
+        QVector<Row> rows(count);
+        QDateTime start = MythDate::fromString("2010-01-01 00:00:00");
+
+        for (int i = 0; i < count; i++)
+        {
+            Row &row = rows[i];
+            uint chan = i % 150;
+
+            row.recordedid   = i + 1;
+            row.chanid       = 1000 + chan;
+            row.title        = QString("Series %1").arg(i % 400).toUtf8();
+            row.subtitle     = QString("Episode %1").arg(i).toUtf8();
+            row.description  = QString("Description of episode %1 of "
+                                       "series %2").arg(i).arg(i % 400)
+                                   .toUtf8();
+            row.category     = categories[i % 6];
+            row.channum      = QByteArray::number(chan + 1);
+            row.callsign     = "CALL" + QByteArray::number(chan);
+            row.channame     = "Channel " + QByteArray::number(chan);
+            row.recgroup     = recgroups[i % 4];
+            row.playgroup    = "Default";
+            row.pathname     = QString("%1_%2.ts").arg(row.chanid)
+                                   .arg(i).toUtf8();
+            row.hostname     = (i % 3) ? "backend1" : "backend2";
+            row.storagegroup = "Default";
+            row.inetref      = QString("ttvdb.py_%1").arg(70000 + i % 400)
+                                   .toUtf8();
+            row.inputname    = "Tuner " + QByteArray::number(i % 4);
+            row.startts      = start.addSecs(i * 1800);
+            row.endts        = row.startts.addSecs(1800);
+        }
+
+        return rows;
+    }
+
+    static QString str(const QByteArray &value, ProgramStringPool *pool)
+    {
+        QString s = QString::fromUtf8(value);
+        return pool ? pool->Intern(s) : s;
+    }
+
+    void assemble(const QVector<Row> &rows, ProgramList &list,
+                  ProgramStringPool *pool)
+    {
+        QVector<Row>::const_iterator it = rows.begin();
+        for (; it != rows.end(); ++it)
+        {
+            list.push_back(new ProgramInfo(
+                it->recordedid,
+                str(it->title, pool),
+                QString::fromUtf8(it->subtitle),
+                QString::fromUtf8(it->description),
+                1, 2, 10,
+                QString(),
+                str(it->category, pool),
+
+                it->chanid,
+                str(it->channum, pool),
+                str(it->callsign, pool),
+                str(it->channame, pool),
+                QString(),
+
+                str(it->recgroup, pool),
+                str(it->playgroup, pool),
+
+                QString::fromUtf8(it->pathname),
+
+                str(it->hostname, pool),
+                str(it->storagegroup, pool),
+
+                QString(), QString(),
+                str(it->inetref, pool),
+                ProgramInfo::kCategorySeries,
+
+                0, 1024 * 1024 * 1024,
+
+                it->startts, it->endts, it->startts, it->endts,
+
+                0.0f, 2010, 0, 0, QDate(), it->endts,
+
+                RecStatus::Recorded, 1,
+                kDupsInAll, kDupCheckSubThenDesc, 0,
+
+                0, 0, 0, 0,
+                str(it->inputname, pool),
+                QDateTime()));
+        }
+    }
+
+    static QString env(const char *name, const char *def)
+    {
+        QString value = QString::fromLocal8Bit(qgetenv(name));
+        return value.isEmpty() ? QString(def) : value;
+    }
+
+    static bool exec(const QString &sql)
+    {
+        MSqlQuery query(MSqlQuery::InitCon());
+        if (query.exec(sql))
+            return true;
+        MythDB::DBError("TestProgramInfoLoad", query);
+        return false;
+    }
+
+    static void removeFixtures(void)
+    {
+        QString where = QString(" WHERE chanid >= %1").arg(FIXTURE_ID);
+        exec("DELETE FROM recorded" + where);
+        exec("DELETE FROM program" + where);
+        exec("DELETE FROM channel" + where);
+    }
+
+    static bool addChannel(uint chanid, const QString &callsign)
+    {
+        return exec(QString("INSERT INTO channel "
+                            "(chanid, channum, callsign, name, sourceid) "
+                            "VALUES (%1, '%2', '%3', '%3 Channel', 1)")
+                    .arg(chanid).arg(chanid - FIXTURE_ID).arg(callsign));
+    }
+
+    static bool addRecording(uint recordedid, uint chanid,
+                             const QString &title, const QString &start,
+                             int commflagged)
+    {
+        return exec(QString("INSERT INTO recorded "
+                            "(recordedid, chanid, starttime, endtime, "
+                            " progstart, progend, title, subtitle, "
+                            " description, category, hostname, basename, "
+                            " commflagged, recgroup, storagegroup) "
+                            "VALUES (%1, %2, '%3', '%3' + INTERVAL 30 MINUTE,"
+                            " '%3', '%3' + INTERVAL 30 MINUTE, '%4', '', '',"
+                            " 'Drama', 'testhost', '%2_%1.ts', %5, "
+                            " 'Default', 'Default')")
+                    .arg(recordedid).arg(chanid).arg(start).arg(title)
+                    .arg(commflagged));
+    }
+
+    static bool addProgram(uint chanid, const QString &title,
+                           const QString &start)
+    {
+        return exec(QString("INSERT INTO program "
+                            "(chanid, starttime, endtime, title, subtitle, "
+                            " description, category, category_type) "
+                            "VALUES (%1, '%2', '%2' + INTERVAL 30 MINUTE, "
+                            " '%3', 'Part one', 'The first part', 'Drama', "
+                            " 'series')")
+                    .arg(chanid).arg(start).arg(title));
+    }
+
+    static int commFlagged(uint recordedid)
+    {
+        MSqlQuery query(MSqlQuery::InitCon());
+        query.prepare("SELECT commflagged FROM recorded "
+                      "WHERE recordedid = :ID");
+        query.bindValue(":ID", recordedid);
+        if (!query.exec() || !query.next())
+            return -1;
+        return query.value(0).toInt();
+    }
+
+    /// A scheduled showing, as the scheduler would hand it to
+    /// LoadFromProgram()
+    static ProgramInfo *scheduled(uint chanid, const QString &callsign,
+                                  const QString &title, const QString &start,
+                                  RecStatus::Type recstatus, uint recordid)
+    {
+        QDateTime startts = MythDate::fromString(start);
+        QDateTime endts   = startts.addSecs(1800);
+
+        return new ProgramInfo(
+            0, title, "Part one", "The first part", 0, 0, 0,
+            QString(), "Drama",
+            chanid, QString::number(chanid - FIXTURE_ID), callsign,
+            callsign + " Channel", QString(),
+            "Default", "Default", QString(), "testhost", "Default",
+            QString(), QString(), QString(), ProgramInfo::kCategorySeries,
+            0, 0,
+            startts, endts, startts, endts,
+            0.0f, 0, 0, 0, QDate(), endts,
+            recstatus, recordid,
+            kDupsInAll, kDupCheckSubThenDesc, 0,
+            0, 0, 0, 0, QString(), QDateTime());
+    }
+
+    /// The programs of \p list which come from fixture rows
+    static QList<ProgramInfo*> fixtures(const ProgramList &list)
+    {
+        QList<ProgramInfo*> result;
+        ProgramList::const_iterator it = list.begin();
+        for (; it != list.end(); ++it)
+            if ((*it)->GetChanID() >= FIXTURE_ID)
+                result.push_back(*it);
+        return result;
+    }
+
+  private slots:
+    // called at the beginning of these sets of tests
+    void initTestCase(void)
+    {
+        gCoreContext = new MythCoreContext("bin_version", NULL);
+
+        m_haveDB = !qgetenv("MYTHTV_TEST_DB_NAME").isEmpty();
+        if (!m_haveDB)
+            return;
+
+        DatabaseParams params = GetMythDB()->GetDatabaseParams();
+        params.dbHostName = env("MYTHTV_TEST_DB_HOST", "localhost");
+        params.dbUserName = env("MYTHTV_TEST_DB_USER", "mythtv");
+        params.dbPassword = env("MYTHTV_TEST_DB_PASSWORD", "mythtv");
+        params.dbName     = env("MYTHTV_TEST_DB_NAME", "");
+        GetMythDB()->SetDatabaseParams(params);
+
+        m_haveDB = MSqlQuery::testDBConnection();
+        if (m_haveDB)
+            removeFixtures();
+    }
+
+    // called at the end of these sets of tests
+    void cleanupTestCase(void)
+    {
+        if (m_haveDB)
+            removeFixtures();
+
+        // Let the update events of reset recordings go out
+        MThreadPool::globalInstance()->waitForDone();
+    }
+
+    /**
+     * LoadFromRecorded() fills in the channel of each recording, and resets
+     * the recordings left flagging by a job that is gone with one UPDATE
+     */
+    void loadFromRecorded_test(void)
+    {
+        if (!m_haveDB)
+            MSKIP("no test database, set MYTHTV_TEST_DB_NAME to run");
+
+        const uint chan1 = FIXTURE_ID + 1, chan2 = FIXTURE_ID + 2;
+        const uint gone  = FIXTURE_ID + 3; // channel deleted since
+        QVERIFY (addChannel(chan1, "TESTONE"));
+        QVERIFY (addChannel(chan2, "TESTTWO"));
+        QVERIFY (addRecording(FIXTURE_ID + 1, chan1, "Series A",
+                              "2010-01-01 20:00:00", COMM_FLAG_DONE));
+        QVERIFY (addRecording(FIXTURE_ID + 2, chan1, "Series B",
+                              "2010-01-02 20:00:00", COMM_FLAG_PROCESSING));
+        QVERIFY (addRecording(FIXTURE_ID + 3, chan2, "Series A",
+                              "2010-01-03 20:00:00", COMM_FLAG_PROCESSING));
+        QVERIFY (addRecording(FIXTURE_ID + 4, chan2, "Series B",
+                              "2010-01-04 20:00:00", COMM_FLAG_PROCESSING));
+        QVERIFY (addRecording(FIXTURE_ID + 5, gone, "Series A",
+                              "2010-01-05 20:00:00", COMM_FLAG_NOT_FLAGGED));
+
+        // Only the flagging job of the third recording is still running
+        QMap<QString,bool> isJobRunning;
+        isJobRunning[ProgramInfo::MakeUniqueKey(
+            chan2, MythDate::fromString("2010-01-03 20:00:00"))] = true;
+
+        ProgramList list;
+        QVERIFY (LoadFromRecorded(list, false, QMap<QString,uint32_t>(),
+                                  isJobRunning,
+                                  QMap<QString,ProgramInfo*>(), 1));
+
+        QList<ProgramInfo*> progs = fixtures(list);
+        QCOMPARE (progs.size(), 5);
+        for (int i = 0; i < progs.size(); i++)
+            QCOMPARE (progs[i]->GetRecordingID(), (uint)FIXTURE_ID + 1 + i);
+
+        QCOMPARE (progs[0]->GetChannelSchedulingID(), QString("TESTONE"));
+        QCOMPARE (progs[2]->GetChannelSchedulingID(), QString("TESTTWO"));
+        QCOMPARE (progs[4]->GetChannelSchedulingID(),
+                  QString("#%1").arg(gone));
+        QCOMPARE (progs[0]->GetRecordingStartTime(),
+                  MythDate::fromString("2010-01-01 20:00:00"));
+
+        /* the repeated values of the list share one copy */
+        QCOMPARE (progs[2]->GetTitle().constData(),
+                  progs[0]->GetTitle().constData());
+        QCOMPARE (progs[1]->GetChannelSchedulingID().constData(),
+                  progs[0]->GetChannelSchedulingID().constData());
+
+        QVERIFY (progs[0]->GetProgramFlags() & FL_COMMFLAG);
+        QVERIFY (!(progs[1]->GetProgramFlags() & FL_COMMPROCESSING));
+        QVERIFY (progs[2]->GetProgramFlags() & FL_COMMPROCESSING);
+        QVERIFY (!(progs[3]->GetProgramFlags() & FL_COMMPROCESSING));
+
+        /* only the recordings without a running job were reset */
+        QCOMPARE (commFlagged(FIXTURE_ID + 1), (int)COMM_FLAG_DONE);
+        QCOMPARE (commFlagged(FIXTURE_ID + 2), (int)COMM_FLAG_NOT_FLAGGED);
+        QCOMPARE (commFlagged(FIXTURE_ID + 3), (int)COMM_FLAG_PROCESSING);
+        QCOMPARE (commFlagged(FIXTURE_ID + 4), (int)COMM_FLAG_NOT_FLAGGED);
+        QCOMPARE (commFlagged(FIXTURE_ID + 5), (int)COMM_FLAG_NOT_FLAGGED);
+    }
+
+    /**
+     * LoadFromProgram() gives each program the status of the scheduled
+     * showing of it, and only of a showing at the same time
+     */
+    void loadFromProgram_test(void)
+    {
+        if (!m_haveDB)
+            MSKIP("no test database, set MYTHTV_TEST_DB_NAME to run");
+
+        const uint chan1 = FIXTURE_ID + 11, chan2 = FIXTURE_ID + 12;
+        QVERIFY (addChannel(chan1, "TESTELEVEN"));
+        QVERIFY (addChannel(chan2, "TESTTWELVE"));
+        QVERIFY (addProgram(chan1, "Series A", "2010-02-01 20:00:00"));
+        QVERIFY (addProgram(chan2, "Series A", "2010-02-01 20:00:00"));
+        QVERIFY (addProgram(chan1, "Series A", "2010-02-02 20:00:00"));
+        QVERIFY (addProgram(chan1, "Series B", "2010-02-03 20:00:00"));
+        QVERIFY (addProgram(chan2, "Series B", "2010-02-03 20:00:00"));
+
+        ProgramList schedList;
+        schedList.push_back(scheduled(chan1, "TESTELEVEN", "Series A",
+                                      "2010-02-01 20:00:00",
+                                      RecStatus::WillRecord, 7));
+        schedList.push_back(scheduled(chan2, "TESTTWELVE", "Series B",
+                                      "2010-02-03 20:00:00",
+                                      RecStatus::Conflict, 8));
+        // Same showing at another time, which matches nothing loaded
+        schedList.push_back(scheduled(chan1, "TESTELEVEN", "Series A",
+                                      "2010-02-09 20:00:00",
+                                      RecStatus::WillRecord, 9));
+
+        MSqlBindings bindings;
+        bindings[":FIXTURES"] = FIXTURE_ID;
+        ProgramList list;
+        uint count;
+        QVERIFY (LoadFromProgram(list,
+                                 "WHERE program.chanid >= :FIXTURES "
+                                 "ORDER BY program.starttime, "
+                                 "program.chanid ",
+                                 bindings, schedList, 0, 0, count));
+
+        QList<ProgramInfo*> progs = fixtures(list);
+        QCOMPARE (progs.size(), 5);
+
+        /* the scheduled showing, and the same showing elsewhere */
+        QCOMPARE (progs[0]->GetChanID(), chan1);
+        QCOMPARE (progs[0]->GetRecordingStatus(), RecStatus::WillRecord);
+        QCOMPARE (progs[0]->GetRecordingRuleID(), 7U);
+        QCOMPARE (progs[1]->GetChanID(), chan2);
+        QCOMPARE (progs[1]->GetRecordingStatus(), RecStatus::WillRecord);
+        QCOMPARE (progs[1]->GetRecordingRuleID(), 7U);
+
+        /* a later showing isn't matched by an earlier schedule entry */
+        QCOMPARE (progs[2]->GetRecordingRuleID(), 0U);
+        QVERIFY (progs[2]->GetRecordingStatus() != RecStatus::WillRecord);
+
+        /* a conflict only applies to the channel it is on */
+        QCOMPARE (progs[3]->GetChanID(), chan1);
+        QCOMPARE (progs[3]->GetRecordingRuleID(), 8U);
+        QVERIFY (progs[3]->GetRecordingStatus() != RecStatus::Conflict);
+        QCOMPARE (progs[4]->GetChanID(), chan2);
+        QCOMPARE (progs[4]->GetRecordingStatus(), RecStatus::Conflict);
+    }
+
+    /**
+     * every program of a pooled list shares the data of its repeated strings
+     */
+    void stringPool_test(void)
+    {
+        QVector<Row> rows = makeRows(1000);
+        ProgramStringPool pool;
+        ProgramList list;
+
+        assemble(rows, list, &pool);
+
+        QCOMPARE ((int)list.size(), 1000);
+        QCOMPARE (list[0]->GetTitle(), QString("Series 0"));
+        QCOMPARE (list[400]->GetTitle(), list[0]->GetTitle());
+        QCOMPARE (list[400]->GetTitle().constData(),
+                  list[0]->GetTitle().constData());
+        QCOMPARE (list[150]->GetChannelSchedulingID().constData(),
+                  list[0]->GetChannelSchedulingID().constData());
+        QCOMPARE (list[6]->GetCategory().constData(),
+                  list[0]->GetCategory().constData());
+        QVERIFY (list[1]->GetTitle().constData() !=
+                 list[0]->GetTitle().constData());
+        QVERIFY (pool.size() < 1000);
+
+        /* empty strings are not pooled */
+        QVERIFY (pool.Intern(QString()).isNull());
+    }
+
+    void assemble_bench_data(void)
+    {
+        QTest::addColumn<int>("count");
+        QTest::addColumn<bool>("pooled");
+
+        QTest::newRow("10k rows")         << 10000 << false;
+        QTest::newRow("10k rows, pooled") << 10000 << true;
+        QTest::newRow("50k rows")         << 50000 << false;
+        QTest::newRow("50k rows, pooled") << 50000 << true;
+    }
+
+    void assemble_bench(void)
+    {
+        QFETCH(int, count);
+        QFETCH(bool, pooled);
+
+        QVector<Row> rows = makeRows(count);
+
+        QBENCHMARK
+        {
+            ProgramStringPool pool;
+            ProgramList list;
+            assemble(rows, list, pooled ? &pool : NULL);
+        }
+    }
+};
@@ -11,6 +11,8 @@
 #include <QMap>
 #include <QRegExp>
 #include <QVariantMap>
+#include <QThreadStorage>
+#include <QtEndian>
 #include <iostream>
 
 using namespace std;
@@ -66,7 +68,21 @@ extern "C" {
 
 static QMutex                  logQueueMutex;
 static QQueue<LoggingItem *>   logQueue;
-static QRegExp                 logRegExp = QRegExp("[%]{1,2}");
+
+static QMutex                  logRingsMutex;
+static QList<LogRing *>        logRings;
+
+/// Marks a thread's LogRing as orphaned when the thread exits, or when it is
+/// replaced by a larger one, the logging thread deletes the ring once it has
+/// been drained.
+class LogRingHolder
+{
+  public:
+    explicit LogRingHolder(LogRing *ring) : m_ring(ring) {}
+    ~LogRingHolder() { m_ring->m_orphaned.storeRelease(1); }
+    LogRing *m_ring;
+};
+static QThreadStorage<LogRingHolder *> logRingStorage;
 
 static LoggerThread           *logThread = NULL;
 static QMutex                  logThreadMutex;
@@ -139,6 +155,77 @@ void loggingGetTimeStamp(qlonglong *epoch, uint *usec)
 #endif
 }
 
+/// \brief Get the OS thread ID of the calling thread, as shown in gdb
+static int64_t loggingGetTid(void)
+{
+    int64_t tid = 0;
+
+#if defined(linux)
+    tid = (int64_t)syscall(SYS_gettid);
+#elif defined(__FreeBSD__)
+    long lwpid;
+    int dummy = thr_self( &lwpid );
+    (void)dummy;
+    tid = (int64_t)lwpid;
+#elif CONFIG_DARWIN
+    tid = (int64_t)mach_thread_self();
+#endif
+
+    return tid;
+}
+
+/// \brief Get the LogRing of the calling thread, creating it on first use
+static LogRing *loggingGetThreadRing(void)
+{
+    if (logRingStorage.hasLocalData())
+        return logRingStorage.localData()->m_ring;
+
+    LogRing *ring = new LogRing((uint64_t)(QThread::currentThreadId()),
+                                loggingGetTid(), LOGRING_MIN_SIZE);
+    logRingStorage.setLocalData(new LogRingHolder(ring));
+
+    QMutexLocker locker(&logRingsMutex);
+    logRings.append(ring);
+
+    return ring;
+}
+
+/// \brief Replace the full LogRing of the calling thread by one twice the
+///        size.  The old ring is drained first, as the rings are merged by
+///        timestamp.
+/// \return The new ring, or NULL if the ring is already at LOGRING_MAX_SIZE
+static LogRing *loggingGrowThreadRing(void)
+{
+    LogRingHolder *holder = logRingStorage.localData();
+    LogRing *old = holder->m_ring;
+    if (old->size() >= LOGRING_MAX_SIZE)
+        return NULL;
+
+    LogRing *ring = new LogRing(old->m_threadId, old->m_tid, old->size() * 2);
+    holder->m_ring = ring;
+    old->m_orphaned.storeRelease(1);
+
+    QMutexLocker locker(&logRingsMutex);
+    logRings.append(ring);
+
+    return ring;
+}
+
+/// \brief Check if all LogRings have been drained
+static bool loggingRingsEmpty(void)
+{
+    QMutexLocker locker(&logRingsMutex);
+
+    QList<LogRing *>::const_iterator it = logRings.begin();
+    for (; it != logRings.end(); ++it)
+    {
+        if (!(*it)->isEmpty())
+            return false;
+    }
+
+    return true;
+}
+
 LoggingItem::LoggingItem() :
         ReferenceCounter("LoggingItem", false),
         m_pid(-1), m_tid(-1), m_threadId(-1), m_usec(0), m_line(0),
@@ -180,14 +267,89 @@ LoggingItem::~LoggingItem()
     free(m_logFile);
 }
 
-QByteArray LoggingItem::toByteArray(void)
+/*
+ * Binary wire format used between the logging thread and mythlogserver.
+ * All numbers are little endian:
+ *
+ *   char[4]  magic "MLB1"
+ *   int32    pid
+ *   int64    tid
+ *   uint64   threadId
+ *   uint32   usec
+ *   int32    line, type, level, facility
+ *   int64    epoch
+ *   7 x      uint16 length + bytes of file, function, threadName, appName,
+ *            table, logFile and message
+ *
+ * Items from clients which still send JSON are recognised by the missing
+ * magic.
+ */
+static const char kLogWireMagic[4] = { 'M', 'L', 'B', '1' };
+static const int  kLogWireFixedSize = 4 + 4 + 8 + 8 + 4 + 4 * 4 + 8;
+
+template <typename T>
+static inline void put_le(char *&buf, T val)
 {
-    QVariantMap variant = QJsonWrapper::qobject2qvariant(this);
-    QByteArray json = QJsonWrapper::toJson(variant);
+    qToLittleEndian<T>(val, (uchar *)buf);
+    buf += sizeof(T);
+}
 
-    //cout << json.constData() << endl;
+template <typename T>
+static inline T get_le(const char *&buf)
+{
+    T val = qFromLittleEndian<T>((const uchar *)buf);
+    buf += sizeof(T);
+    return val;
+}
+
+static inline void put_str(char *&buf, const char *str)
+{
+    quint16 len = str ? (quint16)qMin(strlen(str), (size_t)0xffff) : 0;
+    put_le<quint16>(buf, len);
+    if (len)
+        memcpy(buf, str, len);
+    buf += len;
+}
+
+static inline bool get_str(const char *&buf, const char *end, QByteArray &str)
+{
+    if (end - buf < 2)
+        return false;
+    quint16 len = get_le<quint16>(buf);
+    if (end - buf < len)
+        return false;
+    str = QByteArray(buf, len);
+    buf += len;
+    return true;
+}
 
-    return json;
+QByteArray LoggingItem::toByteArray(void)
+{
+    const char *strs[7] = { m_file, m_function, m_threadName, m_appName,
+                            m_table, m_logFile, m_message };
+
+    int size = kLogWireFixedSize;
+    for (uint i = 0; i < 7; i++)
+        size += 2 + (strs[i] ? qMin(strlen(strs[i]), (size_t)0xffff) : 0);
+
+    QByteArray buf(size, '\0');
+    char *p = buf.data();
+
+    memcpy(p, kLogWireMagic, sizeof(kLogWireMagic));
+    p += sizeof(kLogWireMagic);
+    put_le<qint32>(p, m_pid);
+    put_le<qint64>(p, m_tid);
+    put_le<quint64>(p, m_threadId);
+    put_le<quint32>(p, m_usec);
+    put_le<qint32>(p, m_line);
+    put_le<qint32>(p, m_type);
+    put_le<qint32>(p, m_level);
+    put_le<qint32>(p, m_facility);
+    put_le<qint64>(p, m_epoch);
+    for (uint i = 0; i < 7; i++)
+        put_str(p, strs[i]);
+
+    return buf;
 }
 
 /// \brief Get the name of the thread that produced the LoggingItem
@@ -228,18 +390,7 @@ void LoggingItem::setThreadTid(void)
     m_tid = logThreadTidHash.value(m_threadId, -1);
     if (m_tid == -1)
     {
-        m_tid = 0;
-
-#if defined(linux)
-        m_tid = (int64_t)syscall(SYS_gettid);
-#elif defined(__FreeBSD__)
-        long lwpid;
-        int dummy = thr_self( &lwpid );
-        (void)dummy;
-        m_tid = (int64_t)lwpid;
-#elif CONFIG_DARWIN
-        m_tid = (int64_t)mach_thread_self();
-#endif
+        m_tid = loggingGetTid();
         logThreadTidHash[m_threadId] = m_tid;
     }
 }
@@ -380,29 +531,34 @@ void LoggerThread::run(void)
 
     QMutexLocker qLock(&logQueueMutex);
 
-    while (!m_aborted || !logQueue.isEmpty())
+    while (!m_aborted || !logQueue.isEmpty() || !loggingRingsEmpty())
     {
         qLock.unlock();
         qApp->processEvents(QEventLoop::AllEvents, 10);
         qApp->sendPostedEvents(NULL, QEvent::DeferredDelete);
 
         qLock.relock();
-        if (logQueue.isEmpty())
+        LoggingItem *item = dequeueItem();
+        if (!item)
         {
             m_waitEmpty->wakeAll();
             m_waitNotEmpty->wait(qLock.mutex(), 100);
             continue;
         }
 
-        LoggingItem *item = logQueue.dequeue();
-        qLock.unlock();
+        // Handle a batch of items between event processing
+        for (int i = 0; item && i < 64; i++)
+        {
+            qLock.unlock();
 
-        fillItem(item);
-        handleItem(item);
-        logConsole(item);
-        item->DecrRef();
+            fillItem(item);
+            handleItem(item);
+            logConsole(item);
+            item->DecrRef();
 
-        qLock.relock();
+            qLock.relock();
+            item = (i < 63) ? dequeueItem() : NULL;
+        }
     }
 
     qLock.unlock();
@@ -444,6 +600,60 @@ void LoggerThread::run(void)
     }
 }
 
+/// \brief  Take the oldest item from the logging queue or the threads'
+///         LogRings.  The rings are merged by timestamp, so messages of
+///         different threads stay in order, and a registration item is
+///         handled before the messages the new thread logs.  Must be called
+///         with logQueueMutex held.
+/// \return The item, or NULL if there is nothing to log
+LoggingItem *LoggerThread::dequeueItem(void)
+{
+    LoggingItem     *queued  = logQueue.isEmpty() ? NULL : logQueue.head();
+    LogRing         *oldest  = NULL;
+    const LogRecord *oldestRec = NULL;
+
+    QMutexLocker locker(&logRingsMutex);
+
+    QList<LogRing *>::iterator it = logRings.begin();
+    while (it != logRings.end())
+    {
+        // Check the orphan flag first, the thread's final records are
+        // published before it is set
+        bool orphaned = (*it)->m_orphaned.loadAcquire();
+        const LogRecord *rec = (*it)->readSlot();
+
+        if (!rec)
+        {
+            if (orphaned)
+            {
+                delete *it;
+                it = logRings.erase(it);
+                continue;
+            }
+        }
+        else if (!oldestRec || (rec->epoch < oldestRec->epoch) ||
+                 ((rec->epoch == oldestRec->epoch) &&
+                  (rec->usec < oldestRec->usec)))
+        {
+            oldest    = *it;
+            oldestRec = rec;
+        }
+        ++it;
+    }
+
+    if (oldestRec &&
+        (!queued || (oldestRec->epoch < queued->m_epoch) ||
+         ((oldestRec->epoch == queued->m_epoch) &&
+          (oldestRec->usec < queued->m_usec))))
+    {
+        LoggingItem *item = LoggingItem::create(*oldestRec, *oldest);
+        oldest->release();
+        return item;
+    }
+
+    return queued ? logQueue.dequeue() : NULL;
+}
+
 /// \brief  Handles the initial startup timeout when waiting for the log server
 ///         to show signs of life
 void LoggerThread::initialTimeout(void)
@@ -695,14 +905,15 @@ bool LoggerThread::flush(int timeoutMS)
 {
     QTime t;
     t.start();
-    while (!m_aborted && !logQueue.isEmpty() && t.elapsed() < timeoutMS)
+    while (!m_aborted && (!logQueue.isEmpty() || !loggingRingsEmpty()) &&
+           t.elapsed() < timeoutMS)
     {
         m_waitNotEmpty->wakeAll();
         int left = timeoutMS - t.elapsed();
         if (left > 0)
             m_waitEmpty->wait(&logQueueMutex, left);
     }
-    return logQueue.isEmpty();
+    return logQueue.isEmpty() && loggingRingsEmpty();
 }
 
 void LoggerThread::fillItem(LoggingItem *item)
@@ -738,11 +949,66 @@ LoggingItem *LoggingItem::create(const char *_file,
 
 LoggingItem *LoggingItem::create(QByteArray &buf)
 {
-    // Deserialize buffer
-    QVariant variant = QJsonWrapper::parseJson(buf);
+    LoggingItem *item = new LoggingItem;
+
+    if (buf.size() < kLogWireFixedSize ||
+        memcmp(buf.constData(), kLogWireMagic, sizeof(kLogWireMagic)))
+    {
+        // Deserialize JSON buffer
+        QVariant variant = QJsonWrapper::parseJson(buf);
+        QJsonWrapper::qvariant2qobject(variant.toMap(), item);
+        return item;
+    }
+
+    const char *p   = buf.constData() + sizeof(kLogWireMagic);
+    const char *end = buf.constData() + buf.size();
+
+    item->m_pid      = get_le<qint32>(p);
+    item->m_tid      = get_le<qint64>(p);
+    item->m_threadId = get_le<quint64>(p);
+    item->m_usec     = get_le<quint32>(p);
+    item->m_line     = get_le<qint32>(p);
+    item->m_type     = (LoggingType)get_le<qint32>(p);
+    item->m_level    = (LogLevel_t)get_le<qint32>(p);
+    item->m_facility = get_le<qint32>(p);
+    item->m_epoch    = get_le<qint64>(p);
+
+    char **strs[6] = { &item->m_file, &item->m_function, &item->m_threadName,
+                       &item->m_appName, &item->m_table, &item->m_logFile };
+    QByteArray str;
+    for (uint i = 0; i < 6; i++)
+    {
+        if (!get_str(p, end, str))
+            return item;
+        *strs[i] = strdup(str.constData());
+    }
+
+    if (get_str(p, end, str))
+    {
+        strncpy(item->m_message, str.constData(), LOGLINE_MAX);
+        item->m_message[LOGLINE_MAX] = '\0';
+    }
+
+    return item;
+}
 
+/// \brief  Create a LoggingItem from a record of a thread's LogRing.  This is
+///         run by the logging thread, so the producing thread only paid for
+///         the copy of the message.
+LoggingItem *LoggingItem::create(const LogRecord &rec, const LogRing &ring)
+{
     LoggingItem *item = new LoggingItem;
-    QJsonWrapper::qvariant2qobject(variant.toMap(), item);
+
+    item->m_tid      = ring.m_tid;
+    item->m_threadId = ring.m_threadId;
+    item->m_epoch    = rec.epoch;
+    item->m_usec     = rec.usec;
+    item->m_line     = rec.line;
+    item->m_type     = (LoggingType)rec.type;
+    item->m_level    = (LogLevel_t)rec.level;
+    item->m_file     = strdup(rec.file);
+    item->m_function = strdup(rec.function);
+    strncpy(item->m_message, rec.message, LOGLINE_MAX);
 
     return item;
 }
@@ -768,26 +1034,75 @@ void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
     int type = kMessage;
     type |= (mask & VB_FLUSH) ? kFlush : 0;
     type |= (mask & VB_STDIO) ? kStandardIO : 0;
+
+    // Fast path: write a fixed size record into this thread's ring without
+    // taking any lock, the logging thread does everything else.  Messages
+    // which need to be flushed or do not fit take the queue below.
+    if (!(type & kFlush) && logThread && !logThreadFinished)
+    {
+        LogRing *ring = loggingGetThreadRing();
+        LogRecord *rec = ring->writeSlot();
+        if (!rec)
+        {
+            LogRing *larger = loggingGrowThreadRing();
+            if (larger)
+            {
+                ring = larger;
+                rec  = ring->writeSlot();
+            }
+        }
+        if (rec)
+        {
+            int len;
+            if (fromQString)
+            {
+                // Messages from QStrings are not format strings
+                len = strlen(format);
+                if (len < LOGRECORD_MESSAGE_MAX)
+                    memcpy(rec->message, format, len + 1);
+            }
+            else
+            {
+                va_start(arguments, format);
+                len = vsnprintf(rec->message, LOGRECORD_MESSAGE_MAX,
+                                format, arguments);
+                va_end(arguments);
+            }
+
+            if (len >= 0 && len < LOGRECORD_MESSAGE_MAX)
+            {
+                loggingGetTimeStamp(&rec->epoch, &rec->usec);
+                rec->line     = line;
+                rec->type     = type;
+                rec->level    = level;
+                rec->file     = file;
+                rec->function = function;
+                ring->publish();
+
+#if defined( _MSC_VER ) && defined( _DEBUG )
+                OutputDebugStringA( rec->message );
+                OutputDebugStringA( "\n" );
+#endif
+                return;
+            }
+        }
+    }
+
     LoggingItem *item = LoggingItem::create(file, function, line, level,
                                             (LoggingType)type);
     if (!item)
         return;
 
-    char *formatcopy = NULL;
-    if( fromQString && strchr(format, '%') )
+    if (fromQString)
     {
-        QString string(format);
-        format = strdup(string.replace(logRegExp, "%%").toLocal8Bit()
-                              .constData());
-        formatcopy = (char *)format;
+        strncpy(item->m_message, format, LOGLINE_MAX);
+    }
+    else
+    {
+        va_start(arguments, format);
+        vsnprintf(item->m_message, LOGLINE_MAX, format, arguments);
+        va_end(arguments);
     }
-
-    va_start(arguments, format);
-    vsnprintf(item->m_message, LOGLINE_MAX, format, arguments);
-    va_end(arguments);
-
-    if (formatcopy)
-        free(formatcopy);
 
     QMutexLocker qLock(&logQueueMutex);
 
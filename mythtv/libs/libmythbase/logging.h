@@ -6,6 +6,7 @@
 #include <QQueue>
 #include <QTime>
 #include <QPointer>
+#include <QAtomicInt>
 
 #include <stdint.h>
 #include <stdlib.h>
@@ -63,9 +64,100 @@ typedef struct tm tmType;
                                 arg = strdup(val.toLocal8Bit().constData()); \
                             }
 
+/// Size of the message in a LogRecord, longer messages take the slow path
+#define LOGRECORD_MESSAGE_MAX (512 - 48)
+/// Number of records in a thread's first LogRing, must be a power of two.
+/// The ring is replaced by one twice the size each time it fills up, up to
+/// LOGRING_MAX_SIZE, so threads which log little keep a small ring.
+#define LOGRING_MIN_SIZE 16
+/// Number of records in the largest LogRing
+#define LOGRING_MAX_SIZE 256
+
+/// \brief Fixed size binary log message as written by LOG() on the fast
+///        path.  Everything beyond the message text itself is formatted
+///        by the logging thread.
+typedef struct logrecord {
+    qlonglong   epoch;
+    uint        usec;
+    int         line;
+    int         type;
+    int         level;
+    const char *file;       ///< __FILE__, has static storage
+    const char *function;   ///< __FUNCTION__, has static storage
+    char        message[LOGRECORD_MESSAGE_MAX];
+} LogRecord;
+
+/// \brief Single producer, single consumer ring of LogRecords.  Each thread
+///        that logs gets its own ring, so LOG() does not need to take any
+///        lock.  The logging thread is the only consumer of all rings.
+class LogRing
+{
+  public:
+    LogRing(uint64_t threadId, int64_t tid, int size) :
+        m_threadId(threadId), m_tid(tid), m_head(0), m_tail(0), m_orphaned(0),
+        m_size(size), m_indexMask((2 * size) - 1),
+        m_records(new LogRecord[size])
+    {
+    }
+
+   ~LogRing() { delete [] m_records; }
+
+    int size(void) const { return m_size; }
+
+    /// Producer side, returns NULL if the ring is full
+    LogRecord *writeSlot(void)
+    {
+        int head = m_head.loadAcquire();
+        int tail = m_tail.loadAcquire();
+        if (((head - tail) & m_indexMask) == m_size)
+            return NULL;
+        return &m_records[head & (m_size - 1)];
+    }
+
+    /// Producer side, makes the record returned by writeSlot() visible
+    void publish(void)
+    {
+        m_head.storeRelease((m_head.loadAcquire() + 1) & m_indexMask);
+    }
+
+    /// Consumer side, returns NULL if the ring is empty
+    const LogRecord *readSlot(void) const
+    {
+        int tail = m_tail.loadAcquire();
+        if (tail == m_head.loadAcquire())
+            return NULL;
+        return &m_records[tail & (m_size - 1)];
+    }
+
+    /// Consumer side, releases the record returned by readSlot()
+    void release(void)
+    {
+        m_tail.storeRelease((m_tail.loadAcquire() + 1) & m_indexMask);
+    }
+
+    bool isEmpty(void) const
+        { return m_tail.loadAcquire() == m_head.loadAcquire(); }
+
+    uint64_t    m_threadId;
+    int64_t     m_tid;
+    QAtomicInt  m_head;         ///< Written by the producing thread only
+    QAtomicInt  m_tail;         ///< Written by the logging thread only
+    QAtomicInt  m_orphaned;     ///< Set once the producing thread exited
+
+  private:
+    LogRing(const LogRing &);
+    LogRing &operator=(const LogRing &);
+
+    int         m_size;
+    // The indices run over twice the ring size, so a full ring can be
+    // told apart from an empty one
+    int         m_indexMask;
+    LogRecord  *m_records;
+};
+
 /// \brief The logging items that are generated by LOG() and are sent to the
 ///        console and to mythlogserver via ZeroMQ
-class LoggingItem: public QObject, public ReferenceCounter
+class MBASE_PUBLIC LoggingItem: public QObject, public ReferenceCounter
 {
     Q_OBJECT
 
@@ -97,6 +189,7 @@ class LoggingItem: public QObject, public ReferenceCounter
     static LoggingItem *create(const char *, const char *, int, LogLevel_t,
                                LoggingType);
     static LoggingItem *create(QByteArray &buf);
+    static LoggingItem *create(const LogRecord &rec, const LogRing &ring);
     QByteArray toByteArray(void);
 
     int                 pid() const         { return m_pid; };
@@ -219,6 +312,7 @@ class LoggerThread : public QObject, public MThread
     bool m_noserver;
 
   protected:
+    LoggingItem *dequeueItem(void);
     bool logConsole(LoggingItem *item);
     void launchLogServer(void);
     void pingLogServer(void);
@@ -0,0 +1,175 @@
+/*
+ *  Class TestLogging
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QList>
+
+#include "mythlogging.h"
+#include "logging.h"
+
+#define LOG_THREADS        4
+#define LOG_LINES_PER_CALL 10000
+
+/// Logs the given number of lines and remembers how long that took
+class LogWriterThread : public QThread
+{
+  public:
+    explicit LogWriterThread(int lines) : m_lines(lines), m_nsecs(0) {}
+
+    virtual void run(void)
+    {
+        QElapsedTimer t;
+        t.start();
+        for (int i = 0; i < m_lines; i++)
+            LOG(VB_GENERAL, LOG_INFO, "LogWriterThread benchmark message");
+        m_nsecs = t.nsecsElapsed();
+    }
+
+    int    m_lines;
+    qint64 m_nsecs;
+};
+
+class TestLogging: public QObject
+{
+    Q_OBJECT
+
+    /// Average time of a LOG() call with the given number of threads
+    /// logging at the same time
+    double NsecsPerCall(int threads)
+    {
+        QList<LogWriterThread*> writers;
+        for (int i = 0; i < threads; i++)
+            writers.push_back(new LogWriterThread(LOG_LINES_PER_CALL));
+        for (int i = 0; i < threads; i++)
+            writers[i]->start();
+
+        qint64 total = 0;
+        for (int i = 0; i < threads; i++)
+        {
+            writers[i]->wait();
+            total += writers[i]->m_nsecs;
+            delete writers[i];
+        }
+
+        return (double)total / (threads * LOG_LINES_PER_CALL);
+    }
+
+  private slots:
+    // called at the beginning of these sets of tests
+    void initTestCase(void)
+    {
+        // the logging thread needs an application for its event processing
+        static int argc = 1;
+        static char *argv[] = { (char *)"test_logging", NULL };
+        if (!QCoreApplication::instance())
+            new QCoreApplication(argc, argv);
+
+        // log quietly and without mythlogserver, so only the cost of
+        // handing the messages to the logging thread is measured
+        logStart("", 0, 1, -1, LOG_INFO, false, false, true);
+    }
+
+    // called at the end of these sets of tests
+    void cleanupTestCase(void)
+    {
+        logStop();
+    }
+
+    // every field of an item survives the MLB1 format sent to
+    // mythlogserver, also a message too long for a ring record
+    void WireFormatRoundTrip(void)
+    {
+        QString msg;
+        for (int i = 0; i < LOGRECORD_MESSAGE_MAX * 3; i++)
+            msg += QChar('a' + i % 26);
+        QVERIFY(msg.size() > LOGRECORD_MESSAGE_MAX);
+        QVERIFY(msg.size() <= LOGLINE_MAX);
+
+        LoggingItem *item = LoggingItem::create("test_logging.h",
+                                                "WireFormatRoundTrip", 123,
+                                                LOG_WARNING, kMessage);
+        item->setPid(4321);
+        item->setTid(Q_INT64_C(0x123456789a));
+        item->setThreadId(Q_UINT64_C(0xfedcba9876543210));
+        item->setUsec(654321);
+        item->setFacility(3);
+        item->setEpoch(Q_INT64_C(1400000000));
+        item->setThreadName("TestThread");
+        item->setAppName("test_logging");
+        item->setTable("logging");
+        item->setLogFile("/tmp/test_logging.log");
+        item->setMessage(msg);
+
+        QByteArray buf = item->toByteArray();
+        QVERIFY(buf.startsWith("MLB1"));
+
+        LoggingItem *copy = LoggingItem::create(buf);
+        QCOMPARE(copy->pid(),        item->pid());
+        QCOMPARE(copy->tid(),        item->tid());
+        QCOMPARE(copy->threadId(),   item->threadId());
+        QCOMPARE(copy->usec(),       item->usec());
+        QCOMPARE(copy->line(),       123);
+        QCOMPARE(copy->type(),       (int)kMessage);
+        QCOMPARE(copy->level(),      (int)LOG_WARNING);
+        QCOMPARE(copy->facility(),   item->facility());
+        QCOMPARE(copy->epoch(),      item->epoch());
+        QCOMPARE(copy->file(),       QString("test_logging.h"));
+        QCOMPARE(copy->function(),   QString("WireFormatRoundTrip"));
+        QCOMPARE(copy->threadName(), QString("TestThread"));
+        QCOMPARE(copy->appName(),    QString("test_logging"));
+        QCOMPARE(copy->table(),      QString("logging"));
+        QCOMPARE(copy->logFile(),    QString("/tmp/test_logging.log"));
+        QCOMPARE(copy->message(),    msg);
+
+        copy->DecrRef();
+        item->DecrRef();
+    }
+
+    void benchmark_log_enabled(void)
+    {
+        QBENCHMARK
+        {
+            LOG(VB_GENERAL, LOG_INFO, "benchmark message");
+        }
+    }
+
+    void benchmark_log_disabled(void)
+    {
+        QBENCHMARK
+        {
+            LOG(VB_CHANNEL, LOG_DEBUG, "benchmark message");
+        }
+    }
+
+    void benchmark_log_uncontended(void)
+    {
+        double ns = NsecsPerCall(1);
+        qDebug("LOG() with 1 thread: %.0f ns per call", ns);
+        QVERIFY(ns > 0);
+    }
+
+    void benchmark_log_contended(void)
+    {
+        double ns = NsecsPerCall(LOG_THREADS);
+        qDebug("LOG() with %d threads: %.0f ns per call", LOG_THREADS, ns);
+        QVERIFY(ns > 0);
+    }
+};
@@ -0,0 +1,474 @@
+// POSIX headers
+#include <sys/stat.h>
+#include <utime.h>
+
+// C++ headers
+#include <algorithm>
+
+// Qt headers
+#include <QCryptographicHash>
+#include <QDirIterator>
+#include <QImageReader>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QBuffer>
+#include <QThread>
+#include <QImage>
+#include <QFile>
+#include <QDir>
+#include <QMap>
+
+// MythTV headers
+#include "artworkcache.h"
+#include "mthreadpool.h"
+#include "mythlogging.h"
+#include "remotefile.h"
+#include "mythdirs.h"
+#include "mythdate.h"
+
+#define LOC QString("ArtworkCache: ")
+
+/// Largest side of the resized copies, smallest first
+const int ArtworkCache::kBuckets[] = { 64, 128, 256, 512, 1024, 2048 };
+const int ArtworkCache::kNumBuckets =
+    sizeof(ArtworkCache::kBuckets) / sizeof(ArtworkCache::kBuckets[0]);
+
+/// Bytes of encoded copies kept in memory
+static const int    kMemoryLimit = 32 * 1024 * 1024;
+/// Bytes of copies kept on disk, the least recently used go first
+static const qint64 kDiskLimit     = 1024LL * 1024 * 1024;
+/// Bytes of copies written between checks of kDiskLimit
+static const qint64 kPruneInterval = kDiskLimit / 16;
+/// Seconds between updates of the last use of a copy
+static const int    kTouchInterval = 60 * 60;
+
+QMutex        ArtworkCache::s_lock;
+ArtworkCache *ArtworkCache::s_cache = NULL;
+
+class ArtworkCacheTask : public QRunnable
+{
+  public:
+    ArtworkCacheTask(ArtworkCache *cache, const QString &source,
+                     const QString &format) :
+        m_cache(cache), m_source(source), m_format(format) {}
+
+    void run(void)
+    {
+        if (m_source.isEmpty())
+        {
+            m_cache->Prune();
+            QMutexLocker locker(&m_cache->m_lock);
+            m_cache->m_pruneQueued = false;
+            return;
+        }
+
+        ArtworkCache::Source info;
+        QByteArray data;
+        if (m_cache->Identify(m_source, info, &data))
+        {
+            int largest = std::max(info.dimensions.width(),
+                                   info.dimensions.height());
+            for (int i = 0; i < ArtworkCache::kNumBuckets; i++)
+            {
+                int bucket = ArtworkCache::kBuckets[i];
+                if (bucket >= largest)
+                    break;
+                if (!QFile::exists(m_cache->FileName(info.hash, bucket,
+                                                     m_format)))
+                    m_cache->Create(m_source, info, data, bucket, m_format);
+            }
+        }
+
+        QMutexLocker locker(&m_cache->m_lock);
+        m_cache->m_queued.remove(m_source);
+    }
+
+  private:
+    ArtworkCache *m_cache;
+    QString       m_source;
+    QString       m_format;
+};
+
+ArtworkCache *ArtworkCache::GetCache(void)
+{
+    QMutexLocker locker(&s_lock);
+
+    if (!s_cache)
+        s_cache = new ArtworkCache();
+    return s_cache;
+}
+
+ArtworkCache::ArtworkCache() :
+    m_dir(GetConfDir() + "/cache/artwork"), m_memory(kMemoryLimit),
+    m_written(0), m_pruneQueued(false),
+    m_pool(new MThreadPool("ArtworkCache"))
+{
+    m_pool->setMaxThreadCount(2);
+
+    QMutexLocker locker(&m_lock);
+    QueuePrune();
+}
+
+ArtworkCache::~ArtworkCache()
+{
+    m_pool->waitForDone();
+    delete m_pool;
+}
+
+/** \brief Returns the size of the copy to use for a request
+ *  \param source Size of the original
+ *  \param width  Width asked for, 0 to follow the height
+ *  \param height Height asked for, 0 to follow the width
+ *  \return The side of the bucket, 0 for the original
+ */
+int ArtworkCache::Bucket(const QSize &source, int width, int height)
+{
+    if (source.isEmpty() || (width <= 0 && height <= 0))
+        return 0;
+
+    double aspect = (double)source.width() / source.height();
+    if (width <= 0)
+        width = (int)(height * aspect + 0.5);
+    if (height <= 0)
+        height = (int)(width / aspect + 0.5);
+
+    QSize fit = source;
+    fit.scale(std::max(width, 1), std::max(height, 1), Qt::KeepAspectRatio);
+    int needed  = std::max(fit.width(), fit.height());
+    int largest = std::max(source.width(), source.height());
+
+    for (int i = 0; i < kNumBuckets; i++)
+    {
+        if (kBuckets[i] >= needed)
+            return (kBuckets[i] < largest) ? kBuckets[i] : 0;
+    }
+
+    return 0;
+}
+
+/** \brief Returns an image of at least \p width x \p height made from
+ *         \p source, generating it if needed
+ *
+ *  \param source Local path or myth:// URL of the original
+ *  \param format Image format of the copies, the original is returned
+ *                instead of a copy only if it has this format
+ *  \return Path of the copy or of the original, empty on failure
+ */
+QString ArtworkCache::GetImage(const QString &source, int width, int height,
+                               const QString &format)
+{
+    Source info;
+    QByteArray data;
+    if (!Identify(source, info, &data))
+        return QString();
+
+    int bucket = Bucket(info.dimensions, width, height);
+
+    if (bucket == 0 && !source.startsWith("myth://"))
+    {
+        QString suffix = QFileInfo(source).suffix().toLower();
+        if (suffix == format.toLower() ||
+            (suffix == "jpeg" && format.toLower() == "jpg"))
+            return source;
+    }
+
+    QString filename = FileName(info.hash, bucket, format);
+    if (QFile::exists(filename))
+    {
+        Touch(filename);
+        return filename;
+    }
+
+    return Create(source, info, data, bucket, format);
+}
+
+/** \brief Returns the content of a copy made by the cache
+ *
+ *  \param etag  Set to a strong ETag for the content
+ *  \return false if \p filename is not in the cache
+ */
+bool ArtworkCache::GetData(const QString &filename, QByteArray &data,
+                           QString &etag)
+{
+    if (!filename.startsWith(m_dir + "/"))
+        return false;
+
+    // The name is derived from the content
+    etag = QString("\"%1\"").arg(QFileInfo(filename).fileName());
+
+    {
+        QMutexLocker locker(&m_lock);
+        QByteArray *cached = m_memory.object(filename);
+        if (cached)
+            data = *cached;
+    }
+
+    if (data.isEmpty())
+    {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        data = file.readAll();
+        Remember(filename, data);
+    }
+
+    Touch(filename);
+
+    return true;
+}
+
+/// Makes all the copies of \p source in the background
+void ArtworkCache::Pregenerate(const QString &source, const QString &format)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_queued.contains(source))
+        return;
+
+    m_queued.insert(source);
+    m_pool->start(new ArtworkCacheTask(this, source, format),
+                  "ArtworkCacheTask");
+}
+
+/// Fills in the content hash and size of \p source, reading it only
+/// if it changed since the last time it was seen
+bool ArtworkCache::Identify(const QString &source, Source &info,
+                            QByteArray *data)
+{
+    qint64 size;
+    QDateTime mtime;
+    if (!Stat(source, size, mtime))
+        return false;
+
+    {
+        QMutexLocker locker(&m_lock);
+        QHash<QString, Source>::const_iterator it =
+            m_sources.constFind(source);
+        if (it != m_sources.constEnd() &&
+            it->size == size && it->mtime == mtime)
+        {
+            info = *it;
+            return true;
+        }
+    }
+
+    QByteArray bytes;
+    if (!Read(source, bytes))
+        return false;
+
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    QSize dimensions = reader.size();
+    if (!dimensions.isValid())
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("%1 is not a supported image").arg(source));
+        return false;
+    }
+
+    info.size       = size;
+    info.mtime      = mtime;
+    info.dimensions = dimensions;
+    info.hash       = QCryptographicHash::hash(bytes, QCryptographicHash::Sha1)
+                          .toHex();
+
+    if (data)
+        *data = bytes;
+
+    QMutexLocker locker(&m_lock);
+    m_sources.insert(source, info);
+
+    return true;
+}
+
+/// Makes the copy of \p source for \p bucket, \p data is the content of
+/// \p source if already read
+QString ArtworkCache::Create(const QString &source, const Source &info,
+                             QByteArray &data, int bucket,
+                             const QString &format)
+{
+    if (data.isEmpty() && !Read(source, data))
+        return QString();
+
+    QImage image;
+    if (!image.loadFromData(data))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to load %1")
+            .arg(source));
+        return QString();
+    }
+
+    if (bucket > 0 && (image.width() > bucket || image.height() > bucket))
+        image = image.scaled(bucket, bucket, Qt::KeepAspectRatio,
+                             Qt::SmoothTransformation);
+
+    QByteArray encoded;
+    QBuffer buffer(&encoded);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, format.toUpper().toLatin1().constData()))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to encode %1 as %2")
+            .arg(source).arg(format));
+        return QString();
+    }
+
+    QString filename = FileName(info.hash, bucket, format);
+    QDir().mkpath(QFileInfo(filename).path());
+
+    // Requests for the same copy may race, whoever renames last wins
+    QString tmpname = QString("%1.%2.tmp").arg(filename)
+        .arg((quintptr)QThread::currentThreadId());
+    QFile file(tmpname);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(encoded) != encoded.size())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Unable to write %1")
+            .arg(tmpname));
+        file.remove();
+        return QString();
+    }
+    file.close();
+
+    if (!QFile::rename(tmpname, filename))
+        QFile::remove(tmpname);
+
+    Remember(filename, encoded);
+
+    {
+        QMutexLocker locker(&m_lock);
+        m_lastUsed.insert(filename, MythDate::current());
+        m_written += encoded.size();
+        if (m_written >= kPruneInterval)
+            QueuePrune();
+    }
+
+    LOG(VB_FILE, LOG_DEBUG, LOC + QString("%1 -> %2 (%3x%4)").arg(source)
+        .arg(filename).arg(image.width()).arg(image.height()));
+
+    return filename;
+}
+
+QString ArtworkCache::FileName(const QString &hash, int bucket,
+                               const QString &format) const
+{
+    return QString("%1/%2/%3.%4.%5").arg(m_dir).arg(hash.left(2))
+        .arg(hash).arg(bucket).arg(format.toLower());
+}
+
+void ArtworkCache::Remember(const QString &filename, const QByteArray &data)
+{
+    QMutexLocker locker(&m_lock);
+    m_memory.insert(filename, new QByteArray(data), data.size());
+}
+
+/** \brief Records a use of the copy \p filename
+ *
+ *  The time is kept as the modification time of the file, which nothing
+ *  else changes as the names follow the content. It is updated at most
+ *  every kTouchInterval seconds, which is plenty for ordering Prune().
+ */
+void ArtworkCache::Touch(const QString &filename)
+{
+    QDateTime now = MythDate::current();
+
+    {
+        QMutexLocker locker(&m_lock);
+        QHash<QString, QDateTime>::const_iterator it =
+            m_lastUsed.constFind(filename);
+        if (it != m_lastUsed.constEnd() && it->secsTo(now) < kTouchInterval)
+            return;
+        m_lastUsed.insert(filename, now);
+    }
+
+    utime(filename.toLocal8Bit().constData(), NULL);
+}
+
+/// Runs Prune() in the background unless it is already queued,
+/// m_lock must be held
+void ArtworkCache::QueuePrune(void)
+{
+    if (m_pruneQueued)
+        return;
+
+    m_pruneQueued = true;
+    m_written = 0;
+    m_pool->start(new ArtworkCacheTask(this, QString(), QString()),
+                  "ArtworkCachePrune");
+}
+
+/// Removes the least recently used copies once there are too many
+void ArtworkCache::Prune(void)
+{
+    QMultiMap<QDateTime, QFileInfo> files;
+    qint64 total = 0;
+
+    QDirIterator it(m_dir, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        QFileInfo fi = it.fileInfo();
+        // The last use, see Touch()
+        files.insert(fi.lastModified(), fi);
+        total += fi.size();
+    }
+
+    int removed = 0;
+    QMultiMap<QDateTime, QFileInfo>::const_iterator oldest = files.begin();
+    for (; total > kDiskLimit && oldest != files.end(); ++oldest)
+    {
+        QString filename = oldest->absoluteFilePath();
+        if (QFile::remove(filename))
+        {
+            total -= oldest->size();
+            removed++;
+
+            QMutexLocker locker(&m_lock);
+            m_lastUsed.remove(filename);
+        }
+    }
+
+    if (removed)
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Removed %1 old images").arg(removed));
+}
+
+bool ArtworkCache::Read(const QString &source, QByteArray &data)
+{
+    if (source.startsWith("myth://"))
+    {
+        RemoteFile rf(source, false, false, 0);
+        return rf.SaveAs(data) && !data.isEmpty();
+    }
+
+    QFile file(source);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    data = file.readAll();
+    return !data.isEmpty();
+}
+
+bool ArtworkCache::Stat(const QString &source, qint64 &size,
+                        QDateTime &mtime)
+{
+    if (source.startsWith("myth://"))
+    {
+        struct stat st;
+        if (!RemoteFile::Exists(source, &st))
+            return false;
+
+        size  = st.st_size;
+        mtime = QDateTime::fromTime_t(st.st_mtime);
+        return true;
+    }
+
+    QFileInfo fi(source);
+    if (!fi.exists())
+        return false;
+
+    size  = fi.size();
+    mtime = fi.lastModified();
+    return true;
+}
@@ -0,0 +1,109 @@
+#ifndef ARTWORKCACHE_H
+#define ARTWORKCACHE_H
+
+// Qt headers
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QCache>
+#include <QMutex>
+#include <QHash>
+#include <QSize>
+#include <QSet>
+
+// MythTV headers
+#include "mythmetaexp.h"
+
+class MThreadPool;
+
+/** \class ArtworkCache
+ *  \brief Resized copies of artwork and previews, shared by all requests.
+ *
+ *  Clients ask for images at whatever size suits their layout, so resizing
+ *  to the exact size asked for made almost every request decode and scale
+ *  the original again. The cache only makes copies fitting a fixed set of
+ *  square sizes, kBuckets, and answers with the smallest that is at least
+ *  as large as the size asked for. It never scales up, when the original
+ *  is small enough it is used as is.
+ *
+ *  Copies are named after the SHA1 of the content of the original, so the
+ *  same cover art used by several tracks, or copied to several storage
+ *  groups, is only resized once, and a changed original gets new copies.
+ *  They are stored in the artwork directory of the cache and the last used
+ *  ones are also kept in memory, with an ETag derived from the name, so
+ *  the HTTP server can answer without touching the disk.
+ *
+ *  Pregenerate() makes all the copies of a new image in the background.
+ *  The copies on disk are pruned to kDiskLimit at startup and then each
+ *  time kPruneInterval bytes more were written, the least recently used
+ *  first. The last use of a copy is recorded as its modification time by
+ *  Touch(), since access times are not updated on most mounts, nor by
+ *  requests answered from memory.
+ *  All methods are thread-safe.
+ */
+class META_PUBLIC ArtworkCache
+{
+  public:
+    static const int kBuckets[];
+    static const int kNumBuckets;
+
+    static ArtworkCache *GetCache(void);
+
+    QString GetImage(const QString &source, int width, int height,
+                     const QString &format = "jpg");
+    bool    GetData(const QString &filename, QByteArray &data,
+                    QString &etag);
+    void    Pregenerate(const QString &source,
+                        const QString &format = "jpg");
+
+    static int  Bucket(const QSize &source, int width, int height);
+
+  private:
+    ArtworkCache();
+   ~ArtworkCache();
+
+    class Source
+    {
+      public:
+        Source() : size(-1) {}
+        qint64    size;
+        QDateTime mtime;
+        QString   hash;
+        QSize     dimensions;
+    };
+
+    bool    Identify(const QString &source, Source &info, QByteArray *data);
+    QString Create(const QString &source, const Source &info,
+                   QByteArray &data, int bucket, const QString &format);
+    QString FileName(const QString &hash, int bucket,
+                     const QString &format) const;
+    void    Remember(const QString &filename, const QByteArray &data);
+    void    Touch(const QString &filename);
+    void    QueuePrune(void);
+    void    Prune(void);
+
+    static bool Read(const QString &source, QByteArray &data);
+    static bool Stat(const QString &source, qint64 &size, QDateTime &mtime);
+
+    friend class ArtworkCacheTask;
+
+    QString                     m_dir;
+    QMutex                      m_lock;
+    /// Identity of the originals seen, by path or URL
+    QHash<QString, Source>      m_sources;
+    /// Encoded copies in memory, by file name, cost in bytes
+    QCache<QString, QByteArray> m_memory;
+    /// Last use of the copies recorded by Touch(), by file name
+    QHash<QString, QDateTime>   m_lastUsed;
+    /// Originals waiting for Pregenerate()
+    QSet<QString>               m_queued;
+    /// Bytes of copies written since the last Prune() was queued
+    qint64                      m_written;
+    bool                        m_pruneQueued;
+    MThreadPool                *m_pool;
+
+    static QMutex               s_lock;
+    static ArtworkCache        *s_cache;
+};
+
+#endif // ARTWORKCACHE_H
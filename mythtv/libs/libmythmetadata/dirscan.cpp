@@ -11,6 +11,7 @@
 #include "mythlogging.h"
 #include "videoutils.h"
 #include "storagegroup.h"
+#include "filestateindex.h"
 
 DirectoryHandler::~DirectoryHandler()
 {
@@ -114,6 +115,65 @@ namespace
         return true;
     }
 
+    /// scan_dir(), reading only directories which changed since last time
+    bool scan_indexed_dir(const QString &start_path, DirectoryHandler *handler,
+                          const ext_lookup &ext_settings,
+                          FileStateIndex *index)
+    {
+        QList<FileState> list;
+        if (!index->List(start_path, list))
+            return false;
+
+        QStringList subdirs;
+        for (int i = 0; i < list.size(); ++i)
+        {
+            if (list[i].isDir)
+                subdirs << list[i].path;
+        }
+        index->Prefetch(subdirs);
+
+        for (int i = 0; i < list.size(); ++i)
+        {
+            const FileState &entry = list[i];
+            QString name = entry.fileName();
+
+            if (name == "Thumbs.db")
+                continue;
+
+            QString suffix = entry.isDir ? QString() :
+                QFileInfo(name).suffix();
+
+            if (!entry.isDir && ext_settings.extension_ignored(suffix))
+                continue;
+
+            if (entry.isDir)
+            {
+                QList<FileState> sublist;
+                bool disc = false;
+                if (index->List(entry.path, sublist))
+                {
+                    for (int j = 0; j < sublist.size() && !disc; ++j)
+                    {
+                        QString subname = sublist[j].fileName();
+                        disc = (subname == "VIDEO_TS" || subname == "BDMV");
+                    }
+                }
+
+                if (!disc)
+                {
+                    DirectoryHandler *dh = handler->newDir(name, entry.path);
+                    (void) scan_indexed_dir(entry.path, dh, ext_settings,
+                                            index);
+                    continue;
+                }
+            }
+
+            handler->handleFile(name, entry.path, suffix, "");
+        }
+
+        return true;
+    }
+
     bool scan_sg_dir(const QString &start_path, const QString &host,
                      const QString &base_path, DirectoryHandler *handler,
                      const ext_lookup &ext_settings, bool isMaster = false)
@@ -229,7 +289,7 @@ namespace
 
 bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions)
+        bool list_unknown_extensions, FileStateIndex *index)
 {
     ext_lookup extlookup(ext_disposition, list_unknown_extensions);
 
@@ -241,7 +301,10 @@ bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
             QString("MythVideo::ScanVideoDirectory Scanning (%1)")
                 .arg(start_path));
 
-        if (!scan_dir(start_path, handler, extlookup))
+        bool ok = index ?
+            scan_indexed_dir(start_path, handler, extlookup, index) :
+            scan_dir(start_path, handler, extlookup);
+        if (!ok)
         {
             LOG(VB_GENERAL, LOG_ERR,
                 QString("MythVideo::ScanVideoDirectory failed to scan %1")
@@ -0,0 +1,874 @@
+// POSIX headers
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstring>
+#include <cerrno>
+
+#include "mythconfig.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#endif
+
+#if CONFIG_DARWIN || defined(BSD)
+#include <sys/param.h>
+#include <sys/mount.h>  // for struct statfs
+#endif
+
+// Qt headers
+#include <QRunnable>
+#include <QDateTime>
+#include <QFile>
+#include <QDir>
+
+// MythTV headers
+#include "filestateindex.h"
+#include "mythcorecontext.h"
+#include "mthreadpool.h"
+#include "mythlogging.h"
+#include "mythdb.h"
+
+#define LOC QString("FileStateIndex: ")
+
+/// Directories of network mounts listed at the same time by Prefetch()
+static const int kPrefetchThreads = 8;
+/// Rows per INSERT when saving the index
+static const int kSaveBatchSize = 200;
+
+/** \class FileChangeFeed
+ *  \brief Notices changes of local directories with inotify.
+ *
+ *  Rather than running a thread, the pending events are read whenever the
+ *  feed is asked about a directory. Every event advances a sequence number
+ *  and stamps the directory it happened in, so an index can tell whether a
+ *  directory changed since it was read by comparing the stamp with the
+ *  sequence number taken before reading it. If the kernel queue overflows
+ *  between scans every directory counts as changed.
+ */
+class FileChangeFeed
+{
+  public:
+    static FileChangeFeed *Get(void);
+
+    bool    Watch(const QString &dir);
+    quint64 Sequence(void);
+    bool    IsUnchanged(const QString &dir, quint64 since);
+
+  private:
+    FileChangeFeed(int fd) :
+        m_fd(fd), m_seq(1), m_overflowSeq(0), m_full(false) {}
+
+    void Drain(void);
+
+    int                     m_fd;
+    QMutex                  m_lock;
+    quint64                 m_seq;
+    quint64                 m_overflowSeq;
+    bool                    m_full;
+    QHash<int, QString>     m_wds;
+    QHash<QString, int>     m_dirWds;
+    QHash<QString, quint64> m_lastChange;
+};
+
+FileChangeFeed *FileChangeFeed::Get(void)
+{
+#ifdef __linux__
+    static QMutex s_lock;
+    static FileChangeFeed *s_feed = NULL;
+    static bool s_tried = false;
+
+    QMutexLocker locker(&s_lock);
+    if (!s_tried)
+    {
+        s_tried = true;
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd >= 0)
+            s_feed = new FileChangeFeed(fd);
+        else
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                "Unable to watch for file changes" + ENO);
+    }
+    return s_feed;
+#else
+    return NULL;
+#endif
+}
+
+/// Starts watching a directory, returns false if it can not be watched
+bool FileChangeFeed::Watch(const QString &dir)
+{
+#ifdef __linux__
+    QMutexLocker locker(&m_lock);
+
+    if (m_dirWds.contains(dir))
+        return true;
+
+    int wd = inotify_add_watch(m_fd, QFile::encodeName(dir).constData(),
+                               IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                               IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB |
+                               IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+    if (wd < 0)
+    {
+        if (errno == ENOSPC && !m_full)
+        {
+            m_full = true;
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("Out of inotify watches at %1 directories, "
+                        "raise fs.inotify.max_user_watches to watch "
+                        "the rest").arg(m_dirWds.size()));
+        }
+        return false;
+    }
+
+    m_wds[wd] = dir;
+    m_dirWds[dir] = wd;
+    return true;
+#else
+    (void) dir;
+    return false;
+#endif
+}
+
+/// The sequence number to remember when reading a watched directory
+quint64 FileChangeFeed::Sequence(void)
+{
+    QMutexLocker locker(&m_lock);
+    Drain();
+    return m_seq;
+}
+
+/// True if the directory is watched and had no events since the sequence
+bool FileChangeFeed::IsUnchanged(const QString &dir, quint64 since)
+{
+    QMutexLocker locker(&m_lock);
+    Drain();
+    return m_dirWds.contains(dir) && m_overflowSeq <= since &&
+           m_lastChange.value(dir, 0) <= since;
+}
+
+void FileChangeFeed::Drain(void)
+{
+#ifdef __linux__
+    char buf[16 * 1024]
+        __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+    while (true)
+    {
+        ssize_t len = read(m_fd, buf, sizeof(buf));
+        if (len <= 0)
+            break;
+
+        for (char *ptr = buf; ptr < buf + len; )
+        {
+            const struct inotify_event *event =
+                reinterpret_cast<const struct inotify_event *>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                LOG(VB_FILE, LOG_INFO, LOC +
+                    "Change queue overflowed, rescanning everything");
+                m_overflowSeq = ++m_seq;
+                continue;
+            }
+
+            QHash<int, QString>::iterator it = m_wds.find(event->wd);
+            if (it == m_wds.end())
+                continue;
+            QString dir = *it;
+
+            m_lastChange[dir] = ++m_seq;
+
+            // A directory moved away keeps its watch, but its old path
+            // must not look unchanged, so forget about it
+            if (event->mask & (IN_IGNORED | IN_MOVE_SELF | IN_DELETE_SELF))
+            {
+                if (!(event->mask & IN_IGNORED))
+                    inotify_rm_watch(m_fd, event->wd);
+                m_wds.erase(it);
+                m_dirWds.remove(dir);
+            }
+        }
+    }
+#endif
+}
+
+/// Lists a directory of a network mount on behalf of Prefetch()
+class FileStatePrefetchTask : public QRunnable
+{
+  public:
+    FileStatePrefetchTask(FileStateIndex *index, const QString &dir,
+                          bool statFiles) :
+        m_index(index), m_dir(dir), m_statFiles(statFiles) {}
+
+    void run(void)
+    {
+        QList<FileState> entries;
+        m_index->List(m_dir, entries, m_statFiles);
+    }
+
+  private:
+    FileStateIndex *m_index;
+    QString         m_dir;
+    bool            m_statFiles;
+};
+
+QMutex                          FileStateIndex::s_indexLock;
+QHash<QString, FileStateIndex*> FileStateIndex::s_indexes;
+
+/// Returns the index of the named scanner, e.g. "video"
+FileStateIndex *FileStateIndex::GetIndex(const QString &scanner)
+{
+    QMutexLocker locker(&s_indexLock);
+
+    FileStateIndex *index = s_indexes.value(scanner);
+    if (!index)
+    {
+        index = new FileStateIndex(scanner);
+        s_indexes[scanner] = index;
+    }
+    return index;
+}
+
+FileStateIndex::FileStateIndex(const QString &scanner) :
+    m_scanner(scanner), m_loaded(false),
+    m_reads(0), m_pool(NULL)
+{
+}
+
+FileStateIndex::~FileStateIndex()
+{
+    delete m_pool;
+}
+
+/// Loads the index the first time and starts a new scan
+void FileStateIndex::BeginScan(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (!m_loaded)
+        Load();
+
+    m_visited.clear();
+    m_changed.clear();
+    m_movedHashes.clear();
+    m_reads = 0;
+}
+
+/** \brief Ends a scan and saves the index if it changed.
+ *  \param complete true if every directory below the roots of the scanner
+ *                  has been listed, so directories not seen are gone
+ */
+void FileStateIndex::EndScan(bool complete)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (complete)
+    {
+        QStringList gone;
+        QHash<QString, DirState>::const_iterator it = m_dirs.begin();
+        for (; it != m_dirs.end(); ++it)
+        {
+            if (!m_visited.contains(it.key()))
+                gone << it.key();
+        }
+        for (int i = 0; i < gone.size(); ++i)
+            RemoveTree(gone[i]);
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("%1 scan: %2 directories, %3 read, %4 changes")
+            .arg(m_scanner).arg(m_visited.size()).arg(m_reads)
+            .arg(m_changed.size()));
+
+    Save();
+
+    m_movedHashes.clear();
+}
+
+/** \brief Returns the entries of a directory, reading it only if it changed
+ *         since the index last saw it.
+ *
+ *  Hidden files, sockets, devices and dangling symlinks are left out like
+ *  QDir does by default.
+ *
+ *  \param statFiles Read the directory even if its mtime is unchanged, to
+ *                   notice files modified in place. Not needed for watched
+ *                   directories, which are told about such changes.
+ *  \return false if dir does not exist or can not be read
+ */
+bool FileStateIndex::List(const QString &dir, QList<FileState> &entries,
+                          bool statFiles)
+{
+    QString path = QDir::cleanPath(dir);
+    FileChangeFeed *feed = FileChangeFeed::Get();
+
+    {
+        QMutexLocker locker(&m_lock);
+
+        QHash<QString, DirState>::const_iterator it = m_dirs.find(path);
+        if (it != m_dirs.end() &&
+            (m_visited.contains(path) ||
+             (it->watched && feed && feed->IsUnchanged(path, it->seq))))
+        {
+            m_visited.insert(path);
+            Collect(path, entries);
+            return true;
+        }
+    }
+
+    FileState self;
+    if (!Stat(path, self) || !self.isDir)
+    {
+        QMutexLocker locker(&m_lock);
+        if (m_files.contains(path) || m_dirs.contains(path))
+            RemoveTree(path);
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&m_lock);
+
+        QHash<QString, DirState>::const_iterator it = m_dirs.find(path);
+        if (it != m_dirs.end() && IsClean(*it, statFiles, self))
+        {
+            m_visited.insert(path);
+            Collect(path, entries);
+            return true;
+        }
+    }
+
+    // Watch before reading, so changes made while reading are not missed
+    quint64 seq = 0;
+    bool watched = false;
+    if (feed && !IsRemoteDir(path))
+    {
+        watched = feed->Watch(path);
+        if (watched)
+            seq = feed->Sequence();
+    }
+
+    QList<FileState> current;
+    if (!Read(path, current))
+        return false;
+
+    // Changes within the second a directory was read in would not change
+    // its mtime, so such a directory has to be read again next time
+    if (self.mtime >= (qint64)QDateTime::currentDateTime().toTime_t() - 1)
+        self.mtime = -1;
+
+    QMutexLocker locker(&m_lock);
+    Update(path, self, current, seq, watched);
+    Collect(path, entries);
+
+    return true;
+}
+
+/** \brief Lists the given directories of network mounts in parallel.
+ *
+ *  Meant to be called with the subdirectories of a directory before
+ *  descending into them, List() then returns the entries without waiting
+ *  for the server. Local directories are left alone, reading them one by
+ *  one is faster than seeking between them.
+ */
+void FileStateIndex::Prefetch(const QStringList &dirs, bool statFiles)
+{
+    QStringList remote;
+    for (int i = 0; i < dirs.size(); ++i)
+    {
+        QString path = QDir::cleanPath(dirs[i]);
+        {
+            QMutexLocker locker(&m_lock);
+            if (m_visited.contains(path))
+                continue;
+        }
+        if (IsRemoteDir(path))
+            remote << path;
+    }
+
+    if (remote.size() < 2)
+        return;
+
+    {
+        QMutexLocker locker(&m_lock);
+        if (!m_pool)
+        {
+            m_pool = new MThreadPool("FileStateIndex");
+            m_pool->setMaxThreadCount(kPrefetchThreads);
+        }
+    }
+
+    for (int i = 0; i < remote.size(); ++i)
+    {
+        m_pool->start(new FileStatePrefetchTask(this, remote[i], statFiles),
+                      "FileStatePrefetch");
+    }
+    m_pool->waitForDone();
+}
+
+/// True if the path is new, modified or gone during the current scan
+bool FileStateIndex::IsChanged(const QString &path) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_changed.contains(QDir::cleanPath(path));
+}
+
+/// True if anything was found new, modified or gone during the current scan
+bool FileStateIndex::HasChanges(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return !m_changed.isEmpty();
+}
+
+bool FileStateIndex::Get(const QString &path, FileState &state) const
+{
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString, FileState>::const_iterator it =
+        m_files.find(QDir::cleanPath(path));
+    if (it == m_files.end())
+        return false;
+
+    state = *it;
+    return true;
+}
+
+/// Number of files and directories known below root
+int FileStateIndex::Count(const QString &root) const
+{
+    QString prefix = QDir::cleanPath(root) + '/';
+    int count = 0;
+
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString, FileState>::const_iterator it = m_files.begin();
+    for (; it != m_files.end(); ++it)
+    {
+        if (it.key().startsWith(prefix))
+            ++count;
+    }
+    return count;
+}
+
+/// Returns the hash stored for a file, empty if it changed since then
+QString FileStateIndex::GetHash(const QString &path) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_files.value(QDir::cleanPath(path)).hash;
+}
+
+void FileStateIndex::SetHash(const QString &path, const QString &hash)
+{
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString, FileState>::iterator it =
+        m_files.find(QDir::cleanPath(path));
+    if (it != m_files.end() && it->hash != hash)
+    {
+        it->hash = hash;
+        m_unsaved.insert(it.key());
+    }
+}
+
+/// True if the path is on a network mount, where inotify sees no changes
+/// made by other hosts
+bool FileStateIndex::IsRemote(const QString &path)
+{
+#if CONFIG_DARWIN || defined(BSD) || defined(__linux__)
+    struct statfs statbuf;
+    memset(&statbuf, 0, sizeof(statbuf));
+
+    if (statfs(QFile::encodeName(path).constData(), &statbuf))
+        return false;
+#endif
+
+#if CONFIG_DARWIN
+    const char *fstypename = statbuf.f_fstypename;
+    return (!strcmp(fstypename, "nfs")) ||      // NFS|FTP
+           (!strcmp(fstypename, "afpfs")) ||    // AppleShare
+           (!strcmp(fstypename, "smbfs"));      // SMB
+#elif __linux__
+    long fstype = statbuf.f_type;
+    return (fstype == 0x6969)  ||               // NFS
+           (fstype == 0x517B)  ||               // SMB
+           (fstype == (long)0xFF534D42) ||      // CIFS
+           (fstype == (long)0xFE534D42) ||      // SMB2
+           (fstype == 0x65735546) ||            // FUSE, e.g. sshfs
+           (fstype == 0x01021997);              // 9P
+#else
+    (void) path;
+    return false;
+#endif
+}
+
+/// IsRemote(), without asking the file system about every subdirectory
+bool FileStateIndex::IsRemoteDir(const QString &dir)
+{
+    {
+        QMutexLocker locker(&m_lock);
+
+        QHash<QString, bool>::const_iterator it = m_remote.find(dir);
+        if (it != m_remote.end())
+            return *it;
+
+        // Subdirectories are on the file system of their parent, unless
+        // they are symlinks which may lead anywhere
+        it = m_remote.find(dir.section('/', 0, -2));
+        QHash<QString, FileState>::const_iterator f = m_files.find(dir);
+        if (it != m_remote.end() && f != m_files.end() && !f->isLink)
+        {
+            m_remote[dir] = *it;
+            return *it;
+        }
+    }
+
+    bool remote = IsRemote(dir);
+
+    QMutexLocker locker(&m_lock);
+    m_remote[dir] = remote;
+    return remote;
+}
+
+bool FileStateIndex::Load(void)
+{
+    m_loaded = true;
+    m_files.clear();
+    m_dirs.clear();
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT path, isdir, islink, size, mtime, inode, hash "
+                  "FROM filestate "
+                  "WHERE scanner = :SCANNER AND hostname = :HOSTNAME");
+    query.bindValue(":SCANNER", m_scanner);
+    query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+
+    if (!query.exec())
+    {
+        MythDB::DBError("FileStateIndex::Load", query);
+        return false;
+    }
+
+    while (query.next())
+    {
+        FileState state;
+        state.path   = query.value(0).toString();
+        state.isDir  = query.value(1).toBool();
+        state.isLink = query.value(2).toBool();
+        state.size   = query.value(3).toLongLong();
+        state.mtime  = query.value(4).toLongLong();
+        state.inode  = query.value(5).toULongLong();
+        state.hash   = query.value(6).toString();
+
+        m_files[state.path] = state;
+        if (state.isDir)
+            m_dirs[state.path].self = state;
+    }
+
+    QHash<QString, FileState>::const_iterator it = m_files.begin();
+    for (; it != m_files.end(); ++it)
+    {
+        QHash<QString, DirState>::iterator parent =
+            m_dirs.find(it.key().section('/', 0, -2));
+        if (parent != m_dirs.end())
+            parent->children << it.key();
+    }
+
+    LOG(VB_FILE, LOG_INFO, LOC + QString("Loaded %1 entries for %2")
+            .arg(m_files.size()).arg(m_scanner));
+
+    return true;
+}
+
+/// Rewrites the rows of the paths new, modified or gone since the last save
+bool FileStateIndex::Save(void)
+{
+    if (m_unsaved.isEmpty())
+        return true;
+
+    QStringList paths = m_unsaved.toList();
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    for (int start = 0; start < paths.size(); start += kSaveBatchSize)
+    {
+        int end = qMin(start + kSaveBatchSize, paths.size());
+
+        // Directories are saved with their own state, which has the mtime
+        // as of when they were read rather than when their parent was
+        QStringList keys;
+        QList<FileState> rows;
+        for (int i = start; i < end; ++i)
+        {
+            keys << QString(":PATH%1").arg(i - start);
+
+            QHash<QString, DirState>::const_iterator dit =
+                m_dirs.find(paths[i]);
+            QHash<QString, FileState>::const_iterator it =
+                m_files.find(paths[i]);
+            if (dit != m_dirs.end())
+                rows << dit->self;
+            else if (it != m_files.end())
+                rows << *it;
+        }
+
+        query.prepare("DELETE FROM filestate "
+                      "WHERE scanner = :SCANNER AND hostname = :HOSTNAME "
+                      "AND path IN (" + keys.join(", ") + ")");
+        query.bindValue(":SCANNER", m_scanner);
+        query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+        for (int i = start; i < end; ++i)
+            query.bindValue(QString(":PATH%1").arg(i - start), paths[i]);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("FileStateIndex::Save delete", query);
+            return false;
+        }
+
+        if (rows.isEmpty())
+            continue;
+
+        QStringList values;
+        for (int i = 0; i < rows.size(); ++i)
+        {
+            values << QString("(:SCANNER, :HOSTNAME, :PATH%1, :ISDIR%1, "
+                              ":ISLINK%1, :SIZE%1, :MTIME%1, :INODE%1, "
+                              ":HASH%1)").arg(i);
+        }
+
+        query.prepare("INSERT INTO filestate "
+                      "(scanner, hostname, path, isdir, islink, size, "
+                      " mtime, inode, hash) VALUES " + values.join(", "));
+        query.bindValue(":SCANNER", m_scanner);
+        query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+
+        for (int i = 0; i < rows.size(); ++i)
+        {
+            const FileState &state = rows[i];
+            QString n = QString::number(i);
+            query.bindValue(":PATH" + n, state.path);
+            query.bindValue(":ISDIR" + n, state.isDir);
+            query.bindValue(":ISLINK" + n, state.isLink);
+            query.bindValue(":SIZE" + n, state.size);
+            query.bindValue(":MTIME" + n, state.mtime);
+            query.bindValue(":INODE" + n, state.inode);
+            query.bindValue(":HASH" + n, state.hash);
+        }
+
+        if (!query.exec())
+        {
+            MythDB::DBError("FileStateIndex::Save insert", query);
+            return false;
+        }
+
+        for (int i = start; i < end; ++i)
+            m_unsaved.remove(paths[i]);
+    }
+
+    LOG(VB_FILE, LOG_INFO, LOC + QString("Saved %1 changed entries for %2")
+            .arg(paths.size()).arg(m_scanner));
+
+    return true;
+}
+
+bool FileStateIndex::IsClean(const DirState &dirstate, bool statFiles,
+                             const FileState &now) const
+{
+    return !statFiles && dirstate.self.mtime >= 0 &&
+           dirstate.self.mtime == now.mtime &&
+           dirstate.self.inode == now.inode;
+}
+
+bool FileStateIndex::Read(const QString &dir, QList<FileState> &entries)
+{
+    DIR *d = opendir(QFile::encodeName(dir).constData());
+    if (!d)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to read directory %1").arg(dir) + ENO);
+        return false;
+    }
+
+    qint64 now = QDateTime::currentDateTime().toTime_t();
+
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL)
+    {
+        // Also skips "." and ".."
+        if (de->d_name[0] == '.')
+            continue;
+
+        FileState state;
+        if (!Stat(dir + '/' + QFile::decodeName(de->d_name), state))
+            continue;
+
+        if (state.mtime >= now - 1)
+            state.mtime = -1;
+
+        entries << state;
+    }
+
+    closedir(d);
+
+    return true;
+}
+
+/// Replaces the entries of a directory with what it contains now
+void FileStateIndex::Update(const QString &dir, const FileState &self,
+                            const QList<FileState> &entries,
+                            quint64 seq, bool watched)
+{
+    QSet<QString> gone;
+    QHash<QString, DirState>::const_iterator old = m_dirs.find(dir);
+    if (old != m_dirs.end())
+        gone = old->children.toSet();
+
+    DirState dirstate;
+    dirstate.self    = self;
+    dirstate.seq     = seq;
+    dirstate.watched = watched;
+
+    QList<FileState> added;
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        FileState state = entries[i];
+        dirstate.children << state.path;
+
+        QHash<QString, FileState>::const_iterator it =
+            m_files.find(state.path);
+        if (it != m_files.end() && it->isDir == state.isDir)
+        {
+            gone.remove(state.path);
+
+            if (state.isDir)
+            {
+                state.hash = it->hash;
+            }
+            else if (it->size != state.size || it->mtime != state.mtime ||
+                     it->inode != state.inode || state.mtime < 0)
+            {
+                m_changed.insert(state.path);
+                m_unsaved.insert(state.path);
+            }
+            else
+            {
+                state.hash = it->hash;
+            }
+
+            m_files[state.path] = state;
+        }
+        else
+        {
+            added << state;
+        }
+    }
+
+    // Remember the hashes of files gone before looking at the new ones,
+    // a file renamed within the directory keeps its inode and size
+    QSet<QString>::const_iterator git = gone.begin();
+    for (; git != gone.end(); ++git)
+    {
+        QHash<QString, FileState>::const_iterator it = m_files.find(*git);
+        if (it != m_files.end() && !it->isDir && it->inode &&
+            !it->hash.isEmpty())
+        {
+            m_movedHashes[qMakePair(it->inode, it->size)] = it->hash;
+        }
+    }
+
+    for (git = gone.begin(); git != gone.end(); ++git)
+        RemoveTree(*git);
+
+    for (int i = 0; i < added.size(); ++i)
+    {
+        FileState state = added[i];
+
+        if (m_files.contains(state.path))
+            RemoveTree(state.path);
+
+        if (!state.isDir && state.inode)
+            state.hash = m_movedHashes.take(qMakePair(state.inode, state.size));
+
+        m_files[state.path] = state;
+        m_changed.insert(state.path);
+        m_unsaved.insert(state.path);
+    }
+
+    if (old == m_dirs.end() || old->self.mtime != self.mtime ||
+        old->self.inode != self.inode)
+    {
+        m_unsaved.insert(dir);
+    }
+
+    m_dirs[dir] = dirstate;
+    m_visited.insert(dir);
+    m_reads++;
+}
+
+/// Forgets about a file or a directory and everything below it
+void FileStateIndex::RemoveTree(const QString &path)
+{
+    QHash<QString, DirState>::iterator it = m_dirs.find(path);
+    if (it != m_dirs.end())
+    {
+        QStringList children = it->children;
+        m_dirs.erase(it);
+
+        for (int i = 0; i < children.size(); ++i)
+            RemoveTree(children[i]);
+    }
+
+    m_files.remove(path);
+    m_remote.remove(path);
+    m_changed.insert(path);
+    m_unsaved.insert(path);
+}
+
+void FileStateIndex::Collect(const QString &dir,
+                             QList<FileState> &entries) const
+{
+    QStringList children = m_dirs.value(dir).children;
+    for (int i = 0; i < children.size(); ++i)
+    {
+        QHash<QString, FileState>::const_iterator it =
+            m_files.find(children[i]);
+        if (it != m_files.end())
+            entries << *it;
+    }
+}
+
+/// Fills in the state of a file or directory, following symlinks
+bool FileStateIndex::Stat(const QString &path, FileState &state)
+{
+    QByteArray fname = QFile::encodeName(path);
+    struct stat st;
+
+#ifdef _WIN32
+    if (stat(fname.constData(), &st))
+        return false;
+#else
+    if (lstat(fname.constData(), &st))
+        return false;
+
+    if (S_ISLNK(st.st_mode))
+    {
+        state.isLink = true;
+        if (stat(fname.constData(), &st))
+            return false;
+    }
+#endif
+
+    if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode))
+        return false;
+
+    state.path  = path;
+    state.isDir = S_ISDIR(st.st_mode);
+    state.size  = state.isDir ? 0 : st.st_size;
+    state.mtime = st.st_mtime;
+    state.inode = st.st_ino;
+
+    return true;
+}
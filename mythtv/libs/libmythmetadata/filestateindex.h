@@ -0,0 +1,128 @@
+#ifndef FILESTATEINDEX_H
+#define FILESTATEINDEX_H
+
+// Qt headers
+#include <QStringList>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+
+// MythTV headers
+#include "mythmetaexp.h"
+
+class MThreadPool;
+
+/// What the index knows about a file or directory
+struct META_PUBLIC FileState
+{
+    FileState() : isDir(false), isLink(false), size(0), mtime(0), inode(0) {}
+
+    QString  path;      ///< absolute path
+    bool     isDir;
+    bool     isLink;
+    qint64   size;
+    qint64   mtime;     ///< seconds since the epoch, -1 if not trusted
+    quint64  inode;
+    QString  hash;      ///< content hash, filled in by the scanner
+
+    QString fileName(void) const { return path.section('/', -1); }
+};
+
+/** \class FileStateIndex
+ *  \brief Persistent index of the files below the directories of a scanner.
+ *
+ *  The media scanners used to read every directory of their libraries and
+ *  stat every file on each run. This index remembers the listing of every
+ *  directory seen, with size, mtime, inode and content hash of the entries,
+ *  in the filestate table, so a directory only needs to be read again when
+ *  it changed:
+ *
+ *  - Local directories are watched with inotify while the process runs, so
+ *    on the next scan directories without events are not even stat'ed.
+ *  - Otherwise a directory whose mtime and inode are unchanged keeps its
+ *    entries, unless the caller asks for every file to be stat'ed to
+ *    notice files modified in place.
+ *  - Subdirectories on network mounts, where inotify does not see changes
+ *    made by other hosts, can be listed in parallel with Prefetch().
+ *
+ *  There is one index per scanner, shared by all its runs in the process,
+ *  get it with GetIndex(). A scan is framed by BeginScan() and EndScan().
+ *  All methods are thread-safe.
+ */
+class META_PUBLIC FileStateIndex
+{
+  public:
+    static FileStateIndex *GetIndex(const QString &scanner);
+
+    void BeginScan(void);
+    void EndScan(bool complete);
+
+    bool List(const QString &dir, QList<FileState> &entries,
+              bool statFiles = false);
+    void Prefetch(const QStringList &dirs, bool statFiles = false);
+
+    bool IsChanged(const QString &path) const;
+    bool HasChanges(void) const;
+    bool Get(const QString &path, FileState &state) const;
+    int  Count(const QString &root) const;
+
+    QString GetHash(const QString &path) const;
+    void SetHash(const QString &path, const QString &hash);
+
+    static bool IsRemote(const QString &path);
+
+  private:
+    explicit FileStateIndex(const QString &scanner);
+   ~FileStateIndex();
+
+    class DirState
+    {
+      public:
+        DirState() : seq(0), watched(false) {}
+        FileState   self;
+        QStringList children;
+        quint64     seq;        ///< change feed sequence when it was read
+        bool        watched;
+    };
+
+    bool Load(void);
+    bool Save(void);
+    bool IsClean(const DirState &dirstate, bool statFiles,
+                 const FileState &now) const;
+    void Update(const QString &dir, const FileState &self,
+                const QList<FileState> &entries, quint64 seq, bool watched);
+    void RemoveTree(const QString &path);
+    void Collect(const QString &dir, QList<FileState> &entries) const;
+    bool IsRemoteDir(const QString &dir);
+
+    static bool Read(const QString &dir, QList<FileState> &entries);
+    static bool Stat(const QString &path, FileState &state);
+
+    QString                     m_scanner;
+    mutable QMutex              m_lock;
+    bool                        m_loaded;
+    /// Paths whose rows in the filestate table are out of date
+    QSet<QString>               m_unsaved;
+    QHash<QString, FileState>   m_files;
+    QHash<QString, DirState>    m_dirs;
+    /// Directories listed during the current scan
+    QSet<QString>               m_visited;
+    /// Paths new, modified or gone during the current scan
+    QSet<QString>               m_changed;
+    /// Hashes of files gone during the current scan, by inode and size,
+    /// so files moved to another directory keep their hash
+    QHash<QPair<quint64, qint64>, QString> m_movedHashes;
+    /// Whether directories are on a network mount, by directory
+    QHash<QString, bool>        m_remote;
+    /// Number of directories read during the current scan
+    int                         m_reads;
+    MThreadPool                *m_pool;
+
+    static QMutex                           s_indexLock;
+    static QHash<QString, FileStateIndex*>  s_indexes;
+};
+
+#endif // FILESTATEINDEX_H
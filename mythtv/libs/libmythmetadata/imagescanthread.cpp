@@ -5,6 +5,7 @@
 #include "storagegroup.h"
 #include "imagescanthread.h"
 #include "imageutils.h"
+#include "filestateindex.h"
 
 
 /** \fn     ImageScanThread::ImageScanThread()
@@ -17,6 +18,7 @@ ImageScanThread::ImageScanThread() : MThread("ImageScanThread")
     m_dbDirList   = new QMap<QString, ImageMetadata *>;
     m_dbFileList  = new QMap<QString, ImageMetadata *>;
     m_continue = false;
+    m_index    = FileStateIndex::GetIndex("images");
 
     m_progressCount       = 0;
     m_progressTotalCount  = 0;
@@ -74,11 +76,21 @@ void ImageScanThread::run()
 
     QStringList paths = iu->GetStorageDirs();
 
+    m_index->BeginScan();
+
     // Get the total list of directories that will be synced.
     // This is only an additional information that the themer can show.
+    // The index knows it unless this is the first scan of a directory.
     for (int i = 0; i < paths.size(); ++i)
     {
         QString path = paths.at(i);
+        int count = m_index->Count(path);
+        if (count > 0)
+        {
+            m_progressTotalCount += count;
+            continue;
+        }
+
         QDirIterator it(path, QDirIterator::Subdirectories);
 
         while(it.hasNext())
@@ -98,6 +110,9 @@ void ImageScanThread::run()
         SyncFilesFromDir(path, 0, base);
     }
 
+    // Directories not seen by an interrupted scan are not gone
+    m_index->EndScan(m_continue);
+
     // Adding or updating directories have been completed.
     // The directory list still contains the remaining directories
     // that are not in the filesystem anymore. Remove them from the database
@@ -145,18 +160,21 @@ void ImageScanThread::SyncFilesFromDir(QString &path, int parentId,
     LOG(VB_FILE, LOG_DEBUG,
         QString("Syncing from SG dir %1").arg(path));
 
-    QDir dir(path);
-    if (!dir.exists())
+    // Only get files and dirs, no special and hidden stuff. Directories
+    // which did not change since the last scan are not read again.
+    QList<FileState> list;
+    if (!m_index->List(path, list))
         return;
 
-    // Only get files and dirs, no special and hidden stuff
-    dir.setFilter(QDir::Dirs | QDir::Files |
-                  QDir::NoDotAndDotDot | QDir::NoSymLinks);
-    QFileInfoList list = dir.entryInfoList();
-    if (list.isEmpty())
-        return;
+    QStringList subdirs;
+    for (int i = 0; i < list.size(); ++i)
+    {
+        if (list[i].isDir && !list[i].isLink)
+            subdirs << list[i].path;
+    }
+    m_index->Prefetch(subdirs);
 
-    for (QFileInfoList::iterator it = list.begin(); it != list.end(); ++it)
+    for (QList<FileState>::iterator it = list.begin(); it != list.end(); ++it)
     {
         if (!m_continue)
         {
@@ -165,8 +183,13 @@ void ImageScanThread::SyncFilesFromDir(QString &path, int parentId,
             return;
         }
 
-        QFileInfo fileInfo = *it;
-        if (fileInfo.isDir())
+        if (it->isLink)
+            continue;
+
+        // QFileInfo only stats the file when asked for more than the path,
+        // which only happens for files not in the database yet
+        QFileInfo fileInfo(it->path);
+        if (it->isDir)
         {
             // Get the id. This will be new parent id
             // when we traverse down the current directory.
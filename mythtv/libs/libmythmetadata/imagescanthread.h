@@ -10,6 +10,8 @@
 #include "mthread.h"
 #include "imagemetadata.h"
 
+class FileStateIndex;
+
 class ImageScanThread : public MThread
 {
 public:
@@ -32,6 +34,7 @@ private:
 
     QMap<QString, ImageMetadata *> *m_dbDirList;
     QMap<QString, ImageMetadata *> *m_dbFileList;
+    FileStateIndex                 *m_index;
 };
 
 #endif // IMAGESCANTHREAD_H
@@ -1,5 +1,13 @@
+// C++ headers
+#include <algorithm>
+using namespace std;
+
 // Qt headers
+#include <QCryptographicHash>
+#include <QImageReader>
+#include <QTextStream>
 #include <QPainter>
+#include <QRunnable>
 #include <QFile>
 
 // MythTV headers
@@ -13,6 +21,32 @@
 #include "imageutils.h"
 #include "imagethumbgenthread.h"
 
+/// Number of bytes from the start and from the end of a file which
+/// are hashed to tell whether its content changed
+#define HASH_CHUNK_SIZE (64 * 1024)
+
+/** \class ImageThumbGenTask
+ *  \brief Creates the thumbnail of a single file on the pool
+ *          of an ImageThumbGenThread.
+ */
+class ImageThumbGenTask : public QRunnable
+{
+  public:
+    ImageThumbGenTask(ImageThumbGenThread *parent, ImageMetadata *im)
+        : m_parent(parent), m_im(im) {}
+
+    void run(void)
+    {
+        m_parent->CreateThumbnail(m_im);
+        delete m_im;
+        m_parent->ThumbnailDone();
+    }
+
+  private:
+    ImageThumbGenThread *m_parent;
+    ImageMetadata       *m_im;
+};
+
 /** \fn     ImageThumbGenThread::ImageThumbGenThread()
  *  \brief  Constructor
  *  \return void
@@ -20,11 +54,14 @@
 ImageThumbGenThread::ImageThumbGenThread()
         :   m_progressCount(0), m_progressTotalCount(0),
             m_width(400), m_height(300),
-            m_pause(false), m_fileListSize(0)
+            m_pause(false), m_fileListSize(0),
+            m_pool("ImageThumbGen"), m_inProgress(0)
 {
     QString sgName = IMAGE_STORAGE_GROUP;
     m_storageGroup = StorageGroup(sgName, gCoreContext->GetHostName());
 
+    m_pool.setMaxThreadCount(max(QThread::idealThreadCount(), 1));
+
     if (!gCoreContext->IsMasterBackend())
         LOG(VB_GENERAL, LOG_ERR, "ImageThumbGenThread MUST be run on the master backend");
 }
@@ -44,54 +81,202 @@ ImageThumbGenThread::~ImageThumbGenThread()
 
 
 /** \fn     ImageThumbGenThread::run()
- *  \brief  Called when the thread starts. Tries to generate
- *          thumbnails from the file list until its empty or aborted.
+ *  \brief  Called when the thread starts. Hands the files in the
+ *          list to the pool until its empty or aborted.
  *  \return void
  */
 void ImageThumbGenThread::run()
 {
-    volatile bool exit = false;
+    QMutexLocker locker(&m_mutex);
 
-    m_mutex.lock();
-    m_fileListSize = m_fileList.size();
-    m_mutex.unlock();
+    m_timer.start();
 
-    while (!exit)
+    while (true)
     {
-        ImageMetadata *im = NULL;
-
-        m_mutex.lock();
-        if (!m_fileList.isEmpty())
-            im = m_fileList.takeFirst();
+        // Allows the thread to be paused when Pause() was called
+        if (m_pause)
+            m_condition.wait(&m_mutex);
 
-        // Update the progressbar even if the thumbnail will not be created
-        emit UpdateThumbnailProgress(m_fileList.size(), m_fileListSize);
-        m_mutex.unlock();
+        if (m_fileList.isEmpty())
+            break;
 
-        if (im)
+        // Only queue a few files per thread, so cancel() and Pause()
+        // take effect quickly
+        if (m_inProgress >= 2 * m_pool.maxThreadCount())
         {
-            if (im->m_type == kImageFile)
-            {
-                CreateImageThumbnail(im);
-            }
-            else if (im->m_type == kVideoFile)
-            {
-                CreateVideoThumbnail(im);
-            }
+            m_thumbnailDone.wait(&m_mutex);
+            continue;
         }
 
-        delete im;
+        m_inProgress++;
+        m_pool.start(new ImageThumbGenTask(this, m_fileList.takeFirst()),
+                     "ImageThumbGen");
+    }
 
-        m_mutex.lock();
-        exit = m_fileList.isEmpty();
-        m_mutex.unlock();
+    while (m_inProgress)
+        m_thumbnailDone.wait(&m_mutex);
 
-        // Allows the thread to be paused when Pause() was called
-        m_mutex.lock();
-        if (m_pause)
-            m_condition.wait(&m_mutex);
-        m_mutex.unlock();
+    if (m_progressCount)
+    {
+        LOG(VB_FILE, LOG_INFO,
+            QString("Handled %1 thumbnails in %2 s (%3 per second)")
+                .arg(m_progressCount).arg(m_timer.elapsed() / 1000.0)
+                .arg(m_progressCount * 1000.0 / max(m_timer.elapsed(), 1LL),
+                     0, 'f', 1));
+    }
+
+    m_progressCount      = 0;
+    m_progressTotalCount = 0;
+    m_fileListSize       = 0;
+}
+
+
+
+/** \fn     ImageThumbGenThread::CreateThumbnail(ImageMetadata *)
+ *  \brief  Creates the thumbnail of a file, called by the pool threads
+ *  \param  im The thumbnail details
+ *  \return void
+ */
+void ImageThumbGenThread::CreateThumbnail(ImageMetadata *im)
+{
+    if (im->m_type == kImageFile)
+    {
+        CreateImageThumbnail(im);
+    }
+    else if (im->m_type == kVideoFile)
+    {
+        CreateVideoThumbnail(im);
+    }
+}
+
+
+
+/** \fn     ImageThumbGenThread::ThumbnailDone()
+ *  \brief  Updates the progress once a pool thread is done with a file,
+ *          even if no thumbnail had to be created
+ *  \return void
+ */
+void ImageThumbGenThread::ThumbnailDone(void)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_inProgress--;
+    m_progressCount++;
+
+    double perSecond = m_progressCount * 1000.0 /
+                       max(m_timer.elapsed(), 1LL);
+
+    emit UpdateThumbnailProgress(m_progressTotalCount - m_progressCount,
+                                 m_progressTotalCount, perSecond);
+
+    m_thumbnailDone.wakeAll();
+}
+
+
+
+/** \fn     ImageThumbGenThread::IsUpToDate(const ImageMetadata *, const QString &)
+ *  \brief  Checks whether the existing thumbnail was made from the
+ *          current version of the file with the current settings.
+ *
+ *          The key saved along with the thumbnail holds the time stamp,
+ *          size and content hash of the file. If only the time stamp
+ *          changed, e.g. because the file was copied, the hash tells
+ *          whether the thumbnail needs to be recreated.
+ *  \param  im The thumbnail details
+ *  \param  fileName The full path of the file
+ *  \return True if the thumbnail need not be created
+ */
+bool ImageThumbGenThread::IsUpToDate(const ImageMetadata *im,
+                                     const QString &fileName)
+{
+    QString thumbFileName = im->m_thumbFileNameList->at(0);
+    QFileInfo thumbInfo(thumbFileName);
+    QFileInfo fileInfo(fileName);
+
+    if (!thumbInfo.exists())
+        return false;
+
+    QFile keyFile(thumbFileName + ".key");
+    if (!keyFile.open(QIODevice::ReadOnly))
+    {
+        // A thumbnail from before keys were saved
+        return thumbInfo.lastModified() >= fileInfo.lastModified();
+    }
+
+    QStringList key = QString(keyFile.readAll()).split(' ');
+    keyFile.close();
+
+    if (key.size() != 5 ||
+        key[3] != QString("%1x%2").arg(m_width).arg(m_height) ||
+        key[4].toInt() != im->GetOrientation())
+    {
+        return false;
+    }
+
+    if (key[0].toUInt() == fileInfo.lastModified().toTime_t() &&
+        key[1].toLongLong() == fileInfo.size())
+    {
+        return true;
+    }
+
+    if (key[2] != ContentHash(fileName).toHex())
+        return false;
+
+    // Same content, remember the new time stamp
+    SaveThumbnailKey(im, fileName);
+    return true;
+}
+
+
+
+/** \fn     ImageThumbGenThread::SaveThumbnailKey(const ImageMetadata *, const QString &)
+ *  \brief  Saves what IsUpToDate() needs to know next to the thumbnail
+ *  \param  im The thumbnail details
+ *  \param  fileName The full path of the file
+ *  \return void
+ */
+void ImageThumbGenThread::SaveThumbnailKey(const ImageMetadata *im,
+                                           const QString &fileName)
+{
+    QFileInfo fileInfo(fileName);
+    QFile keyFile(im->m_thumbFileNameList->at(0) + ".key");
+
+    if (!keyFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return;
+
+    QTextStream(&keyFile) << QString("%1 %2 %3 %4x%5 %6")
+        .arg(fileInfo.lastModified().toTime_t())
+        .arg(fileInfo.size())
+        .arg(QString(ContentHash(fileName).toHex()))
+        .arg(m_width).arg(m_height)
+        .arg(im->GetOrientation());
+}
+
+
+
+/** \fn     ImageThumbGenThread::ContentHash(const QString &)
+ *  \brief  Hashes the size, the start and the end of a file, which is
+ *          enough to notice edited images and is cheap even for videos.
+ *  \param  fileName The full path of the file
+ *  \return The hash, empty if the file could not be read
+ */
+QByteArray ImageThumbGenThread::ContentHash(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(QByteArray::number(file.size()));
+    hash.addData(file.read(HASH_CHUNK_SIZE));
+
+    if (file.size() > HASH_CHUNK_SIZE)
+    {
+        file.seek(max(file.size() - HASH_CHUNK_SIZE, (qint64)HASH_CHUNK_SIZE));
+        hash.addData(file.read(HASH_CHUNK_SIZE));
     }
+
+    return hash.result();
 }
 
 
@@ -104,17 +289,29 @@ void ImageThumbGenThread::run()
  */
 void ImageThumbGenThread::CreateImageThumbnail(ImageMetadata *im)
 {
-    if (QFile(im->m_thumbFileNameList->at(0)).exists())
+    QString imageFileName = m_storageGroup.FindFile(im->m_fileName);
+
+    if (IsUpToDate(im, imageFileName))
         return;
 
     QDir dir;
     if (!dir.exists(im->m_thumbPath))
         dir.mkpath(im->m_thumbPath);
 
-    QString imageFileName = m_storageGroup.FindFile(im->m_fileName);
+    // Let the decoder scale the image down while decoding, which for
+    // JPEG images skips most of the work (libjpeg's scale_denom)
+    QImageReader reader(imageFileName);
+    QSize size = reader.size();
+    if (size.isValid())
+    {
+        QSize scaledSize = size;
+        scaledSize.scale(m_width, m_height, Qt::KeepAspectRatio);
+        if (scaledSize.width() < size.width())
+            reader.setScaledSize(scaledSize);
+    }
 
     QImage image;
-    if (!image.load(imageFileName))
+    if (!reader.read(&image))
     {
         LOG(VB_FILE, LOG_ERR, QString("Failed to create pic thumbnail for %1").arg(imageFileName));
         return;
@@ -170,6 +367,7 @@ void ImageThumbGenThread::CreateImageThumbnail(ImageMetadata *im)
     // save the image in the thumbnail directory
     if (image.save(im->m_thumbFileNameList->at(0)))
     {
+        SaveThumbnailKey(im, imageFileName);
         LOG(VB_FILE, LOG_DEBUG, QString("Created pic thumbnail for %1").arg(imageFileName));
         QString msg = "IMAGE_THUMB_CREATED %1";
         gCoreContext->SendMessage(msg.arg(im->m_id));
@@ -185,15 +383,15 @@ void ImageThumbGenThread::CreateImageThumbnail(ImageMetadata *im)
  */
 void ImageThumbGenThread::CreateVideoThumbnail(ImageMetadata *im)
 {
-    if (QFile(im->m_thumbFileNameList->at(0)).exists())
+    QString videoFileName = m_storageGroup.FindFile(im->m_fileName);
+
+    if (IsUpToDate(im, videoFileName))
         return;
 
     QDir dir;
     if (!dir.exists(im->m_thumbPath))
         dir.mkpath(im->m_thumbPath);
 
-    QString videoFileName = m_storageGroup.FindFile(im->m_fileName);
-
     QString cmd = "mythpreviewgen";
     QStringList args;
     args << logPropagateArgs.split(" ", QString::SkipEmptyParts);
@@ -217,6 +415,7 @@ void ImageThumbGenThread::CreateVideoThumbnail(ImageMetadata *im)
         // save the default image in the thumbnail directory
         if (image.save(im->m_thumbFileNameList->at(0)))
         {
+            SaveThumbnailKey(im, videoFileName);
             emit ThumbnailCreated(im, 0);
             QString msg = "IMAGE_THUMB_CREATED %1";
             gCoreContext->SendMessage(msg.arg(im->m_id));
@@ -254,12 +453,16 @@ void ImageThumbGenThread::AddToThumbnailList(ImageMetadata *im,
         return;
 
     if (recreate)
+    {
         // remove any existing thumbnail to force its regeneration
         QFile::remove(im->m_thumbFileNameList->at(0));
+        QFile::remove(im->m_thumbFileNameList->at(0) + ".key");
+    }
 
     m_mutex.lock();
     m_fileList.append(im);
-    m_fileListSize = m_fileList.size();
+    m_progressTotalCount++;
+    m_fileListSize = m_progressTotalCount;
     m_mutex.unlock();
 }
 
@@ -274,10 +477,12 @@ void ImageThumbGenThread::cancel()
     m_mutex.lock();
     while (!m_fileList.isEmpty())
         delete m_fileList.takeFirst();
-    m_fileListSize = 0;
+    // The files already handed to the pool are still finished
+    m_progressTotalCount = m_progressCount + m_inProgress;
+    m_fileListSize = m_progressTotalCount;
     m_mutex.unlock();
 
-    emit UpdateThumbnailProgress(0, 0);
+    emit UpdateThumbnailProgress(0, 0, 0.0);
 }
 
 
@@ -299,8 +504,9 @@ void ImageThumbGenThread::Pause()
  */
 void ImageThumbGenThread::Resume()
 {
-    m_condition.wakeAll();
+    QMutexLocker locker(&m_mutex);
     m_pause = false;
+    m_condition.wakeAll();
 }
 
 
@@ -5,17 +5,28 @@
 #include <QThread>
 #include <QMutex>
 #include <QWaitCondition>
+#include <QElapsedTimer>
 
 // MythTV headers
 #include "mythuibuttontree.h"
 #include "imagemetadata.h"
 #include "storagegroup.h"
+#include "mthreadpool.h"
 #include "mythmetaexp.h"
 
+/** \class ImageThumbGenThread
+ *  \brief Creates the thumbnails of the files handed to it.
+ *
+ *  The thread itself only feeds the files to a pool with a thread per
+ *  core, which does the actual work. Thumbnails are only recreated when
+ *  the file they were made from changed, see IsUpToDate().
+ */
 class META_PUBLIC ImageThumbGenThread : public QThread
 {
     Q_OBJECT
 
+    friend class ImageThumbGenTask;
+
   public:
     ImageThumbGenThread();
     ~ImageThumbGenThread();
@@ -31,14 +42,20 @@ class META_PUBLIC ImageThumbGenThread : public QThread
 
   signals:
     void ThumbnailCreated(ImageMetadata *, int);
-    void UpdateThumbnailProgress(int, int);
+    void UpdateThumbnailProgress(int remaining, int total, double perSecond);
 
   protected:
     void run();
 
   private:
+    void CreateThumbnail(ImageMetadata *);
     void CreateImageThumbnail(ImageMetadata *);
     void CreateVideoThumbnail(ImageMetadata *);
+    void ThumbnailDone(void);
+
+    bool IsUpToDate(const ImageMetadata *, const QString &);
+    void SaveThumbnailKey(const ImageMetadata *, const QString &);
+    static QByteArray ContentHash(const QString &);
 
     void Resize(QImage &);
     void Rotate(QImage &);
@@ -55,6 +72,11 @@ class META_PUBLIC ImageThumbGenThread : public QThread
 
     QWaitCondition      m_condition;
     StorageGroup        m_storageGroup;
+
+    MThreadPool         m_pool;
+    int                 m_inProgress;
+    QWaitCondition      m_thumbnailDone;
+    QElapsedTimer       m_timer;
 };
 
 class META_PUBLIC ImageThumbGen
@@ -27,6 +27,7 @@ HEADERS += metaioflacvorbis.h metaioavfcomment.h metaiomp4.h
 HEADERS += metaiowavpack.h metaioid3.h metaiooggvorbis.h
 HEADERS += imagemetadata.h imageutils.h imagescan.h imagescanthread.h
 HEADERS += imagethumbgenthread.h musicfilescanner.h metadatagrabber.h
+HEADERS += filestateindex.h artworkcache.h
 
 SOURCES += cleanup.cpp  dbaccess.cpp  dirscan.cpp  globals.cpp
 SOURCES += parentalcontrols.cpp  videoscan.cpp  videoutils.cpp
@@ -39,6 +40,7 @@ SOURCES += metaioflacvorbis.cpp metaioavfcomment.cpp metaiomp4.cpp
 SOURCES += metaiowavpack.cpp metaioid3.cpp metaiooggvorbis.cpp
 SOURCES += imagemetadata.cpp imageutils.cpp imagescan.cpp imagescanthread.cpp
 SOURCES += imagethumbgenthread.cpp musicfilescanner.cpp metadatagrabber.cpp
+SOURCES += filestateindex.cpp artworkcache.cpp
 
 INCLUDEPATH += ../libmythbase ../libmythtv
 INCLUDEPATH += ../.. ../ ./ ../libmythui
@@ -94,6 +96,7 @@ inc.files += metaioflacvorbis.h metaioavfcomment.h metaiomp4.h
 inc.files += metaiowavpack.h metaioid3.h metaiooggvorbis.h
 inc.files += imagemetadata.h imageutils.h imagescan.h imagescanthread.h
 inc.files += imagethumbgenthread.h musicfilescanner.h metadatagrabber.h
+inc.files += filestateindex.h artworkcache.h
 
 INSTALLS += inc
 
@@ -11,6 +11,7 @@
 #include "mythdirs.h"
 #include "storagegroup.h"
 #include "metadataimagedownload.h"
+#include "artworkcache.h"
 #include "remotefile.h"
 #include "mythdownloadmanager.h"
 #include "mythlogging.h"
@@ -304,6 +305,11 @@ void MetadataImageDownload::run()
                                 break;
                             }
                         }
+
+                        // The backend serves this artwork to its clients,
+                        // have the sizes they ask for ready
+                        if (gCoreContext->IsBackend())
+                            ArtworkCache::GetCache()->Pregenerate(resolvedFN);
                     }
                 }
             }
@@ -3,6 +3,10 @@
 #include <unistd.h>
 
 // Qt headers
+#include <QWaitCondition>
+#include <QMutex>
+#include <QRunnable>
+#include <QThread>
 #include <QDir>
 
 // MythTV headers
@@ -11,12 +15,16 @@
 #include <mythcontext.h>
 #include <musicmetadata.h>
 #include <metaio.h>
+#include <mthreadpool.h>
+#include <mythtimer.h>
 #include <musicfilescanner.h>
+#include <filestateindex.h>
 
 MusicFileScanner::MusicFileScanner():
     m_tracksTotal(0), m_tracksUnchanged(0), m_tracksAdded (0), m_tracksRemoved(0),
     m_tracksUpdated(0), m_coverartTotal(0), m_coverartUnchanged(0), m_coverartAdded(0),
-    m_coverartRemoved(0), m_coverartUpdated(0)
+    m_coverartRemoved(0), m_coverartUpdated(0),
+    m_index(FileStateIndex::GetIndex("music"))
 {
     MSqlQuery query(MSqlQuery::InitCon());
 
@@ -66,6 +74,88 @@ MusicFileScanner::~MusicFileScanner ()
 
 }
 
+/// Tracks added with one INSERT
+static const int kTrackBatchSize = 100;
+
+/// Tags of a track, read by a MusicTagReaderTask
+struct MusicFileScanner::ScannedTrack
+{
+    ScannedTrack() : update(false), data(NULL) {}
+
+    QString        filename;
+    QString        startDir;
+    bool           update;
+    MusicMetadata *data;
+    AlbumArtList   art;
+};
+
+/// Tracks read by the tag readers, in the order they were done
+class MusicFileScanner::TrackQueue
+{
+  public:
+    void Push(ScannedTrack *track)
+    {
+        QMutexLocker locker(&m_lock);
+        m_tracks.push_back(track);
+        m_wait.wakeAll();
+    }
+
+    ScannedTrack *Pop(void)
+    {
+        QMutexLocker locker(&m_lock);
+        while (m_tracks.isEmpty())
+            m_wait.wait(&m_lock);
+        return m_tracks.takeFirst();
+    }
+
+  private:
+    QMutex                  m_lock;
+    QWaitCondition          m_wait;
+    QList<ScannedTrack*>    m_tracks;
+};
+
+/// Reads the tags of a track on the tag reader pool
+class MusicTagReaderTask : public QRunnable
+{
+  public:
+    MusicTagReaderTask(MusicFileScanner::TrackQueue *queue,
+                       MusicFileScanner::ScannedTrack *track) :
+        m_queue(queue), m_track(track) {}
+
+    void run(void)
+    {
+        const QString &filename = m_track->filename;
+
+        LOG(VB_FILE, LOG_INFO, QString("Reading metadata from %1")
+                .arg(filename));
+
+        MusicMetadata *data = MetaIO::readMetadata(filename);
+        if (data)
+        {
+            data->setFileSize((quint64)QFileInfo(filename).size());
+            data->setHostname(gCoreContext->GetHostName());
+
+            // read any embedded images from the tag of new tracks
+            MetaIO *tagger = m_track->update ? NULL :
+                MetaIO::createTagger(filename);
+
+            if (tagger)
+            {
+                if (tagger->supportsEmbeddedImages())
+                    m_track->art = tagger->getAlbumArtList(filename);
+                delete tagger;
+            }
+        }
+
+        m_track->data = data;
+        m_queue->Push(m_track);
+    }
+
+  private:
+    MusicFileScanner::TrackQueue   *m_queue;
+    MusicFileScanner::ScannedTrack *m_track;
+};
+
 /*!
  * \brief Builds a list of all the files found descending recursively
  *        into the given directory
@@ -79,28 +169,30 @@ MusicFileScanner::~MusicFileScanner ()
  */
 void MusicFileScanner::BuildFileList(QString &directory, MusicLoadedMap &music_files, MusicLoadedMap &art_files, int parentid)
 {
-    QDir d(directory);
-
-    if (!d.exists())
+    // Every file is stat'ed to notice tags edited in place, unless the
+    // directory is watched for changes
+    QList<FileState> list;
+    if (!m_index->List(directory, list, true))
         return;
 
-    d.setFilter(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-
-    QFileInfoList list = d.entryInfoList();
-    if (list.isEmpty())
-        return;
+    QStringList subdirs;
+    for (int i = 0; i < list.size(); ++i)
+    {
+        if (list[i].isDir)
+            subdirs << list[i].path;
+    }
+    m_index->Prefetch(subdirs, true);
 
-    QFileInfoList::const_iterator it = list.begin();
-    const QFileInfo *fi;
+    QList<FileState>::const_iterator it = list.begin();
 
     // Recursively traverse directory
     int newparentid = 0;
     while (it != list.end())
     {
-        fi = &(*it);
+        QString filename = it->path;
+        bool isDir = it->isDir;
         ++it;
-        QString filename = fi->absoluteFilePath();
-        if (fi->isDir())
+        if (isDir)
         {
 
             QString dir(filename);
@@ -236,8 +328,14 @@ int MusicFileScanner::GetDirectoryId(const QString &directory, const int &parent
 bool MusicFileScanner::HasFileChanged(
     const QString &filename, const QString &date_modified)
 {
-    QFileInfo fi(filename);
-    QDateTime dt = fi.lastModified();
+    // The scan just stat'ed the file or knows it did not change
+    QDateTime dt;
+    FileState state;
+    if (m_index->Get(filename, state) && state.mtime >= 0)
+        dt = MythDate::fromTime_t(state.mtime);
+    else
+        dt = QFileInfo(filename).lastModified();
+
     if (dt.isValid())
     {
         QDateTime old_dt = MythDate::fromString(date_modified);
@@ -557,16 +655,31 @@ void MusicFileScanner::RemoveFileFromDB(const QString &filename, const QString &
  * \returns Nothing.
  */
 void MusicFileScanner::UpdateFileInDB(const QString &filename, const QString &startDir)
+{
+    MusicMetadata *disk_meta = MetaIO::readMetadata(filename);
+
+    UpdateFileInDB(filename, startDir, disk_meta);
+
+    if (disk_meta)
+        delete disk_meta;
+}
+
+/*!
+ * \brief Updates a file in the database with tags already read.
+ *
+ * \param filename Full path to file.
+ * \param disk_meta The tags read from the file, remains owned by the caller.
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::UpdateFileInDB(const QString &filename,
+                                      const QString &startDir,
+                                      MusicMetadata *disk_meta)
 {
     QString dbFilename = filename;
     dbFilename.remove(0, startDir.length());
 
-    QString directory = filename;
-    directory.remove(0, startDir.length());
-    directory = directory.section( '/', 0, -2);
-
     MusicMetadata *db_meta   = MetaIO::getMetadata(dbFilename);
-    MusicMetadata *disk_meta = MetaIO::readMetadata(filename);
 
     if (db_meta && disk_meta)
     {
@@ -575,7 +688,6 @@ void MusicFileScanner::UpdateFileInDB(const QString &filename, const QString &st
             LOG(VB_GENERAL, LOG_ERR, QString("Asked to update track with "
                                                 "invalid ID - %1")
                                             .arg(db_meta->ID()));
-            delete disk_meta;
             delete db_meta;
             return;
         }
@@ -585,52 +697,338 @@ void MusicFileScanner::UpdateFileInDB(const QString &filename, const QString &st
         if (db_meta->PlayCount() > disk_meta->PlayCount())
             disk_meta->setPlaycount(db_meta->Playcount());
 
-        QString album_cache_string;
+        ResolveIds(disk_meta, filename, startDir);
 
-        // Set values from cache
-        int did = m_directoryid[directory];
-        if (did > 0)
-            disk_meta->setDirectoryId(did);
+        disk_meta->setFileSize((quint64)QFileInfo(filename).size());
 
-        int aid = m_artistid[disk_meta->Artist().toLower()];
-        if (aid > 0)
+        disk_meta->setHostname(gCoreContext->GetHostName());
+
+        // Commit track info to database
+        disk_meta->dumpToDatabase();
+    }
+
+    if (db_meta)
+        delete db_meta;
+}
+
+/*!
+ * \brief Adds new and updates changed tracks.
+ *
+ *        The tags are read on a pool of threads, while this thread resolves
+ *        the artist, album and genre ids through the caches and adds the
+ *        new tracks to the database in batches.
+ *
+ * \param music_files MusicLoadedMap
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::ReadTracks(MusicLoadedMap &music_files)
+{
+    QList<ScannedTrack*> pending;
+
+    MusicLoadedMap::Iterator iter;
+    for (iter = music_files.begin(); iter != music_files.end(); iter++)
+    {
+        if ((*iter).location != MusicFileScanner::kFileSystem &&
+            (*iter).location != MusicFileScanner::kNeedUpdate)
+            continue;
+
+        ScannedTrack *track = new ScannedTrack;
+        track->filename = iter.key();
+        track->startDir = (*iter).startDir;
+        track->update   = ((*iter).location == MusicFileScanner::kNeedUpdate);
+        pending.push_back(track);
+    }
+
+    if (pending.isEmpty())
+        return;
+
+    int threads = qMax(1, QThread::idealThreadCount());
+    MThreadPool pool("MusicTagReader");
+    pool.setMaxThreadCount(threads);
+
+    TrackQueue queue;
+    QList<ScannedTrack*> batch;
+    int total = pending.size();
+    int started = 0;
+    int done = 0;
+
+    MythTimer timer;
+    timer.start();
+
+    LOG(VB_GENERAL, LOG_INFO, QString("Reading tags of %1 tracks with %2 "
+                                      "threads").arg(total).arg(threads));
+
+    while (done < total)
+    {
+        // Keep the readers busy without holding the tags of every track
+        while (started < total && started - done < threads * 4)
         {
-            disk_meta->setArtistId(aid);
+            pool.start(new MusicTagReaderTask(&queue, pending[started++]),
+                       "MusicTagReader");
+        }
 
-            // The album cache depends on the artist id
-            album_cache_string = QString::number(disk_meta->getArtistId()) + "#" +
-                disk_meta->Album().toLower();
+        ScannedTrack *track = queue.Pop();
+        ++done;
 
-            if (m_albumid[album_cache_string] > 0)
-                disk_meta->setAlbumId(m_albumid[album_cache_string]);
+        if (!track->data)
+        {
+            delete track;
+        }
+        else if (track->update)
+        {
+            UpdateFileInDB(track->filename, track->startDir, track->data);
+            ++m_tracksUpdated;
+            delete track->data;
+            delete track;
+        }
+        else
+        {
+            batch.push_back(track);
+            if (batch.size() >= kTrackBatchSize)
+                AddTracksToDB(batch);
         }
 
-        int gid = m_genreid[disk_meta->Genre().toLower()];
-        if (gid > 0)
-            disk_meta->setGenreId(gid);
+        if (done % 1000 == 0)
+        {
+            LOG(VB_GENERAL, LOG_INFO,
+                QString("Scanned %1 of %2 tracks, %3 tracks/sec")
+                    .arg(done).arg(total)
+                    .arg(done * 1000.0 / qMax(timer.elapsed(), 1), 0, 'f', 1));
+        }
+    }
 
-        disk_meta->setFileSize((quint64)QFileInfo(filename).size());
+    AddTracksToDB(batch);
+    pool.waitForDone();
 
-        disk_meta->setHostname(gCoreContext->GetHostName());
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Scanned %1 tracks in %2 seconds, %3 tracks/sec")
+            .arg(total).arg(timer.elapsed() / 1000.0, 0, 'f', 1)
+            .arg(total * 1000.0 / qMax(timer.elapsed(), 1), 0, 'f', 1));
+}
 
-        // Commit track info to database
-        disk_meta->dumpToDatabase();
+/*!
+ * \brief Inserts a batch of new tracks with a single query and frees them.
+ *
+ *        The music tables use MyISAM, which has no transactions, so the
+ *        tracks are grouped into multi-row INSERTs instead.
+ *
+ * \param batch The tracks, empty afterwards
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::AddTracksToDB(QList<ScannedTrack*> &batch)
+{
+    if (batch.isEmpty())
+        return;
 
-        // Update the cache
-        m_artistid[disk_meta->Artist().toLower()]
-            = disk_meta->getArtistId();
-        m_genreid[disk_meta->Genre().toLower()]
-            = disk_meta->getGenreId();
-        album_cache_string = QString::number(disk_meta->getArtistId()) + "#" +
-            disk_meta->Album().toLower();
-        m_albumid[album_cache_string] = disk_meta->getAlbumId();
+    QMap<int, QPair<bool, int> > albums;
+    QStringList values;
+    bool embeddedArt = false;
+
+    for (int i = 0; i < batch.size(); ++i)
+    {
+        ScannedTrack *track = batch[i];
+        MusicMetadata *data = track->data;
+
+        ResolveIds(data, track->filename, track->startDir);
+
+        albums[data->getAlbumId()] = qMakePair(data->Compilation(),
+                                               data->Year());
+        embeddedArt |= !track->art.isEmpty();
+
+        values << QString("(:DIRECTORY%1, :ARTIST%1, :ALBUM%1, :TITLE%1, "
+                          ":GENRE%1, :YEAR%1, :TRACKNUM%1, :LENGTH%1, "
+                          ":FILENAME%1, :RATING%1, :FORMAT%1, :DATE_ADD, "
+                          ":DATE_MOD, :PLAYCOUNT%1, :TRACKCOUNT%1, "
+                          ":DISC_NUMBER%1, :DISC_COUNT%1, :SIZE%1, "
+                          ":HOSTNAME)").arg(i);
     }
 
-    if (disk_meta)
-        delete disk_meta;
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("INSERT INTO music_songs ( directory_id,"
+                  " artist_id, album_id,    name,         genre_id,"
+                  " year,      track,       length,       filename,"
+                  " rating,    format,      date_entered, date_modified,"
+                  " numplays,  track_count, disc_number,  disc_count,"
+                  " size,      hostname) VALUES " + values.join(", "));
+
+    QDateTime now = MythDate::current();
+    query.bindValue(":DATE_ADD", now);
+    query.bindValue(":DATE_MOD", now);
+    query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
 
-    if (db_meta)
-        delete db_meta;
+    for (int i = 0; i < batch.size(); ++i)
+    {
+        MusicMetadata *data = batch[i]->data;
+        QString n = QString::number(i);
+
+        query.bindValue(":DIRECTORY" + n, data->getDirectoryId());
+        query.bindValue(":ARTIST" + n, data->getArtistId());
+        query.bindValue(":ALBUM" + n, data->getAlbumId());
+        query.bindValue(":TITLE" + n, data->Title());
+        query.bindValue(":GENRE" + n, data->getGenreId());
+        query.bindValue(":YEAR" + n, data->Year());
+        query.bindValue(":TRACKNUM" + n, data->Track());
+        query.bindValue(":LENGTH" + n, data->Length());
+        query.bindValue(":FILENAME" + n, batch[i]->filename.section('/', -1));
+        query.bindValue(":RATING" + n, data->Rating());
+        query.bindValue(":FORMAT" + n, data->Format());
+        query.bindValue(":PLAYCOUNT" + n, data->Playcount());
+        query.bindValue(":TRACKCOUNT" + n, data->GetTrackCount());
+        query.bindValue(":DISC_NUMBER" + n, data->DiscNumber());
+        query.bindValue(":DISC_COUNT" + n, data->DiscCount());
+        query.bindValue(":SIZE" + n, (quint64)data->FileSize());
+    }
+
+    if (!query.exec())
+        MythDB::DBError("music insert tracks", query);
+    else
+        m_tracksAdded += batch.size();
+
+    // The ids of the new tracks are only needed to save embedded images
+    if (embeddedArt && query.isActive())
+    {
+        int firstid = query.lastInsertId().toInt();
+        QHash<QString, int> songids;
+
+        query.prepare("SELECT song_id, directory_id, filename "
+                      "FROM music_songs WHERE song_id >= :FIRSTID");
+        query.bindValue(":FIRSTID", firstid);
+
+        if (!query.exec())
+            MythDB::DBError("music select new track ids", query);
+
+        while (query.next())
+        {
+            songids[query.value(1).toString() + '/' +
+                    query.value(2).toString()] = query.value(0).toInt();
+        }
+
+        for (int i = 0; i < batch.size(); ++i)
+        {
+            ScannedTrack *track = batch[i];
+            if (track->art.isEmpty())
+                continue;
+
+            int id = songids.value(
+                QString::number(track->data->getDirectoryId()) + '/' +
+                track->filename.section('/', -1));
+            if (id <= 0)
+                continue;
+
+            track->data->setID(id);
+            track->data->setEmbeddedAlbumArt(track->art);
+            track->data->getAlbumArtImages()->dumpToDatabase();
+        }
+    }
+
+    // make sure the compilation flag is updated, once per album
+    query.prepare("UPDATE music_albums SET compilation = :COMPILATION, "
+                  "year = :YEAR WHERE music_albums.album_id = :ALBUMID");
+
+    QMap<int, QPair<bool, int> >::const_iterator it = albums.begin();
+    for (; it != albums.end(); ++it)
+    {
+        query.bindValue(":ALBUMID", it.key());
+        query.bindValue(":COMPILATION", it->first);
+        query.bindValue(":YEAR", it->second);
+
+        if (!query.exec())
+            MythDB::DBError("music compilation update", query);
+    }
+
+    for (int i = 0; i < batch.size(); ++i)
+    {
+        qDeleteAll(batch[i]->art);
+        delete batch[i]->data;
+        delete batch[i];
+    }
+    batch.clear();
+}
+
+/*!
+ * \brief Sets the directory, artist, album and genre ids of a track from
+ *        the caches, adding those not in the database yet.
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::ResolveIds(MusicMetadata *data,
+                                  const QString &filename,
+                                  const QString &startDir)
+{
+    QString directory = filename;
+    directory.remove(0, startDir.length());
+    directory = directory.section( '/', 0, -2);
+
+    int did = m_directoryid.value(directory);
+    if (did > 0)
+        data->setDirectoryId(did);
+    else
+        data->getDirectoryId();
+
+    int aid = CachedId(m_artistid, data->Artist().toLower(),
+                       "INSERT INTO music_artists (artist_name) "
+                       "VALUES (:NAME);", data->Artist());
+    data->setArtistId(aid);
+
+    // Albums belong to the compilation artist
+    int caid = aid;
+    if (data->CompilationArtist().toLower() != data->Artist().toLower())
+    {
+        caid = CachedId(m_artistid, data->CompilationArtist().toLower(),
+                        "INSERT INTO music_artists (artist_name) "
+                        "VALUES (:NAME);", data->CompilationArtist());
+    }
+
+    QString album_cache_string = QString::number(caid) + "#" +
+        data->Album().toLower();
+    int albumid = m_albumid.value(album_cache_string);
+    if (albumid <= 0)
+    {
+        MSqlQuery query(MSqlQuery::InitCon());
+        query.prepare("INSERT INTO music_albums "
+                      "(artist_id, album_name, compilation, year) "
+                      "VALUES (:COMP_ARTIST_ID, :ALBUM, :COMPILATION, :YEAR);");
+        query.bindValue(":COMP_ARTIST_ID", caid);
+        query.bindValue(":ALBUM", data->Album());
+        query.bindValue(":COMPILATION", data->Compilation());
+        query.bindValue(":YEAR", data->Year());
+
+        if (!query.exec() || query.numRowsAffected() <= 0)
+            MythDB::DBError("music insert album", query);
+        else
+            albumid = m_albumid[album_cache_string] =
+                query.lastInsertId().toInt();
+    }
+    data->setAlbumId(albumid);
+
+    data->setGenreId(CachedId(m_genreid, data->Genre().toLower(),
+                              "INSERT INTO music_genres (genre) "
+                              "VALUES (:NAME);", data->Genre()));
+}
+
+/// Returns the id of a name from the cache, inserting it if it is new
+int MusicFileScanner::CachedId(IdCache &cache, const QString &key,
+                               const QString &insert, const QString &name)
+{
+    int id = cache.value(key);
+    if (id > 0)
+        return id;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(insert);
+    query.bindValue(":NAME", name);
+
+    if (!query.exec() || query.numRowsAffected() <= 0)
+    {
+        MythDB::DBError("music insert id", query);
+        return -1;
+    }
+
+    id = query.lastInsertId().toInt();
+    cache[key] = id;
+    return id;
 }
 
 /*!
@@ -690,6 +1088,8 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
     MusicLoadedMap art_files;
     MusicLoadedMap::Iterator iter;
 
+    m_index->BeginScan();
+
     for (int x = 0; x < dirList.count(); x++)
     {
         QString startDir = dirList[x];
@@ -708,29 +1108,17 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
     LOG(VB_GENERAL, LOG_INFO, "Updating database");
 
         /*
-        This can be optimised quite a bit by consolidating all commands
-        via a lot of refactoring.
+        This can be optimised further:
 
-        1) group all files of the same decoder type, and don't
-        create/delete a Decoder pr. AddFileToDB. Or make Decoders be
-        singletons, it should be a fairly simple change.
-
-        2) RemoveFileFromDB should group the remove into one big SQL.
-
-        3) UpdateFileInDB, same as 1.
+        RemoveFileFromDB should group the remove into one big SQL.
         */
 
+    ReadTracks(music_files);
+
     for (iter = music_files.begin(); iter != music_files.end(); iter++)
     {
-        if ((*iter).location == MusicFileScanner::kFileSystem)
-            AddFileToDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kDatabase)
+        if ((*iter).location == MusicFileScanner::kDatabase)
             RemoveFileFromDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kNeedUpdate)
-        {
-            UpdateFileInDB(iter.key(), (*iter).startDir);
-            ++m_tracksUpdated;
-        }
     }
 
     for (iter = art_files.begin(); iter != art_files.end(); iter++)
@@ -749,6 +1137,8 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
     // Cleanup orphaned entries from the database
     cleanDB();
 
+    m_index->EndScan(true);
+
     QString trackStatus = QString("total tracks found: %1 (unchanged: %2, added: %3, removed: %4, updated %5)")
                                   .arg(m_tracksTotal).arg(m_tracksUnchanged).arg(m_tracksAdded)
                                   .arg(m_tracksRemoved).arg(m_tracksUpdated);
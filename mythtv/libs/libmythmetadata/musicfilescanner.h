@@ -7,12 +7,17 @@
 // Qt headers
 #include <QCoreApplication>
 
+class FileStateIndex;
+class MusicMetadata;
+
 typedef QMap<QString, int> IdCache;
 
 class META_PUBLIC MusicFileScanner
 {
     Q_DECLARE_TR_FUNCTIONS(MusicFileScanner)
 
+    friend class MusicTagReaderTask;
+
     enum MusicFileLocation
     {
         kFileSystem,
@@ -28,6 +33,9 @@ class META_PUBLIC MusicFileScanner
     };
 
     typedef QMap <QString, MusicFileData> MusicLoadedMap;
+
+    struct ScannedTrack;
+    class TrackQueue;
     public:
         MusicFileScanner(void);
         ~MusicFileScanner(void);
@@ -43,6 +51,14 @@ class META_PUBLIC MusicFileScanner
         void AddFileToDB(const QString &filename, const QString &startDir);
         void RemoveFileFromDB (const QString &filename, const QString &startDir);
         void UpdateFileInDB(const QString &filename, const QString &startDir);
+        void UpdateFileInDB(const QString &filename, const QString &startDir,
+                            MusicMetadata *disk_meta);
+        void ReadTracks(MusicLoadedMap &music_files);
+        void AddTracksToDB(QList<ScannedTrack*> &batch);
+        void ResolveIds(MusicMetadata *data, const QString &filename,
+                        const QString &startDir);
+        int  CachedId(IdCache &cache, const QString &key,
+                      const QString &insert, const QString &name);
         void ScanMusic(MusicLoadedMap &music_files);
         void ScanArtwork(MusicLoadedMap &music_files);
         void cleanDB();
@@ -61,6 +77,8 @@ class META_PUBLIC MusicFileScanner
 
         uint m_tracksTotal, m_tracksUnchanged, m_tracksAdded, m_tracksRemoved, m_tracksUpdated;
         uint m_coverartTotal, m_coverartUnchanged, m_coverartAdded, m_coverartRemoved, m_coverartUpdated;
+
+        FileStateIndex *m_index;
 };
 
 #endif // _MUSICFILESCANNER_H_
@@ -26,6 +26,7 @@
 #include "globals.h"
 #include "dbaccess.h"
 #include "dirscan.h"
+#include "filestateindex.h"
 
 QEvent::Type VideoScanChanges::kEventType =
     (QEvent::Type) QEvent::registerEventType();
@@ -86,7 +87,7 @@ class MythUIProgressDialog;
 VideoScannerThread::VideoScannerThread(QObject *parent) :
     MThread("VideoScanner"),
     m_RemoveAll(false), m_KeepAll(false), m_dialog(NULL),
-    m_DBDataChanged(false)
+    m_index(FileStateIndex::GetIndex("video")), m_DBDataChanged(false)
 {
     m_parent = parent;
     m_dbmetadata = new VideoMetadataListManager;
@@ -159,10 +160,6 @@ void VideoScannerThread::run()
 {
     RunProlog();
 
-    VideoMetadataListManager::metadata_list ml;
-    VideoMetadataListManager::loadAllFromDatabase(ml);
-    m_dbmetadata->setList(ml);
-
     QList<QByteArray> image_types = QImageReader::supportedImageFormats();
     QStringList imageExtensions;
     for (QList<QByteArray>::const_iterator p = image_types.begin();
@@ -175,6 +172,9 @@ void VideoScannerThread::run()
 
     uint counter = 0;
     FileCheckList fs_files;
+    bool local_only = true;
+
+    m_index->BeginScan();
 
     if (m_HasGUI)
         SendProgressEvent(counter, (uint)m_directories.size(),
@@ -182,6 +182,9 @@ void VideoScannerThread::run()
     for (QStringList::const_iterator iter = m_directories.begin();
          iter != m_directories.end(); ++iter)
     {
+        if (iter->startsWith("myth://"))
+            local_only = false;
+
         if (!buildFileList(*iter, imageExtensions, fs_files))
         {
             if (iter->startsWith("myth://"))
@@ -200,10 +203,31 @@ void VideoScannerThread::run()
             SendProgressEvent(++counter);
     }
 
+    // Nothing can have changed if the same local directories were scanned
+    // with the same settings before and none of their files changed
+    QString key = scanKey();
+    if (local_only && !m_index->HasChanges() && key == m_lastScanKey)
+    {
+        LOG(VB_GENERAL, LOG_INFO,
+            "No video files changed since the last scan.");
+        m_index->EndScan(true);
+        m_DBDataChanged = false;
+        gCoreContext->SendMessage("VIDEO_LIST_NO_CHANGE");
+        RunEpilog();
+        return;
+    }
+
+    VideoMetadataListManager::metadata_list ml;
+    VideoMetadataListManager::loadAllFromDatabase(ml);
+    m_dbmetadata->setList(ml);
+
     PurgeList db_remove;
     verifyFiles(fs_files, db_remove);
     m_DBDataChanged = updateDB(fs_files, db_remove);
 
+    m_index->EndScan(true);
+    m_lastScanKey = key;
+
     if (m_DBDataChanged)
     {
         QCoreApplication::postEvent(m_parent,
@@ -321,7 +345,16 @@ bool VideoScannerThread::updateDB(const FileCheckList &add, const PurgeList &rem
             int id = -1;
 
             // Are we sure this needs adding?  Let's check our Hash list.
-            QString hash = VideoMetadata::VideoFileHash(p->first, p->second.host);
+            // Local files moved or seen before keep their hash in the index
+            QString hash;
+            if (p->second.host.isEmpty())
+                hash = m_index->GetHash(p->first);
+            if (hash.isEmpty())
+            {
+                hash = VideoMetadata::VideoFileHash(p->first, p->second.host);
+                if (p->second.host.isEmpty() && hash != "NULL")
+                    m_index->SetHash(p->first, hash);
+            }
             if (hash != "NULL" && !hash.isEmpty())
             {
                 id = VideoMetadata::UpdateHashedDBRecord(hash, p->first, p->second.host);
@@ -405,7 +438,24 @@ bool VideoScannerThread::buildFileList(const QString &directory,
     FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
 
     dirhandler<FileCheckList> dh(filelist, imageExtensions);
-    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown);
+    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown,
+                              m_index);
+}
+
+/// Everything besides the files which decides what the scan finds
+QString VideoScannerThread::scanKey(void) const
+{
+    FileAssociations::ext_ignore_list ext_list;
+    FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
+
+    QStringList key = m_directories;
+    key << QString::number(m_ListUnknown);
+    for (FileAssociations::ext_ignore_list::const_iterator p =
+         ext_list.begin(); p != ext_list.end(); ++p)
+    {
+        key << QString("%1=%2").arg(p->first).arg(p->second);
+    }
+    return key.join("\n");
 }
 
 void VideoScannerThread::SendProgressEvent(uint progress, uint total,
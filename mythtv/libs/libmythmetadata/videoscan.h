@@ -15,6 +15,7 @@
 #include "mythprogressdialog.h"
 
 class VideoMetadataListManager;
+class FileStateIndex;
 
 class META_PUBLIC VideoScanner : public QObject
 {
@@ -89,6 +90,7 @@ class META_PUBLIC VideoScannerThread : public MThread
     bool buildFileList(const QString &directory,
                                         const QStringList &imageExtensions,
                                         FileCheckList &filelist);
+    QString scanKey(void) const;
 
     void SendProgressEvent(uint progress, uint total = 0,
             QString messsage = QString());
@@ -106,6 +108,10 @@ class META_PUBLIC VideoScannerThread : public MThread
     VideoMetadataListManager *m_dbmetadata;
     MythUIProgressDialog *m_dialog;
 
+    FileStateIndex *m_index;
+    // settings of the last scan which brought the database up to date
+    QString m_lastScanKey;
+
     QList<int> m_addList; // newly added intids
     QList<int> m_movList; // intids moved to new filename
     QList<int> m_delList; // orphaned/deleted intids
@@ -11,6 +11,7 @@ using namespace std;
 
 #include <QTextCodec>
 #include <QFileInfo>
+#include <QThread>
 
 // MythTV headers
 #include "mythtvexp.h"
@@ -27,6 +28,7 @@ using namespace std;
 #include "mythdbcon.h"
 #include "iso639.h"
 #include "mpegtables.h"
+#include "bytereader.h"
 #include "atscdescriptors.h"
 #include "dvbdescriptors.h"
 #include "cc608decoder.h"
@@ -252,6 +254,60 @@ static bool force_sw_decode(AVCodecContext *avctx)
     return false;
 }
 
+/** \fn set_decode_threading(AVCodecContext*, uint, const QSize&)
+ *  \brief Chooses the libavcodec threading mode and thread count for a
+ *         software video decode.
+ *
+ *  Frame threading scales best for H.264, HEVC and VPx but adds one frame
+ *  of latency per thread, so for SD material we only use a few threads.
+ *  MPEG-1/2 slice threading is cheap and adds no latency, so it is used
+ *  there with one thread per macroblock row at most.
+ *
+ *  This must be called before the codec is opened, libavcodec ignores
+ *  changes to the threading parameters of an open codec.
+ *
+ *  \param max_threads Upper bound from the display profile, further
+ *                     limited by the number of cores in this machine.
+ *  \return the number of threads that will be used.
+ */
+static uint set_decode_threading(AVCodecContext *enc, uint max_threads,
+                                 const QSize &dim)
+{
+    static const uint kMaxDecodeThreads = 16;
+
+    int cores = QThread::idealThreadCount();
+    uint threads = (cores > 0) ? min(max_threads, (uint)cores) : max_threads;
+    threads = max(min(threads, kMaxDecodeThreads), 1U);
+
+    int  type   = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    uint pixels = dim.width() * dim.height();
+    bool is_hd  = pixels >= 1280U * 720U;
+
+    switch (enc->codec_id)
+    {
+        case AV_CODEC_ID_MPEG1VIDEO:
+        case AV_CODEC_ID_MPEG2VIDEO:
+            type    = FF_THREAD_SLICE;
+            threads = min(threads, (uint)(dim.height() + 15) / 16);
+            break;
+        case AV_CODEC_ID_H264:
+        case AV_CODEC_ID_HEVC:
+        case AV_CODEC_ID_VP8:
+        case AV_CODEC_ID_VP9:
+            type = FF_THREAD_FRAME;
+            if (!is_hd)
+                threads = min(threads, 4U);
+            break;
+        default:
+            break;
+    }
+
+    enc->thread_count = threads;
+    enc->thread_type  = (threads > 1) ? type : 0;
+
+    return threads;
+}
+
 static void myth_av_log(void *ptr, int level, const char* fmt, va_list vl)
 {
     if (silence_ffmpeg_logging)
@@ -397,6 +453,9 @@ AvFormatDecoder::AvFormatDecoder(MythPlayer *parent,
       playerFlags(flags),
       video_codec_id(kCodec_NONE),
       maxkeyframedist(-1),
+      m_max_decode_threads(1),
+      m_decode_time_total(0),       m_decode_time_max(0),
+      m_decode_time_count(0),
       // Closed Caption & Teletext decoders
       ignore_scte(0),
       invert_scte_field(0),
@@ -2337,7 +2396,7 @@ int AvFormatDecoder::ScanStreams(bool novideo)
             uint width  = max(dim.width(),  16);
             uint height = max(dim.height(), 16);
             QString dec = "ffmpeg";
-            uint thread_count = 1;
+            uint thread_count = max(QThread::idealThreadCount(), 1);
 
             if (!is_db_ignored)
             {
@@ -2458,12 +2517,18 @@ int AvFormatDecoder::ScanStreams(bool novideo)
             if (FlagIsSet(kDecodeSingleThreaded))
                 thread_count = 1;
 
-            LOG(VB_PLAYBACK, LOG_INFO, LOC +
-                QString("Using %1 CPUs for decoding")
-                .arg(HAVE_THREADS ? thread_count : 1));
+            if (!HAVE_THREADS)
+                thread_count = 1;
 
-            if (HAVE_THREADS)
-                enc->thread_count = thread_count;
+            m_max_decode_threads = thread_count;
+            thread_count = set_decode_threading(enc, thread_count,
+                                                QSize(width, height));
+
+            LOG(VB_PLAYBACK, LOG_INFO, LOC +
+                QString("Using %1 CPUs for decoding (%2 threading)")
+                .arg(thread_count)
+                .arg((enc->thread_type & FF_THREAD_FRAME) ? "frame" :
+                     (enc->thread_type & FF_THREAD_SLICE) ? "slice" : "no"));
 
             InitVideoCodec(ic->streams[selTrack], enc, true);
 
@@ -3256,7 +3321,7 @@ void AvFormatDecoder::MpegPreProcessPkt(AVStream *stream, AVPacket *pkt)
 
     while (bufptr < bufend)
     {
-        bufptr = avpriv_find_start_code(bufptr, bufend, &start_code_state);
+        bufptr = ByteReader::find_start_code(bufptr, bufend, &start_code_state);
 
         float aspect_override = -1.0f;
         if (ringBuffer->IsDVD())
@@ -3426,6 +3491,8 @@ int AvFormatDecoder::H264PreProcessPkt(AVStream *stream, AVPacket *pkt)
             // The ffmpeg H.264 decoder currently does not support
             // resolution changes when thread_count!=1, so we
             // close and re-open the codec for resolution changes.
+            // The threading policy is re-evaluated for the new
+            // resolution rather than dropping to a single thread.
 
             bool do_it = HAVE_THREADS && res_changed;
             for (uint i = 0; do_it && (i < ic->nb_streams); i++)
@@ -3440,6 +3507,12 @@ int AvFormatDecoder::H264PreProcessPkt(AVStream *stream, AVPacket *pkt)
                     avcodec_flush_buffers(enc);
                     const AVCodec *codec = enc->codec;
                     avcodec_close(enc);
+                    uint threads = set_decode_threading(
+                        enc, m_max_decode_threads, QSize(width, height));
+                    LOG(VB_PLAYBACK, LOG_INFO, LOC +
+                        QString("Resolution changed to %1x%2, "
+                                "using %3 CPUs for decoding")
+                        .arg(width).arg(height).arg(threads));
                     int open_val = avcodec_open2(enc, codec, NULL);
                     if (open_val < 0)
                     {
@@ -3532,6 +3605,41 @@ bool AvFormatDecoder::PreProcessVideoPacket(AVStream *curstream, AVPacket *pkt)
     return true;
 }
 
+/** \fn AvFormatDecoder::UpdateDecodeTime(int64_t)
+ *  \brief Accumulates the time spent in the software video decoder.
+ *
+ *  The mean and worst case of each window of kDecodeTimeWindow packets are
+ *  made available to the playback data OSD via GetDecodeStats().
+ */
+void AvFormatDecoder::UpdateDecodeTime(int64_t nsecs)
+{
+    static const uint kDecodeTimeWindow = 100;
+
+    m_decode_time_total += nsecs;
+    m_decode_time_max    = max(m_decode_time_max, nsecs);
+
+    if (++m_decode_time_count < kDecodeTimeWindow)
+        return;
+
+    QMutexLocker locker(&m_decode_stats_lock);
+    m_decode_stats = QString("%1 ms avg, %2 ms max, %3 threads")
+        .arg(m_decode_time_total / (m_decode_time_count * 1000000.0), 0, 'f', 2)
+        .arg(m_decode_time_max / 1000000.0, 0, 'f', 2)
+        .arg(ic && selectedTrack[kTrackTypeVideo].av_stream_index >= 0 ?
+             ic->streams[selectedTrack[kTrackTypeVideo].av_stream_index]
+                 ->codec->thread_count : 1);
+
+    m_decode_time_total = 0;
+    m_decode_time_max   = 0;
+    m_decode_time_count = 0;
+}
+
+QString AvFormatDecoder::GetDecodeStats(void) const
+{
+    QMutexLocker locker(&m_decode_stats_lock);
+    return m_decode_stats;
+}
+
 bool AvFormatDecoder::ProcessVideoPacket(AVStream *curstream, AVPacket *pkt)
 {
     int ret = 0, gotpicture = 0;
@@ -3560,7 +3668,9 @@ bool AvFormatDecoder::ProcessVideoPacket(AVStream *curstream, AVPacket *pkt)
     else
     {
         context->reordered_opaque = pkt->pts;
+        m_decode_timer.start();
         ret = avcodec_decode_video2(context, mpa_pic, &gotpicture, pkt);
+        UpdateDecodeTime(m_decode_timer.nsecsElapsed());
     }
     avcodeclock->unlock();
 
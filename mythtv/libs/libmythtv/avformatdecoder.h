@@ -7,6 +7,7 @@
 #include <QString>
 #include <QMap>
 #include <QList>
+#include <QMutex>
 
 #include "programinfo.h"
 #include "format.h"
@@ -17,6 +18,7 @@
 #include "spdifencoder.h"
 #include "vbilut.h"
 #include "H264Parser.h"
+#include "mythtimer.h"
 #include "videodisplayprofile.h"
 #include "mythplayer.h"
 
@@ -142,6 +144,7 @@ class AvFormatDecoder : public DecoderBase
     long UpdateStoredFrameNum(long frame) { (void)frame; return 0;}
 
     QString      GetCodecDecoderName(void) const;
+    QString      GetDecodeStats(void) const;
     QString      GetRawEncodingType(void);
     MythCodecID  GetVideoCodecID(void) const { return video_codec_id; }
     void        *GetVideoCodecPrivate(void);
@@ -225,6 +228,7 @@ class AvFormatDecoder : public DecoderBase
     int  H264PreProcessPkt(AVStream *stream, AVPacket *pkt);
     bool PreProcessVideoPacket(AVStream *stream, AVPacket *pkt);
     virtual bool ProcessVideoPacket(AVStream *stream, AVPacket *pkt);
+    void UpdateDecodeTime(int64_t nsecs);
     virtual bool ProcessVideoFrame(AVStream *stream, AVFrame *mpa_pic);
     bool ProcessAudioPacket(AVStream *stream, AVPacket *pkt,
                             DecodeType decodetype);
@@ -331,6 +335,15 @@ class AvFormatDecoder : public DecoderBase
 
     int maxkeyframedist;
 
+    // Software decode threading and timing
+    uint             m_max_decode_threads;
+    MythTimer        m_decode_timer;
+    int64_t          m_decode_time_total;
+    int64_t          m_decode_time_max;
+    uint             m_decode_time_count;
+    mutable QMutex   m_decode_stats_lock;
+    QString          m_decode_stats;
+
     // Caption/Subtitle/Teletext decoders
     uint             ignore_scte;
     uint             invert_scte_field;
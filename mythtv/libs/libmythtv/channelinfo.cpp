@@ -6,6 +6,8 @@
 #include <QFileInfo>
 #include <QImage>
 #include <QUrl>
+#include <QSet>
+#include <QStringList>
 
 // MythTV headers
 #include "channelinfo.h"
@@ -174,6 +176,15 @@ void ChannelInfo::Init()
     m_sourcename.clear();
 }
 
+/// Columns read by FromQuery()
+static const char *kChannelColumns =
+    "chanid, channum, freqid, sourceid, "
+    "callsign, name, icon, finetune, videofilters, xmltvid, "
+    "recpriority, contrast, brightness, colour, hue, tvformat, "
+    "visible, outputfilters, useonairguide, mplexid, "
+    "serviceid, atsc_major_chan, atsc_minor_chan, last_record, "
+    "default_authority, commmethod, tmoffset, iptvid";
+
 bool ChannelInfo::Load(uint lchanid)
 {
     if (lchanid <= 0 && chanid <= 0)
@@ -183,13 +194,8 @@ bool ChannelInfo::Load(uint lchanid)
         lchanid = chanid;
 
     MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("SELECT channum, freqid, sourceid, "
-                    "callsign, name, icon, finetune, videofilters, xmltvid, "
-                    "recpriority, contrast, brightness, colour, hue, tvformat, "
-                    "visible, outputfilters, useonairguide, mplexid, "
-                    "serviceid, atsc_major_chan, atsc_minor_chan, last_record, "
-                    "default_authority, commmethod, tmoffset, iptvid "
-                    "FROM channel WHERE chanid = :CHANID ;");
+    query.prepare(QString("SELECT %1 FROM channel WHERE chanid = :CHANID ;")
+                  .arg(kChannelColumns));
 
     query.bindValue(":CHANID", lchanid);
 
@@ -202,38 +208,85 @@ bool ChannelInfo::Load(uint lchanid)
     if (!query.next())
         return false;
 
-    chanid        = lchanid;
-    channum       = query.value(0).toString();
-    freqid        = query.value(1).toString();
-    sourceid      = query.value(2).toUInt();
-    callsign      = query.value(3).toString();
-    name          = query.value(4).toString();
-    icon          = query.value(5).toString();
-    finetune      = query.value(6).toInt();
-    videofilters  = query.value(7).toString();
-    xmltvid       = query.value(8).toString();
-    recpriority   = query.value(9).toInt();
-    contrast      = query.value(10).toUInt();
-    brightness    = query.value(11).toUInt();
-    colour        = query.value(12).toUInt();
-    hue           = query.value(13).toUInt();
-    tvformat      = query.value(14).toString();
-    visible       = query.value(15).toBool();
-    outputfilters = query.value(16).toString();
-    useonairguide = query.value(17).toBool();
-    mplexid       = query.value(18).toUInt();
-    serviceid     = query.value(19).toUInt();
-    atsc_major_chan = query.value(20).toUInt();
-    atsc_minor_chan = query.value(21).toUInt();
-    last_record   = query.value(22).toDateTime();
-    default_authority = query.value(23).toString();
-    commmethod    = query.value(24).toUInt();
-    tmoffset      = query.value(25).toUInt();
-    iptvid        = query.value(26).toUInt();
+    FromQuery(query);
 
     return true;
 }
 
+/** \brief Loads the channels \p chanids with one query per few hundred,
+ *         rather than one each.
+ *
+ *  Channels that don't exist are left out of the result.
+ */
+QMap<uint, ChannelInfo> ChannelInfo::LoadList(const QList<uint> &chanids)
+{
+    QMap<uint, ChannelInfo> result;
+
+    QList<uint> unique = chanids.toSet().toList();
+    const int kBatch = 500;
+
+    for (int start = 0; start < unique.size(); start += kBatch)
+    {
+        QList<uint> batch = unique.mid(start, kBatch);
+        QStringList placeholders;
+        for (int i = 0; i < batch.size(); ++i)
+            placeholders << QString(":CHANID%1").arg(i);
+
+        MSqlQuery query(MSqlQuery::InitCon());
+        query.prepare(QString("SELECT %1 FROM channel WHERE chanid IN (%2) ;")
+                      .arg(kChannelColumns).arg(placeholders.join(", ")));
+        for (int i = 0; i < batch.size(); ++i)
+            query.bindValue(placeholders[i], batch[i]);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("ChannelInfo::LoadList()", query);
+            return result;
+        }
+
+        while (query.next())
+        {
+            ChannelInfo channel;
+            channel.FromQuery(query);
+            result.insert(channel.chanid, channel);
+        }
+    }
+
+    return result;
+}
+
+void ChannelInfo::FromQuery(const MSqlQuery &query)
+{
+    chanid        = query.value(0).toUInt();
+    channum       = query.value(1).toString();
+    freqid        = query.value(2).toString();
+    sourceid      = query.value(3).toUInt();
+    callsign      = query.value(4).toString();
+    name          = query.value(5).toString();
+    icon          = query.value(6).toString();
+    finetune      = query.value(7).toInt();
+    videofilters  = query.value(8).toString();
+    xmltvid       = query.value(9).toString();
+    recpriority   = query.value(10).toInt();
+    contrast      = query.value(11).toUInt();
+    brightness    = query.value(12).toUInt();
+    colour        = query.value(13).toUInt();
+    hue           = query.value(14).toUInt();
+    tvformat      = query.value(15).toString();
+    visible       = query.value(16).toBool();
+    outputfilters = query.value(17).toString();
+    useonairguide = query.value(18).toBool();
+    mplexid       = query.value(19).toUInt();
+    serviceid     = query.value(20).toUInt();
+    atsc_major_chan = query.value(21).toUInt();
+    atsc_minor_chan = query.value(22).toUInt();
+    last_record   = query.value(23).toDateTime();
+    default_authority = query.value(24).toString();
+    commmethod    = query.value(25).toUInt();
+    tmoffset      = query.value(26).toUInt();
+    iptvid        = query.value(27).toUInt();
+}
+
 QString ChannelInfo::GetFormatted(const ChannelFormat &format) const
 {
     QString tmp;
@@ -14,12 +14,15 @@ using namespace std;
 #include <QImage>
 #include <QVariant>
 #include <QDateTime>
+#include <QMap>
 
 // MythTV headers
 #include "mythtvexp.h"
 #include "mythtypes.h"
 #include "programtypes.h"
 
+class MSqlQuery;
+
 class MTV_PUBLIC ChannelInfo
 {
  public:
@@ -37,6 +40,7 @@ class MTV_PUBLIC ChannelInfo
         { return chanid == _chanid; }
         
     bool Load(uint lchanid = -1);
+    static QMap<uint, ChannelInfo> LoadList(const QList<uint> &chanids);
 
     enum ChannelFormat { kChannelShort, kChannelLong };
     QString GetFormatted(const ChannelFormat &format) const;
@@ -70,6 +74,7 @@ class MTV_PUBLIC ChannelInfo
     
   private:
     void Init();
+    void FromQuery(const MSqlQuery &query);
 
   public:
       
@@ -163,6 +163,7 @@ ChannelScanSM::ChannelScanSM(ScanMonitor *_scan_monitor,
       // Transports List
       m_transportsScanned(0),
       m_currentTestingDecryption(false),
+      m_queue(NULL),
       // Misc
       m_channelsFound(999),
       m_currentInfo(NULL),
@@ -346,6 +347,8 @@ bool ChannelScanSM::ScanExistingTransports(uint sourceid, bool follow_nit)
     if (!m_scanTransports.empty())
     {
         m_nextIt   = m_scanTransports.begin();
+        if (m_queue)
+            QueueTransports();
         m_scanning = true;
     }
     else
@@ -990,6 +993,8 @@ bool ChannelScanSM::UpdateChannelInfo(bool wait_until_complete)
         if (m_scanning)
         {
             m_transportsScanned++;
+            if (m_queue)
+                m_queue->TransportScanned();
             UpdateScanPercentCompleted();
             m_waitingForTables = false;
             m_nextIt = m_current.nextTransport();
@@ -1632,6 +1637,9 @@ void ChannelScanSM::HandleActiveScan(void)
 
     m_current = m_nextIt; // Increment current
 
+    if (m_current == m_scanTransports.end() && m_queue)
+        TakeQueuedTransport();
+
     if (m_current != m_scanTransports.end())
     {
         ScanTransport(m_current);
@@ -1640,6 +1648,17 @@ void ChannelScanSM::HandleActiveScan(void)
         m_nextIt = m_current;
         ++m_nextIt;
     }
+    else if (m_queue)
+    {
+        // Keep asking while the other tuners may still find transports
+        if (m_queue->Finish(this))
+            m_scanMonitor->ScanComplete();
+        if (m_queue->IsComplete())
+        {
+            m_scanning = false;
+            m_current = m_nextIt = m_scanTransports.end();
+        }
+    }
     else if (!m_extendTransports.isEmpty())
     {
         --m_current;
@@ -1669,6 +1688,38 @@ void ChannelScanSM::HandleActiveScan(void)
     }
 }
 
+/// Moves the transports to scan to the shared queue, the scanners of all
+/// the tuners then take them from there
+void ChannelScanSM::QueueTransports(void)
+{
+    transport_scan_items_t::const_iterator it = m_scanTransports.begin();
+    for (; it != m_scanTransports.end(); ++it)
+        m_queue->Add(*it);
+
+    m_scanTransports.clear();
+    m_current = m_nextIt = m_scanTransports.end();
+}
+
+/// Appends the next transport of the shared queue to the scan list and
+/// makes it the current one, after handing over the transports found
+/// in the NITs
+bool ChannelScanSM::TakeQueuedTransport(void)
+{
+    m_queue->Extend(m_sourceID, m_signalTimeout, m_tsScanned,
+                    m_extendTransports);
+    m_extendTransports.clear();
+
+    TransportScanItem item;
+    if (!m_queue->Take(this, item))
+        return false;
+
+    m_scanTransports.push_back(item);
+    transport_scan_items_t::iterator last = m_scanTransports.end();
+    m_current = --last;
+
+    return true;
+}
+
 bool ChannelScanSM::Tune(const transport_scan_items_it_t &transport)
 {
     const TransportScanItem &item = *transport;
@@ -1852,6 +1903,27 @@ bool ChannelScanSM::ScanTransports(
 
     m_nextIt            = m_scanTransports.begin();
     m_transportsScanned = 0;
+    if (m_queue)
+        QueueTransports();
+    m_scanning          = true;
+
+    return true;
+}
+
+/** \brief Scans the transports of the shared queue, on behalf of the
+ *         scanner of another tuner of the same video source.
+ */
+bool ChannelScanSM::ScanQueuedTransports(bool follow_nit)
+{
+    if (m_scanning || !m_queue)
+        return false;
+
+    m_scanTransports.clear();
+    m_current = m_nextIt = m_scanTransports.end();
+
+    m_extendScanList    = follow_nit;
+    m_waitingForTables  = false;
+    m_transportsScanned = 0;
     m_scanning          = true;
 
     return true;
@@ -2149,3 +2221,92 @@ bool ChannelScanSM::CheckImportedList(
 
     return found;
 }
+
+void ChannelScanQueue::Add(const TransportScanItem &item)
+{
+    QMutexLocker locker(&m_lock);
+    m_pending.push_back(item);
+    m_total++;
+}
+
+/// Gives the next transport to \p scanner, which then counts as busy
+/// until it asks for another one
+bool ChannelScanQueue::Take(const ChannelScanSM *scanner,
+                            TransportScanItem &item)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_complete || m_pending.empty())
+        return false;
+
+    item = m_pending.front();
+    m_pending.pop_front();
+    m_busy.insert(scanner);
+
+    return true;
+}
+
+/** \brief Queues the transports found in the NITs by a scanner.
+ *
+ *  \param scanned    Transports seen by the scanner, updated with the
+ *                    ones seen by all the scanners
+ *  \param transports Transports to add unless seen already
+ */
+void ChannelScanQueue::Extend(uint sourceid, uint signal_timeout,
+                              QSet<uint32_t> &scanned,
+                              const QMap<uint32_t,DTVMultiplex> &transports)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_tsScanned.unite(scanned);
+
+    QMap<uint32_t,DTVMultiplex>::const_iterator it = transports.begin();
+    for (; it != transports.end(); ++it)
+    {
+        if (m_tsScanned.contains(it.key()))
+            continue;
+
+        QString name = QString("TransportID %1").arg(it.key() & 0xffff);
+        TransportScanItem item(sourceid, name, *it, signal_timeout);
+        LOG(VB_CHANSCAN, LOG_INFO, QString("ChannelScanQueue: Adding ") +
+            name + " - " + item.tuning.toString());
+        m_pending.push_back(item);
+        m_tsScanned.insert(it.key());
+        m_total++;
+    }
+
+    scanned = m_tsScanned;
+}
+
+/// Notes that \p scanner ran out of transports, returns true the first
+/// time all the scanners are out of them
+bool ChannelScanQueue::Finish(const ChannelScanSM *scanner)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_busy.remove(scanner);
+
+    if (m_complete || !m_busy.empty() || !m_pending.empty())
+        return false;
+
+    m_complete = true;
+    return true;
+}
+
+void ChannelScanQueue::TransportScanned(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_scanned++;
+}
+
+int ChannelScanQueue::PercentComplete(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return (m_total) ? (m_scanned * 100) / m_total : 0;
+}
+
+bool ChannelScanQueue::IsComplete(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_complete;
+}
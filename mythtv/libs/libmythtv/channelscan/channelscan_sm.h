@@ -67,6 +67,44 @@ typedef QPair<transport_scan_items_it_t, ScannedChannelInfo*> ChannelListItem;
 typedef QList<ChannelListItem> ChannelList;
 
 class ChannelScanSM;
+
+/** \class ChannelScanQueue
+ *  \brief Transports to scan shared by the ChannelScanSM of several tuners.
+ *
+ *   Each scanner takes the next transport when it is done with the
+ *   previous one, so tuners that spend their time on empty frequencies
+ *   take more of them. The transports found in the NITs are added only
+ *   once whichever tuner finds them, and not at all if a tuner already
+ *   saw their SDT. The last scanner to run out of transports reports the
+ *   end of the scan.
+ */
+class ChannelScanQueue
+{
+  public:
+    ChannelScanQueue() : m_total(0), m_scanned(0), m_complete(false) {}
+
+    void Add(const TransportScanItem &item);
+    bool Take(const ChannelScanSM *scanner, TransportScanItem &item);
+    void Extend(uint sourceid, uint signal_timeout, QSet<uint32_t> &scanned,
+                const QMap<uint32_t,DTVMultiplex> &transports);
+    bool Finish(const ChannelScanSM *scanner);
+    void TransportScanned(void);
+
+    int  PercentComplete(void) const;
+    bool IsComplete(void) const;
+
+  private:
+    mutable QMutex                m_lock;
+    transport_scan_items_t        m_pending;
+    /// Scanners working on a transport
+    QSet<const ChannelScanSM*>    m_busy;
+    /// Transports seen by any of the scanners, (netid << 16) | tsid
+    QSet<uint32_t>                m_tsScanned;
+    uint                          m_total;
+    uint                          m_scanned;
+    bool                          m_complete;
+};
+
 class AnalogSignalHandler : public SignalMonitorListener
 {
   public:
@@ -114,6 +152,9 @@ class ChannelScanSM : public MPEGStreamListener,
     bool ScanIPTVChannels(uint sourceid, const fbox_chan_map_t &iptv_channels);
 
     bool ScanExistingTransports(uint sourceid, bool follow_nit);
+    bool ScanQueuedTransports(bool follow_nit);
+
+    void SetScanQueue(ChannelScanQueue *queue) { m_queue = queue; }
 
     void SetAnalog(bool is_analog);
     void SetSourceID(int _SourceID)   { m_sourceID                = _SourceID; }
@@ -168,6 +209,8 @@ class ChannelScanSM : public MPEGStreamListener,
 
     bool HasTimedOut(void);
     void HandleActiveScan(void);
+    void QueueTransports(void);
+    bool TakeQueuedTransport(void);
     bool Tune(const transport_scan_items_it_t &transport);
     void ScanTransport(const transport_scan_items_it_t &transport);
     DTVTunerType GuessDTVTunerType(DTVTunerType) const;
@@ -239,6 +282,9 @@ class ChannelScanSM : public MPEGStreamListener,
     QMap<uint, bool>            m_currentEncryptionStatusChecked;
     QMap<uint64_t, QString>     m_defAuthorities;
 
+    /// Transports shared with the scanners of other tuners, if any
+    ChannelScanQueue           *m_queue;
+
     /// Found Channel Info
     ChannelList       m_channelList;
     uint              m_channelsFound;
@@ -254,7 +300,8 @@ class ChannelScanSM : public MPEGStreamListener,
 
 inline void ChannelScanSM::UpdateScanPercentCompleted(void)
 {
-    int tmp = (m_transportsScanned * 100) /
+    int tmp = (m_queue) ? m_queue->PercentComplete() :
+              (m_transportsScanned * 100) /
               (m_scanTransports.size() + m_extendTransports.size());
     m_scanMonitor->ScanPercentComplete(tmp);
 }
@@ -135,6 +135,20 @@ class TrustEncSISetting : public CheckBoxSetting, public TransientStorage
     }
 };
 
+class UseAllTuners : public CheckBoxSetting, public TransientStorage
+{
+  public:
+    UseAllTuners() : CheckBoxSetting(this)
+    {
+        setValue(false);
+        setLabel(QObject::tr("Use All Tuners"));
+        setHelpText(
+            QObject::tr("If set, full scans share the frequencies between "
+                        "all the idle tuners of the same type connected to "
+                        "this video source, which makes them much quicker."));
+    }
+};
+
 class ScanFrequencykHz: public LineEditSetting, public TransientStorage
 {
   public:
@@ -49,6 +49,7 @@ using namespace std;
 
 ChannelScanner::ChannelScanner() :
     scanMonitor(NULL), channel(NULL), sigmonScanner(NULL), iptvScanner(NULL),
+    scanQueue(NULL), useAllTuners(false),
     freeToAirOnly(false), serviceRequirements(kRequireAV)
 {
 }
@@ -66,6 +67,12 @@ ChannelScanner::~ChannelScanner()
 
 void ChannelScanner::Teardown(void)
 {
+    while (!helperScanners.empty())
+        delete helperScanners.takeLast();
+
+    while (!helperChannels.empty())
+        delete helperChannels.takeLast();
+
     if (sigmonScanner)
     {
         delete sigmonScanner;
@@ -85,6 +92,12 @@ void ChannelScanner::Teardown(void)
         iptvScanner = NULL;
     }
 
+    if (scanQueue)
+    {
+        delete scanQueue;
+        scanQueue = NULL;
+    }
+
     if (scanMonitor)
     {
         scanMonitor->deleteLater();
@@ -127,6 +140,17 @@ void ChannelScanner::Scan(
         return;
     }
 
+    bool use_helpers = useAllTuners &&
+        ((ScanTypeSetting::FullScan_ATSC     == scantype) ||
+         (ScanTypeSetting::FullScan_DVBC     == scantype) ||
+         (ScanTypeSetting::FullScan_DVBT     == scantype) ||
+         (ScanTypeSetting::FullTransportScan == scantype));
+    if (use_helpers)
+    {
+        PreScanHelpers(scantype, cardid, sourceid,
+                       do_ignore_signal_timeout, do_test_decryption);
+    }
+
     sigmonScanner->StartScanner();
     scanMonitor->ScanUpdateStatusText("");
 
@@ -147,6 +171,14 @@ void ChannelScanner::Scan(
         {
             sigmonScanner->SetSignalTimeout(1000);
         }
+        for (int i = 0; i < helperScanners.size(); i++)
+        {
+            if ((mod.startsWith("qam", Qt::CaseInsensitive)) &&
+                (helperScanners[i]->GetSignalTimeout() < 1000))
+            {
+                helperScanners[i]->SetSignalTimeout(1000);
+            }
+        }
         // HACK HACK HACK -- end
 
         sigmonScanner->SetAnalog(ScanTypeSetting::FullScan_Analog == scantype);
@@ -247,6 +279,19 @@ void ChannelScanner::Scan(
         ok = sigmonScanner->ScanCurrentTransport(sistandard);
     }
 
+    if (ok && scanQueue)
+    {
+        bool follow_nit = (ScanTypeSetting::FullTransportScan == scantype) ?
+            do_follow_nit : true;
+        for (int i = 0; i < helperScanners.size(); i++)
+        {
+            helperScanners[i]->ScanQueuedTransports(follow_nit);
+            helperScanners[i]->StartScanner();
+        }
+        LOG(VB_CHANSCAN, LOG_INFO, LOC + QString("Scanning with %1 tuners")
+            .arg(helperScanners.size() + 1));
+    }
+
     if (!ok)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to handle tune complete.");
@@ -318,31 +363,17 @@ bool ChannelScanner::ImportM3U(uint cardid, const QString &inputname,
     return true;
 }
 
-void ChannelScanner::PreScanCommon(
-    int scantype,
-    uint cardid,
-    const QString &inputname,
-    uint sourceid,
-    bool do_ignore_signal_timeout,
-    bool do_test_decryption)
+/// Returns the timeouts to use when scanning with \p cardid
+static void get_scan_timeouts(int scantype, uint cardid,
+                              const QString &card_type,
+                              const QString &device,
+                              bool do_ignore_signal_timeout,
+                              uint &signal_timeout, uint &channel_timeout)
 {
-    uint signal_timeout  = 1000;
-    uint channel_timeout = 40000;
+    signal_timeout  = 1000;
+    channel_timeout = 40000;
     CardUtil::GetTimeouts(cardid, signal_timeout, channel_timeout);
 
-    QString device = CardUtil::GetVideoDevice(cardid);
-    if (device.isEmpty())
-    {
-        LOG(VB_GENERAL, LOG_ERR, LOC + "No Device");
-        InformUser(tr("Programmer Error: No Device"));
-        return;
-    }
-
-    if (!scanMonitor)
-        scanMonitor = new ScanMonitor(this);
-
-    QString card_type = CardUtil::GetRawCardType(cardid);
-
     if ("DVB" == card_type)
     {
         QString sub_type = CardUtil::ProbeDVBType(device).toUpper();
@@ -366,6 +397,12 @@ void ChannelScanner::PreScanCommon(
         // ensures that we catch the NIT then.
         channel_timeout = max(channel_timeout, need_nit * 7 * 1000U);
     }
+}
+
+static ChannelBase *create_scan_channel(const QString &card_type,
+                                        const QString &device)
+{
+    ChannelBase *channel = NULL;
 
 #ifdef USING_DVB
     if ("DVB" == card_type)
@@ -403,6 +440,70 @@ void ChannelScanner::PreScanCommon(
         channel = new ExternalChannel(NULL, device);
     }
 
+    return channel;
+}
+
+// If we know the channel types we can give the signal montior a hint.
+// Since we unfortunately do not record this info in the DB, we cannot
+// do this for the other scan types and have to guess later on...
+static void set_scan_tuner_type(ChannelScanSM *scanner, int scantype)
+{
+    switch (scantype)
+    {
+        case ScanTypeSetting::FullScan_ATSC:
+            scanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeATSC);
+            break;
+        case ScanTypeSetting::FullScan_DVBC:
+            scanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBC);
+            break;
+        case ScanTypeSetting::FullScan_DVBT:
+            scanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBT);
+            break;
+        case ScanTypeSetting::NITAddScan_DVBT:
+            scanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBT);
+            break;
+        case ScanTypeSetting::NITAddScan_DVBS:
+            scanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBS1);
+            break;
+        case ScanTypeSetting::NITAddScan_DVBS2:
+            scanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBS2);
+            break;
+        case ScanTypeSetting::NITAddScan_DVBC:
+            scanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBC);
+            break;
+        default:
+            break;
+    }
+}
+
+void ChannelScanner::PreScanCommon(
+    int scantype,
+    uint cardid,
+    const QString &inputname,
+    uint sourceid,
+    bool do_ignore_signal_timeout,
+    bool do_test_decryption)
+{
+    QString device = CardUtil::GetVideoDevice(cardid);
+    if (device.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No Device");
+        InformUser(tr("Programmer Error: No Device"));
+        return;
+    }
+
+    if (!scanMonitor)
+        scanMonitor = new ScanMonitor(this);
+
+    QString card_type = CardUtil::GetRawCardType(cardid);
+
+    uint signal_timeout, channel_timeout;
+    get_scan_timeouts(scantype, cardid, card_type, device,
+                      do_ignore_signal_timeout,
+                      signal_timeout, channel_timeout);
+
+    channel = create_scan_channel(card_type, device);
+
     if (!channel)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC + "Channel not created");
@@ -427,35 +528,7 @@ void ChannelScanner::PreScanCommon(
                                       sourceid, signal_timeout, channel_timeout,
                                       inputname, do_test_decryption);
 
-    // If we know the channel types we can give the signal montior a hint.
-    // Since we unfortunately do not record this info in the DB, we cannot
-    // do this for the other scan types and have to guess later on...
-    switch (scantype)
-    {
-        case ScanTypeSetting::FullScan_ATSC:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeATSC);
-            break;
-        case ScanTypeSetting::FullScan_DVBC:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBC);
-            break;
-        case ScanTypeSetting::FullScan_DVBT:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBT);
-            break;
-        case ScanTypeSetting::NITAddScan_DVBT:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBT);
-            break;
-        case ScanTypeSetting::NITAddScan_DVBS:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBS1);
-            break;
-        case ScanTypeSetting::NITAddScan_DVBS2:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBS2);
-            break;
-        case ScanTypeSetting::NITAddScan_DVBC:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBC);
-            break;
-        default:
-            break;
-    }
+    set_scan_tuner_type(sigmonScanner, scantype);
 
     // Signal Meters are connected here
     SignalMonitor *mon = sigmonScanner->GetSignalMonitor();
@@ -473,3 +546,104 @@ void ChannelScanner::PreScanCommon(
 
     MonitorProgress(mon, mon, dvbm, using_rotor);
 }
+
+/** \brief Sets up scanners for the other tuners of \p sourceid.
+ *
+ *   Only tuners of the same type as \p cardid that are not in use, and do
+ *   not share their tuner with one already used, are taken. When any is
+ *   found the transports of the scan are shared between all the scanners.
+ */
+void ChannelScanner::PreScanHelpers(
+    int scantype,
+    uint cardid,
+    uint sourceid,
+    bool do_ignore_signal_timeout,
+    bool do_test_decryption)
+{
+    QString card_type = CardUtil::GetRawCardType(cardid);
+
+    vector<uint> used;
+    used.push_back(cardid);
+
+    vector<uint> cardids = CardUtil::GetCardIDs(sourceid);
+    for (uint i = 0; i < cardids.size(); i++)
+    {
+        uint other = cardids[i];
+        if ((find(used.begin(), used.end(), other) != used.end()) ||
+            (CardUtil::GetRawCardType(other) != card_type))
+        {
+            continue;
+        }
+
+        bool shared = false;
+        for (uint j = 0; j < used.size() && !shared; j++)
+            shared = CardUtil::IsTunerShared(used[j], other);
+        if (shared)
+            continue;
+
+        QStringList inputs = CardUtil::GetInputNames(other, sourceid);
+        QString device = CardUtil::GetVideoDevice(other);
+        if (inputs.empty() || device.isEmpty())
+            continue;
+
+        ChannelBase *chan = create_scan_channel(card_type, device);
+        if (!chan)
+            continue;
+
+        chan->SetCardID(other);
+        if (!chan->Open())
+        {
+            LOG(VB_CHANSCAN, LOG_INFO, LOC +
+                QString("Card %1 is busy, not scanning with it").arg(other));
+            delete chan;
+            continue;
+        }
+
+        uint signal_timeout, channel_timeout;
+        get_scan_timeouts(scantype, other, card_type, device,
+                          do_ignore_signal_timeout,
+                          signal_timeout, channel_timeout);
+
+        ChannelScanSM *scanner = new ChannelScanSM(
+            scanMonitor, card_type, chan, sourceid,
+            signal_timeout, channel_timeout, inputs[0], do_test_decryption);
+        set_scan_tuner_type(scanner, scantype);
+
+        helperChannels.push_back(chan);
+        helperScanners.push_back(scanner);
+        used.push_back(other);
+    }
+
+    if (helperScanners.empty())
+        return;
+
+    scanQueue = new ChannelScanQueue();
+    sigmonScanner->SetScanQueue(scanQueue);
+    for (int i = 0; i < helperScanners.size(); i++)
+        helperScanners[i]->SetScanQueue(scanQueue);
+}
+
+void ChannelScanner::StopScanners(void)
+{
+    if (sigmonScanner)
+        sigmonScanner->StopScanner();
+
+    for (int i = 0; i < helperScanners.size(); i++)
+        helperScanners[i]->StopScanner();
+}
+
+/// Returns the transports found by all the tuners that took part
+ScanDTVTransportList ChannelScanner::GetChannelList(void) const
+{
+    ScanDTVTransportList list;
+    if (sigmonScanner)
+        list = sigmonScanner->GetChannelList();
+
+    for (int i = 0; i < helperScanners.size(); i++)
+    {
+        ScanDTVTransportList more = helperScanners[i]->GetChannelList();
+        list.insert(list.end(), more.begin(), more.end());
+    }
+
+    return list;
+}
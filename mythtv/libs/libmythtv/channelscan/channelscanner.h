@@ -32,6 +32,7 @@
 
 // Qt headers
 #include <QCoreApplication>
+#include <QList>
 
 // MythTV headers
 #include "mythtvexp.h"
@@ -43,6 +44,7 @@
 class ScanMonitor;
 class IPTVChannelFetcher;
 class ChannelScanSM;
+class ChannelScanQueue;
 class ChannelBase;
 
 // Not (yet?) implemented from old scanner
@@ -83,6 +85,9 @@ class MTV_PUBLIC ChannelScanner
     virtual bool ImportM3U(uint cardid, const QString &inputname,
                            uint sourceid, bool is_mpts);
 
+    /// Share full scans with the other free tuners of the video source
+    void SetUseAllTuners(bool use_all) { useAllTuners = use_all; }
+
   protected:
     virtual void Teardown(void);
 
@@ -92,6 +97,14 @@ class MTV_PUBLIC ChannelScanner
         uint sourceid, bool do_ignore_signal_timeout,
         bool do_test_decryption);
 
+    void PreScanHelpers(
+        int scantype, uint cardid,
+        uint sourceid, bool do_ignore_signal_timeout,
+        bool do_test_decryption);
+
+    void StopScanners(void);
+    ScanDTVTransportList GetChannelList(void) const;
+
     virtual void MonitorProgress(
         bool /*lock*/, bool /*strength*/, bool /*snr*/, bool /*rotor*/) { }
 
@@ -106,6 +119,12 @@ class MTV_PUBLIC ChannelScanner
     ChannelScanSM      *sigmonScanner;
     IPTVChannelFetcher *iptvScanner;
 
+    /// Scanners of the other tuners, sharing the transports of sigmonScanner
+    QList<ChannelScanSM*> helperScanners;
+    QList<ChannelBase*>   helperChannels;
+    ChannelScanQueue     *scanQueue;
+    bool                  useAllTuners;
+
     /// imported channels
     DTVChannelList      channels;
     fbox_chan_map_t     iptv_channels;
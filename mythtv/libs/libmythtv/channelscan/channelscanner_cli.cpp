@@ -63,8 +63,8 @@ void ChannelScannerCLI::HandleEvent(const ScannerEvent *scanEvent)
         ScanDTVTransportList transports;
         if (sigmonScanner)
         {
-            sigmonScanner->StopScanner();
-            transports = sigmonScanner->GetChannelList();
+            StopScanners();
+            transports = GetChannelList();
         }
 
         Teardown();
@@ -109,8 +109,8 @@ void ChannelScannerGUI::HandleEvent(const ScannerEvent *scanEvent)
         ScanDTVTransportList transports;
         if (sigmonScanner)
         {
-            sigmonScanner->StopScanner();
-            transports = sigmonScanner->GetChannelList();
+            StopScanners();
+            transports = GetChannelList();
         }
 
         bool wasIPTV = iptvScanner != NULL;
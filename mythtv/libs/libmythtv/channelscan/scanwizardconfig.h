@@ -44,6 +44,7 @@ class IgnoreSignalTimeout;
 class DesiredServices;
 class FreeToAirOnly;
 class TrustEncSISetting;
+class UseAllTuners;
 
 class PaneAll;
 class PaneATSC;
@@ -172,6 +173,7 @@ class ScanWizardConfig: public VerticalConfigurationGroup
         { return scanConfig->DoFollowNIT(); }
     bool    DoFreeToAirOnly(void)  const;
     bool    DoTestDecryption(void) const;
+    bool    DoUseAllTuners(void)   const;
 
   protected:
     VideoSourceSelector *videoSource;
@@ -181,6 +183,7 @@ class ScanWizardConfig: public VerticalConfigurationGroup
     DesiredServices     *services;
     FreeToAirOnly       *ftaOnly;
     TrustEncSISetting   *trustEncSI;
+    UseAllTuners        *allTuners;
 };
 
 #endif // _SCAN_WIZARD_CONFIG_H_
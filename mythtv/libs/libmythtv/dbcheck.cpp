@@ -3143,6 +3143,42 @@ NULL
             return false;
     }
 
+    if (dbver == "1339")
+    {
+        const char *updates[] = {
+            // statustime changes with every comment update, so keep the
+            // time a job was started separately for wait/run statistics
+            "ALTER TABLE jobqueue ADD COLUMN runstarttime DATETIME NULL "
+            "    DEFAULT NULL AFTER statustime;",
+            NULL
+        };
+        if (!performActualUpdate(updates, "1340", dbver))
+            return false;
+    }
+
+    if (dbver == "1340")
+    {
+        const char *updates[] = {
+            // Listings of the media scanner directories, so unchanged
+            // directories need not be read again, see FileStateIndex
+            "CREATE TABLE IF NOT EXISTS filestate ("
+            "  scanner      VARCHAR(32) NOT NULL,"
+            "  hostname     VARCHAR(64) NOT NULL DEFAULT '',"
+            "  path         TEXT NOT NULL,"
+            "  isdir        TINYINT(1) NOT NULL DEFAULT '0',"
+            "  islink       TINYINT(1) NOT NULL DEFAULT '0',"
+            "  size         BIGINT(20) NOT NULL DEFAULT '0',"
+            "  mtime        BIGINT(20) NOT NULL DEFAULT '0',"
+            "  inode        BIGINT(20) UNSIGNED NOT NULL DEFAULT '0',"
+            "  hash         VARCHAR(64) NOT NULL DEFAULT '',"
+            "  KEY path (scanner, hostname, path(200))"
+            ") ENGINE=MyISAM DEFAULT CHARSET=utf8;",
+            NULL
+        };
+        if (!performActualUpdate(updates, "1341", dbver))
+            return false;
+    }
+
     return true;
 }
 
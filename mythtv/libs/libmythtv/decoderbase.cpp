@@ -8,6 +8,7 @@ using namespace std;
 #include "mythlogging.h"
 #include "decoderbase.h"
 #include "programinfo.h"
+#include "posmapcache.h"
 #include "iso639.h"
 #include "DVD/dvdringbuffer.h"
 #include "Bluray/bdringbuffer.h"
@@ -148,7 +149,7 @@ bool DecoderBase::PosMapFromDb(void)
     else if ((positionMapType == MARK_UNSET) ||
         (keyframedist == -1))
     {
-        m_playbackinfo->QueryPositionMap(posMap, MARK_GOP_BYFRAME);
+        PositionMapCache::QueryPositionMap(*m_playbackinfo, posMap, MARK_GOP_BYFRAME);
         if (!posMap.empty())
         {
             positionMapType = MARK_GOP_BYFRAME;
@@ -157,7 +158,7 @@ bool DecoderBase::PosMapFromDb(void)
         }
         else
         {
-            m_playbackinfo->QueryPositionMap(posMap, MARK_GOP_START);
+            PositionMapCache::QueryPositionMap(*m_playbackinfo, posMap, MARK_GOP_START);
             if (!posMap.empty())
             {
                 positionMapType = MARK_GOP_START;
@@ -170,7 +171,7 @@ bool DecoderBase::PosMapFromDb(void)
             }
             else
             {
-                m_playbackinfo->QueryPositionMap(posMap, MARK_KEYFRAME);
+                PositionMapCache::QueryPositionMap(*m_playbackinfo, posMap, MARK_KEYFRAME);
                 if (!posMap.empty())
                 {
                     // keyframedist should be set in the fileheader so no
@@ -182,13 +183,13 @@ bool DecoderBase::PosMapFromDb(void)
     }
     else
     {
-        m_playbackinfo->QueryPositionMap(posMap, positionMapType);
+        PositionMapCache::QueryPositionMap(*m_playbackinfo, posMap, positionMapType);
     }
 
     if (posMap.empty())
         return false; // no position map in recording
 
-    m_playbackinfo->QueryPositionMap(durMap, MARK_DURATION_MS);
+    PositionMapCache::QueryPositionMap(*m_playbackinfo, durMap, MARK_DURATION_MS);
 
     QMutexLocker locker(&m_positionMapLock);
     m_positionMap.clear();
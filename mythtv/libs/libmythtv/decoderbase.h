@@ -211,6 +211,8 @@ class DecoderBase
     long long GetFramesPlayed(void) const { return framesPlayed; }
 
     virtual QString GetCodecDecoderName(void) const = 0;
+    /// Returns a summary of recent video decode times, if measured.
+    virtual QString GetDecodeStats(void) const { return QString(); }
     virtual QString GetRawEncodingType(void) { return QString(); }
     virtual MythCodecID GetVideoCodecID(void) const = 0;
     virtual void *GetVideoCodecPrivate(void) { return NULL; }
@@ -232,6 +234,7 @@ class DecoderBase
     bool IsErrored() const { return errored; }
 
     bool HasPositionMap(void) const { return GetPositionMapSize(); }
+    long long GetLastFrameInPosMap(void) const;
 
     void SetWaitForChange(void);
     bool GetWaitForChange(void) const;
@@ -282,7 +285,6 @@ class DecoderBase
     virtual void DoFastForwardSeek(long long desiredFrame, bool &needflush);
 
     long long ConditionallyUpdatePosMap(long long desiredFrame);
-    long long GetLastFrameInPosMap(void) const;
     unsigned long GetPositionMapSize(void) const;
 
     typedef struct posmapentry
@@ -13,6 +13,7 @@
 
 #include "threadedfilewriter.h"
 #include "fileringbuffer.h"
+#include "recordingtap.h"
 #include "mythcontext.h"
 #include "remotefile.h"
 #include "mythconfig.h" // gives us HAVE_POSIX_FADVISE
@@ -420,12 +421,36 @@ bool FileRingBuffer::ReOpen(QString newFilename)
         poslock.lockForWrite();
         writepos = 0;
         poslock.unlock();
+
+        // The tap was for the file written so far
+        delete tap;
+        tap = NULL;
     }
 
     rwlock.unlock();
     return result;
 }
 
+bool FileRingBuffer::AttachRecordingTap(void)
+{
+    QWriteLocker lock(&rwlock);
+
+    if (writemode || remotefile || fd2 < 0)
+        return false;
+
+    if (!tap)
+    {
+        tap = new RecordingTap(filename);
+        if (!tap->Attach())
+        {
+            delete tap;
+            tap = NULL;
+        }
+    }
+
+    return tap;
+}
+
 bool FileRingBuffer::IsOpen(void) const
 {
     rwlock.lockForRead();
@@ -462,6 +487,18 @@ int FileRingBuffer::safe_read(int fd, void *data, uint sz)
     if (stopreads)
         return 0;
 
+    if (tap)
+    {
+        // Take what the recorder still has in memory, and keep the file
+        // where reading it would go on from
+        ret = tap->Read(internalreadpos, data, sz);
+        if (ret > 0)
+        {
+            lseek64(fd2, internalreadpos + ret, SEEK_SET);
+            return ret;
+        }
+    }
+
     struct stat sb;
 
     while (tot < sz)
@@ -609,12 +646,16 @@ long long FileRingBuffer::GetRealFileSizeInternal(void) const
 
             ret = fstat(fd2, &sb);
             if (ret == 0 && S_ISREG(sb.st_mode))
-            {
-                rwlock.unlock();
-                return sb.st_size;
-            }
+                ret = sb.st_size;
+            else
+                ret = QFileInfo(filename).size();
         }
-        ret = QFileInfo(filename).size();
+        else
+            ret = QFileInfo(filename).size();
+
+        // The recorder may not have written all it has to disk yet
+        if (tap)
+            ret = max(ret, tap->GetWritten());
     }
     rwlock.unlock();
     return ret;
@@ -20,6 +20,7 @@ class MTV_PUBLIC FileRingBuffer : public RingBuffer
     virtual bool OpenFile(const QString &lfilename,
                           uint retry_ms = kDefaultOpenTimeout);
     virtual bool ReOpen(QString newFilename = "");
+    virtual bool AttachRecordingTap(void);
 
   protected:
     FileRingBuffer(const QString &lfilename,
@@ -4,8 +4,13 @@
 #include <sys/stat.h>
 #include <iostream>
 #include <cstdlib>
+#include <cstdio>
 #include <fcntl.h>
 #include <pthread.h>
+#ifdef __linux__
+#include <sys/sysmacros.h>      // for major(), minor()
+#endif
+#include <algorithm>
 using namespace std;
 
 #include <QDateTime>
@@ -13,6 +18,8 @@ using namespace std;
 #include <QRegExp>
 #include <QEvent>
 #include <QCoreApplication>
+#include <QThread>
+#include <QFile>
 
 #include "mythconfig.h"
 
@@ -47,6 +54,11 @@ JobQueue::JobQueue(bool master) :
     m_hostname(gCoreContext->GetHostName()),
     jobsRunning(0),
     jobQueueCPU(0),
+    m_cpuLoad(0),
+    m_ioLoad(0),
+    m_activeRecordings(0),
+    m_cpuLastBusy(0),
+    m_cpuLastTotal(0),
     m_pginfo(NULL),
     runningJobsLock(new QMutex(QMutex::Recursive)),
     isMaster(master),
@@ -176,6 +188,8 @@ void JobQueue::ProcessQueue(void)
     int sleepTime;
 
     QMap<int, int> jobStatus;
+    QMap<int, int> jobsRunningByType;
+    QList<int> jobOrder;
     int maxJobs;
     QString message;
     QMap<int, JobQueueEntry> jobs;
@@ -208,6 +222,7 @@ void JobQueue::ProcessQueue(void)
         runningJobsLock->unlock();
 
         jobsRunning = 0;
+        jobsRunningByType.clear();
         GetJobsInQueue(jobs);
 
         if (jobs.size())
@@ -222,7 +237,39 @@ void JobQueue::ProcessQueue(void)
                      (status == JOB_STARTING) ||
                      (status == JOB_PAUSED)) &&
                     (hostname == m_hostname))
-                jobsRunning++;
+                {
+                    jobsRunning++;
+                    // user jobs share one limit
+                    jobsRunningByType[(jobs[x].type & JOB_USERJOB) ?
+                                      (int)JOB_USERJOB : jobs[x].type]++;
+                }
+            }
+
+            UpdateLoadStats();
+
+            // Jobs which are not queued keep their place, so their
+            // commands are handled as before. Queued jobs are looked at
+            // in order of their aged priority.
+            QDateTime now = MythDate::current();
+            QMap<QPair<int, int>, int> queuedByPriority;
+            jobOrder.clear();
+            for (int x = 0; x < jobs.size(); x++)
+            {
+                if (jobs[x].status == JOB_QUEUED)
+                {
+                    queuedByPriority.insert(
+                        qMakePair(-GetJobPriority(jobs[x], now), x), x);
+                }
+                else
+                {
+                    jobOrder.push_back(x);
+                }
+            }
+            QMap<QPair<int, int>, int>::const_iterator pit;
+            for (pit = queuedByPriority.begin();
+                 pit != queuedByPriority.end(); ++pit)
+            {
+                jobOrder.push_back(*pit);
             }
 
             message = QString("Currently Running %1 jobs.")
@@ -251,9 +298,10 @@ void JobQueue::ProcessQueue(void)
             }
 
 
-            for ( int x = 0;
-                 (x < jobs.size()) && (jobsRunning < maxJobs); x++)
+            for (int i = 0;
+                 (i < jobOrder.size()) && (jobsRunning < maxJobs); i++)
             {
+                int x = jobOrder[i];
                 jobID = jobs[x].id;
                 cmds = jobs[x].cmds;
                 //flags = jobs[x].flags;
@@ -435,6 +483,31 @@ void JobQueue::ProcessQueue(void)
                 if (startedJobAlready)
                     continue;
 
+                int typeKey = (jobs[x].type & JOB_USERJOB) ?
+                              (int)JOB_USERJOB : jobs[x].type;
+                int typeLimit = GetJobTypeLimit(jobs[x].type);
+                if ((inTimeWindow) && (typeLimit > 0) &&
+                    (jobsRunningByType[typeKey] >= typeLimit))
+                {
+                    message = QString("Skipping '%1' job for %2, "
+                                      "already running %3 job(s) of this "
+                                      "type.")
+                                      .arg(JobText(jobs[x].type)).arg(logInfo)
+                                      .arg(jobsRunningByType[typeKey]);
+                    LOG(VB_JOBQUEUE, LOG_INFO, LOC + message);
+                    continue;
+                }
+
+                QString reason;
+                if ((inTimeWindow) && (!AdmitJob(jobs[x], reason)))
+                {
+                    message = QString("Deferring '%1' job for %2, %3.")
+                                      .arg(JobText(jobs[x].type)).arg(logInfo)
+                                      .arg(reason);
+                    LOG(VB_JOBQUEUE, LOG_INFO, LOC + message);
+                    continue;
+                }
+
                 if ((inTimeWindow) &&
                     (hostname.isEmpty()) &&
                     (!ChangeJobHost(jobID, m_hostname)))
@@ -622,14 +695,16 @@ bool JobQueue::QueueJobs(int jobTypes, uint chanid, const QDateTime &recstartts,
         if (jobTypes & JOB_TRANSCODE)
             QueueJob(JOB_TRANSCODE, chanid, recstartts, args, comment, host);
         if (jobTypes & JOB_COMMFLAG)
-            QueueJob(JOB_COMMFLAG, chanid, recstartts, args, comment, host);
+            QueueJob(JOB_COMMFLAG, chanid, recstartts, args, comment, host,
+                     GetCommFlagPassFlags());
     }
     else
     {
         if (jobTypes & JOB_METADATA)
             QueueJob(JOB_METADATA, chanid, recstartts, args, comment, host);
         if (jobTypes & JOB_COMMFLAG)
-            QueueJob(JOB_COMMFLAG, chanid, recstartts, args, comment, host);
+            QueueJob(JOB_COMMFLAG, chanid, recstartts, args, comment, host,
+                     GetCommFlagPassFlags());
         if (jobTypes & JOB_TRANSCODE)
         {
             QDateTime schedruntime = MythDate::current();
@@ -658,6 +733,22 @@ bool JobQueue::QueueJobs(int jobTypes, uint chanid, const QDateTime &recstartts,
     return true;
 }
 
+/**
+ *  The post-processing the commercial flagging jobs of new recordings do
+ *  along the way, instead of separate jobs decoding the recording again.
+ */
+int JobQueue::GetCommFlagPassFlags(void)
+{
+    int flags = JOB_NO_FLAGS;
+
+    if (gCoreContext->GetNumSetting("CommFlagSinglePass", 0))
+        flags |= JOB_PREVIEW | JOB_SEEKTABLE;
+    if (gCoreContext->GetNumSetting("CommFlagExtractCaptions", 0))
+        flags |= JOB_CAPTIONS;
+
+    return flags;
+}
+
 int JobQueue::GetJobID(int jobType, uint chanid, const QDateTime &recstartts)
 {
     MSqlQuery query(MSqlQuery::InitCon());
@@ -975,10 +1066,17 @@ bool JobQueue::ChangeJobStatus(int jobID, int newStatus, QString comment)
     LOG(VB_JOBQUEUE, LOG_INFO, LOC + QString("ChangeJobStatus(%1, %2, '%3')")
             .arg(jobID).arg(StatusText(newStatus)).arg(comment));
 
+    // Remember when the job was started, for the wait and run times
+    QString runstart;
+    if (newStatus == JOB_STARTING)
+        runstart = ", runstarttime = NOW()";
+    else if (newStatus == JOB_QUEUED)
+        runstart = ", runstarttime = NULL";
+
     MSqlQuery query(MSqlQuery::InitCon());
 
-    query.prepare("UPDATE jobqueue SET status = :STATUS, comment = :COMMENT "
-                  "WHERE id = :ID AND status <> :NEWSTATUS;");
+    query.prepare("UPDATE jobqueue SET status = :STATUS, comment = :COMMENT" +
+                  runstart + " WHERE id = :ID AND status <> :NEWSTATUS;");
 
     query.bindValue(":STATUS", newStatus);
     query.bindValue(":COMMENT", comment);
@@ -1278,7 +1376,8 @@ int JobQueue::GetJobsInQueue(QMap<int, JobQueueEntry> &jobs, int findJobs)
 
     query.prepare("SELECT j.id, j.chanid, j.starttime, j.inserttime, j.type, "
                       "j.cmds, j.flags, j.status, j.statustime, j.hostname, "
-                      "j.args, j.comment, r.endtime, j.schedruntime "
+                      "j.args, j.comment, r.endtime, j.schedruntime, "
+                      "j.runstarttime "
                   "FROM jobqueue j "
                   "LEFT JOIN recorded r "
                   "  ON j.chanid = r.chanid AND j.starttime = r.starttime "
@@ -1366,6 +1465,11 @@ int JobQueue::GetJobsInQueue(QMap<int, JobQueueEntry> &jobs, int findJobs)
         thisJob.hostname = query.value(9).toString();
         thisJob.args = query.value(10).toString();
         thisJob.comment = query.value(11).toString();
+        if (!query.value(14).isNull())
+            thisJob.runstarttime =
+                MythDate::as_utc(query.value(14).toDateTime());
+        else
+            thisJob.runstarttime = QDateTime();
 
         if ((thisJob.type & JOB_USERJOB) &&
             (UserJobTypeToIndex(thisJob.type) == 0))
@@ -1451,6 +1555,236 @@ bool JobQueue::AllowedToRun(JobQueueEntry job)
     return false;
 }
 
+/** \brief Returns the aged priority of a queued job.
+ *
+ *  Short metadata lookups come before commercial flagging, which comes
+ *  before transcodes and user jobs. Every "JobQueuePriorityAging" minutes
+ *  a job has waited adds one to its priority, so a transcode queued for
+ *  a few hours will not be starved by a stream of new commflag jobs.
+ */
+int JobQueue::GetJobPriority(const JobQueueEntry &job, const QDateTime &now)
+{
+    int priority;
+
+    switch (job.type)
+    {
+        case JOB_METADATA:  priority = 30; break;
+        case JOB_COMMFLAG:  priority = 20; break;
+        case JOB_TRANSCODE: priority = 10; break;
+        default:            priority = 10; break;
+    }
+
+    QDateTime queued = max(job.inserttime, job.schedruntime);
+    int aging = gCoreContext->GetNumSetting("JobQueuePriorityAging", 6);
+    if (aging > 0 && queued.isValid() && queued < now)
+        priority += queued.secsTo(now) / (aging * 60);
+
+    return priority;
+}
+
+/// Maximum number of jobs of a type running on this host, 0 for no limit
+int JobQueue::GetJobTypeLimit(int jobType)
+{
+    if (jobType & JOB_USERJOB)
+        return gCoreContext->GetNumSetting("JobQueueMaxUserJobs", 0);
+
+    switch (jobType)
+    {
+        case JOB_TRANSCODE:
+            return gCoreContext->GetNumSetting("JobQueueMaxTranscodeJobs", 0);
+        case JOB_COMMFLAG:
+            return gCoreContext->GetNumSetting("JobQueueMaxCommFlagJobs", 0);
+        default:
+            return 0;
+    }
+}
+
+/// Jobs which compete with the recorders for CPU and disk bandwidth
+bool JobQueue::IsHeavyJob(int jobType)
+{
+    return (jobType != JOB_METADATA);
+}
+
+/** \brief Measures the CPU load, the load of the storage group devices and
+ *         the number of active recordings on this host.
+ *
+ *  The loads are averaged over the time since the previous call, so the
+ *  first call after startup only records the counters.
+ */
+void JobQueue::UpdateLoadStats(void)
+{
+    int elapsed = m_loadTimer.isRunning() ? m_loadTimer.restart() : 0;
+    if (!m_loadTimer.isRunning())
+        m_loadTimer.start();
+
+#ifdef __linux__
+    QFile cpustat("/proc/stat");
+    if (cpustat.open(QIODevice::ReadOnly))
+    {
+        QByteArray line = cpustat.readLine(256);
+        qulonglong user = 0, nice = 0, system = 0, idle = 0, iowait = 0;
+        qulonglong irq = 0, softirq = 0;
+        if (sscanf(line.constData(), "cpu %llu %llu %llu %llu %llu %llu %llu",
+                   &user, &nice, &system, &idle, &iowait, &irq, &softirq) >= 4)
+        {
+            qulonglong busy  = user + nice + system + irq + softirq;
+            qulonglong total = busy + idle + iowait;
+            if (total > m_cpuLastTotal && m_cpuLastTotal)
+            {
+                m_cpuLoad = (busy - m_cpuLastBusy) * 100 /
+                            (total - m_cpuLastTotal);
+            }
+            m_cpuLastBusy  = busy;
+            m_cpuLastTotal = total;
+        }
+    }
+
+    // Find the block devices holding this host's storage groups and use
+    // the time they spent doing I/O as their load.
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT DISTINCT dirname FROM storagegroup "
+                  "WHERE hostname = :HOSTNAME");
+    query.bindValue(":HOSTNAME", m_hostname);
+
+    QMap<QString, qulonglong> ioticks;
+    if (query.exec())
+    {
+        while (query.next())
+        {
+            struct stat st;
+            QByteArray dir = query.value(0).toString().toLocal8Bit();
+            if (stat(dir.constData(), &st) < 0)
+                continue;
+
+            QString path = QString("/sys/dev/block/%1:%2/stat")
+                .arg(major(st.st_dev)).arg(minor(st.st_dev));
+            if (ioticks.contains(path))
+                continue;
+
+            QFile devstat(path);
+            if (!devstat.open(QIODevice::ReadOnly))
+                continue;
+
+            // the tenth field is the number of milliseconds spent doing I/O
+            QStringList fields = QString(devstat.readLine(256))
+                .split(' ', QString::SkipEmptyParts);
+            if (fields.size() >= 10)
+                ioticks[path] = fields[9].toULongLong();
+        }
+    }
+    else
+    {
+        MythDB::DBError("JobQueue::UpdateLoadStats()", query);
+    }
+
+    m_ioLoad = 0;
+    QMap<QString, qulonglong>::const_iterator it = ioticks.begin();
+    for (; it != ioticks.end(); ++it)
+    {
+        if (elapsed > 0 && m_ioLastTicks.contains(it.key()) &&
+            *it >= m_ioLastTicks[it.key()])
+        {
+            uint load = (*it - m_ioLastTicks[it.key()]) * 100 / elapsed;
+            m_ioLoad = max(m_ioLoad, min(load, 100U));
+        }
+    }
+    m_ioLastTicks = ioticks;
+#else
+    (void) elapsed;
+    double loadavg;
+    if (getloadavg(&loadavg, 1) == 1)
+        m_cpuLoad = (uint)(loadavg * 100 / max(QThread::idealThreadCount(), 1));
+#endif
+
+    MSqlQuery recquery(MSqlQuery::InitCon());
+    recquery.prepare("SELECT COUNT(DISTINCT chanid, starttime) "
+                     "FROM inuseprograms "
+                     "WHERE recusage = :RECORDER AND hostname = :HOSTNAME "
+                     "AND lastupdatetime > :ONEHOURAGO");
+    recquery.bindValue(":RECORDER", kRecorderInUseID);
+    recquery.bindValue(":HOSTNAME", m_hostname);
+    recquery.bindValue(":ONEHOURAGO", MythDate::current().addSecs(-60 * 60));
+
+    if (recquery.exec() && recquery.next())
+        m_activeRecordings = recquery.value(0).toUInt();
+    else
+        MythDB::DBError("JobQueue::UpdateLoadStats()", recquery);
+
+    LOG(VB_JOBQUEUE, LOG_DEBUG, LOC +
+        QString("Load: CPU %1%, storage I/O %2%, %3 active recording(s)")
+            .arg(m_cpuLoad).arg(m_ioLoad).arg(m_activeRecordings));
+}
+
+/** \brief Decides whether a job may start with the current load.
+ *
+ *  Metadata lookups are always admitted. Other jobs are deferred while
+ *  "JobQueueMaxActiveRecordings" or more recordings are in progress, and,
+ *  unless no job is running on this host yet, while the CPU or storage
+ *  load is above "JobQueueMaxCPULoad" or "JobQueueMaxIOLoad" percent.
+ */
+bool JobQueue::AdmitJob(const JobQueueEntry &job, QString &reason) const
+{
+    if (!IsHeavyJob(job.type))
+        return true;
+
+    uint maxRecordings =
+        gCoreContext->GetNumSetting("JobQueueMaxActiveRecordings", 0);
+    if (maxRecordings && m_activeRecordings >= maxRecordings)
+    {
+        reason = QString("%1 recording(s) in progress")
+            .arg(m_activeRecordings);
+        return false;
+    }
+
+    // Always let one job make progress
+    if (!jobsRunning)
+        return true;
+
+    uint maxCPU = gCoreContext->GetNumSetting("JobQueueMaxCPULoad", 90);
+    if (maxCPU && m_cpuLoad > maxCPU)
+    {
+        reason = QString("CPU load is %1%").arg(m_cpuLoad);
+        return false;
+    }
+
+    uint maxIO = gCoreContext->GetNumSetting("JobQueueMaxIOLoad", 80);
+    if (maxIO && m_ioLoad > maxIO)
+    {
+        reason = QString("storage I/O load is %1%").arg(m_ioLoad);
+        return false;
+    }
+
+    return true;
+}
+
+/// Seconds the job waited, or has been waiting, to be started
+int JobQueue::GetJobWaitTime(const JobQueueEntry &job)
+{
+    QDateTime queued = max(job.inserttime, job.schedruntime);
+    QDateTime started = job.runstarttime;
+
+    if (!started.isValid())
+    {
+        if (job.status & JOB_DONE)
+            return 0;
+        started = MythDate::current();
+    }
+
+    return max(queued.secsTo(started), 0);
+}
+
+/// Seconds the job has been running, or ran for if it is done
+int JobQueue::GetJobRunTime(const JobQueueEntry &job)
+{
+    if (!job.runstarttime.isValid())
+        return 0;
+
+    QDateTime end = (job.status & JOB_DONE) ?
+        job.statustime : MythDate::current();
+
+    return max(job.runstarttime.secsTo(end), 0);
+}
+
 enum JobCmds JobQueue::GetJobCmd(int jobID)
 {
     MSqlQuery query(MSqlQuery::InitCon());
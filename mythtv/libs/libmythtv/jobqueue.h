@@ -12,6 +12,7 @@
 #include <QMap>
 
 #include "mythtvexp.h"
+#include "mythtimer.h"
 
 class MThread;
 class ProgramInfo;
@@ -59,7 +60,11 @@ enum JobFlags {
     JOB_USE_CUTLIST  = 0x0001,
     JOB_LIVE_REC     = 0x0002,
     JOB_EXTERNAL     = 0x0004,
-    JOB_REBUILD      = 0x0008
+    JOB_REBUILD      = 0x0008,
+    // Done by a commercial flagging job while it decodes the recording
+    JOB_PREVIEW      = 0x0010,
+    JOB_SEEKTABLE    = 0x0020,
+    JOB_CAPTIONS     = 0x0040
 };
 
 enum JobLists {
@@ -97,6 +102,7 @@ typedef struct jobqueueentry {
     int flags;
     int status;
     QDateTime statustime;
+    QDateTime runstarttime;
     QString hostname;
     QString args;
     QString comment;
@@ -171,6 +177,7 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
 
     static enum JobCmds GetJobCmd(int jobID);
     static enum JobFlags GetJobFlags(int jobID);
+    static int GetCommFlagPassFlags(void);
     static enum JobStatus GetJobStatus(int jobID);
     static enum JobStatus GetJobStatus(int jobType, uint chanid,
                                        const QDateTime &recstartts);
@@ -193,6 +200,8 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
 
     static int GetJobsInQueue(QMap<int, JobQueueEntry> &jobs,
                               int findJobs = JOB_LIST_NOT_DONE);
+    static int GetJobWaitTime(const JobQueueEntry &job);
+    static int GetJobRunTime(const JobQueueEntry &job);
 
     static void RecoverQueue(bool justOld = false);
     static void RecoverOldJobsInQueue()
@@ -213,6 +222,12 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
 
     bool AllowedToRun(JobQueueEntry job);
 
+    static int GetJobPriority(const JobQueueEntry &job, const QDateTime &now);
+    static int GetJobTypeLimit(int jobType);
+    static bool IsHeavyJob(int jobType);
+    void UpdateLoadStats(void);
+    bool AdmitJob(const JobQueueEntry &job, QString &reason) const;
+
     static bool InJobRunWindow(int orStartingWithinMins = 0);
 
     void StartChildJob(void *(*start_routine)(void *), int jobID);
@@ -240,6 +255,15 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
     int jobsRunning;
     int jobQueueCPU;
 
+    // Load measured by UpdateLoadStats(), used for job admission
+    uint       m_cpuLoad;           // percent, all CPUs
+    uint       m_ioLoad;            // percent, busiest storage device
+    uint       m_activeRecordings;  // recordings in progress on this host
+    qulonglong m_cpuLastBusy;
+    qulonglong m_cpuLastTotal;
+    QMap<QString, qulonglong> m_ioLastTicks;
+    MythTimer  m_loadTimer;
+
     ProgramInfo *m_pginfo;
 
     QMutex controlFlagsLock;
@@ -139,7 +139,7 @@ HEADERS += mythsystemevent.h
 HEADERS += avfringbuffer.h
 HEADERS += ringbuffer.h             fileringbuffer.h
 HEADERS += streamingringbuffer.h    metadataimagehelper.h
-HEADERS += icringbuffer.h
+HEADERS += icringbuffer.h           recordingtap.h
 HEADERS += mythavutil.h
 HEADERS += recordingfile.h
 
@@ -168,7 +168,7 @@ SOURCES += mythsystemevent.cpp
 SOURCES += avfringbuffer.cpp
 SOURCES += ringbuffer.cpp           fileringBuffer.cpp
 SOURCES += streamingringbuffer.cpp  metadataimagehelper.cpp
-SOURCES += icringbuffer.cpp
+SOURCES += icringbuffer.cpp         recordingtap.cpp
 SOURCES += mythframe.cpp            mythavutil.cpp
 SOURCES += recordingfile.cpp
 
@@ -182,9 +182,9 @@ SOURCES += datadirect.cpp
 
 # File/FIFO Writer classes
 HEADERS += filewriterbase.h         avformatwriter.h
-HEADERS += fifowriter.h
+HEADERS += fifowriter.h             transcodeparts.h
 SOURCES += filewriterbase.cpp       avformatwriter.cpp
-SOURCES += fifowriter.cpp
+SOURCES += fifowriter.cpp           transcodeparts.cpp
 
 # Teletext stuff
 HEADERS += teletextdecoder.h        teletextreader.h   vbilut.h
@@ -205,7 +205,9 @@ HEADERS += mpeg/atsc_huffman.h
 HEADERS += mpeg/freesat_huffman.h   mpeg/freesat_tables.h
 HEADERS += mpeg/iso6937tables.h
 HEADERS += mpeg/tsstats.h           mpeg/streamlisteners.h
-HEADERS += mpeg/H264Parser.h
+HEADERS += mpeg/H264Parser.h        mpeg/psipcache.h
+HEADERS += mpeg/HEVCParser.h
+HEADERS += mpeg/bytereader.h
 
 SOURCES += mpeg/tspacket.cpp        mpeg/pespacket.cpp
 SOURCES += mpeg/mpegtables.cpp      mpeg/atsctables.cpp
@@ -220,7 +222,9 @@ SOURCES += mpeg/dishdescriptors.cpp mpeg/premieredescriptors.cpp
 SOURCES += mpeg/atsc_huffman.cpp
 SOURCES += mpeg/freesat_huffman.cpp
 SOURCES += mpeg/iso6937tables.cpp
-SOURCES += mpeg/H264Parser.cpp
+SOURCES += mpeg/H264Parser.cpp      mpeg/psipcache.cpp
+SOURCES += mpeg/HEVCParser.cpp
+SOURCES += mpeg/bytereader.cpp
 
 # Channels, and the multiplexes that transmit them
 HEADERS += frequencies.h            frequencytables.h
@@ -331,10 +335,10 @@ using_frontend {
     SOURCES += textsubtitleparser.cpp   xine_demux_sputext.cpp
 
     # A/V decoders
-    HEADERS += decoderbase.h
+    HEADERS += decoderbase.h            posmapcache.h
     HEADERS += nuppeldecoder.h          avformatdecoder.h
     HEADERS += privatedecoder.h
-    SOURCES += decoderbase.cpp
+    SOURCES += decoderbase.cpp          posmapcache.cpp
     SOURCES += nuppeldecoder.cpp        avformatdecoder.cpp
     SOURCES += privatedecoder.cpp
 
@@ -566,9 +570,11 @@ using_backend {
     HEADERS += recorders/recorderbase.h
     HEADERS += recorders/DeviceReadBuffer.h
     HEADERS += recorders/dtvrecorder.h
+    HEADERS += recorders/positionmapwriter.h
     SOURCES += recorders/recorderbase.cpp
     SOURCES += recorders/DeviceReadBuffer.cpp
     SOURCES += recorders/dtvrecorder.cpp
+    SOURCES += recorders/positionmapwriter.cpp
 
     # Import recorder
     HEADERS += recorders/importrecorder.h
@@ -678,12 +684,14 @@ using_backend {
     HEADERS += recorders/HLS/HLSPlaylistWorker.h
     HEADERS += recorders/HLS/HLSReader.h
     HEADERS += recorders/HLS/HLSSegment.h
+    HEADERS += recorders/HLS/HLSSegmentFetch.h
     HEADERS += recorders/HLS/HLSStream.h
     HEADERS += recorders/HLS/HLSStreamWorker.h
 
     SOURCES += recorders/HLS/HLSPlaylistWorker.cpp
     SOURCES += recorders/HLS/HLSReader.cpp
     SOURCES += recorders/HLS/HLSSegment.cpp
+    SOURCES += recorders/HLS/HLSSegmentFetch.cpp
     SOURCES += recorders/HLS/HLSStream.cpp
     SOURCES += recorders/HLS/HLSStreamWorker.cpp
 
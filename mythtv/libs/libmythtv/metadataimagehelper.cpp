@@ -1,6 +1,9 @@
 
 #include "metadataimagehelper.h"
 
+#include <QStringList>
+#include <QHash>
+#include <QSet>
 #include <QUrl>
 
 #include "mythdirs.h"
@@ -18,6 +21,41 @@ namespace {
         return gCoreContext->GenMythURL(host, port, path,
                                         StorageGroup::GetGroupToUse(host, storage_group));
     }
+
+    ArtworkMap artwork_map(const QString &host, const QString &coverart,
+                           const QString &fanart, const QString &banner)
+    {
+        ArtworkMap map;
+
+        if (!coverart.isEmpty())
+        {
+            ArtworkInfo coverartinfo;
+            coverartinfo.url = generate_myth_url("Coverart", host, coverart);
+            map.insert(kArtworkCoverart, coverartinfo);
+        }
+
+        if (!fanart.isEmpty())
+        {
+            ArtworkInfo fanartinfo;
+            fanartinfo.url = generate_myth_url("Fanart", host, fanart);
+            map.insert(kArtworkFanart, fanartinfo);
+        }
+
+        if (!banner.isEmpty())
+        {
+            ArtworkInfo bannerinfo;
+            bannerinfo.url = generate_myth_url("Banners", host, banner);
+            map.insert(kArtworkBanner, bannerinfo);
+        }
+
+        return map;
+    }
+
+    struct ArtworkRow
+    {
+        uint    season;
+        QString host, coverart, fanart, banner;
+    };
 }
 
 ArtworkMap GetArtwork(QString inetref,
@@ -60,34 +98,99 @@ ArtworkMap GetArtwork(QString inetref,
 
     if (query.next())
     {
-        QString host = query.value(0).toString();
-        QString coverart = query.value(1).toString();
-        QString fanart = query.value(2).toString();
-        QString banner = query.value(3).toString();
+        map = artwork_map(query.value(0).toString(), query.value(1).toString(),
+                          query.value(2).toString(), query.value(3).toString());
+    }
 
-        if (!coverart.isEmpty())
+    return map;
+}
+
+/** \brief Artwork of a list of programs, with one query per few hundred
+ *         inetrefs instead of one per program.
+ *
+ *  The season of each key is chosen like GetArtwork() does when not
+ *  strict, the artwork of that season if there is some and of the latest
+ *  season otherwise. Keys without any artwork are left out of the result.
+ */
+QMap<ArtworkKey, ArtworkMap> GetArtworkList(const QList<ArtworkKey> &keys)
+{
+    QMap<ArtworkKey, ArtworkMap> result;
+
+    QSet<QString> unique;
+    QList<ArtworkKey>::const_iterator kit = keys.begin();
+    for (; kit != keys.end(); ++kit)
+    {
+        if (!kit->first.isEmpty())
+            unique.insert(kit->first);
+    }
+    QStringList inetrefs = unique.toList();
+
+    // Rows of each inetref, latest season first
+    QHash<QString, QList<ArtworkRow> > rows;
+    const int kBatch = 500;
+
+    for (int start = 0; start < inetrefs.size(); start += kBatch)
+    {
+        QStringList batch = inetrefs.mid(start, kBatch);
+        QStringList placeholders;
+        for (int i = 0; i < batch.size(); ++i)
+            placeholders << QString(":INETREF%1").arg(i);
+
+        MSqlQuery query(MSqlQuery::InitCon());
+        query.prepare(QString("SELECT inetref, season, host, coverart, "
+                              "fanart, banner FROM recordedartwork "
+                              "WHERE inetref IN (%1) "
+                              "ORDER BY season DESC;")
+                      .arg(placeholders.join(", ")));
+        for (int i = 0; i < batch.size(); ++i)
+            query.bindValue(placeholders[i], batch[i]);
+
+        if (!query.exec())
         {
-            ArtworkInfo coverartinfo;
-            coverartinfo.url = generate_myth_url("Coverart", host, coverart);
-            map.insert(kArtworkCoverart, coverartinfo);
+            MythDB::DBError("GetArtworkList SELECT", query);
+            return result;
         }
 
-        if (!fanart.isEmpty())
+        while (query.next())
         {
-            ArtworkInfo fanartinfo;
-            fanartinfo.url = generate_myth_url("Fanart", host, fanart);
-            map.insert(kArtworkFanart, fanartinfo);
+            ArtworkRow row;
+            row.season   = query.value(1).toUInt();
+            row.host     = query.value(2).toString();
+            row.coverart = query.value(3).toString();
+            row.fanart   = query.value(4).toString();
+            row.banner   = query.value(5).toString();
+            rows[query.value(0).toString()].push_back(row);
         }
+    }
 
-        if (!banner.isEmpty())
+    for (kit = keys.begin(); kit != keys.end(); ++kit)
+    {
+        if (result.contains(*kit))
+            continue;
+
+        QHash<QString, QList<ArtworkRow> >::const_iterator rit =
+            rows.constFind(kit->first);
+        if (rit == rows.constEnd() || rit->empty())
+            continue;
+
+        const ArtworkRow *best = &rit->front();
+        QList<ArtworkRow>::const_iterator it = rit->begin();
+        for (; kit->second > 0 && it != rit->end(); ++it)
         {
-            ArtworkInfo bannerinfo;
-            bannerinfo.url = generate_myth_url("Banners", host, banner);
-            map.insert(kArtworkBanner, bannerinfo);
+            if (it->season == kit->second)
+            {
+                best = &(*it);
+                break;
+            }
         }
+
+        ArtworkMap map = artwork_map(best->host, best->coverart,
+                                     best->fanart, best->banner);
+        if (!map.isEmpty())
+            result.insert(*kit, map);
     }
 
-    return map;
+    return result;
 }
 
 bool SetArtwork(const QString &inetref,
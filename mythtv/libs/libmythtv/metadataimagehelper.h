@@ -3,6 +3,9 @@
 
 #include <QObject>
 #include <QMultiMap>
+#include <QPair>
+#include <QList>
+#include <QMap>
 #include <QMetaType>
 
 #include "mythtvexp.h"
@@ -34,6 +37,11 @@ typedef QMultiMap< VideoArtworkType, ArtworkInfo > ArtworkMap;
 MTV_PUBLIC ArtworkMap GetArtwork(QString inetref,
                                        uint season,
                                        bool strict = false);
+/// An inetref and a season
+typedef QPair< QString, uint > ArtworkKey;
+
+MTV_PUBLIC QMap<ArtworkKey, ArtworkMap> GetArtworkList(
+                                   const QList<ArtworkKey> &keys);
 MTV_PUBLIC bool SetArtwork(const QString &inetref,
                                    uint season,
                                    const QString &host,
@@ -0,0 +1,812 @@
+// MythTV headers
+#include "HEVCParser.h"
+#include "bytereader.h"
+#include "mythlogging.h"
+#include "recorders/dtvrecorder.h" // for FrameRate
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavcodec/golomb.h"
+}
+
+#include <cmath>
+#include <cstring>
+
+static const float eps = 1E-5;
+
+/*
+  The comments quoting the syntax below are from ITU-T Rec. H.265
+  as found here:  http://www.itu.int/rec/T-REC-H.265
+ */
+
+/*
+  Useful definitions:
+
+  * access unit: A set of NAL units that are associated with each
+  other according to a specified classification rule, are consecutive
+  in decoding order, and contain exactly one coded picture with
+  nuh_layer_id equal to 0.
+
+  * intra random access point (IRAP) picture: A coded picture for
+  which each VCL NAL unit has nal_unit_type in the range of BLA_W_LP
+  to RSV_IRAP_VCL23, inclusive. An IRAP picture contains only I slices,
+  and may be a BLA picture, a CRA picture or an IDR picture. The first
+  picture in the bitstream in decoding order must be an IRAP picture.
+
+  * NAL unit header: Unlike H.264 it is two bytes long,
+
+      forbidden_zero_bit     f(1)
+      nal_unit_type          u(6)
+      nuh_layer_id           u(6)
+      nuh_temporal_id_plus1  u(3)
+
+  so the first byte of the RBSP buffer below is still part of it.
+*/
+
+HEVCParser::HEVCParser(void)
+{
+    rbsp_buffer_size = 188 * 2;
+    rbsp_buffer = new uint8_t[rbsp_buffer_size];
+    if (rbsp_buffer == 0)
+        rbsp_buffer_size = 0;
+
+    Reset();
+}
+
+void HEVCParser::Reset(void)
+{
+    state_changed = false;
+    seen_sps = false;
+
+    sync_accumulator = 0xffffffff;
+    AU_pending = false;
+
+    nal_unit_type = UNKNOWN;
+    nuh_layer_id_msb = 0;
+
+    chroma_format_idc = 1;
+    separate_colour_plane_flag = 0;
+    pic_width = pic_height = 0;
+    conf_win_left_offset = conf_win_right_offset = 0;
+    conf_win_top_offset = conf_win_bottom_offset = 0;
+    aspect_ratio_idc = 0;
+    sar_width = sar_height = 0;
+    unitsInTick = timeScale = 0;
+    vpsUnitsInTick = vpsTimeScale = 0;
+
+    pkt_offset = AU_offset = frame_start_offset = keyframe_start_offset = 0;
+    on_frame = on_key_frame = false;
+
+    resetRBSP();
+}
+
+QString HEVCParser::NAL_type_str(uint8_t type)
+{
+    switch (type)
+    {
+      case TRAIL_N:
+        return "TRAIL_N";
+      case TRAIL_R:
+        return "TRAIL_R";
+      case TSA_N:
+        return "TSA_N";
+      case TSA_R:
+        return "TSA_R";
+      case STSA_N:
+        return "STSA_N";
+      case STSA_R:
+        return "STSA_R";
+      case RADL_N:
+        return "RADL_N";
+      case RADL_R:
+        return "RADL_R";
+      case RASL_N:
+        return "RASL_N";
+      case RASL_R:
+        return "RASL_R";
+      case BLA_W_LP:
+        return "BLA_W_LP";
+      case BLA_W_RADL:
+        return "BLA_W_RADL";
+      case BLA_N_LP:
+        return "BLA_N_LP";
+      case IDR_W_RADL:
+        return "IDR_W_RADL";
+      case IDR_N_LP:
+        return "IDR_N_LP";
+      case CRA_NUT:
+        return "CRA_NUT";
+      case VPS_NUT:
+        return "VPS_NUT";
+      case SPS_NUT:
+        return "SPS_NUT";
+      case PPS_NUT:
+        return "PPS_NUT";
+      case AUD_NUT:
+        return "AUD_NUT";
+      case EOS_NUT:
+        return "EOS_NUT";
+      case EOB_NUT:
+        return "EOB_NUT";
+      case FD_NUT:
+        return "FD_NUT";
+      case PREFIX_SEI_NUT:
+        return "PREFIX_SEI_NUT";
+      case SUFFIX_SEI_NUT:
+        return "SUFFIX_SEI_NUT";
+    }
+    return "OTHER";
+}
+
+void HEVCParser::resetRBSP(void)
+{
+    rbsp_index = 0;
+    consecutive_zeros = 0;
+    have_unfinished_NAL = false;
+}
+
+bool HEVCParser::fillRBSP(const uint8_t *byteP, uint32_t byte_count,
+                          bool found_start_code)
+{
+    /*
+      bitstream buffer, must be FF_INPUT_BUFFER_PADDING_SIZE
+      bytes larger then the actual data
+    */
+    uint32_t required_size = rbsp_index + byte_count +
+                             FF_INPUT_BUFFER_PADDING_SIZE;
+    if (rbsp_buffer_size < required_size)
+    {
+        // Round up to packet size
+        required_size = ((required_size / 188) + 1) * 188;
+
+        /* Need a bigger buffer */
+        uint8_t *new_buffer = new uint8_t[required_size];
+
+        if (new_buffer == NULL)
+        {
+            /* Allocation failed. Discard the new bytes */
+            LOG(VB_GENERAL, LOG_ERR,
+                "HEVCParser::fillRBSP: FAILED to allocate RBSP buffer!");
+            return false;
+        }
+
+        /* Copy across bytes from old buffer */
+        memcpy(new_buffer, rbsp_buffer, rbsp_index);
+        delete [] rbsp_buffer;
+        rbsp_buffer = new_buffer;
+        rbsp_buffer_size = required_size;
+    }
+
+    /* Fill rbsp while we have data */
+    while (byte_count)
+    {
+        /* Copy the byte into the rbsp, unless it
+         * is the 0x03 in a 0x000003 */
+        if (consecutive_zeros < 2 || *byteP != 0x03)
+            rbsp_buffer[rbsp_index++] = *byteP;
+
+        if (*byteP == 0)
+            ++consecutive_zeros;
+        else
+            consecutive_zeros = 0;
+
+        ++byteP;
+        --byte_count;
+    }
+
+    /* If we've found the next start code then that, plus the first byte of
+     * the next NAL, plus the preceding zero bytes will all be in the rbsp
+     * buffer. Move rbsp_index back to the end of the actual rbsp data.
+     */
+    if (found_start_code)
+    {
+        if (rbsp_index >= 4)
+        {
+            rbsp_index -= 4;
+            while (rbsp_index > 0 && rbsp_buffer[rbsp_index-1] == 0)
+                --rbsp_index;
+        }
+        else
+        {
+            /* This should never happen. */
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("HEVCParser::fillRBSP: Found start code, rbsp_index "
+                        "is %1 but it should be >4")
+                    .arg(rbsp_index));
+        }
+    }
+
+    /* Stick some 0xff on the end for get_bits to run into */
+    memset(&rbsp_buffer[rbsp_index], 0xff, FF_INPUT_BUFFER_PADDING_SIZE);
+    return true;
+}
+
+uint32_t HEVCParser::addBytes(const uint8_t  *bytes,
+                              const uint32_t  byte_count,
+                              const uint64_t  stream_offset)
+{
+    const uint8_t *startP = bytes;
+    const uint8_t *endP;
+    bool           found_start_code;
+
+    state_changed = false;
+    on_frame      = false;
+    on_key_frame  = false;
+
+    while (startP < bytes + byte_count && !on_frame)
+    {
+        endP = ByteReader::find_start_code(startP,
+                                  bytes + byte_count, &sync_accumulator);
+
+        found_start_code = ((sync_accumulator & 0xffffff00) == 0x00000100);
+
+        /* Between startP and endP we potentially have some more
+         * bytes of a NAL that we've been parsing (plus some bytes of
+         * start code)
+         */
+        if (have_unfinished_NAL)
+        {
+            if (!fillRBSP(startP, endP - startP, found_start_code))
+            {
+                resetRBSP();
+                return endP - bytes;
+            }
+            processRBSP(found_start_code); /* Call may set have_unfinished_NAL
+                                            * to false */
+        }
+
+        /* Dealt with everything up to endP */
+        startP = endP;
+
+        if (found_start_code)
+        {
+            if (have_unfinished_NAL)
+            {
+                /* We've found a new start code, without completely
+                 * parsing the previous NAL. Either there's a
+                 * problem with the stream or with this parser.
+                 */
+                LOG(VB_GENERAL, LOG_ERR,
+                    "HEVCParser::addBytes: Found new start "
+                    "code, but previous NAL is incomplete!");
+            }
+
+            /* Prepare for accepting the new NAL */
+            resetRBSP();
+
+            /* If we find the start of an AU somewhere from here
+             * to the next start code, the offset to associate with
+             * it is the one passed in to this call, not any of the
+             * subsequent calls.
+             */
+            pkt_offset = stream_offset;
+
+            /* forbidden_zero_bit shall be equal to 0 */
+            if (sync_accumulator & 0x80)
+            {
+                LOG(VB_GENERAL, LOG_ERR,
+                    "HEVCParser::addBytes: malformed NAL units");
+                continue;
+            }
+
+            nal_unit_type = (sync_accumulator >> 1) & 0x3f;
+            nuh_layer_id_msb = sync_accumulator & 0x1;
+
+            /* Everything that can start an access unit, or tells about
+             * the pictures, needs at least the rest of the NAL header
+             * to know which layer it belongs to.
+             */
+            if (NALisVCL(nal_unit_type) ||
+                (nal_unit_type >= VPS_NUT && nal_unit_type <= AUD_NUT) ||
+                nal_unit_type == PREFIX_SEI_NUT ||
+                (nal_unit_type >= 41 && nal_unit_type <= 44) ||
+                (nal_unit_type >= UNSPEC48 && nal_unit_type <= 55))
+            {
+                have_unfinished_NAL = true;
+            }
+        } //found start code
+    }
+
+    return startP - bytes;
+}
+
+void HEVCParser::processRBSP(bool rbsp_complete)
+{
+    /* The second byte of the NAL header, with the rest of nuh_layer_id */
+    if (rbsp_index < 1)
+    {
+        if (rbsp_complete)
+            have_unfinished_NAL = false;
+        return;
+    }
+
+    uint nuh_layer_id = (nuh_layer_id_msb << 5) | (rbsp_buffer[0] >> 3);
+    if (nuh_layer_id != 0)
+    {
+        /* Only the base layer makes up the pictures we count */
+        have_unfinished_NAL = false;
+        return;
+    }
+
+    GetBitContext gb;
+
+    if (nal_unit_type == VPS_NUT || nal_unit_type == SPS_NUT)
+    {
+        /* Best wait until we have the whole thing */
+        if (!rbsp_complete)
+            return;
+
+        set_AU_pending();
+
+        init_get_bits(&gb, rbsp_buffer + 1, 8 * (rbsp_index - 1));
+        if (nal_unit_type == VPS_NUT)
+            decode_VPS(&gb);
+        else if (!decode_SPS(&gb))
+            LOG(VB_GENERAL, LOG_ERR, "HEVCParser: malformed SPS");
+    }
+    else if (NALisVCL(nal_unit_type))
+    {
+        /* Need only first_slice_segment_in_pic_flag, the first bit
+         * after the NAL header */
+        if (rbsp_index < 2)
+        {
+            if (rbsp_complete)
+                have_unfinished_NAL = false;
+            return;
+        }
+
+        if (rbsp_buffer[1] & 0x80)
+        {
+            /*
+              The first slice of a coded picture, the first VCL NAL
+              unit of a new access unit. Any AUD, VPS, SPS, PPS or
+              prefix SEI before it already marked where that starts.
+             */
+            set_AU_pending();
+
+            AU_pending = false;
+            state_changed = seen_sps;
+
+            on_frame = true;
+            frame_start_offset = AU_offset;
+
+            if (NALisIRAP(nal_unit_type))
+            {
+                on_key_frame = true;
+                keyframe_start_offset = AU_offset;
+            }
+        }
+    }
+    else
+    {
+        /* AUD, PPS, prefix SEI and the reserved types 41..44 and
+         * 48..55 all start a new access unit when they follow the
+         * slices of a picture */
+        set_AU_pending();
+    }
+
+    /* If we got this far, we managed to parse a sufficient
+     * prefix of the current NAL. We can go onto the next. */
+    have_unfinished_NAL = false;
+}
+
+/*
+  7.3.3 Profile, tier and level syntax
+ */
+bool HEVCParser::profile_tier_level(GetBitContext *gb,
+                                    uint max_sub_layers_minus1)
+{
+    uint8_t sub_layer_profile_present_flag[MAX_SUB_LAYERS];
+    uint8_t sub_layer_level_present_flag[MAX_SUB_LAYERS];
+
+    if (max_sub_layers_minus1 >= MAX_SUB_LAYERS)
+        return false;
+
+    /*
+      general_profile_space u(2), general_tier_flag u(1),
+      general_profile_idc u(5), general_profile_compatibility_flag[32],
+      general_progressive_source_flag, general_interlaced_source_flag,
+      general_non_packed_constraint_flag, general_frame_only_constraint_flag,
+      43 bits of constraint flags and general_inbld_flag or a reserved bit
+     */
+    skip_bits_long(gb, 88);
+    get_bits(gb, 8); // general_level_idc
+
+    for (uint i = 0; i < max_sub_layers_minus1; ++i)
+    {
+        sub_layer_profile_present_flag[i] = get_bits1(gb);
+        sub_layer_level_present_flag[i]   = get_bits1(gb);
+    }
+
+    if (max_sub_layers_minus1 > 0)
+    {
+        for (uint i = max_sub_layers_minus1; i < 8; ++i)
+            get_bits(gb, 2); // reserved_zero_2bits
+    }
+
+    for (uint i = 0; i < max_sub_layers_minus1; ++i)
+    {
+        if (sub_layer_profile_present_flag[i])
+            skip_bits_long(gb, 88); // as for the general profile
+        if (sub_layer_level_present_flag[i])
+            get_bits(gb, 8); // sub_layer_level_idc
+    }
+
+    return true;
+}
+
+/*
+  7.3.2.1 Video parameter set RBSP syntax
+
+  Only needed for its timing information, which applies to the whole
+  stream when the SPS has none.
+ */
+void HEVCParser::decode_VPS(GetBitContext *gb)
+{
+    get_bits(gb, 4);    // vps_video_parameter_set_id
+    get_bits1(gb);      // vps_base_layer_internal_flag
+    get_bits1(gb);      // vps_base_layer_available_flag
+    get_bits(gb, 6);    // vps_max_layers_minus1
+    uint max_sub_layers_minus1 = get_bits(gb, 3);
+    get_bits1(gb);      // vps_temporal_id_nesting_flag
+    get_bits(gb, 16);   // vps_reserved_0xffff_16bits
+
+    if (!profile_tier_level(gb, max_sub_layers_minus1))
+        return;
+
+    bool ordering_info_present = get_bits1(gb);
+    for (uint i = ordering_info_present ? 0 : max_sub_layers_minus1;
+         i <= max_sub_layers_minus1; ++i)
+    {
+        get_ue_golomb(gb); // vps_max_dec_pic_buffering_minus1
+        get_ue_golomb(gb); // vps_max_num_reorder_pics
+        get_ue_golomb(gb); // vps_max_latency_increase_plus1
+    }
+
+    uint max_layer_id = get_bits(gb, 6);
+    uint num_layer_sets_minus1 = get_ue_golomb(gb);
+    if (num_layer_sets_minus1 > 1023)
+        return;
+    for (uint i = 1; i <= num_layer_sets_minus1; ++i)
+        skip_bits_long(gb, max_layer_id + 1); // layer_id_included_flag
+
+    if (get_bits1(gb)) // vps_timing_info_present_flag
+    {
+        vpsUnitsInTick = get_bits_long(gb, 32); // vps_num_units_in_tick
+        vpsTimeScale   = get_bits_long(gb, 32); // vps_time_scale
+    }
+    else
+        vpsUnitsInTick = vpsTimeScale = 0;
+}
+
+/*
+  7.3.7 Short-term reference picture set syntax
+
+  There is nothing in there we want, but it has to be parsed to get
+  to the VUI. \p num_delta_pocs holds NumDeltaPocs of the sets parsed
+  so far, as a set may be predicted from the one before it.
+ */
+bool HEVCParser::st_ref_pic_set(GetBitContext *gb, uint idx, uint num_sets,
+                                uint *num_delta_pocs)
+{
+    bool inter_ref_pic_set_prediction_flag = false;
+    if (idx != 0)
+        inter_ref_pic_set_prediction_flag = get_bits1(gb);
+
+    if (inter_ref_pic_set_prediction_flag)
+    {
+        uint delta_idx_minus1 = 0;
+        if (idx == num_sets) // only in slice headers
+            delta_idx_minus1 = get_ue_golomb(gb);
+        if (delta_idx_minus1 >= idx)
+            return false;
+
+        get_bits1(gb);      // delta_rps_sign
+        get_ue_golomb(gb);  // abs_delta_rps_minus1
+
+        uint ref_idx = idx - (delta_idx_minus1 + 1);
+        uint count = 0;
+        for (uint j = 0; j <= num_delta_pocs[ref_idx]; ++j)
+        {
+            bool used_by_curr_pic_flag = get_bits1(gb);
+            bool use_delta_flag = true;
+            if (!used_by_curr_pic_flag)
+                use_delta_flag = get_bits1(gb);
+            if (use_delta_flag)
+                ++count;
+        }
+        num_delta_pocs[idx] = count;
+    }
+    else
+    {
+        uint num_negative_pics = get_ue_golomb(gb);
+        uint num_positive_pics = get_ue_golomb(gb);
+        if (num_negative_pics + num_positive_pics > MAX_DELTA_POCS)
+            return false;
+
+        for (uint i = 0; i < num_negative_pics + num_positive_pics; ++i)
+        {
+            get_ue_golomb(gb); // delta_poc_s0_minus1 / delta_poc_s1_minus1
+            get_bits1(gb);     // used_by_curr_pic_s0_flag / _s1_flag
+        }
+        num_delta_pocs[idx] = num_negative_pics + num_positive_pics;
+    }
+
+    return num_delta_pocs[idx] <= MAX_DELTA_POCS;
+}
+
+/*
+  7.3.4 Scaling list data syntax
+ */
+void HEVCParser::scaling_list_data(GetBitContext *gb)
+{
+    for (uint sizeId = 0; sizeId < 4; ++sizeId)
+    {
+        for (uint matrixId = 0; matrixId < 6;
+             matrixId += (sizeId == 3) ? 3 : 1)
+        {
+            if (!get_bits1(gb)) // scaling_list_pred_mode_flag
+            {
+                get_ue_golomb(gb); // scaling_list_pred_matrix_id_delta
+                continue;
+            }
+
+            uint coefNum = FFMIN(64, 1 << (4 + (sizeId << 1)));
+            if (sizeId > 1)
+                get_se_golomb(gb); // scaling_list_dc_coef_minus8
+            for (uint i = 0; i < coefNum; ++i)
+                get_se_golomb(gb); // scaling_list_delta_coef
+        }
+    }
+}
+
+/*
+  7.3.2.2 Sequence parameter set RBSP syntax
+ */
+bool HEVCParser::decode_SPS(GetBitContext *gb)
+{
+    get_bits(gb, 4); // sps_video_parameter_set_id
+    uint max_sub_layers_minus1 = get_bits(gb, 3);
+    get_bits1(gb);   // sps_temporal_id_nesting_flag
+
+    if (!profile_tier_level(gb, max_sub_layers_minus1))
+        return false;
+
+    get_ue_golomb(gb); // sps_seq_parameter_set_id
+
+    chroma_format_idc = get_ue_golomb(gb);
+    if (chroma_format_idc > 3)
+        return false;
+    separate_colour_plane_flag = 0;
+    if (chroma_format_idc == 3)
+        separate_colour_plane_flag = get_bits1(gb);
+
+    pic_width  = get_ue_golomb_long(gb); // pic_width_in_luma_samples
+    pic_height = get_ue_golomb_long(gb); // pic_height_in_luma_samples
+
+    conf_win_left_offset = conf_win_right_offset = 0;
+    conf_win_top_offset = conf_win_bottom_offset = 0;
+    if (get_bits1(gb)) // conformance_window_flag
+    {
+        conf_win_left_offset   = get_ue_golomb_long(gb);
+        conf_win_right_offset  = get_ue_golomb_long(gb);
+        conf_win_top_offset    = get_ue_golomb_long(gb);
+        conf_win_bottom_offset = get_ue_golomb_long(gb);
+    }
+
+    get_ue_golomb(gb); // bit_depth_luma_minus8
+    get_ue_golomb(gb); // bit_depth_chroma_minus8
+    uint log2_max_pic_order_cnt_lsb = get_ue_golomb(gb) + 4;
+    if (log2_max_pic_order_cnt_lsb > 16)
+        return false;
+
+    bool ordering_info_present = get_bits1(gb);
+    for (uint i = ordering_info_present ? 0 : max_sub_layers_minus1;
+         i <= max_sub_layers_minus1; ++i)
+    {
+        get_ue_golomb(gb); // sps_max_dec_pic_buffering_minus1
+        get_ue_golomb(gb); // sps_max_num_reorder_pics
+        get_ue_golomb(gb); // sps_max_latency_increase_plus1
+    }
+
+    get_ue_golomb(gb); // log2_min_luma_coding_block_size_minus3
+    get_ue_golomb(gb); // log2_diff_max_min_luma_coding_block_size
+    get_ue_golomb(gb); // log2_min_luma_transform_block_size_minus2
+    get_ue_golomb(gb); // log2_diff_max_min_luma_transform_block_size
+    get_ue_golomb(gb); // max_transform_hierarchy_depth_inter
+    get_ue_golomb(gb); // max_transform_hierarchy_depth_intra
+
+    if (get_bits1(gb)) // scaling_list_enabled_flag
+    {
+        if (get_bits1(gb)) // sps_scaling_list_data_present_flag
+            scaling_list_data(gb);
+    }
+
+    get_bits1(gb); // amp_enabled_flag
+    get_bits1(gb); // sample_adaptive_offset_enabled_flag
+
+    if (get_bits1(gb)) // pcm_enabled_flag
+    {
+        get_bits(gb, 4);   // pcm_sample_bit_depth_luma_minus1
+        get_bits(gb, 4);   // pcm_sample_bit_depth_chroma_minus1
+        get_ue_golomb(gb); // log2_min_pcm_luma_coding_block_size_minus3
+        get_ue_golomb(gb); // log2_diff_max_min_pcm_luma_coding_block_size
+        get_bits1(gb);     // pcm_loop_filter_disabled_flag
+    }
+
+    uint num_short_term_ref_pic_sets = get_ue_golomb(gb);
+    if (num_short_term_ref_pic_sets > MAX_ST_RPS)
+        return false;
+    uint num_delta_pocs[MAX_ST_RPS];
+    for (uint i = 0; i < num_short_term_ref_pic_sets; ++i)
+    {
+        if (!st_ref_pic_set(gb, i, num_short_term_ref_pic_sets,
+                            num_delta_pocs))
+            return false;
+    }
+
+    if (get_bits1(gb)) // long_term_ref_pics_present_flag
+    {
+        uint num_long_term_ref_pics_sps = get_ue_golomb(gb);
+        if (num_long_term_ref_pics_sps > MAX_LT_REF_PICS)
+            return false;
+        for (uint i = 0; i < num_long_term_ref_pics_sps; ++i)
+        {
+            // lt_ref_pic_poc_lsb_sps
+            skip_bits_long(gb, log2_max_pic_order_cnt_lsb);
+            get_bits1(gb); // used_by_curr_pic_lt_sps_flag
+        }
+    }
+
+    get_bits1(gb); // sps_temporal_mvp_enabled_flag
+    get_bits1(gb); // strong_intra_smoothing_enabled_flag
+
+    /* Without timing in the VUI, the one in the VPS applies */
+    unitsInTick = vpsUnitsInTick;
+    timeScale   = vpsTimeScale;
+    aspect_ratio_idc = 0;
+    sar_width = sar_height = 0;
+
+    if (get_bits1(gb)) // vui_parameters_present_flag
+        vui_parameters(gb);
+
+    if (get_bits_left(gb) < 0)
+        return false;
+
+    seen_sps = true;
+    return true;
+}
+
+/*
+  E.2.1 VUI parameters syntax
+
+  The aspect_ratio_idc values are those of H.264, see
+  H264Parser::vui_parameters().
+ */
+void HEVCParser::vui_parameters(GetBitContext *gb)
+{
+    if (get_bits1(gb)) //aspect_ratio_info_present_flag
+    {
+        aspect_ratio_idc = get_bits(gb, 8);
+        if (aspect_ratio_idc == EXTENDED_SAR)
+        {
+            sar_width  = get_bits(gb, 16);
+            sar_height = get_bits(gb, 16);
+        }
+    }
+
+    if (get_bits1(gb)) //overscan_info_present_flag
+        get_bits1(gb); //overscan_appropriate_flag
+
+    if (get_bits1(gb)) //video_signal_type_present_flag
+    {
+        get_bits(gb, 3); //video_format
+        get_bits1(gb);   //video_full_range_flag
+        if (get_bits1(gb)) // colour_description_present_flag
+        {
+            get_bits(gb, 8); // colour_primaries
+            get_bits(gb, 8); // transfer_characteristics
+            get_bits(gb, 8); // matrix_coeffs
+        }
+    }
+
+    if (get_bits1(gb)) //chroma_loc_info_present_flag
+    {
+        get_ue_golomb(gb); //chroma_sample_loc_type_top_field
+        get_ue_golomb(gb); //chroma_sample_loc_type_bottom_field
+    }
+
+    get_bits1(gb); // neutral_chroma_indication_flag
+    get_bits1(gb); // field_seq_flag
+    get_bits1(gb); // frame_field_info_present_flag
+
+    if (get_bits1(gb)) // default_display_window_flag
+    {
+        get_ue_golomb(gb); // def_disp_win_left_offset
+        get_ue_golomb(gb); // def_disp_win_right_offset
+        get_ue_golomb(gb); // def_disp_win_top_offset
+        get_ue_golomb(gb); // def_disp_win_bottom_offset
+    }
+
+    if (get_bits1(gb)) // vui_timing_info_present_flag
+    {
+        unitsInTick = get_bits_long(gb, 32); // vui_num_units_in_tick
+        timeScale   = get_bits_long(gb, 32); // vui_time_scale
+    }
+}
+
+/*
+  Unlike H.264, where a tick is a field, in H.265 time_scale divided
+  by num_units_in_tick is the picture rate.
+ */
+double HEVCParser::frameRate(void) const
+{
+    return unitsInTick ? timeScale / (double)unitsInTick : 0.0;
+}
+
+void HEVCParser::getFrameRate(FrameRate &result) const
+{
+    if (unitsInTick == 0)
+        result = FrameRate(0);
+    else
+        result = FrameRate(timeScale, unitsInTick);
+}
+
+uint HEVCParser::aspectRatio(void) const
+{
+    // Sample aspect ratios of table E-1, for aspect_ratio_idc 1 to 16
+    static const uint sar[17][2] = {
+        {  0,  1 }, {  1,  1 }, { 12, 11 }, { 10, 11 }, { 16, 11 },
+        { 40, 33 }, { 24, 11 }, { 20, 11 }, { 32, 11 }, { 80, 33 },
+        { 18, 11 }, { 15, 11 }, { 64, 33 }, {160, 99 }, {  4,  3 },
+        {  3,  2 }, {  2,  1 },
+    };
+
+    double aspect = 0.0;
+
+    if (pictureHeight())
+        aspect = pictureWidth() / (double)pictureHeight();
+
+    if (aspect_ratio_idc == EXTENDED_SAR)
+    {
+        if (sar_height)
+            aspect *= sar_width / (double)sar_height;
+        else
+            aspect = 0.0;
+    }
+    else if (aspect_ratio_idc > 0 && aspect_ratio_idc <= 16)
+    {
+        aspect *= sar[aspect_ratio_idc][0] /
+                  (double)sar[aspect_ratio_idc][1];
+    }
+
+    if (aspect == 0.0)
+        return 0;
+    if (fabs(aspect - 1.3333333333333333) < eps)
+        return 2;
+    if (fabs(aspect - 1.7777777777777777) < eps)
+        return 3;
+    if (fabs(aspect - 2.21) < eps)
+        return 4;
+
+    return aspect * 1000000;
+}
+
+/*
+  The conformance window offsets are in chroma samples, 7.4.3.2.1
+ */
+uint HEVCParser::pictureWidth(void) const
+{
+    uint ChromaArrayType = separate_colour_plane_flag ? 0 : chroma_format_idc;
+    uint SubWidthC = (ChromaArrayType == 1 || ChromaArrayType == 2) ? 2 : 1;
+    uint crop = SubWidthC * (conf_win_left_offset + conf_win_right_offset);
+    return (crop < pic_width) ? pic_width - crop : pic_width;
+}
+
+uint HEVCParser::pictureHeight(void) const
+{
+    uint ChromaArrayType = separate_colour_plane_flag ? 0 : chroma_format_idc;
+    uint SubHeightC = (ChromaArrayType == 1) ? 2 : 1;
+    uint crop = SubHeightC * (conf_win_top_offset + conf_win_bottom_offset);
+    return (crop < pic_height) ? pic_height - crop : pic_height;
+}
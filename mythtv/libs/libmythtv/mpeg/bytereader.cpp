@@ -0,0 +1,70 @@
+// MythTV headers
+#include "bytereader.h"
+#include "mythconfig.h"
+
+#if HAVE_SSE2 && defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define USE_SSE2_START_CODE 1
+#else
+#define USE_SSE2_START_CODE 0
+#endif
+
+const uint8_t *ByteReader::find_start_code(
+    const uint8_t *p, const uint8_t *end, uint32_t *state, bool simd)
+{
+    if (p >= end)
+        return end;
+
+    // Finish a start code begun in the previous buffer
+    for (int i = 0; i < 3; i++)
+    {
+        uint32_t tmp = *state << 8;
+        *state = tmp + *(p++);
+        if (tmp == 0x100 || p == end)
+            return p;
+    }
+
+#if USE_SSE2_START_CODE
+    const __m128i zero = _mm_setzero_si128();
+#else
+    (void) simd;
+#endif
+
+    // p[-1] is where the 01 of the next start code may be
+    while (p < end)
+    {
+#if USE_SSE2_START_CODE
+        if (simd && p + 13 <= end)
+        {
+            // The 16 bytes from p[-3] on hold the 00 00 of every start
+            // code whose 01 is from p[-1] to p[14]: none without a zero
+            __m128i v = _mm_loadu_si128((const __m128i*)(p - 3));
+            int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+            if (!mask)
+            {
+                p += 16;
+                continue;
+            }
+            // and none before the first zero
+            p += __builtin_ctz(mask);
+            if (p >= end)
+                break;
+        }
+#endif
+        if      (p[-1] > 1)           p += 3;
+        else if (p[-2])               p += 2;
+        else if (p[-3] | (p[-1] - 1)) p++;
+        else
+        {
+            p++;
+            break;
+        }
+    }
+
+    if (p > end)
+        p = end;
+    p -= 4;
+    *state = ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+
+    return p + 4;
+}
@@ -0,0 +1,27 @@
+// -*- Mode: c++ -*-
+#ifndef BYTEREADER_H
+#define BYTEREADER_H
+
+#include <stdint.h>
+
+#include "mythtvexp.h"
+
+namespace ByteReader
+{
+    /** \brief Finds the next MPEG start code (00 00 01 xx).
+     *
+     *  Works like libavcodec's avpriv_find_start_code(), so \p state
+     *  carries the last bytes over to the next call and start codes
+     *  split between two buffers are found. Returns the byte after the
+     *  start code, with \p state set to 0x000001xx, or \p end.
+     *
+     *  Where SSE2 is available the bytes are looked at 16 at a time and
+     *  skipped for as long as none of them is zero, which is most of the
+     *  payload. Pass \p simd false to compare with the plain C scan.
+     */
+    MTV_PUBLIC const uint8_t *find_start_code(
+        const uint8_t *p, const uint8_t *end, uint32_t *state,
+        bool simd = true);
+}
+
+#endif // BYTEREADER_H
@@ -84,7 +84,8 @@ MPEGStreamData::MPEGStreamData(int desiredProgram, int cardnum,
       _pmt_single_program_num_video(1),
       _pmt_single_program_num_audio(0),
       _pat_single_program(NULL), _pmt_single_program(NULL),
-      _invalid_pat_seen(false), _invalid_pat_warning(false)
+      _invalid_pat_seen(false), _invalid_pat_warning(false),
+      _tables_received(false)
 {
     memset(_si_time_offsets, 0, sizeof(_si_time_offsets));
 
@@ -179,6 +180,7 @@ void MPEGStreamData::Reset(int desiredProgram)
     _normalize_stream_type = true;
 
     _invalid_pat_seen = false;
+    _tables_received = false;
 
     SetPATSingleProgram(NULL);
     SetPMTSingleProgram(NULL);
@@ -974,6 +976,8 @@ void MPEGStreamData::HandleTSTables(const TSPacket* tspacket)
         DONE_WITH_PSIP_PACKET();
     }
 
+    _tables_received = true;
+
     // Don't decode redundant packets,
     // but if it is a desired PAT or PMT emit a "heartbeat" signal.
     if (IsRedundant(tspacket->PID(), *psip))
@@ -123,6 +123,9 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     virtual void HandleTSTables(const TSPacket* tspacket);
     virtual bool ProcessTSPacket(const TSPacket& tspacket);
     virtual int  ProcessData(const unsigned char *buffer, int len);
+    /// Whether a valid table was read from the stream since the last
+    /// Reset(), tables passed to HandleTables() directly don't count
+    bool HasReceivedTables(void) const { return _tables_received; }
     inline  void HandleAdaptationFieldControl(const TSPacket* tspacket);
 
     // Listening
@@ -425,6 +428,7 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
   private:
     bool                      _invalid_pat_seen;
     bool                      _invalid_pat_warning;
+    volatile bool             _tables_received;
     MythTimer                 _invalid_pat_timer;
 
   protected:
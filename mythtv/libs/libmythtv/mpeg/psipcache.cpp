@@ -0,0 +1,137 @@
+// -*- Mode: c++ -*-
+
+// MythTV headers
+#include "psipcache.h"
+#include "mpegstreamdata.h"
+#include "dvbstreamdata.h"
+#include "channelutil.h"
+#include "mythlogging.h"
+
+#define LOC QString("PSIPCache: ")
+
+/// Number of multiplexes remembered
+static const int kMaxEntries = 64;
+
+QMutex                           PSIPCache::s_lock;
+QMap<QString, PSIPCache::Entry*> PSIPCache::s_entries;
+QList<QString>                   PSIPCache::s_order;
+
+PSIPCache::Entry::~Entry()
+{
+    while (!tables.empty())
+        delete tables.takeFirst();
+}
+
+/// Returns the key of the multiplex carrying \p channum, or of the channel
+/// itself when it is not on a known multiplex, as with IPTV
+QString PSIPCache::Key(uint sourceid, const QString &channum)
+{
+    uint mplexid = ChannelUtil::GetMplexID(sourceid, channum);
+    if (mplexid)
+        return QString("m%1").arg(mplexid);
+    return QString("c%1_%2").arg(sourceid).arg(channum);
+}
+
+/// Keeps copies of the PAT, the PMT of the desired program and, for DVB,
+/// the SDT of the transport cached by \p sd
+void PSIPCache::Save(const QString &key, const MPEGStreamData *sd)
+{
+    if (!sd || key.isEmpty())
+        return;
+
+    Entry *entry = new Entry();
+
+    pat_vec_t pats = sd->GetCachedPATs();
+    pmt_vec_t pmts = sd->GetCachedPMTs();
+    for (uint i = 0; i < pats.size(); i++)
+    {
+        entry->pids.push_back(MPEG_PAT_PID);
+        entry->tables.push_back(new PSIPTable(*pats[i]));
+
+        for (uint j = 0; j < pmts.size(); j++)
+        {
+            uint pid = pats[i]->FindPID(pmts[j]->ProgramNumber());
+            if (!pid)
+                continue;
+            entry->pids.push_back(pid);
+            entry->tables.push_back(new PSIPTable(*pmts[j]));
+        }
+    }
+    sd->ReturnCachedPMTTables(pmts);
+    sd->ReturnCachedPATTables(pats);
+
+    const DVBStreamData *dsd = dynamic_cast<const DVBStreamData*>(sd);
+    if (dsd)
+    {
+        sdt_vec_t sdts = dsd->GetCachedSDTs();
+        for (uint i = 0; i < sdts.size(); i++)
+        {
+            if (sdts[i]->TSID() != dsd->DesiredTransportID())
+                continue;
+            entry->pids.push_back(DVB_SDT_PID);
+            entry->tables.push_back(new PSIPTable(*sdts[i]));
+        }
+        dsd->ReturnCachedSDTTables(sdts);
+    }
+
+    if (entry->tables.empty())
+    {
+        delete entry;
+        return;
+    }
+
+    QMutexLocker locker(&s_lock);
+
+    delete s_entries.take(key);
+    s_order.removeAll(key);
+
+    s_entries.insert(key, entry);
+    s_order.push_back(key);
+
+    while (s_order.size() > kMaxEntries)
+        delete s_entries.take(s_order.takeFirst());
+
+    LOG(VB_CHANNEL, LOG_DEBUG, LOC + QString("Saved %1 tables for %2")
+        .arg(entry->tables.size()).arg(key));
+}
+
+/// Processes the tables saved for \p key as if \p sd had just received
+/// them, returns the number of tables processed
+uint PSIPCache::Seed(const QString &key, MPEGStreamData *sd)
+{
+    if (!sd)
+        return 0;
+
+    // Copy the tables, the listeners may take some time
+    QList<uint> pids;
+    QList<PSIPTable*> tables;
+    {
+        QMutexLocker locker(&s_lock);
+        Entry *entry = s_entries.value(key);
+        if (!entry)
+            return 0;
+        pids = entry->pids;
+        for (int i = 0; i < entry->tables.size(); i++)
+            tables.push_back(new PSIPTable(*entry->tables[i]));
+    }
+
+    for (int i = 0; i < tables.size(); i++)
+        sd->HandleTables(pids[i], *tables[i]);
+
+    LOG(VB_CHANNEL, LOG_INFO, LOC + QString("Seeded %1 tables for %2")
+        .arg(tables.size()).arg(key));
+
+    uint count = tables.size();
+    while (!tables.empty())
+        delete tables.takeFirst();
+
+    return count;
+}
+
+void PSIPCache::Clear(void)
+{
+    QMutexLocker locker(&s_lock);
+    qDeleteAll(s_entries);
+    s_entries.clear();
+    s_order.clear();
+}
@@ -0,0 +1,51 @@
+// -*- Mode: c++ -*-
+#ifndef _PSIP_CACHE_H_
+#define _PSIP_CACHE_H_
+
+#include <QString>
+#include <QMutex>
+#include <QList>
+#include <QMap>
+
+class MPEGStreamData;
+class PSIPTable;
+
+/** \class PSIPCache
+ *  \brief Tables of the multiplexes tuned recently, kept across tunings.
+ *
+ *  A new tuning starts from an empty MPEGStreamData, and used to wait for
+ *  the PAT, the PMT and, for DVB, the SDT to be broadcast again before the
+ *  signal monitor and the recorder could go on. Save() keeps copies of the
+ *  tables seen once a tuning completes, Seed() feeds them to the stream
+ *  data of the next tuning of the same multiplex, so that only the tables
+ *  that changed since have to be waited for. A newer version of a table
+ *  replaces the seeded one as usual when it is received. As the seeded
+ *  tables say nothing about the stream, TVRec still waits for one table
+ *  read from the tuner before it counts the signal as good.
+ */
+class PSIPCache
+{
+  public:
+    static QString Key(uint sourceid, const QString &channum);
+
+    static void Save(const QString &key, const MPEGStreamData *sd);
+    static uint Seed(const QString &key, MPEGStreamData *sd);
+    static void Clear(void);
+
+  private:
+    class Entry
+    {
+      public:
+        Entry() {}
+        ~Entry();
+        QList<uint>       pids;
+        QList<PSIPTable*> tables;
+    };
+
+    static QMutex                 s_lock;
+    static QMap<QString, Entry*>  s_entries;
+    /// Keys from the least to the most recently saved
+    static QList<QString>         s_order;
+};
+
+#endif // _PSIP_CACHE_H_
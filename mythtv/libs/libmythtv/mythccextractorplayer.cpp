@@ -51,9 +51,11 @@ DVBSubStuff::~DVBSubStuff() { delete reader; }
 
 MythCCExtractorPlayer::MythCCExtractorPlayer(
     PlayerFlags flags, bool showProgress, const QString &fileName) :
-    MythPlayer(flags),
+    MythCommFlagPlayer(flags),
     m_curTime(0),
     m_myFramesPlayed(0),
+    m_capturedTo(-1),
+    m_capturing(true),
     m_showProgress(showProgress),
     m_fileName(fileName)
 {
@@ -83,12 +85,95 @@ void MythCCExtractorPlayer::OnGotNewFrame(void)
         videoOutput->DoneDisplayingFrame(frame);
     }
 
+    IngestCaptions();
+}
+
+void MythCCExtractorPlayer::IngestCaptions(void)
+{
+    QMutexLocker locker(&m_readersLock);
+
     Ingest608Captions();  Process608Captions(kProcessNormal);
     Ingest708Captions();  Process708Captions(kProcessNormal);
     IngestTeletext();     ProcessTeletext(kProcessNormal);
     IngestDVBSubtitles(); ProcessDVBSubtitles(kProcessNormal);
 }
 
+/**
+ *  Drops what the readers got from frames whose captions are not taken,
+ *  so that it does not end up with the next frame taken.
+ */
+void MythCCExtractorPlayer::ClearCaptionReaders(void)
+{
+    QMutexLocker locker(&m_readersLock);
+
+    CC608Info::iterator it608 = m_cc608_info.begin();
+    for (; it608 != m_cc608_info.end(); ++it608)
+        (*it608).reader->ClearBuffers(true, true);
+
+    CC708Info::iterator it708 = m_cc708_info.begin();
+    for (; it708 != m_cc708_info.end(); ++it708)
+        (*it708).reader->ClearBuffers();
+
+    TeletextInfo::iterator itttx = m_ttx_info.begin();
+    for (; itttx != m_ttx_info.end(); ++itttx)
+        (*itttx).reader->Reset();
+
+    DVBSubInfo::iterator itdvb = m_dvbsub_info.begin();
+    for (; itdvb != m_dvbsub_info.end(); ++itdvb)
+    {
+        (*itdvb).reader->ClearAVSubtitles();
+        (*itdvb).reader->ClearRawTextSubtitles();
+    }
+}
+
+int MythCCExtractorPlayer::OpenFile(uint retries)
+{
+    int ret = MythCommFlagPlayer::OpenFile(retries);
+    if (ret >= 0 && decoder)
+        decoder->SetDecodeAllSubtitles(true);
+    return ret;
+}
+
+/**
+ *  Takes the captions of the frames the flagger goes through in order
+ *  from the start of the recording. The flagger may first look at frames
+ *  all over the recording for a logo, or go through it more than once,
+ *  the captions of each frame are taken only the first time.
+ */
+void MythCCExtractorPlayer::ProcessRawVideoFrame(const VideoFrame *frame,
+                                                 bool seeked)
+{
+    if (seeked)
+        m_capturing = (frame->frameNumber <= m_capturedTo + 1);
+
+    if (!m_capturing || frame->frameNumber <= m_capturedTo)
+    {
+        ClearCaptionReaders();
+        return;
+    }
+
+    m_capturedTo     = frame->frameNumber;
+    m_myFramesPlayed = frame->frameNumber;
+
+    double fps = frame->frame_rate;
+    if (fps <= 0)
+        fps = GetDecoder()->GetFPS();
+    double duration = 1 / fps + frame->repeat_pict * 0.5 / fps;
+    m_curTime += duration * 1000;
+
+    IngestCaptions();
+}
+
+void MythCCExtractorPlayer::FinishCaptions(void)
+{
+    QMutexLocker locker(&m_readersLock);
+
+    Process608Captions(kProcessFinalize);
+    Process708Captions(kProcessFinalize);
+    ProcessTeletext(kProcessFinalize);
+    ProcessDVBSubtitles(kProcessFinalize);
+}
+
 static QString progress_string(
     MythTimer &flagTime, uint64_t m_myFramesPlayed, uint64_t totalFrames)
 {
@@ -189,10 +274,7 @@ bool MythCCExtractorPlayer::run(void)
         cout << qPrintable(str) << endl;
     }
 
-    Process608Captions(kProcessFinalize);
-    Process708Captions(kProcessFinalize);
-    ProcessTeletext(kProcessFinalize);
-    ProcessDVBSubtitles(kProcessFinalize);
+    FinishCaptions();
 
     SetPlaying(false);
     killdecoder = true;
@@ -794,6 +876,7 @@ void MythCCExtractorPlayer::ProcessDVBSubtitles(uint flags)
 
 CC708Reader *MythCCExtractorPlayer::GetCC708Reader(uint id)
 {
+    QMutexLocker locker(&m_readersLock);
     if (!m_cc708_info[id].reader)
     {
         m_cc708_info[id].reader = new CC708Reader(this);
@@ -805,6 +888,7 @@ CC708Reader *MythCCExtractorPlayer::GetCC708Reader(uint id)
 
 CC608Reader *MythCCExtractorPlayer::GetCC608Reader(uint id)
 {
+    QMutexLocker locker(&m_readersLock);
     if (!m_cc608_info[id].reader)
     {
         m_cc608_info[id].reader = new CC608Reader(this);
@@ -815,6 +899,7 @@ CC608Reader *MythCCExtractorPlayer::GetCC608Reader(uint id)
 
 TeletextReader *MythCCExtractorPlayer::GetTeletextReader(uint id)
 {
+    QMutexLocker locker(&m_readersLock);
     if (!m_ttx_info[id].reader)
         m_ttx_info[id].reader = new TeletextExtractorReader();
     return m_ttx_info[id].reader;
@@ -822,6 +907,7 @@ TeletextReader *MythCCExtractorPlayer::GetTeletextReader(uint id)
 
 SubtitleReader *MythCCExtractorPlayer::GetSubReader(uint id)
 {
+    QMutexLocker locker(&m_readersLock);
     if (!m_dvbsub_info[id].reader)
     {
         m_dvbsub_info[id].reader = new SubtitleReader();
@@ -6,12 +6,13 @@
 #include <stdint.h>
 
 #include <QStringList>
+#include <QMutex>
 #include <QImage>
 #include <QPoint>
 #include <QHash>
 #include <QDir>
 
-#include "mythplayer.h"
+#include "mythcommflagplayer.h"
 
 class SRTWriter;
 
@@ -115,7 +116,12 @@ typedef QHash<uint, DVBSubStuff> DVBSubInfo;
 
 typedef QHash<uint, SubtitleReader*> SubtitleReaders;
 
-class MTV_PUBLIC MythCCExtractorPlayer : public MythPlayer
+/**
+ *  Extracts the captions and subtitles of a recording to SRT files, either
+ *  on its own with run(), or along with the commercial flagger going
+ *  through the recording, finished with FinishCaptions().
+ */
+class MTV_PUBLIC MythCCExtractorPlayer : public MythCommFlagPlayer
 {
   public:
     MythCCExtractorPlayer(PlayerFlags flags, bool showProgress,
@@ -123,7 +129,9 @@ class MTV_PUBLIC MythCCExtractorPlayer : public MythPlayer
     MythCCExtractorPlayer(const MythCCExtractorPlayer& rhs);
     ~MythCCExtractorPlayer() {}
 
+    virtual int OpenFile(uint retries = 4);
     bool run(void);
+    void FinishCaptions(void);
 
     virtual CC708Reader    *GetCC708Reader(uint id=0);
     virtual CC608Reader    *GetCC608Reader(uint id=0);
@@ -152,8 +160,15 @@ class MTV_PUBLIC MythCCExtractorPlayer : public MythPlayer
     void ProcessDVBSubtitles(uint flags);
 
     void OnGotNewFrame(void);
+    void IngestCaptions(void);
+    void ClearCaptionReaders(void);
 
   protected:
+    virtual void ProcessRawVideoFrame(const VideoFrame *frame, bool seeked);
+
+    /// Guards the readers, the decoder adds them from its own thread
+    /// when the flagger drives the decoding
+    QMutex          m_readersLock;
     CC608Info       m_cc608_info;
     CC708Info       m_cc708_info;
     TeletextInfo    m_ttx_info;
@@ -174,6 +189,10 @@ class MTV_PUBLIC MythCCExtractorPlayer : public MythPlayer
     /// Keeps track for decoding time to make timestamps for subtitles.
     double  m_curTime;
     uint64_t m_myFramesPlayed;
+    /// Last frame the captions were taken from along with the flagger,
+    /// and whether the flagger is going on from there
+    long long m_capturedTo;
+    bool    m_capturing;
     bool    m_showProgress;
     QString m_fileName;
     QDir    m_workingDir;
@@ -224,3 +224,15 @@ bool MythCommFlagPlayer::RebuildSeekTable(
 
     return true;
 }
+
+/**
+ *  Lets the other post-processing of the recording look at each frame the
+ *  flagger decodes, so that the recording is decoded only once.
+ */
+VideoFrame *MythCommFlagPlayer::GetRawVideoFrame(long long frameNumber)
+{
+    VideoFrame *frame = MythPlayer::GetRawVideoFrame(frameNumber);
+    if (frame)
+        ProcessRawVideoFrame(frame, frameNumber >= 0);
+    return frame;
+}
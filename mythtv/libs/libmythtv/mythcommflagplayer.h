@@ -10,6 +10,14 @@ class MTV_PUBLIC MythCommFlagPlayer : public MythPlayer
     MythCommFlagPlayer(MythCommFlagPlayer& rhs);
     bool RebuildSeekTable(bool showPercentage = true, StatusCallback cb = NULL,
                           void* cbData = NULL);
+
+    virtual VideoFrame *GetRawVideoFrame(long long frameNumber = -1);
+
+  protected:
+    /// Called for every frame the flagger gets, \p seeked when the flagger
+    /// asked for that frame rather than the next one
+    virtual void ProcessRawVideoFrame(const VideoFrame *frame, bool seeked)
+        { (void) frame; (void) seeked; }
 };
 
 #endif // MYTHCOMMFLAGPLAYER_H
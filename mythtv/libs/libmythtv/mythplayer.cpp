@@ -4822,7 +4822,10 @@ void MythPlayer::GetPlaybackData(InfoMap &infoMap)
         infoMap.insert("videoframes", frames);
     }
     if (decoder)
+    {
         infoMap["videodecoder"] = decoder->GetCodecDecoderName();
+        infoMap["decodetime"]   = decoder->GetDecodeStats();
+    }
     if (output_jmeter)
     {
         infoMap["framerate"] = QString("%1%2%3")
@@ -196,6 +196,8 @@ class MTV_PUBLIC PlayerContext
     mutable MythTimer   lastSignalMsgTime;
     mutable InfoMap     lastSignalUIInfo;
     mutable MythTimer   lastSignalUIInfoTime;
+    /// Time taken by each step of the last channel change, as "step=ms"
+    QStringList         lastTuningTimes;
 
     // tv state related
     MythDeque<TVState>  nextState;
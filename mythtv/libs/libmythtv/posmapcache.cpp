@@ -0,0 +1,449 @@
+// C++ headers
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
+
+// Qt headers
+#include <QByteArray>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QMultiMap>
+
+// MythTV headers
+#include "posmapcache.h"
+#include "programinfo.h"
+#include "mythdirs.h"
+#include "mythdb.h"
+#include "mythdate.h"
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+
+#define LOC QString("PosMapCache: ")
+
+/*
+ * Cache file layout, all fixed size fields little endian:
+ *
+ *   char[4]  magic "MPMC"
+ *   uint32   version
+ *   int32    mark type
+ *   uint32   number of entries
+ *   uint64   size of the recording when the map was saved
+ *   uint32   length of the recording's basename
+ *   char[]   basename, UTF-8
+ *   entries  pairs of LEB128 encoded zigzag deltas (mark, offset) from
+ *            the previous entry, the first entry is relative to (0, 0)
+ *
+ * A position map with 1 second between keyframes typically encodes to
+ * 3-4 bytes per entry instead of the 16 bytes of the two 64 bit values.
+ */
+static const char     kMagic[4] = { 'M', 'P', 'M', 'C' };
+static const uint32_t kVersion  = 2;
+static const int      kHeaderSize = 28;
+
+/// Maps not saved for this long are pruned
+static const int      kMaxAgeDays = 30;
+
+QMutex    PositionMapCache::s_pruneLock;
+QDateTime PositionMapCache::s_lastPrune;
+
+static inline void put_u32(QByteArray &buf, uint32_t val)
+{
+    for (uint i = 0; i < 4; i++)
+        buf.append((char)((val >> (8 * i)) & 0xff));
+}
+
+static inline uint32_t get_u32(const uchar *buf)
+{
+    return  (uint32_t)buf[0]        | ((uint32_t)buf[1] << 8) |
+           ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static inline void put_varint(QByteArray &buf, int64_t sval)
+{
+    // zigzag, so small negative deltas stay small
+    uint64_t val = ((uint64_t)sval << 1) ^ (uint64_t)(sval >> 63);
+    while (val >= 0x80)
+    {
+        buf.append((char)((val & 0x7f) | 0x80));
+        val >>= 7;
+    }
+    buf.append((char)val);
+}
+
+static inline void put_u64(QByteArray &buf, uint64_t val)
+{
+    put_u32(buf, (uint32_t)(val & 0xffffffff));
+    put_u32(buf, (uint32_t)(val >> 32));
+}
+
+static inline uint64_t get_u64(const uchar *buf)
+{
+    return (uint64_t)get_u32(buf) | ((uint64_t)get_u32(buf + 4) << 32);
+}
+
+static inline uint64_t max_offset(const frm_pos_map_t &posMap)
+{
+    uint64_t ret = 0;
+    frm_pos_map_t::const_iterator it = posMap.begin();
+    for (; it != posMap.end(); ++it)
+        ret = std::max(ret, (uint64_t)*it);
+    return ret;
+}
+
+static inline bool get_varint(const uchar *&buf, const uchar *end,
+                              int64_t &sval)
+{
+    uint64_t val = 0;
+    for (uint shift = 0; buf < end && shift < 64; shift += 7)
+    {
+        uchar byte = *buf++;
+        val |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            sval = (int64_t)(val >> 1) ^ -(int64_t)(val & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/** \fn PositionMapCache::QueryPositionMap(const ProgramInfo&, frm_pos_map_t&, MarkTypes)
+ *  \brief Drop in replacement for ProgramInfo::QueryPositionMap() which
+ *         serves the map from the local cache where it is still valid.
+ */
+void PositionMapCache::QueryPositionMap(const ProgramInfo &pginfo,
+                                        frm_pos_map_t &posMap, MarkTypes type)
+{
+    if (!pginfo.IsRecording() || pginfo.HasPositionMapDBReplacement())
+    {
+        pginfo.QueryPositionMap(posMap, type);
+        return;
+    }
+
+    QString filename = GetCacheFilename(pginfo, type);
+
+    Stats stats;
+    if (!QueryStats(pginfo, type, stats))
+    {
+        pginfo.QueryPositionMap(posMap, type);
+        return;
+    }
+
+    posMap.clear();
+
+    if (!stats.count)
+    {
+        QFile::remove(filename);
+        return;
+    }
+
+    Stats cached;
+    if (Load(filename, type, posMap, cached) && !posMap.empty() &&
+        cached.basename == stats.basename)
+    {
+        uint64_t cached_last   = (posMap.end() - 1).key();
+        uint64_t cached_offset = max_offset(posMap);
+
+        if ((uint64_t)posMap.size() == stats.count &&
+            cached_last == stats.last_mark &&
+            cached_offset == stats.max_offset &&
+            cached.filesize == stats.filesize)
+        {
+            LOG(VB_PLAYBACK, LOG_INFO, LOC +
+                QString("Using cached map type %1 with %2 entries")
+                    .arg(type).arg(stats.count));
+            return;
+        }
+
+        // A growing recording, fetch only the new rows
+        if ((uint64_t)posMap.size() <= stats.count &&
+            cached_last <= stats.last_mark &&
+            cached_offset <= stats.max_offset)
+        {
+            frm_pos_map_t tail;
+            if (QueryTail(pginfo, type, cached_last, tail))
+            {
+                frm_pos_map_t::const_iterator it = tail.begin();
+                for (; it != tail.end(); ++it)
+                    posMap[it.key()] = *it;
+
+                if ((uint64_t)posMap.size() == stats.count &&
+                    max_offset(posMap) == stats.max_offset)
+                {
+                    LOG(VB_PLAYBACK, LOG_INFO, LOC +
+                        QString("Extended cached map type %1 by %2 entries")
+                            .arg(type).arg(tail.size()));
+                    Save(filename, type, posMap, stats);
+                    return;
+                }
+            }
+        }
+
+        LOG(VB_PLAYBACK, LOG_INFO, LOC +
+            QString("Cached map type %1 is stale").arg(type));
+    }
+
+    posMap.clear();
+    pginfo.QueryPositionMap(posMap, type);
+    Save(filename, type, posMap, stats);
+}
+
+/// Removes all cached maps of a recording this frontend deletes. Other
+/// changes to a recording are caught by the checks in QueryPositionMap().
+void PositionMapCache::Remove(const ProgramInfo &pginfo)
+{
+    QDir dir(GetCacheDir());
+    QStringList files = dir.entryList(
+        QStringList(QString("%1_%2_*.pmap").arg(pginfo.GetChanID())
+                    .arg(pginfo.GetRecordingStartTime(MythDate::kFilename))),
+        QDir::Files);
+
+    for (int i = 0; i < files.size(); i++)
+        dir.remove(files[i]);
+}
+
+/** \brief Removes the maps not saved for kMaxAgeDays, and then the
+ *         oldest maps until the cache is below its size limit.
+ *
+ *  Runs at most once an hour, from Save().
+ */
+void PositionMapCache::Prune(void)
+{
+    {
+        QMutexLocker locker(&s_pruneLock);
+        QDateTime now = MythDate::current();
+        if (s_lastPrune.isValid() && s_lastPrune.secsTo(now) < 60 * 60)
+            return;
+        s_lastPrune = now;
+    }
+
+    QDateTime cutoff = MythDate::current().addDays(-kMaxAgeDays);
+    int64_t maxSize = (int64_t)gCoreContext->GetNumSetting(
+        "PositionMapCacheSize", 64) * 1024 * 1024;
+
+    QDir dir(GetCacheDir());
+    QFileInfoList files = dir.entryInfoList(QStringList("*.pmap"),
+                                            QDir::Files);
+
+    QMultiMap<QDateTime, QFileInfo> byAge;
+    int64_t total = 0;
+    int removed = 0;
+
+    QFileInfoList::const_iterator it = files.begin();
+    for (; it != files.end(); ++it)
+    {
+        QDateTime saved = it->lastModified().toUTC();
+        if (saved < cutoff)
+        {
+            removed += QFile::remove(it->absoluteFilePath()) ? 1 : 0;
+            continue;
+        }
+        byAge.insert(saved, *it);
+        total += it->size();
+    }
+
+    QMultiMap<QDateTime, QFileInfo>::const_iterator ait = byAge.begin();
+    for (; ait != byAge.end() && total > maxSize; ++ait)
+    {
+        if (QFile::remove(ait->absoluteFilePath()))
+        {
+            total -= ait->size();
+            removed++;
+        }
+    }
+
+    if (removed)
+        LOG(VB_PLAYBACK, LOG_INFO, LOC +
+            QString("Pruned %1 cached maps, %2 KB left")
+                .arg(removed).arg(total / 1024));
+}
+
+QString PositionMapCache::GetCacheDir(void)
+{
+    return GetConfDir() + "/cache/posmapcache/";
+}
+
+QString PositionMapCache::GetCacheFilename(const ProgramInfo &pginfo,
+                                           MarkTypes type)
+{
+    return GetCacheDir() + QString("%1_%2_%3.pmap")
+        .arg(pginfo.GetChanID())
+        .arg(pginfo.GetRecordingStartTime(MythDate::kFilename))
+        .arg((int)type);
+}
+
+bool PositionMapCache::Load(const QString &filename, MarkTypes type,
+                            frm_pos_map_t &posMap, Stats &stats)
+{
+    QFile file(filename);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly))
+        return false;
+
+    qint64 size = file.size();
+    if (size < kHeaderSize)
+        return false;
+
+    const uchar *data = file.map(0, size);
+    if (!data)
+        return false;
+
+    const uchar *end = data + size;
+    bool ok = !memcmp(data, kMagic, sizeof(kMagic)) &&
+              get_u32(data + 4) == kVersion &&
+              (int32_t)get_u32(data + 8) == (int32_t)type;
+
+    uint32_t entries = ok ? get_u32(data + 12) : 0;
+    uint32_t namelen = ok ? get_u32(data + 24) : 0;
+    ok = ok && namelen <= (uint64_t)(size - kHeaderSize);
+    if (ok)
+    {
+        stats.filesize = get_u64(data + 16);
+        stats.basename = QString::fromUtf8((const char*)data + kHeaderSize,
+                                           namelen);
+    }
+    const uchar *buf = data + kHeaderSize + namelen;
+    int64_t mark = 0, offset = 0;
+
+    for (uint32_t i = 0; ok && i < entries; i++)
+    {
+        int64_t dmark, doffset;
+        ok = get_varint(buf, end, dmark) && get_varint(buf, end, doffset);
+        mark   += dmark;
+        offset += doffset;
+        if (ok)
+            posMap.insert(posMap.end(), mark, offset);
+    }
+
+    file.unmap(const_cast<uchar*>(data));
+
+    if (!ok)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Discarding corrupt cache file '%1'").arg(filename));
+        posMap.clear();
+        file.remove();
+    }
+
+    return ok;
+}
+
+bool PositionMapCache::Save(const QString &filename, MarkTypes type,
+                            const frm_pos_map_t &posMap, const Stats &stats)
+{
+    QDir dir;
+    if (!dir.exists(GetCacheDir()) && !dir.mkpath(GetCacheDir()))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Could not create '%1'").arg(GetCacheDir()));
+        return false;
+    }
+
+    QByteArray basename = stats.basename.toUtf8();
+    QByteArray buf;
+    buf.reserve(kHeaderSize + basename.size() + posMap.size() * 4);
+    buf.append(kMagic, sizeof(kMagic));
+    put_u32(buf, kVersion);
+    put_u32(buf, (uint32_t)type);
+    put_u32(buf, (uint32_t)posMap.size());
+    put_u64(buf, stats.filesize);
+    put_u32(buf, (uint32_t)basename.size());
+    buf.append(basename);
+
+    int64_t mark = 0, offset = 0;
+    frm_pos_map_t::const_iterator it = posMap.begin();
+    for (; it != posMap.end(); ++it)
+    {
+        put_varint(buf, it.key() - mark);
+        put_varint(buf, *it - offset);
+        mark   = it.key();
+        offset = *it;
+    }
+
+    // Write to a temporary file and rename it into place, so a concurrent
+    // reader never sees a partially written map
+    QString tmpname = filename + ".tmp";
+    QFile file(tmpname);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        file.write(buf) != buf.size())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Could not write '%1'").arg(tmpname));
+        file.remove();
+        return false;
+    }
+    file.close();
+
+    QFile::remove(filename);
+    if (!QFile::rename(tmpname, filename))
+    {
+        QFile::remove(tmpname);
+        return false;
+    }
+
+    Prune();
+
+    return true;
+}
+
+bool PositionMapCache::QueryStats(const ProgramInfo &pginfo, MarkTypes type,
+                                  Stats &stats)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT COUNT(s.mark), MAX(s.mark), MAX(s.offset),"
+                  "       r.filesize, r.basename"
+                  " FROM recorded r"
+                  " LEFT JOIN recordedseek s"
+                  "  ON s.chanid = r.chanid"
+                  "  AND s.starttime = r.starttime"
+                  "  AND s.type = :TYPE"
+                  " WHERE r.chanid = :CHANID"
+                  " AND r.starttime = :STARTTIME"
+                  " GROUP BY r.filesize, r.basename ;");
+    query.bindValue(":CHANID", pginfo.GetChanID());
+    query.bindValue(":STARTTIME", pginfo.GetRecordingStartTime());
+    query.bindValue(":TYPE", type);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("PositionMapCache::QueryStats", query);
+        return false;
+    }
+
+    if (!query.next())
+        return false;
+
+    stats.count      = query.value(0).toULongLong();
+    stats.last_mark  = query.value(1).toULongLong();
+    stats.max_offset = query.value(2).toULongLong();
+    stats.filesize   = query.value(3).toULongLong();
+    stats.basename   = query.value(4).toString();
+
+    return true;
+}
+
+bool PositionMapCache::QueryTail(const ProgramInfo &pginfo, MarkTypes type,
+                                 uint64_t after_mark, frm_pos_map_t &posMap)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT mark, offset FROM recordedseek"
+                  " WHERE chanid = :CHANID"
+                  " AND starttime = :STARTTIME"
+                  " AND type = :TYPE"
+                  " AND mark > :MARK ;");
+    query.bindValue(":CHANID", pginfo.GetChanID());
+    query.bindValue(":STARTTIME", pginfo.GetRecordingStartTime());
+    query.bindValue(":TYPE", type);
+    query.bindValue(":MARK", (quint64)after_mark);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("PositionMapCache::QueryTail", query);
+        return false;
+    }
+
+    while (query.next())
+        posMap[query.value(0).toULongLong()] = query.value(1).toULongLong();
+
+    return true;
+}
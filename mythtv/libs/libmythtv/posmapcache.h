@@ -0,0 +1,71 @@
+#ifndef POSMAPCACHE_H
+#define POSMAPCACHE_H
+
+// Qt headers
+#include <QString>
+#include <QMutex>
+#include <QDateTime>
+
+// MythTV headers
+#include "mythtvexp.h"
+#include "programtypes.h"               // for frm_pos_map_t, MarkTypes
+
+class ProgramInfo;
+
+/** \class PositionMapCache
+ *  \brief Local on-disk copy of the seek tables of a recording.
+ *
+ *  Each position or duration map is kept delta encoded in a small binary
+ *  file in the frontend cache directory and memory mapped when playback
+ *  starts, so a long recording does not need every recordedseek row pulled
+ *  from the database each time it is played.
+ *
+ *  A cached map is validated against the number of rows, the last mark
+ *  and the largest offset in the database, and against the file name and
+ *  size of the recording, so a transcoded or rebuilt recording is not
+ *  served the old map. This check is what keeps the cache of every
+ *  frontend current, whichever host changed the recording. For a
+ *  recording that is still growing only the rows past the last cached
+ *  mark are fetched, and the cache file is then rewritten whole.
+ *
+ *  Maps not saved for a month are pruned, and so are the oldest maps
+ *  once the cache grows past PositionMapCacheSize megabytes.
+ */
+class MTV_PUBLIC PositionMapCache
+{
+  public:
+    static void QueryPositionMap(const ProgramInfo &pginfo,
+                                 frm_pos_map_t &posMap, MarkTypes type);
+    static void Remove(const ProgramInfo &pginfo);
+
+  private:
+    /// What a cached map is checked against
+    class Stats
+    {
+      public:
+        Stats() : count(0), last_mark(0), max_offset(0), filesize(0) {}
+        uint64_t count;
+        uint64_t last_mark;
+        uint64_t max_offset;
+        uint64_t filesize;
+        QString  basename;
+    };
+
+    static void Prune(void);
+    static QString GetCacheDir(void);
+    static QString GetCacheFilename(const ProgramInfo &pginfo,
+                                    MarkTypes type);
+    static bool Load(const QString &filename, MarkTypes type,
+                     frm_pos_map_t &posMap, Stats &stats);
+    static bool Save(const QString &filename, MarkTypes type,
+                     const frm_pos_map_t &posMap, const Stats &stats);
+    static bool QueryStats(const ProgramInfo &pginfo, MarkTypes type,
+                           Stats &stats);
+    static bool QueryTail(const ProgramInfo &pginfo, MarkTypes type,
+                          uint64_t after_mark, frm_pos_map_t &posMap);
+
+    static QMutex    s_pruneLock;
+    static QDateTime s_lastPrune;
+};
+
+#endif // POSMAPCACHE_H
@@ -641,32 +641,7 @@ bool PreviewGenerator::LocalPreviewRun(void)
     if (captime <= 0)
     {
         m_timeInSeconds = true;
-        int startEarly = 0;
-        int programDuration = 0;
-        int preroll =  gCoreContext->GetNumSetting("RecordPreRoll", 0);
-        if (m_programInfo.GetScheduledStartTime().isValid() &&
-            m_programInfo.GetScheduledEndTime().isValid() &&
-            (m_programInfo.GetScheduledStartTime() !=
-             m_programInfo.GetScheduledEndTime()))
-        {
-            programDuration = m_programInfo.GetScheduledStartTime()
-                .secsTo(m_programInfo.GetScheduledEndTime());
-        }
-        if (m_programInfo.GetRecordingStartTime().isValid() &&
-            m_programInfo.GetScheduledStartTime().isValid() &&
-            (m_programInfo.GetRecordingStartTime() !=
-             m_programInfo.GetScheduledStartTime()))
-        {
-            startEarly = m_programInfo.GetRecordingStartTime()
-                .secsTo(m_programInfo.GetScheduledStartTime());
-        }
-        if (programDuration > 0)
-        {
-            captime = startEarly + (programDuration / 3);
-        }
-        if (captime < 0)
-            captime = 600;
-        captime += preroll;
+        captime = GetDefaultPreviewSeconds(m_programInfo);
         LOG(VB_GENERAL, LOG_INFO,
             QString("Preview at calculated offset (%1 seconds)").arg(captime));
     }
@@ -703,6 +678,41 @@ bool PreviewGenerator::LocalPreviewRun(void)
     return ok;
 }
 
+/**
+ *  A third into the program as scheduled, past the early start and the
+ *  pre-roll, or 10 minutes in when the schedule is unknown.
+ */
+long long PreviewGenerator::GetDefaultPreviewSeconds(const ProgramInfo &pginfo)
+{
+    long long captime = -1;
+    int startEarly = 0;
+    int programDuration = 0;
+    int preroll =  gCoreContext->GetNumSetting("RecordPreRoll", 0);
+    if (pginfo.GetScheduledStartTime().isValid() &&
+        pginfo.GetScheduledEndTime().isValid() &&
+        (pginfo.GetScheduledStartTime() != pginfo.GetScheduledEndTime()))
+    {
+        programDuration = pginfo.GetScheduledStartTime()
+            .secsTo(pginfo.GetScheduledEndTime());
+    }
+    if (pginfo.GetRecordingStartTime().isValid() &&
+        pginfo.GetScheduledStartTime().isValid() &&
+        (pginfo.GetRecordingStartTime() != pginfo.GetScheduledStartTime()))
+    {
+        startEarly = pginfo.GetRecordingStartTime()
+            .secsTo(pginfo.GetScheduledStartTime());
+    }
+    if (programDuration > 0)
+    {
+        captime = startEarly + (programDuration / 3);
+    }
+    if (captime < 0)
+        captime = 600;
+    captime += preroll;
+
+    return captime;
+}
+
 QString PreviewGenerator::CreateAccessibleFilename(
     const QString &pathname, const QString &outFileName)
 {
@@ -67,6 +67,15 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
 
     void AttachSignals(QObject*);
 
+    static bool SavePreview(const QString &filename,
+                            const unsigned char *data,
+                            uint width, uint height, float aspect,
+                            int desired_width, int desired_height,
+                            const QString &format);
+
+    /// Seconds into the recording of the preview when there is no bookmark
+    static long long GetDefaultPreviewSeconds(const ProgramInfo &pginfo);
+
   public slots:
     void deleteLater();
 
@@ -89,13 +98,6 @@ class MTV_PUBLIC PreviewGenerator : public QObject, public MThread
                                int               &video_height,
                                float             &video_aspect);
 
-    static bool SavePreview(const QString &filename,
-                            const unsigned char *data,
-                            uint width, uint height, float aspect,
-                            int desired_width, int desired_height,
-                            const QString &format);
-
-
     static QString CreateAccessibleFilename(
         const QString &pathname, const QString &outFileName);
 
@@ -3,9 +3,13 @@
 
 #include "HLSReader.h"
 #include "HLS/m3u.h"
+#include "mthreadpool.h"
 
 #define LOC QString("%1: ").arg(m_curstream ? m_curstream->Url() : "HLSReader")
 
+// Segments downloading at the same time, including the one being waited on
+static const int kPrefetchWindow = 3;
+
 /**
  * Handles relative URLs without breaking URI encoded parameters by avoiding
  * storing the decoded URL in a QString.
@@ -19,12 +23,14 @@ static QUrl RelativeURI (const QString& baseString, const QString& uriString)
     return base.resolved(uri);
 }
 
+#ifdef HLS_USE_MYTHDOWNLOADMANAGER
 static uint64_t MDate(void)
 {
     timeval  t;
     gettimeofday(&t, NULL);
     return t.tv_sec * 1000000ULL + t.tv_usec;
 }
+#endif
 
 HLSReader::HLSReader(void)
     : m_curstream(NULL), m_cur_seq(-1), m_bitrate_index(0),
@@ -32,14 +38,19 @@ HLSReader::HLSReader(void)
       m_throttle(true), m_aesmsg(false),
       m_playlistworker(NULL), m_streamworker(NULL),
       m_playlist_size(0), m_bandwidthcheck(false), m_prebuffer_cnt(10),
-      m_debug(false), m_debug_cnt(0), m_slow_cnt(0)
+      m_debug(false), m_debug_cnt(0), m_slow_cnt(0),
+      m_buffer_offset(0), m_buffer_size(0), m_buffer_seq(-1),
+      m_fetchpool(new MThreadPool("HLSSegmentFetch"))
 {
+    m_fetchpool->setMaxThreadCount(kPrefetchWindow);
 }
 
 HLSReader::~HLSReader(void)
 {
     LOG(VB_RECORD, LOG_INFO, LOC + "dtor -- start");
     Close();
+    m_fetchpool->waitForDone();
+    delete m_fetchpool;
     LOG(VB_RECORD, LOG_INFO, LOC + "dtor -- end");
 }
 
@@ -160,6 +171,8 @@ void HLSReader::Close(bool quiet)
     delete m_playlistworker;
     m_playlistworker = NULL;
 
+    DeleteFetches();
+
     LOG(VB_RECORD, (quiet ? LOG_DEBUG : LOG_INFO), LOC + "Close -- end");
 }
 
@@ -180,6 +193,12 @@ void HLSReader::Cancel(bool quiet)
 
     if (m_playlistworker)
         m_playlistworker->Cancel();
+    m_fetch_lock.lock();
+    QList<HLSSegmentFetch*>::iterator Ifetch = m_fetches.begin();
+    for ( ; Ifetch != m_fetches.end(); ++Ifetch)
+        (*Ifetch)->Cancel();
+    m_fetch_lock.unlock();
+
     if (m_streamworker)
         m_streamworker->Cancel();
 #ifdef HLS_USE_MYTHDOWNLOADMANAGER // MythDownloadManager leaks memory
@@ -219,21 +238,72 @@ int HLSReader::Read(uint8_t* buffer, int maxlen)
 
     QMutexLocker lock(&m_buflock);
 
-    int len = m_buffer.size() < maxlen ? m_buffer.size() : maxlen;
+    int len = m_buffer_size < maxlen ? m_buffer_size : maxlen;
     LOG(VB_RECORD, LOG_DEBUG, LOC + QString("Reading %1 of %2 bytes")
-        .arg(len).arg(m_buffer.size()));
+        .arg(len).arg(m_buffer_size));
 
-    memcpy(buffer, m_buffer.constData(), len);
-    if (len < m_buffer.size())
+    int copied = 0;
+    while (copied < len)
     {
-        m_buffer.remove(0, len);
+        const QByteArray& segment = m_buffer.front();
+        int count = segment.size() - m_buffer_offset;
+        if (count > len - copied)
+            count = len - copied;
+
+        memcpy(buffer + copied, segment.constData() + m_buffer_offset, count);
+        copied += count;
+        m_buffer_offset += count;
+
+        if (m_buffer_offset >= segment.size())
+        {
+            m_buffer.pop_front();
+            m_buffer_offset = 0;
+        }
     }
-    else
-        m_buffer.clear();
+    m_buffer_size -= len;
 
     return len;
 }
 
+/**
+ * Hands over the oldest downloaded segment, or what Read() left of it.
+ * The data is shared with the download, it is not copied.
+ */
+int HLSReader::ReadSegment(QByteArray& data)
+{
+    data.clear();
+
+    if (!m_curstream)
+    {
+        LOG(VB_RECORD, LOG_ERR, LOC + "ReadSegment: no stream selected");
+        return 0;
+    }
+    if (m_cancel)
+    {
+        LOG(VB_RECORD, LOG_DEBUG, LOC + QString("ReadSegment: canceled"));
+        return 0;
+    }
+
+    QMutexLocker lock(&m_buflock);
+
+    if (m_buffer.empty())
+        return 0;
+
+    data = m_buffer.takeFirst();
+    if (m_buffer_offset > 0)
+    {
+        data = data.mid(m_buffer_offset);
+        m_buffer_offset = 0;
+    }
+    m_buffer_size -= data.size();
+
+    LOG(VB_RECORD, LOG_DEBUG, LOC + QString("Reading segment of %1 bytes, "
+                                            "%2 bytes left")
+        .arg(data.size()).arg(m_buffer_size));
+
+    return data.size();
+}
+
 #ifdef HLS_USE_MYTHDOWNLOADMANAGER // MythDownloadManager leaks memory
 bool HLSReader::DownloadURL(const QString &url, QByteArray *buffer)
 {
@@ -547,6 +617,10 @@ bool HLSReader::ParseM3U8(const QByteArray& buffer, HLSRecStream* stream)
                 QString("Sequence number has been reset from %1 to %2")
                 .arg(m_cur_seq).arg(first_sequence));
             ResetSequence();
+            // The new numbers may repeat ones already recorded
+            m_buflock.lock();
+            m_buffer_seq = -1;
+            m_buflock.unlock();
             return false;
         }
 
@@ -615,6 +689,7 @@ bool HLSReader::ParseM3U8(const QByteArray& buffer, HLSRecStream* stream)
             EnableDebugging();
             Iseg = m_segments.begin() + (behind - max_behind);
             m_segments.erase(m_segments.begin(), Iseg);
+            CancelSkippedFetches();
             m_bandwidthcheck = (m_bitrate_index == 0);
         }
         else if (m_debug_cnt > 0)
@@ -806,6 +881,9 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
                 .arg(m_playlist_size - m_segments.size() + 1)
                 .arg(m_playlist_size));
         }
+#ifndef HLS_USE_MYTHDOWNLOADMANAGER
+        PrefetchSegments();
+#endif
         m_seq_lock.unlock();
 
         m_stream_lock.lock();
@@ -832,8 +910,10 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
             m_seq_lock.unlock();
             return false;
         }
-        else
+        else if (!m_segments.empty() &&
+                 m_segments.front().Sequence() == seg.Sequence())
         {
+            // Unless ParseM3U8() skipped it while downloading
             m_cur_seq = m_segments.front().Sequence();
             m_segments.pop_front();
         }
@@ -909,10 +989,10 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
     }
 
     QByteArray buffer;
-    uint64_t   start = MDate();
 
 #ifdef HLS_USE_MYTHDOWNLOADMANAGER // MythDownloadManager leaks memory
                                    // and can only handle six download at a time
+    uint64_t start = MDate();
     if (!HLSReader::DownloadURL(segment.Url(), &buffer))
     {
         LOG(VB_RECORD, LOG_ERR, LOC +
@@ -929,16 +1009,47 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
         else
             return 0;
     }
+    uint64_t downloadduration = (MDate() - start) / 1000;
 #else
-    if (!downloader.DownloadURL(segment.Url(), &buffer))
+    /* Started by PrefetchSegments(), along with the next few segments */
+    HLSSegmentFetch *fetch = NULL;
+    m_fetch_lock.lock();
+    if (!m_fetches.empty() &&
+        m_fetches.front()->Sequence() == segment.Sequence())
+        fetch = m_fetches.front();
+    m_fetch_lock.unlock();
+
+    if (!fetch)
+    {
+        LOG(VB_RECORD, LOG_ERR, LOC +
+            QString("%1 is not being downloaded").arg(segment.Sequence()));
+        return -1;
+    }
+
+    while (!fetch->Wait(100))
+    {
+        if (m_cancel)
+            fetch->Cancel();
+    }
+
+    // Only this one is downloaded again on retry, the following
+    // segments already downloaded are kept.
+    m_fetch_lock.lock();
+    m_fetches.removeOne(fetch);
+    m_fetch_lock.unlock();
+
+    if (!fetch->Succeeded())
     {
         LOG(VB_RECORD, LOG_ERR, LOC + QString("%1 failed: %2")
-            .arg(segment.Sequence()).arg(downloader.ErrorString()));
+            .arg(segment.Sequence()).arg(fetch->ErrorString()));
+        delete fetch;
         return -1;
     }
-#endif
 
-    uint64_t downloadduration = (MDate() - start) / 1000;
+    buffer = fetch->Data();
+    uint64_t downloadduration = fetch->DownloadDuration();
+    delete fetch;
+#endif
 
 #ifdef USING_LIBCRYPTO
     /* If the segment is encrypted, decode it */
@@ -954,32 +1065,52 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
     int segment_len = buffer.size();
 
     m_buflock.lock();
-    if (m_buffer.size() > segment_len * playlist_size)
+    if (m_buffer_seq >= 0 && segment.Sequence() <= m_buffer_seq)
+    {
+        // Playlist reloaded after a reset, do not record it twice
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("%1 already buffered, last is %2")
+            .arg(segment.Sequence()).arg(m_buffer_seq));
+        m_buflock.unlock();
+        return m_slow_cnt;
+    }
+
+    if (m_buffer_size > segment_len * playlist_size)
     {
         LOG(VB_RECORD, LOG_WARNING, LOC +
             QString("streambuffer is not reading fast enough. "
-                    "buffer size %1").arg(m_buffer.size()));
+                    "buffer size %1").arg(m_buffer_size));
         EnableDebugging();
         if (++m_slow_cnt > 15)
         {
             m_slow_cnt = 15;
             m_fatal = true;
+            m_buflock.unlock();
             return -1;
         }
     }
     else if (m_slow_cnt > 0)
         --m_slow_cnt;
 
-    if (m_buffer.size() >= segment_len * playlist_size * 2)
+    if (m_buffer_size >= segment_len * playlist_size * 2)
     {
-        LOG(VB_RECORD, LOG_WARNING, LOC +
-            QString("streambuffer is not reading fast enough. "
-                    "buffer size %1.  Dropping %2 bytes")
-            .arg(m_buffer.size()).arg(segment_len));
-        m_buffer.remove(0, segment_len);
+        // Drop a whole segment, not part of one, so the recorder
+        // stays aligned on TS packets. The one being read is kept.
+        int drop = (m_buffer_offset > 0) ? 1 : 0;
+        if (drop < m_buffer.size())
+        {
+            LOG(VB_RECORD, LOG_WARNING, LOC +
+                QString("streambuffer is not reading fast enough. "
+                        "buffer size %1.  Dropping a segment of %2 bytes")
+                .arg(m_buffer_size).arg(m_buffer[drop].size()));
+            m_buffer_size -= m_buffer[drop].size();
+            m_buffer.removeAt(drop);
+        }
     }
 
-    m_buffer += buffer;
+    m_buffer.push_back(buffer);
+    m_buffer_size += segment_len;
+    m_buffer_seq = segment.Sequence();
     m_buflock.unlock();
 
     if (hls->Bitrate() == 0 && segment.Duration() > 0)
@@ -1010,6 +1141,96 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
     return m_slow_cnt;
 }
 
+/**
+ * Starts the downloads of the first kPrefetchWindow segments of the
+ * playlist not downloading yet, and cancels those of segments no longer
+ * in it. Called with m_seq_lock held.
+ */
+void HLSReader::PrefetchSegments(void)
+{
+    QMutexLocker lock(&m_fetch_lock);
+
+    QList<HLSSegmentFetch*>::iterator Ifetch = m_discarded.begin();
+    while (Ifetch != m_discarded.end())
+    {
+        if ((*Ifetch)->IsDone())
+        {
+            delete *Ifetch;
+            Ifetch = m_discarded.erase(Ifetch);
+        }
+        else
+            ++Ifetch;
+    }
+
+    QList<HLSSegmentFetch*> fetches;
+    SegmentContainer::const_iterator Iseg = m_segments.begin();
+    for (int i = 0; i < kPrefetchWindow && Iseg != m_segments.end();
+         ++i, ++Iseg)
+    {
+        HLSSegmentFetch *fetch = NULL;
+        for (Ifetch = m_fetches.begin(); Ifetch != m_fetches.end(); ++Ifetch)
+        {
+            if ((*Ifetch)->Sequence() == (*Iseg).Sequence())
+            {
+                fetch = *Ifetch;
+                m_fetches.erase(Ifetch);
+                break;
+            }
+        }
+
+        if (!fetch)
+        {
+            LOG(VB_RECORD, LOG_DEBUG, LOC +
+                QString("Prefetching segment %1").arg((*Iseg).Sequence()));
+            fetch = new HLSSegmentFetch(*Iseg);
+            m_fetchpool->start(fetch, "HLSSegmentFetch");
+        }
+        fetches.push_back(fetch);
+    }
+
+    // Anything left was skipped
+    for (Ifetch = m_fetches.begin(); Ifetch != m_fetches.end(); ++Ifetch)
+    {
+        (*Ifetch)->Cancel();
+        m_discarded.push_back(*Ifetch);
+    }
+    m_fetches = fetches;
+}
+
+/**
+ * Cancels the downloads of segments dropped from the front of the
+ * playlist because we fell behind. Called with m_seq_lock held.
+ */
+void HLSReader::CancelSkippedFetches(void)
+{
+    QMutexLocker lock(&m_fetch_lock);
+
+    int64_t first = m_segments.empty() ? -1 : m_segments.front().Sequence();
+    QList<HLSSegmentFetch*>::const_iterator Ifetch = m_fetches.begin();
+    for ( ; Ifetch != m_fetches.end(); ++Ifetch)
+    {
+        if (first < 0 || (*Ifetch)->Sequence() < first)
+            (*Ifetch)->Cancel();
+    }
+}
+
+void HLSReader::DeleteFetches(void)
+{
+    QMutexLocker lock(&m_fetch_lock);
+
+    m_discarded += m_fetches;
+    m_fetches.clear();
+
+    QList<HLSSegmentFetch*>::iterator Ifetch = m_discarded.begin();
+    for ( ; Ifetch != m_discarded.end(); ++Ifetch)
+        (*Ifetch)->Cancel();
+    m_fetchpool->waitForDone();
+
+    for (Ifetch = m_discarded.begin(); Ifetch != m_discarded.end(); ++Ifetch)
+        delete *Ifetch;
+    m_discarded.clear();
+}
+
 void HLSReader::PlaylistGood(void)
 {
     QMutexLocker lock(&m_stream_lock);
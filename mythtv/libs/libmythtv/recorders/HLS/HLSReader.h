@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QList>
 #include <QUrl>
 #include <QTextStream>
 
@@ -25,10 +26,12 @@
 #include "mythlogging.h"
 
 #include "HLSSegment.h"
+#include "HLSSegmentFetch.h"
 #include "HLSStream.h"
 #include "HLSStreamWorker.h"
 #include "HLSPlaylistWorker.h"
 
+class MThreadPool;
 
 class HLSReader
 {
@@ -45,6 +48,7 @@ class HLSReader
     bool Open(const QString & uri, int bitrate_index = 0);
     void Close(bool quiet = false);
     int Read(uint8_t* buffer, int len);
+    int ReadSegment(QByteArray& data);
     void Throttle(bool val);
     bool IsThrottled(void) const { return m_throttle; }
     bool IsOpen(const QString& url) const
@@ -89,6 +93,9 @@ class HLSReader
     bool LoadSegments(HLSRecStream & hlsstream);
     int DownloadSegmentData(MythSingleDownload& downloader, HLSRecStream* hls,
 			    HLSRecSegment& segment, int playlist_size);
+    void PrefetchSegments(void);
+    void CancelSkippedFetches(void);
+    void DeleteFetches(void);
 
     // Debug
     void EnableDebugging(void);
@@ -127,8 +134,17 @@ class HLSReader
 
     // Downloading
     int         m_slow_cnt;
-    QByteArray  m_buffer;
+    QList<QByteArray> m_buffer;   // downloaded segments, oldest first
+    int         m_buffer_offset;  // bytes of the oldest one already read
+    int         m_buffer_size;    // bytes not read yet
+    int64_t     m_buffer_seq;     // sequence of the last segment buffered
     QMutex      m_buflock;
+
+    // Prefetching
+    QList<HLSSegmentFetch*> m_fetches;   // first segments of m_segments
+    QList<HLSSegmentFetch*> m_discarded; // canceled, still running
+    QMutex      m_fetch_lock;
+    MThreadPool *m_fetchpool;
 };
 
 #endif
@@ -0,0 +1,82 @@
+#include "HLSSegmentFetch.h"
+#include "mythsingledownload.h"
+#include "mythlogging.h"
+#include "mythtimer.h"
+
+#define LOC QString("HLSSegmentFetch[%1]: ").arg(m_segment.Sequence())
+
+HLSSegmentFetch::HLSSegmentFetch(const HLSRecSegment& segment)
+    : m_segment(segment), m_ok(false), m_done(false), m_canceled(false),
+      m_duration(0), m_downloader(NULL)
+{
+    // Owned by HLSReader, which deletes it once done
+    setAutoDelete(false);
+}
+
+HLSSegmentFetch::~HLSSegmentFetch(void)
+{
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "dtor");
+}
+
+void HLSSegmentFetch::run(void)
+{
+    QByteArray data;
+    QString    error;
+    bool       ok = false;
+    MythTimer  timer;
+
+    timer.start();
+
+    m_lock.lock();
+    if (m_canceled)
+        error = "canceled";
+    else
+    {
+        m_downloader = new MythSingleDownload;
+        m_lock.unlock();
+
+        ok = m_downloader->DownloadURL(m_segment.Url(), &data);
+        if (!ok)
+            error = m_downloader->ErrorString();
+
+        m_lock.lock();
+        delete m_downloader;
+        m_downloader = NULL;
+    }
+
+    m_duration = timer.elapsed();
+    m_ok       = ok && !m_canceled;
+    m_error    = (ok && m_canceled) ? QString("canceled") : error;
+    m_data     = data;
+    m_done     = true;
+    m_waitcond.wakeAll();
+    m_lock.unlock();
+
+    LOG(VB_RECORD, LOG_DEBUG, LOC + QString("%1 bytes in %2ms%3")
+        .arg(data.size()).arg(m_duration)
+        .arg(m_ok ? "" : QString(", failed: %1").arg(m_error)));
+}
+
+void HLSSegmentFetch::Cancel(void)
+{
+    QMutexLocker lock(&m_lock);
+    m_canceled = true;
+    if (m_downloader)
+        m_downloader->Cancel();
+}
+
+/// Waits up to \p ms milliseconds for the download to end,
+/// returns true once it did
+bool HLSSegmentFetch::Wait(unsigned long ms)
+{
+    QMutexLocker lock(&m_lock);
+    if (!m_done)
+        m_waitcond.wait(&m_lock, ms);
+    return m_done;
+}
+
+bool HLSSegmentFetch::IsDone(void) const
+{
+    QMutexLocker lock(&m_lock);
+    return m_done;
+}
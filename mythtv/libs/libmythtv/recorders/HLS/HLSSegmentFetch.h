@@ -0,0 +1,56 @@
+#ifndef _HLS_Segment_Fetch_h_
+#define _HLS_Segment_Fetch_h_
+
+#include <QWaitCondition>
+#include <QByteArray>
+#include <QRunnable>
+#include <QString>
+#include <QMutex>
+
+#include "HLSSegment.h"
+
+class MythSingleDownload;
+
+/*
+  Download of one segment, run in the prefetch pool of HLSReader.
+
+  Each fetch has its own MythSingleDownload, so the next few segments
+  of the playlist can be downloading while the reader waits for the
+  first one, and it times its own transfer so the bandwidth can be
+  measured per segment even when downloads overlap.
+*/
+
+class HLSSegmentFetch : public QRunnable
+{
+  public:
+    HLSSegmentFetch(const HLSRecSegment& segment);
+    ~HLSSegmentFetch(void);
+
+    void run(void);
+    void Cancel(void);
+    bool Wait(unsigned long ms);
+
+    int64_t Sequence(void) const { return m_segment.Sequence(); }
+    bool IsDone(void) const;
+
+    // Only valid once Wait() returned true
+    bool       Succeeded(void) const { return m_ok; }
+    QByteArray Data(void) const { return m_data; }
+    uint64_t   DownloadDuration(void) const { return m_duration; } // ms
+    QString    ErrorString(void) const { return m_error; }
+
+  private:
+    HLSRecSegment       m_segment;
+    QByteArray          m_data;
+    bool                m_ok;
+    bool                m_done;
+    bool                m_canceled;
+    uint64_t            m_duration;
+    QString             m_error;
+
+    MythSingleDownload *m_downloader;
+    mutable QMutex      m_lock;
+    QWaitCondition      m_waitcond;
+};
+
+#endif
@@ -25,6 +25,7 @@
 #include "programinfo.h"
 #include "mythlogging.h"
 #include "mpegtables.h"
+#include "bytereader.h"
 #include "ringbuffer.h"
 #include "tv_rec.h"
 #include "mythsystemevent.h"
@@ -181,7 +182,7 @@ void DTVRecorder::ResetForNewFile(void)
     LOG(VB_RECORD, LOG_INFO, LOC + "ResetForNewFile(void)");
     QMutexLocker locker(&positionMapLock);
 
-    // _seen_psp and m_h264_parser should
+    // _seen_psp, m_h264_parser and m_hevc_parser should
     // not be reset here. This will only be called just as
     // we're seeing the first packet of a new keyframe for
     // writing to the new file and anything that makes the
@@ -455,7 +456,7 @@ bool DTVRecorder::FindMPEG2Keyframes(const TSPacket* tspacket)
 
     while (bufptr < bufend)
     {
-        bufptr = avpriv_find_start_code(bufptr, bufend, &_start_code);
+        bufptr = ByteReader::find_start_code(bufptr, bufend, &_start_code);
         bytes_left = bufend - bufptr;
         if ((_start_code & 0xffffff00) == 0x00000100)
         {
@@ -827,19 +828,24 @@ void DTVRecorder::HandleKeyframe(int64_t extra)
     positionMapLock.unlock();
 }
 
-/** \fn DTVRecorder::FindH264Keyframes(const TSPacket*)
+/** \fn DTVRecorder::FindNALKeyframes(const TSPacket*, bool)
  *  \brief This searches the TS packet to identify keyframes.
+ *
+ *   The NAL units of H.264 go to m_h264_parser, those of HEVC to
+ *   m_hevc_parser, where a keyframe is an IRAP picture.
+ *
  *  \param TSPacket Pointer the the TS packet data.
+ *  \param hevc     Whether the video is HEVC rather than H.264.
  *  \return Returns true if a keyframe has been found.
  */
-bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
+bool DTVRecorder::FindNALKeyframes(const TSPacket *tspacket, bool hevc)
 {
     if (!tspacket->HasPayload()) // no payload to scan
         return _first_keyframe >= 0;
 
     if (!ringBuffer)
     {
-        LOG(VB_GENERAL, LOG_ERR, LOC + "FindH264Keyframes: No ringbuffer");
+        LOG(VB_GENERAL, LOG_ERR, LOC + "FindNALKeyframes: No ringbuffer");
         return _first_keyframe >= 0;
     }
 
@@ -859,7 +865,7 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
     bool hasFrame = false;
     bool hasKeyFrame = false;
 
-    // scan for PES packets and H.264 NAL units
+    // scan for PES packets and H.264 or HEVC NAL units
     uint i = tspacket->AFCOffset();
     for (; i < TSPacket::kSize; ++i)
     {
@@ -929,14 +935,34 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
 
         // scan for a NAL unit start code
 
-        uint32_t bytes_used = m_h264_parser.addBytes
-                              (tspacket->data() + i, TSPacket::kSize - i,
-                               ringBuffer->GetWritePosition());
-        i += (bytes_used - 1);
+        if (hevc)
+        {
+            uint32_t bytes_used = m_hevc_parser.addBytes
+                                  (tspacket->data() + i, TSPacket::kSize - i,
+                                   ringBuffer->GetWritePosition());
+            i += (bytes_used - 1);
+
+            if (m_hevc_parser.stateChanged() && m_hevc_parser.onFrameStart())
+            {
+                hasKeyFrame = m_hevc_parser.onKeyFrameStart();
+                hasFrame = true;
+                _seen_sps |= hasKeyFrame;
 
-        if (m_h264_parser.stateChanged())
+                width = m_hevc_parser.pictureWidth();
+                height = m_hevc_parser.pictureHeight();
+                aspectRatio = m_hevc_parser.aspectRatio();
+                m_hevc_parser.getFrameRate(frameRate);
+            }
+        }
+        else
         {
-            if (m_h264_parser.onFrameStart() &&
+            uint32_t bytes_used = m_h264_parser.addBytes
+                                  (tspacket->data() + i, TSPacket::kSize - i,
+                                   ringBuffer->GetWritePosition());
+            i += (bytes_used - 1);
+
+            if (m_h264_parser.stateChanged() &&
+                m_h264_parser.onFrameStart() &&
                 m_h264_parser.FieldType() != H264Parser::FIELD_BOTTOM)
             {
                 hasKeyFrame = m_h264_parser.onKeyFrameStart();
@@ -951,6 +977,10 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
         }
     } // for (; i < TSPacket::kSize; ++i)
 
+    uint64_t keyframeOffset = (hevc) ?
+        m_hevc_parser.keyframeAUstreamOffset() :
+        m_h264_parser.keyframeAUstreamOffset();
+
     // If it has been more than 511 frames since the last keyframe,
     // pretend we have one.
     if (hasFrame && !hasKeyFrame &&
@@ -958,7 +988,7 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
     {
         hasKeyFrame = true;
         LOG(VB_RECORD, LOG_WARNING, LOC +
-            QString("FindH264Keyframes: %1 frames without a keyframe.")
+            QString("FindNALKeyframes: %1 frames without a keyframe.")
             .arg(_frames_seen_count - _last_keyframe_seen));
     }
 
@@ -970,10 +1000,10 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
             .arg(ringBuffer->GetWritePosition())
             .arg(_payload_buffer.size())
             .arg(ringBuffer->GetWritePosition() + _payload_buffer.size())
-            .arg(m_h264_parser.keyframeAUstreamOffset()));
+            .arg(keyframeOffset));
 
         _last_keyframe_seen = _frames_seen_count;
-        HandleH264Keyframe();
+        HandleNALKeyframe(keyframeOffset);
     }
 
     if (hasFrame)
@@ -983,7 +1013,7 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
             .arg(ringBuffer->GetWritePosition())
             .arg(_payload_buffer.size())
             .arg(ringBuffer->GetWritePosition() + _payload_buffer.size())
-            .arg(m_h264_parser.keyframeAUstreamOffset()));
+            .arg(keyframeOffset));
 
         _buffer_packets = false;  // We now know if this is a keyframe
         _frames_seen_count++;
@@ -1013,9 +1043,11 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
     if (frameRate.isNonzero() && frameRate != m_frameRate)
     {
         LOG(VB_RECORD, LOG_INFO, LOC +
-            QString("FindH264Keyframes: timescale: %1, tick: %2, framerate: %3")
-                      .arg( m_h264_parser.GetTimeScale() )
-                      .arg( m_h264_parser.GetUnitsInTick() )
+            QString("FindNALKeyframes: timescale: %1, tick: %2, framerate: %3")
+                      .arg( hevc ? m_hevc_parser.GetTimeScale() :
+                                   m_h264_parser.GetTimeScale() )
+                      .arg( hevc ? m_hevc_parser.GetUnitsInTick() :
+                                   m_h264_parser.GetUnitsInTick() )
                       .arg( frameRate.toDouble() * 1000 ) );
         m_frameRate = frameRate;
         FrameRateChange(frameRate.toDouble() * 1000, _frames_written_count);
@@ -1024,11 +1056,12 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
     return _seen_sps;
 }
 
-/** \fn DTVRecorder::HandleH264Keyframe(void)
+/** \fn DTVRecorder::HandleNALKeyframe(uint64_t)
  *  \brief This save the current frame to the position maps
  *         and handles ringbuffer switching.
+ *  \param au_offset Where the access unit of the keyframe starts.
  */
-void DTVRecorder::HandleH264Keyframe(void)
+void DTVRecorder::HandleNALKeyframe(uint64_t au_offset)
 {
     // Perform ringbuffer switch if needed.
     CheckForRingBufferSwitch();
@@ -1043,7 +1076,7 @@ void DTVRecorder::HandleH264Keyframe(void)
         SendMythSystemRecEvent("REC_STARTED_WRITING", curRecording);
     }
     else
-        startpos = m_h264_parser.keyframeAUstreamOffset();
+        startpos = au_offset;
 
     // Add key frame to position map
     positionMapLock.lock();
@@ -1078,7 +1111,7 @@ void DTVRecorder::FindPSKeyFrames(const uint8_t *buffer, uint len)
 
         const uint8_t *tmp = bufptr;
         bufptr =
-            avpriv_find_start_code(bufptr + skip, bufend, &_start_code);
+            ByteReader::find_start_code(bufptr + skip, bufend, &_start_code);
         _audio_bytes_remaining = 0;
         _other_bytes_remaining = 0;
         _video_bytes_remaining -= std::min(
@@ -1512,7 +1545,9 @@ bool DTVRecorder::ProcessVideoTSPacket(const TSPacket &tspacket)
 
     // Check for keyframes and count frames
     if (streamType == StreamID::H264Video)
-        FindH264Keyframes(&tspacket);
+        FindNALKeyframes(&tspacket, false);
+    else if (streamType == StreamID::H265Video)
+        FindNALKeyframes(&tspacket, true);
     else if (streamType != 0)
         FindMPEG2Keyframes(&tspacket);
     else
@@ -19,6 +19,7 @@ using namespace std;
 #include "streamlisteners.h"
 #include "recorderbase.h"
 #include "H264Parser.h"
+#include "HEVCParser.h"
 
 class MPEGStreamData;
 class TSPacket;
@@ -107,9 +108,9 @@ class DTVRecorder :
     // MPEG2 TS support
     bool FindMPEG2Keyframes(const TSPacket* tspacket);
 
-    // MPEG4 AVC / H.264 TS support
-    bool FindH264Keyframes(const TSPacket* tspacket);
-    void HandleH264Keyframe(void);
+    // MPEG4 AVC / H.264 and HEVC / H.265 TS support
+    bool FindNALKeyframes(const TSPacket* tspacket, bool hevc);
+    void HandleNALKeyframe(uint64_t au_offset);
 
     // MPEG2 PS support (Hauppauge PVR-x50/PVR-500)
     void FindPSKeyFrames(const uint8_t *buffer, uint len);
@@ -143,10 +144,11 @@ class DTVRecorder :
     int _progressive_sequence;
     int _repeat_pict;
 
-    // H.264 support
+    // H.264 and HEVC support
     bool _pes_synced;
     bool _seen_sps;
     H264Parser m_h264_parser;
+    HEVCParser m_hevc_parser;
 
     /// Wait for the a GOP/SEQ-start before sending data
     bool _wait_for_keyframe_option;
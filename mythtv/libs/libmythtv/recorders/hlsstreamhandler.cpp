@@ -9,13 +9,10 @@
 #include "hlsstreamhandler.h"
 #include "mythlogging.h"
 #include "recorders/HLS/HLSReader.h"
+#include "tspacket.h"
 
 #define LOC QString("HLSSH(%1): ").arg(_device)
 
-// BUFFER_SIZE is a multiple of TS_SIZE
-#define TS_SIZE     188
-#define BUFFER_SIZE (512 * TS_SIZE)
-
 QMap<QString,HLSStreamHandler*>  HLSStreamHandler::s_hlshandlers;
 QMap<QString,uint>               HLSStreamHandler::s_hlshandlers_refcnt;
 QMutex                           HLSStreamHandler::s_hlshandlers_lock;
@@ -98,7 +95,6 @@ HLSStreamHandler::HLSStreamHandler(const IPTVTuningData& tuning) :
     IPTVStreamHandler(tuning)
 {
     m_hls        = new HLSReader();
-    m_readbuffer = new uint8_t[BUFFER_SIZE];
     m_throttle   = true;
 }
 
@@ -107,7 +103,6 @@ HLSStreamHandler::~HLSStreamHandler(void)
     LOG(VB_CHANNEL, LOG_INFO, LOC + "dtor");
     Stop();
     delete m_hls;
-    delete[] m_readbuffer;
 }
 
 void HLSStreamHandler::run(void)
@@ -127,7 +122,8 @@ void HLSStreamHandler::run(void)
         return;
     m_hls->Throttle(false);
 
-    int remainder = 0;
+    QByteArray segment;
+    QByteArray left;
     while (_running_desired)
     {
         if (!m_hls->IsOpen(url))
@@ -146,10 +142,7 @@ void HLSStreamHandler::run(void)
             m_throttle = false;
         }
 
-        int size = m_hls->Read(&m_readbuffer[remainder],
-                               BUFFER_SIZE - remainder);
-
-        size += remainder;
+        int size = m_hls->ReadSegment(segment);
 
         if (size < 0)
         {
@@ -173,42 +166,52 @@ void HLSStreamHandler::run(void)
         }
         nil_cnt = 0;
 
-        if (m_readbuffer[0] != 0x47)
+        // Whole segments are processed in place. A packet split across
+        // two segments is completed in the small tail buffer first, if
+        // this segment carries on from where the last one stopped.
+        int offset = 0;
+        if (!left.isEmpty())
         {
-            LOG(VB_RECORD, LOG_INFO, LOC +
-                QString("Packet not starting with SYNC Byte (got 0x%1)")
-                .arg((char)m_readbuffer[0], 2, QLatin1Char('0')));
-            continue;
+            int need = TSPacket::kSize - left.size();
+            if (need < size && segment[need] == 0x47)
+            {
+                left.append(segment.constData(), need);
+                ProcessData(left.constData(), left.size());
+                offset = need;
+            }
+            else
+            {
+                LOG(VB_RECORD, LOG_INFO, LOC +
+                    QString("Dropping %1 bytes left from the last segment")
+                    .arg(left.size()));
+            }
+            left.clear();
         }
 
+        if (segment[offset] != 0x47)
         {
-            QMutexLocker locker(&_listener_lock);
-            HLSStreamHandler::StreamDataList::const_iterator sit;
-            sit = _stream_data_list.begin();
-            for (; sit != _stream_data_list.end(); ++sit)
-                remainder = sit.key()->ProcessData(m_readbuffer, size);
+            LOG(VB_RECORD, LOG_INFO, LOC +
+                QString("Packet not starting with SYNC Byte (got 0x%1)")
+                .arg((uchar)segment[offset], 2, 16, QLatin1Char('0')));
+            offset = segment.indexOf(0x47, offset);
+            if (offset < 0)
+                continue;
         }
 
+        int remainder = ProcessData(segment.constData() + offset,
+                                    size - offset);
+
         if (remainder > 0)
         {
-            if (size > remainder) // unprocessed bytes
-                memmove(m_readbuffer, &(m_readbuffer[size - remainder]),
-                        remainder);
-
             LOG(VB_RECORD, LOG_INFO, LOC +
                 QString("data_length = %1 remainder = %2")
-                .arg(size).arg(remainder));
+                .arg(size - offset).arg(remainder));
+            if (remainder < (int)TSPacket::kSize)
+                left = segment.right(remainder);
         }
 
         if (m_hls->IsThrottled())
             usleep(999999);
-        else if (size < BUFFER_SIZE)
-        {
-            LOG(VB_RECORD, LOG_DEBUG, LOC +
-                QString("Requested %1 bytes, got %2 bytes.")
-                .arg(BUFFER_SIZE).arg(size));
-            usleep(10000); // hundredth of a second.
-        }
         else
             usleep(1000);
     }
@@ -220,3 +223,16 @@ void HLSStreamHandler::run(void)
 
     LOG(VB_GENERAL, LOG_INFO, LOC + "run() -- done");
 }
+
+/// Hands the data to every listener, returns the bytes left unprocessed
+int HLSStreamHandler::ProcessData(const char *data, int len)
+{
+    QMutexLocker locker(&_listener_lock);
+    int remainder = 0;
+    HLSStreamHandler::StreamDataList::const_iterator sit;
+    sit = _stream_data_list.begin();
+    for (; sit != _stream_data_list.end(); ++sit)
+        remainder = sit.key()->ProcessData(
+            reinterpret_cast<const uint8_t*>(data), len);
+    return remainder;
+}
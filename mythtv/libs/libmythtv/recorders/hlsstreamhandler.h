@@ -33,9 +33,10 @@ class HLSStreamHandler : public IPTVStreamHandler
 
     virtual void run(void); // MThread
 
+    int ProcessData(const char *data, int len);
+
   protected:
     HLSReader*     m_hls;
-    uint8_t*       m_readbuffer;
     bool           m_throttle;
 
     // for implementing Get & Return
@@ -28,6 +28,15 @@
 
 #define LOC QString("IPTVSH(%1): ").arg(_device)
 
+/// Datagrams read by each recvmmsg() call
+static const int kRecvBatch       = 64;
+/// Initial size of the receive buffers, an Ethernet MTU
+static const int kMinDatagramSize = 1500;
+/// Largest receive buffers, enough for jumbo frames
+static const int kMaxDatagramSize = 9000;
+/// Interval between statistics in the log, in milliseconds
+static const int kStatsInterval   = 60 * 1000;
+
 QMap<QString,IPTVStreamHandler*> IPTVStreamHandler::s_iptvhandlers;
 QMap<QString,uint>               IPTVStreamHandler::s_iptvhandlers_refcnt;
 QMutex                           IPTVStreamHandler::s_iptvhandlers_lock;
@@ -222,8 +231,6 @@ void IPTVStreamHandler::run(void)
             // the requested server
             m_sender[i] = dest_addr;
         }
-        m_read_helpers[i] = new IPTVStreamHandlerReadHelper(
-            this, m_sockets[i], i);
 
         // we need to open the descriptor ourselves so we
         // can set some socket options
@@ -237,14 +244,41 @@ void IPTVStreamHandler::run(void)
         int buf_size = 2 * 1024 * max(tuning.GetBitrate(i)/1000, 500U);
         if (!tuning.GetBitrate(i))
             buf_size = 2 * 1024 * 1024;
-        int err = setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
-                            (char *)&buf_size, sizeof(buf_size));
+        int err = -1;
+#ifdef SO_RCVBUFFORCE
+        // Not limited by net.core.rmem_max, but needs CAP_NET_ADMIN
+        err = setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE,
+                         (char *)&buf_size, sizeof(buf_size));
+#endif
+        if (err)
+        {
+            err = setsockopt(fd, SOL_SOCKET, SO_RCVBUF,
+                             (char *)&buf_size, sizeof(buf_size));
+        }
         if (err)
         {
             LOG(VB_GENERAL, LOG_INFO, LOC +
                 QString("Increasing buffer size to %1 failed")
                 .arg(buf_size) + ENO);
         }
+        else
+        {
+            int actual = 0;
+            socklen_t len = sizeof(actual);
+            if (!getsockopt(fd, SOL_SOCKET, SO_RCVBUF,
+                            (char *)&actual, &len) && actual < buf_size)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    QString("Socket buffer is %1 bytes instead of %2, "
+                            "raise net.core.rmem_max to avoid losing "
+                            "packets").arg(actual).arg(buf_size));
+            }
+        }
+#ifdef SO_RXQ_OVFL
+        // Have the kernel tell how many datagrams it dropped
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, (char *)&on, sizeof(on));
+#endif
 
         m_sockets[i]->setSocketDescriptor(
             fd, QAbstractSocket::UnconnectedState, QIODevice::ReadOnly);
@@ -275,6 +309,9 @@ void IPTVStreamHandler::run(void)
         {
             m_rtcp_dest = dest_addr;
         }
+
+        m_read_helpers[i] = new IPTVStreamHandlerReadHelper(
+            this, m_sockets[i], i);
     }
 
     if (!error)
@@ -338,69 +375,234 @@ void IPTVStreamHandler::run(void)
     RunEpilog();
 }
 
+/// Tracks an RTP sequence number, a packet older than the one expected
+/// was counted as lost when the gap was seen and is now counted as late
+void IPTVStreamStats::AddSequenceNumber(uint seq)
+{
+    if (!m_seq_init)
+    {
+        m_seq_init = true;
+        m_expected_seq = seq + 1;
+        return;
+    }
+
+    int16_t delta = (int16_t)(uint16_t)(seq - m_expected_seq);
+    if (delta >= 0)
+    {
+        lost += delta;
+        m_expected_seq = seq + 1;
+    }
+    else
+    {
+        reordered++;
+        if (lost)
+            lost--;
+    }
+}
+
+QString IPTVStreamStats::toString(void) const
+{
+    return QString("%1 packets, %2 KB, %3 dropped by the kernel, "
+                   "%4 truncated, %5 lost, %6 out of order")
+        .arg(packets).arg(bytes / 1024).arg(dropped).arg(truncated)
+        .arg(lost).arg(reordered);
+}
+
 IPTVStreamHandlerReadHelper::IPTVStreamHandlerReadHelper(
     IPTVStreamHandler *p, QUdpSocket *s, uint stream) :
     m_parent(p), m_socket(s), m_sender(p->m_sender[stream]),
     m_stream(stream)
+#ifdef IPTV_RECVMMSG
+    , m_datagram_size(kMinDatagramSize)
+#endif
 {
     connect(m_socket, SIGNAL(readyRead()),
             this,     SLOT(ReadPending()));
+    m_stats_timer.start();
+}
+
+IPTVStreamHandlerReadHelper::~IPTVStreamHandlerReadHelper()
+{
+    if (m_stats.packets)
+        LogStats();
 }
 
 #define LOC_WH QString("IPTVSH(%1): ").arg(m_parent->_device)
 
 void IPTVStreamHandlerReadHelper::ReadPending(void)
+{
+#ifdef IPTV_RECVMMSG
+    // QUdpSocket only signals readyRead again once readDatagram() was
+    // called, so the first datagram is read through it and recvmmsg()
+    // takes the rest
+    if (m_socket->hasPendingDatagrams())
+        ReadDatagram();
+    ReadBatch();
+#else
+    while (m_socket->hasPendingDatagrams())
+        ReadDatagram();
+#endif
+
+    if (m_stats_timer.elapsed() >= kStatsInterval)
+    {
+        LogStats();
+        m_stats_timer.restart();
+    }
+}
+
+void IPTVStreamHandlerReadHelper::ReadDatagram(void)
 {
     QHostAddress sender;
     quint16 senderPort;
+
+    UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
+    QByteArray &data = packet.GetDataReference();
+    data.resize(m_socket->pendingDatagramSize());
+#ifdef IPTV_RECVMMSG
+    m_datagram_size = min(max(m_datagram_size, data.size()),
+                          kMaxDatagramSize);
+#endif
+    m_socket->readDatagram(data.data(), data.size(),
+                           &sender, &senderPort);
+    Push(packet, sender);
+}
+
+#ifdef IPTV_RECVMMSG
+/// Reads all the pending datagrams, kRecvBatch at a time, straight into
+/// empty packets of the PacketBuffer
+void IPTVStreamHandlerReadHelper::ReadBatch(void)
+{
+    struct mmsghdr          msgs[kRecvBatch];
+    struct iovec            iovs[kRecvBatch];
+    struct sockaddr_storage addrs[kRecvBatch];
+    char control[kRecvBatch][CMSG_SPACE(sizeof(uint32_t))];
+
+    int fd = m_socket->socketDescriptor();
     bool sender_null = m_sender.isNull();
 
-    if (0 == m_stream)
+    while (true)
     {
-        while (m_socket->hasPendingDatagrams())
+        if (m_slab.empty())
         {
-            UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
-            QByteArray &data = packet.GetDataReference();
-            data.resize(m_socket->pendingDatagramSize());
-            m_socket->readDatagram(data.data(), data.size(),
-                                   &sender, &senderPort);
-            if (sender_null || sender == m_sender)
-            {
-                m_parent->m_buffer->PushDataPacket(packet);
-            }
-            else
+            for (int i = 0; i < kRecvBatch; i++)
+                m_slab.push_back(m_parent->m_buffer->GetEmptyPacket());
+        }
+
+        for (int i = 0; i < kRecvBatch; i++)
+        {
+            QByteArray &data = m_slab[i].GetDataReference();
+            if (data.size() < m_datagram_size)
+                data.resize(m_datagram_size);
+
+            iovs[i].iov_base = data.data();
+            iovs[i].iov_len  = data.size();
+
+            memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_iov        = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen     = 1;
+            msgs[i].msg_hdr.msg_name       = sender_null ? NULL : &addrs[i];
+            msgs[i].msg_hdr.msg_namelen    = sender_null ? 0 : sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_control    = control[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+        }
+
+        // With MSG_TRUNC msg_len is the size of the datagram even when
+        // it did not fit
+        int count = recvmmsg(fd, msgs, kRecvBatch,
+                             MSG_DONTWAIT | MSG_TRUNC, NULL);
+        if (count < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
             {
-                LOG(VB_RECORD, LOG_WARNING, LOC_WH +
-                    QString("Received on socket(%1) %2 bytes from non expected "
-                            "sender:%3 (expected:%4) ignoring")
-                    .arg(m_stream).arg(data.size())
-                    .arg(sender.toString()).arg(m_sender.toString()));
+                LOG(VB_RECORD, LOG_ERR, LOC_WH +
+                    QString("Reading socket(%1) failed").arg(m_stream) + ENO);
             }
+            return;
         }
-    }
-    else
-    {
-        while (m_socket->hasPendingDatagrams())
+
+        for (int i = 0; i < count; i++)
         {
-            UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
-            QByteArray &data = packet.GetDataReference();
-            data.resize(m_socket->pendingDatagramSize());
-            m_socket->readDatagram(data.data(), data.size(),
-                                   &sender, &senderPort);
-            if (sender_null || sender == m_sender)
+            UDPPacket packet(m_slab[i]);
+            m_slab[i] = m_parent->m_buffer->GetEmptyPacket();
+
+            struct msghdr &hdr = msgs[i].msg_hdr;
+#ifdef SO_RXQ_OVFL
+            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg;
+                 cmsg = CMSG_NXTHDR(&hdr, cmsg))
             {
-                m_parent->m_buffer->PushFECPacket(packet, m_stream - 1);
+                if (cmsg->cmsg_level == SOL_SOCKET &&
+                    cmsg->cmsg_type  == SO_RXQ_OVFL)
+                {
+                    uint32_t dropped;
+                    memcpy(&dropped, CMSG_DATA(cmsg), sizeof(dropped));
+                    m_stats.dropped = dropped;
+                }
             }
-            else
+#endif
+
+            if (hdr.msg_flags & MSG_TRUNC)
             {
-                LOG(VB_RECORD, LOG_WARNING, LOC_WH +
-                    QString("Received on socket(%1) %2 bytes from non expected "
-                            "sender:%3 (expected:%4) ignoring")
-                    .arg(m_stream).arg(data.size())
-                    .arg(sender.toString()).arg(m_sender.toString()));
+                // Receive the next ones whole
+                m_datagram_size = min(max(m_datagram_size,
+                                          (int)msgs[i].msg_len),
+                                      kMaxDatagramSize);
+                m_stats.truncated++;
+                m_parent->m_buffer->FreePacket(packet);
+                continue;
             }
+
+            packet.GetDataReference().resize(msgs[i].msg_len);
+
+            QHostAddress sender;
+            if (!sender_null)
+                sender.setAddress(reinterpret_cast<sockaddr*>(&addrs[i]));
+            Push(packet, sender);
+        }
+
+        // A short batch means the socket is empty
+        if (count < kRecvBatch)
+            return;
+    }
+}
+#endif // IPTV_RECVMMSG
+
+void IPTVStreamHandlerReadHelper::Push(const UDPPacket &packet,
+                                       const QHostAddress &sender)
+{
+    if (!m_sender.isNull() && sender != m_sender)
+    {
+        LOG(VB_RECORD, LOG_WARNING, LOC_WH +
+            QString("Received on socket(%1) %2 bytes from non expected "
+                    "sender:%3 (expected:%4) ignoring")
+            .arg(m_stream).arg(packet.GetData().size())
+            .arg(sender.toString()).arg(m_sender.toString()));
+        m_parent->m_buffer->FreePacket(packet);
+        return;
+    }
+
+    const QByteArray data = packet.GetData();
+    m_stats.packets++;
+    m_stats.bytes += data.size();
+
+    if (0 == m_stream)
+    {
+        if (m_parent->m_use_rtp_streaming && data.size() >= 12)
+        {
+            m_stats.AddSequenceNumber(
+                (uint8_t)data[2] << 8 | (uint8_t)data[3]);
         }
+        m_parent->m_buffer->PushDataPacket(packet);
     }
+    else
+    {
+        m_parent->m_buffer->PushFECPacket(packet, m_stream - 1);
+    }
+}
+
+void IPTVStreamHandlerReadHelper::LogStats(void)
+{
+    LOG(VB_RECORD, LOG_INFO, LOC_WH + QString("Socket(%1): %2")
+        .arg(m_stream).arg(m_stats.toString()));
 }
 
 IPTVStreamHandlerWriteHelper::IPTVStreamHandlerWriteHelper(IPTVStreamHandler *p)
@@ -6,6 +6,7 @@
 #include <vector>
 using namespace std;
 
+#include <QElapsedTimer>
 #include <QHostAddress>
 #include <QUdpSocket>
 #include <QString>
@@ -14,16 +15,49 @@ using namespace std;
 
 #include "channelutil.h"
 #include "streamhandler.h"
+#include "udppacket.h"
 
 #define IPTV_SOCKET_COUNT   3
 #define RTCP_TIMER          10
 
+// Receive many datagrams per system call with recvmmsg()
+#ifdef __linux__
+#define IPTV_RECVMMSG       1
+#endif
+
 class IPTVStreamHandler;
 class DTVSignalMonitor;
 class MPEGStreamData;
 class PacketBuffer;
 class IPTVChannel;
 
+/// Receive statistics of one socket of an IPTVStreamHandler
+class IPTVStreamStats
+{
+  public:
+    IPTVStreamStats() :
+        packets(0), bytes(0), dropped(0), truncated(0), lost(0),
+        reordered(0), m_seq_init(false), m_expected_seq(0) {}
+
+    void AddSequenceNumber(uint seq);
+    QString toString(void) const;
+
+    uint64_t packets;
+    uint64_t bytes;
+    /// Datagrams the kernel dropped because the socket buffer was full
+    uint64_t dropped;
+    /// Datagrams larger than the receive buffers
+    uint64_t truncated;
+    /// RTP packets missing from the sequence, less those that came late
+    uint64_t lost;
+    /// RTP packets received after a later one
+    uint64_t reordered;
+
+  private:
+    bool     m_seq_init;
+    uint16_t m_expected_seq;
+};
+
 class IPTVStreamHandlerReadHelper : QObject
 {
     Q_OBJECT
@@ -31,15 +65,32 @@ class IPTVStreamHandlerReadHelper : QObject
   public:
     IPTVStreamHandlerReadHelper(
         IPTVStreamHandler *p, QUdpSocket *s, uint stream);
+    ~IPTVStreamHandlerReadHelper();
 
   public slots:
     void ReadPending(void);
 
+  private:
+    void ReadDatagram(void);
+    void ReadBatch(void);
+    void Push(const UDPPacket &packet, const QHostAddress &sender);
+    void LogStats(void);
+
   private:
     IPTVStreamHandler *m_parent;
     QUdpSocket *m_socket;
     QHostAddress m_sender;
     uint m_stream;
+
+    IPTVStreamStats m_stats;
+    QElapsedTimer m_stats_timer;
+
+#ifdef IPTV_RECVMMSG
+    /// Empty packets from the PacketBuffer, received into in place
+    vector<UDPPacket> m_slab;
+    /// Size of the receive buffers, the largest datagram seen so far
+    int m_datagram_size;
+#endif
 };
 
 class IPTVStreamHandlerWriteHelper : QObject
@@ -0,0 +1,280 @@
+// C++ headers
+#include <algorithm>
+using namespace std;
+
+// Qt headers
+#include <QStringList>
+
+// MythTV headers
+#include "positionmapwriter.h"
+#include "programinfo.h"
+#include "mythlogging.h"
+#include "mythdb.h"
+
+#define LOC QString("PosMapWriter: ")
+
+PositionMapWriter *PositionMapWriter::s_writer = NULL;
+
+const uint PositionMapWriter::kBatchWindow      = 500;
+const uint PositionMapWriter::kMaxRowsPerInsert = 2000;
+const uint PositionMapWriter::kMaxPendingRows   = 100000;
+const uint PositionMapWriter::kLagWarning       = 2000;
+const uint PositionMapWriter::kSummaryInterval  = 60 * 1000;
+
+void PositionMapWriter::CreatePositionMapWriter(void)
+{
+    if (s_writer)
+        return;
+
+    s_writer = new PositionMapWriter();
+    s_writer->start();
+}
+
+/** \brief Writes out everything still queued and stops the writer.
+ *
+ *  Must only be called once no recorder can call Get() anymore, i.e.
+ *  after all TVRec instances have been deleted.
+ */
+void PositionMapWriter::TeardownPositionMapWriter(void)
+{
+    if (!s_writer)
+        return;
+
+    {
+        QMutexLocker locker(&s_writer->m_lock);
+        s_writer->m_stop = true;
+        s_writer->m_wait.wakeAll();
+    }
+    s_writer->wait();
+    delete s_writer;
+    s_writer = NULL;
+}
+
+PositionMapWriter::PositionMapWriter() :
+    MThread("PositionMapWriter"),
+    m_stop(false), m_flushRequests(0), m_pendingRows(0)
+{
+}
+
+PositionMapWriter::~PositionMapWriter()
+{
+    wait();
+}
+
+/** \brief Queues a position or duration map delta of a recording.
+ *
+ *  Maps which are not stored in recordedseek, e.g. those of videos or
+ *  of a transcode in progress, are saved directly.
+ *
+ *  \return false if the writer is stopping or already has too many rows
+ *          queued, in which case the caller should keep the delta and
+ *          offer it again later.
+ */
+bool PositionMapWriter::Enqueue(uint inputid, const ProgramInfo &pginfo,
+                                MarkTypes type, const frm_pos_map_t &delta)
+{
+    if (delta.empty())
+        return true;
+
+    if (!pginfo.IsRecording() || pginfo.HasPositionMapDBReplacement())
+    {
+        frm_pos_map_t copy(delta);
+        pginfo.SavePositionMapDelta(copy, type);
+        return true;
+    }
+
+    QMutexLocker locker(&m_lock);
+
+    if (m_stop)
+        return false;
+
+    if (m_pendingRows + delta.size() > kMaxPendingRows)
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("Deferring %1 rows from input %2, %3 rows queued")
+                .arg(delta.size()).arg(inputid).arg(m_pendingRows));
+        return false;
+    }
+
+    Batch batch;
+    batch.inputid    = inputid;
+    batch.chanid     = pginfo.GetChanID();
+    batch.recstartts = pginfo.GetRecordingStartTime();
+    batch.type       = type;
+    batch.delta      = delta;
+    batch.queued.start();
+    m_queue.push_back(batch);
+
+    m_pendingRows += delta.size();
+    m_stats[inputid].pending += delta.size();
+    m_wait.wakeAll();
+
+    return true;
+}
+
+/** \brief Blocks until everything queued for an input has been written.
+ *
+ *  This also cuts the batching window short, so it is cheap to call
+ *  when a recording is finished or switched to the next one.
+ */
+void PositionMapWriter::Flush(uint inputid)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_flushRequests++;
+    m_wait.wakeAll();
+
+    while (m_stats.value(inputid).pending)
+        m_written.wait(&m_lock);
+
+    m_flushRequests--;
+}
+
+void PositionMapWriter::run(void)
+{
+    RunProlog();
+
+    QMutexLocker locker(&m_lock);
+    m_summaryTimer.start();
+
+    while (!m_stop || !m_queue.empty())
+    {
+        if (m_queue.empty())
+        {
+            m_wait.wait(&m_lock);
+            continue;
+        }
+
+        // Give the other recorders a chance to add their deltas,
+        // unless someone is waiting for the data to hit the database.
+        MythTimer window;
+        window.start();
+        while (!m_stop && !m_flushRequests &&
+               (uint)window.elapsed() < kBatchWindow)
+        {
+            m_wait.wait(&m_lock, kBatchWindow - window.elapsed());
+        }
+
+        QList<Batch> batches;
+        batches.swap(m_queue);
+
+        locker.unlock();
+        bool ok = WriteBatches(batches);
+        locker.relock();
+
+        QList<Batch>::const_iterator it = batches.begin();
+        for (; it != batches.end(); ++it)
+        {
+            InputStats &stats = m_stats[(*it).inputid];
+            uint lag = (*it).queued.elapsed();
+
+            stats.pending -= (*it).delta.size();
+            stats.writes++;
+            stats.lastLag  = lag;
+            stats.maxLag   = max(stats.maxLag, lag);
+            m_pendingRows -= (*it).delta.size();
+
+            if (lag > kLagWarning)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    QString("Seek table of input %1 written %2 ms late "
+                            "(max %3 ms)")
+                        .arg((*it).inputid).arg(lag).arg(stats.maxLag));
+            }
+        }
+
+        LOG(VB_RECORD, LOG_DEBUG, LOC +
+            QString("Wrote %1 deltas, %2 rows still queued%3")
+                .arg(batches.size()).arg(m_pendingRows)
+                .arg(ok ? "" : ", some rows were lost"));
+
+        if ((uint)m_summaryTimer.elapsed() >= kSummaryInterval)
+            LogSummary();
+
+        m_written.wakeAll();
+    }
+
+    RunEpilog();
+}
+
+/// Logs the write lag of each input which wrote since the last summary,
+/// and starts the maximum lag over. Must be called with m_lock held.
+void PositionMapWriter::LogSummary(void)
+{
+    QMap<uint,InputStats>::iterator it = m_stats.begin();
+    while (it != m_stats.end())
+    {
+        if (!(*it).writes && !(*it).pending)
+        {
+            it = m_stats.erase(it);
+            continue;
+        }
+
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("Input %1: %2 deltas written, %3 rows queued, "
+                    "lag %4 ms (max %5 ms)")
+                .arg(it.key()).arg((*it).writes).arg((*it).pending)
+                .arg((*it).lastLag).arg((*it).maxLag));
+
+        (*it).writes = 0;
+        (*it).maxLag = 0;
+        ++it;
+    }
+
+    m_summaryTimer.start();
+}
+
+/// Writes the deltas using multi-row inserts of up to kMaxRowsPerInsert rows
+bool PositionMapWriter::WriteBatches(const QList<Batch> &batches)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    bool ok = true;
+
+    QStringList q;
+    uint rows = 0;
+
+    QList<Batch>::const_iterator it = batches.begin();
+    for (; it != batches.end(); ++it)
+    {
+        QString qfields = QString("(%1,'%2',%3,")
+            .arg((*it).chanid)
+            .arg((*it).recstartts.toString(Qt::ISODate))
+            .arg((*it).type);
+
+        frm_pos_map_t::const_iterator dit = (*it).delta.begin();
+        for (; dit != (*it).delta.end(); ++dit)
+        {
+            if (rows)
+                q << ",";
+            else
+                q << "INSERT INTO recordedseek "
+                     "(chanid, starttime, type, mark, offset) VALUES ";
+
+            q << qfields << QString("%1,%2)").arg(dit.key()).arg(*dit);
+
+            if (++rows >= kMaxRowsPerInsert)
+            {
+                query.prepare(q.join(""));
+                if (!query.exec())
+                {
+                    MythDB::DBError("batched position map insert", query);
+                    ok = false;
+                }
+                q.clear();
+                rows = 0;
+            }
+        }
+    }
+
+    if (rows)
+    {
+        query.prepare(q.join(""));
+        if (!query.exec())
+        {
+            MythDB::DBError("batched position map insert", query);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
@@ -0,0 +1,103 @@
+// -*- Mode: c++ -*-
+#ifndef _POSITION_MAP_WRITER_H_
+#define _POSITION_MAP_WRITER_H_
+
+// Qt headers
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QMutex>
+#include <QList>
+#include <QMap>
+
+// MythTV headers
+#include "programtypes.h"               // for frm_pos_map_t, MarkTypes
+#include "mythtvexp.h"
+#include "mythtimer.h"
+#include "mthread.h"
+
+class ProgramInfo;
+
+/** \class PositionMapWriter
+ *  \brief Backend wide writer for recorder seek table updates.
+ *
+ *  Recorders hand their position and duration map deltas to this
+ *  service instead of writing them to the recordedseek table from
+ *  their own threads. The deltas of all recorders are collected for a
+ *  short batching window and then written with a few large multi-row
+ *  inserts over a single database connection, so a dozen recordings
+ *  starting on the hour no longer cause a dozen concurrent inserts
+ *  every few seconds.
+ *
+ *  When too many rows are queued Enqueue() refuses the delta and the
+ *  recorder keeps it until its next save. The time from queueing to the
+ *  completed insert is tracked per input as the write lag, and logged
+ *  with the queued rows once a minute while recorders are writing.
+ */
+class MTV_PUBLIC PositionMapWriter : public MThread
+{
+  public:
+    static void CreatePositionMapWriter(void);
+    static void TeardownPositionMapWriter(void);
+    static PositionMapWriter *Get(void) { return s_writer; }
+
+    bool Enqueue(uint inputid, const ProgramInfo &pginfo,
+                 MarkTypes type, const frm_pos_map_t &delta);
+    void Flush(uint inputid);
+
+  protected:
+    virtual void run(void); // MThread
+
+  private:
+    PositionMapWriter();
+    ~PositionMapWriter();
+
+    class Batch
+    {
+      public:
+        Batch() : inputid(0), chanid(0), type(MARK_UNSET) {}
+        uint           inputid;
+        uint           chanid;
+        QDateTime      recstartts;
+        MarkTypes      type;
+        frm_pos_map_t  delta;
+        MythTimer      queued;
+    };
+
+    class InputStats
+    {
+      public:
+        InputStats() : pending(0), writes(0), lastLag(0), maxLag(0) {}
+        uint pending;
+        uint writes;  ///< deltas written since the last summary
+        uint lastLag;
+        uint maxLag;  ///< largest lag since the last summary
+    };
+
+    bool WriteBatches(const QList<Batch> &batches);
+    void LogSummary(void);
+
+    mutable QMutex         m_lock;
+    QWaitCondition         m_wait;
+    QWaitCondition         m_written;
+    bool                   m_stop;
+    uint                   m_flushRequests;
+    uint                   m_pendingRows;
+    QList<Batch>           m_queue;
+    QMap<uint,InputStats>  m_stats;
+    MythTimer              m_summaryTimer;
+
+    static PositionMapWriter *s_writer;
+
+    /// Time the writer waits for other recorders to add their deltas
+    static const uint kBatchWindow;
+    /// Maximum number of rows sent in a single insert statement
+    static const uint kMaxRowsPerInsert;
+    /// Queued rows above which recorders are asked to hold their deltas
+    static const uint kMaxPendingRows;
+    /// Write lag in milliseconds above which a warning is logged
+    static const uint kLagWarning;
+    /// Milliseconds between the logged summaries of the write lag
+    static const uint kSummaryInterval;
+};
+
+#endif // _POSITION_MAP_WRITER_H_
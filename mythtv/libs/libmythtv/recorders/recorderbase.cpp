@@ -14,6 +14,7 @@ using namespace std;
 #include "iptvrecorder.h"
 #include "mpegrecorder.h"
 #include "recorderbase.h"
+#include "positionmapwriter.h"
 #include "cetonchannel.h"
 #include "asirecorder.h"
 #include "dvbrecorder.h"
@@ -579,6 +580,9 @@ bool RecorderBase::GetKeyframeDurations(
  *         is true or there are 30 frames in the map or there are five
  *         frames in the map with less than 30 frames in the non-delta
  *         position map.
+ *
+ *         When the backend runs a PositionMapWriter the deltas are handed
+ *         to it and written together with those of the other recorders.
  *  \param force If true this forces a DB sync.
  */
 void RecorderBase::SavePositionMap(bool force, bool finished)
@@ -613,9 +617,44 @@ void RecorderBase::SavePositionMap(bool force, bool finished)
             durationMapDelta.clear();
             positionMapLock.unlock();
 
-            curRecording->SavePositionMapDelta(deltaCopy, positionMapType);
-            curRecording->SavePositionMapDelta(durationDeltaCopy,
-                                               MARK_DURATION_MS);
+            uint inputid = tvrec ? tvrec->GetCaptureCardNum() : 0;
+            PositionMapWriter *writer = PositionMapWriter::Get();
+
+            bool pos_queued = writer &&
+                writer->Enqueue(inputid, *curRecording,
+                                positionMapType, deltaCopy);
+            bool dur_queued = pos_queued &&
+                writer->Enqueue(inputid, *curRecording,
+                                MARK_DURATION_MS, durationDeltaCopy);
+
+            if (writer && !dur_queued && !force)
+            {
+                // Back-pressure from the writer, keep what it refused
+                // and offer it again once the save interval has passed.
+                QMutexLocker locker(&positionMapLock);
+                frm_pos_map_t::const_iterator it;
+                if (!pos_queued)
+                {
+                    for (it = deltaCopy.begin(); it != deltaCopy.end(); ++it)
+                        positionMapDelta.insert(it.key(), *it);
+                }
+                for (it = durationDeltaCopy.begin();
+                     it != durationDeltaCopy.end(); ++it)
+                {
+                    durationMapDelta.insert(it.key(), *it);
+                }
+                return;
+            }
+
+            // Without a writer, or if it is saturated while the caller
+            // needs the maps in the database now, write them ourselves.
+            if (writer && force)
+                writer->Flush(inputid);
+            if (!pos_queued)
+                curRecording->SavePositionMapDelta(deltaCopy, positionMapType);
+            if (!dur_queued)
+                curRecording->SavePositionMapDelta(durationDeltaCopy,
+                                                   MARK_DURATION_MS);
 
             TryWriteProgStartMark(durationDeltaCopy);
         }
@@ -0,0 +1,215 @@
+// C++ headers
+#include <algorithm>
+#include <cstring>
+using namespace std;
+
+// Qt headers
+#include <QFileInfo>
+
+// MythTV headers
+#include "recordingtap.h"
+#include "mythlogging.h"
+
+#define LOC QString("RecordingTap(%1): ").arg(m_key)
+
+#define TAP_MAGIC 0x4d545450 // "MTTP"
+
+/// Start of the shared memory, the ring follows it
+struct RecordingTapHeader
+{
+    quint32 magic;
+    quint32 size;
+    qint64  written;
+};
+
+const uint RecordingTap::kPublishSize = 64 * 1024;
+
+RecordingTap::RecordingTap(const QString &filename) :
+    m_key(QString("mythtv-recordingtap-%1")
+          .arg(QFileInfo(filename).fileName())),
+    m_writer(false), m_data(NULL), m_size(0),
+    m_written(0), m_published(0)
+{
+    m_shm.setKey(m_key);
+}
+
+RecordingTap::~RecordingTap()
+{
+    if (m_writer && m_data)
+        Finish();
+}
+
+/** \brief Creates the ring for the recorder, \p size bytes behind the
+ *         last byte written stay readable.
+ */
+bool RecordingTap::Create(uint size)
+{
+    if (size <= kPublishSize)
+        return false;
+
+    int total = sizeof(RecordingTapHeader) + size;
+    if (!m_shm.create(total))
+    {
+        // Left behind by a backend that did not get to clean up
+        if (m_shm.error() != QSharedMemory::AlreadyExists ||
+            !m_shm.attach() || m_shm.size() < total)
+        {
+            LOG(VB_RECORD, LOG_ERR, LOC + "Could not create the tap: " +
+                m_shm.errorString());
+            m_shm.detach();
+            return false;
+        }
+    }
+
+    m_shm.lock();
+    RecordingTapHeader *header = (RecordingTapHeader*)m_shm.data();
+    header->magic    = TAP_MAGIC;
+    header->size     = size;
+    header->written  = 0;
+    m_shm.unlock();
+
+    m_writer    = true;
+    m_data      = (char*)m_shm.data() + sizeof(RecordingTapHeader);
+    m_size      = size;
+    m_written   = 0;
+    m_published = 0;
+
+    LOG(VB_RECORD, LOG_INFO, LOC + QString("Sharing the last %1 MB written")
+        .arg(size >> 20));
+    return true;
+}
+
+/** \brief Copies what the recorder wrote into the ring.
+ *
+ *  Readers only trust the ring kPublishSize bytes further back than
+ *  what was published, as the writer may have overwritten that much
+ *  since, so it never runs further ahead than that unpublished.
+ */
+void RecordingTap::Write(const void *data, uint sz)
+{
+    if (!m_writer || !m_data)
+        return;
+
+    const char *src = (const char*)data;
+    while (sz)
+    {
+        uint pending = m_written - m_published;
+        uint offset  = m_written % m_size;
+        uint chunk   = min(min(sz, kPublishSize - pending), m_size - offset);
+
+        memcpy(m_data + offset, src, chunk);
+        m_written += chunk;
+        src       += chunk;
+        sz        -= chunk;
+
+        if (m_written - m_published >= kPublishSize)
+            Publish();
+    }
+}
+
+/// Makes everything written so far readable
+void RecordingTap::Flush(void)
+{
+    if (m_writer && m_data && m_written != m_published)
+        Publish();
+}
+
+/// Makes the rest readable, nothing more is written after this
+void RecordingTap::Finish(void)
+{
+    if (!m_writer || !m_data)
+        return;
+
+    Publish();
+    m_data = NULL;
+    LOG(VB_RECORD, LOG_INFO, LOC + QString("Finished after %1 bytes")
+        .arg(m_written));
+}
+
+void RecordingTap::Publish(void)
+{
+    m_shm.lock();
+    RecordingTapHeader *header = (RecordingTapHeader*)m_shm.data();
+    header->written = m_written;
+    m_shm.unlock();
+
+    m_published = m_written;
+}
+
+/// Attaches to the ring of a recording in progress on this host
+bool RecordingTap::Attach(void)
+{
+    if (!m_shm.attach(QSharedMemory::ReadOnly))
+    {
+        LOG(VB_FILE, LOG_INFO, LOC + "No tap for this recording: " +
+            m_shm.errorString());
+        return false;
+    }
+
+    m_shm.lock();
+    const RecordingTapHeader *header =
+        (const RecordingTapHeader*)m_shm.constData();
+    bool ok = (header->magic == TAP_MAGIC) && header->size &&
+        (uint)m_shm.size() >= sizeof(RecordingTapHeader) + header->size;
+    m_size = (ok) ? header->size : 0;
+    m_shm.unlock();
+
+    if (!ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "The tap is not in a known format");
+        m_shm.detach();
+        return false;
+    }
+
+    m_data = (char*)m_shm.constData() + sizeof(RecordingTapHeader);
+    LOG(VB_FILE, LOG_INFO, LOC + "Reading the recording from the recorder");
+    return true;
+}
+
+/** \brief Copies up to \p sz bytes of the recording from \p pos on.
+ *  \return Bytes copied, 0 when \p pos was not written yet,
+ *          or -1 when it is no longer in the ring.
+ */
+int RecordingTap::Read(long long pos, void *data, uint sz)
+{
+    if (m_writer || !m_data)
+        return -1;
+
+    // The writer can not publish while this is held, so nothing from
+    // where the ring is trusted on gets overwritten while copying
+    m_shm.lock();
+    const RecordingTapHeader *header =
+        (const RecordingTapHeader*)m_shm.constData();
+    long long published = header->written;
+    long long oldest    = published + kPublishSize - m_size;
+
+    int ret = -1;
+    if (pos >= published)
+        ret = 0;
+    else if (pos >= oldest && pos >= 0)
+    {
+        uint len = min((long long)sz, published - pos);
+        uint offset = pos % m_size;
+        uint first = min(len, m_size - offset);
+        memcpy(data, m_data + offset, first);
+        memcpy((char*)data + first, m_data, len - first);
+        ret = len;
+    }
+    m_shm.unlock();
+
+    return ret;
+}
+
+/// Bytes of the recording the writer published
+long long RecordingTap::GetWritten(void)
+{
+    if (m_writer)
+        return m_written;
+    if (!m_data)
+        return -1;
+
+    m_shm.lock();
+    long long ret = ((const RecordingTapHeader*)m_shm.constData())->written;
+    m_shm.unlock();
+    return ret;
+}
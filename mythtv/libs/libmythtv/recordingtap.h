@@ -0,0 +1,52 @@
+#ifndef _RECORDING_TAP_H_
+#define _RECORDING_TAP_H_
+
+#include <QSharedMemory>
+#include <QString>
+
+#include "mythtvexp.h"
+
+/** \class RecordingTap
+ *  \brief Shares the last part of a recording being written with
+ *         readers on the same host.
+ *
+ *  The RingBuffer the recorder writes to copies what it is given into a
+ *  ring in shared memory, named after the basename of the recording.
+ *  A commercial flagger following the recording reads from there what
+ *  is still in the ring, instead of reading the file back from disk.
+ *
+ *  The writer makes what it wrote visible in blocks of kPublishSize,
+ *  so only every block and not every TS packet takes the lock.
+ */
+class MTV_PUBLIC RecordingTap
+{
+  public:
+    explicit RecordingTap(const QString &filename);
+    ~RecordingTap();
+
+    // Writer
+    bool Create(uint size);
+    void Write(const void *data, uint sz);
+    void Flush(void);
+    void Finish(void);
+
+    // Reader
+    bool      Attach(void);
+    int       Read(long long pos, void *data, uint sz);
+    long long GetWritten(void);
+
+    static const uint kPublishSize;
+
+  private:
+    void Publish(void);
+
+    QString        m_key;
+    QSharedMemory  m_shm;
+    bool           m_writer;
+    char          *m_data;
+    uint           m_size;
+    long long      m_written;   // writer only
+    long long      m_published; // writer only
+};
+
+#endif // _RECORDING_TAP_H_
@@ -18,6 +18,7 @@
 #include "threadedfilewriter.h"
 #include "fileringbuffer.h"
 #include "streamingringbuffer.h"
+#include "recordingtap.h"
 #include "mythmiscutil.h"
 #include "dvdstream.h"
 #include "livetvchain.h"
@@ -225,6 +226,7 @@ RingBuffer::RingBuffer(RingBufferType rbtype) :
     filename(),               subtitlefilename(),
     tfw(NULL),                fd2(-1),
     writemode(false),         remotefile(NULL),
+    tap(NULL),
     bufferSize(BUFFER_SIZE_MINIMUM),
     low_buffers(false),
     fileismatroska(false),    unknownbitrate(false),
@@ -286,6 +288,9 @@ RingBuffer::~RingBuffer(void)
         delete tfw;
         tfw = NULL;
     }
+
+    delete tap;
+    tap = NULL;
 }
 
 /** \fn RingBuffer::Reset(bool, bool, bool)
@@ -1762,6 +1767,9 @@ int RingBuffer::Write(const void *buf, uint count)
     else
         ret = remotefile->Write(buf, count);
 
+    if (ret > 0 && tap)
+        tap->Write(buf, ret);
+
     if (ret > 0)
     {
         poslock.lockForWrite();
@@ -1799,6 +1807,13 @@ long long RingBuffer::WriterSeek(long long pos, int whence, bool has_lock)
     if (tfw)
     {
         ret = tfw->Seek(pos, whence);
+        if (tap && ret != writepos)
+        {
+            // The tap only follows a file written from start to end
+            LOG(VB_RECORD, LOG_INFO, LOC +
+                "Writer seeked, no longer sharing the recording");
+            tap->Finish();
+        }
         writepos = ret;
     }
 
@@ -1818,6 +1833,8 @@ void RingBuffer::WriterFlush(void)
     rwlock.lockForRead();
     if (tfw)
         tfw->Flush();
+    if (tap)
+        tap->Flush();
     rwlock.unlock();
 }
 
@@ -1844,6 +1861,26 @@ bool RingBuffer::WriterSetBlocking(bool block)
     return false;
 }
 
+/** \brief Shares what is written from now on with readers on this host
+ *         through a RecordingTap, keeping the last \p size bytes.
+ */
+bool RingBuffer::StartRecordingTap(uint size)
+{
+    QWriteLocker lock(&rwlock);
+
+    if (!writemode || !tfw || tap)
+        return tap;
+
+    tap = new RecordingTap(filename);
+    if (!tap->Create(size))
+    {
+        delete tap;
+        tap = NULL;
+    }
+
+    return tap;
+}
+
 /** \brief Tell RingBuffer if this is an old file or not.
  *
  *  Normally the RingBuffer determines that the file is old
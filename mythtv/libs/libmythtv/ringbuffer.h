@@ -30,6 +30,7 @@ class DVDRingBuffer;
 class BDRingBuffer;
 class LiveTVChain;
 class RemoteFile;
+class RecordingTap;
 
 enum RingBufferType
 {
@@ -125,6 +126,9 @@ class MTV_PUBLIC RingBuffer : protected MThread
     virtual bool OpenFile(const QString &lfilename,
                           uint retry_ms = kDefaultOpenTimeout) = 0;
     virtual bool ReOpen(QString newFilename = "") { return false; }
+    /// \brief Reads what the recorder on this host still has in its
+    ///        RecordingTap from there rather than from the file.
+    virtual bool AttachRecordingTap(void) { return false; }
 
     int  Read(void *buf, int count);
     int  Peek(void *buf, int count); // only works with readahead
@@ -158,6 +162,7 @@ class MTV_PUBLIC RingBuffer : protected MThread
     void Sync(void);
     long long WriterSeek(long long pos, int whence, bool has_lock = false);
     bool WriterSetBlocking(bool lock = true);
+    bool StartRecordingTap(uint size);
 
     long long SetAdjustFilesize(void);
 
@@ -224,6 +229,8 @@ class MTV_PUBLIC RingBuffer : protected MThread
 
     RemoteFile *remotefile;       // protected by rwlock
 
+    RecordingTap *tap;            // protected by rwlock
+
     uint      bufferSize;         // protected by rwlock
     bool      low_buffers;        // protected by rwlock
     bool      fileismatroska;     // protected by rwlock
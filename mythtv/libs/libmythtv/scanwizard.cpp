@@ -179,6 +179,7 @@ void ScanWizard::SetPage(const QString &pageTitle)
         QString table_start, table_end;
         configPane->GetFrequencyTableRange(table_start, table_end);
 
+        scannerPane->SetUseAllTuners(configPane->DoUseAllTuners());
         scannerPane->Scan(
             configPane->GetScanType(),            configPane->GetCardID(),
             configPane->GetInputName(),           configPane->GetSourceID(),
@@ -0,0 +1,182 @@
+/*
+ *  Class TestByteReader
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QFile>
+
+#include "bytereader.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+}
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+#define MSKIP(MSG) QSKIP(MSG, SkipSingle)
+#else
+#define MSKIP(MSG) QSKIP(MSG)
+#endif
+
+#define TS_SIZE     188
+#define SCAN_BYTES  (256 * 1024 * 1024)
+
+class TestByteReader : public QObject
+{
+    Q_OBJECT
+
+    /// TS packets of a made up stream, with a start code every few kB
+    static QByteArray sampleTS(int packets)
+    {
+        QByteArray ts(packets * TS_SIZE, 0);
+        uint8_t *buf = (uint8_t*)ts.data();
+        qsrand(188);
+        for (int i = 0; i < ts.size(); i++)
+            buf[i] = (i % TS_SIZE) ? (qrand() % 255) + 1 : 0x47;
+        for (int i = 1000; i + 4 < ts.size(); i += 1000 + qrand() % 5000)
+        {
+            if ((i % TS_SIZE) < 4 || (i % TS_SIZE) > TS_SIZE - 4)
+                continue;
+            buf[i] = buf[i + 1] = 0;
+            buf[i + 2] = 1;
+        }
+        return ts;
+    }
+
+    /// Scans the payload of every packet like FindMPEG2Keyframes() does
+    static int scanTS(const QByteArray &ts, bool simd)
+    {
+        const uint8_t *buf = (const uint8_t*)ts.constData();
+        uint32_t state = 0xffffffff;
+        int found = 0;
+        for (int i = 0; i + TS_SIZE <= ts.size(); i += TS_SIZE)
+        {
+            const uint8_t *bufptr = buf + i + 4;
+            const uint8_t *bufend = buf + i + TS_SIZE;
+            while (bufptr < bufend)
+            {
+                bufptr = ByteReader::find_start_code(bufptr, bufend,
+                                                     &state, simd);
+                if ((state & 0xffffff00) == 0x00000100)
+                    found++;
+            }
+        }
+        return found;
+    }
+
+    /// Compares every call with libavcodec, cutting \p data at random
+    static void compareWithAV(const QByteArray &data, bool simd)
+    {
+        const uint8_t *buf = (const uint8_t*)data.constData();
+        const uint8_t *end = buf + data.size();
+        const uint8_t *p1 = buf, *p2 = buf;
+        uint32_t state1 = 0xffffffff, state2 = 0xffffffff;
+
+        while (p1 < end)
+        {
+            const uint8_t *cut = (qrand() % 2) ? end :
+                p1 + qrand() % (end - p1 + 1);
+            p1 = avpriv_find_start_code(p1, cut, &state1);
+            p2 = ByteReader::find_start_code(p2, cut, &state2, simd);
+            QCOMPARE (p2 - buf, p1 - buf);
+            QCOMPARE (state2, state1);
+        }
+    }
+
+  private slots:
+    void compare_data(void)
+    {
+        QTest::addColumn<bool>("SSE");
+        QTest::newRow("SSE") << true;
+        QTest::newRow("Pure C") << false;
+    }
+
+    void compare(void)
+    {
+        QFETCH(bool, SSE);
+
+        // Buffers of all sizes, from no zeros to mostly zeros and ones
+        qsrand(1);
+        for (int i = 0; i < 20000; i++)
+        {
+            QByteArray data(qrand() % 300 + 1, 0);
+            int zeros = (i % 4) * 10;
+            for (int j = 0; j < data.size(); j++)
+            {
+                int r = qrand() % 100;
+                data[j] = (r < zeros) ? 0 : (r < zeros + 5) ? 1 :
+                    (char)(qrand() % 256);
+            }
+            compareWithAV(data, SSE);
+        }
+
+        QByteArray ts = sampleTS(1000);
+        compareWithAV(ts, SSE);
+        QCOMPARE (scanTS(ts, SSE), scanTS(ts, false));
+    }
+
+    void speed_data(void)
+    {
+        QTest::addColumn<bool>("SSE");
+        QTest::addColumn<QString>("sample");
+        QTest::newRow("SSE made up")    << true  << QString();
+        QTest::newRow("Pure C made up") << false << QString();
+
+        // A capture to measure on, e.g. a recording of a H.264 multiplex
+        QString file = QString::fromLocal8Bit(qgetenv("MYTHTV_TEST_TS"));
+        if (!file.isEmpty())
+        {
+            QTest::newRow("SSE capture")    << true  << file;
+            QTest::newRow("Pure C capture") << false << file;
+        }
+    }
+
+    /// Prints how many MB/s of TS the start code scan gets through
+    void speed(void)
+    {
+        QFETCH(bool, SSE);
+        QFETCH(QString, sample);
+
+        QByteArray ts;
+        if (sample.isEmpty())
+            ts = sampleTS(64 * 1024);
+        else
+        {
+            QFile f(sample);
+            if (!f.open(QIODevice::ReadOnly))
+                MSKIP("Can't open the capture in MYTHTV_TEST_TS");
+            ts = f.read(64 * 1024 * TS_SIZE);
+        }
+        if (ts.size() < TS_SIZE)
+            MSKIP("Not enough TS to measure with");
+
+        QElapsedTimer timer;
+        timer.start();
+        qint64 scanned = 0;
+        while (scanned < SCAN_BYTES)
+        {
+            scanTS(ts, SSE);
+            scanned += ts.size();
+        }
+        qint64 elapsed = timer.elapsed();
+
+        qDebug() << QString("%1 MB/s")
+            .arg(elapsed ? (scanned * 1000.0 / elapsed) / (1024 * 1024) : 0,
+                 0, 'f', 0);
+    }
+};
@@ -0,0 +1,480 @@
+/*
+ *  Class TestHEVCParser
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QByteArray>
+#include <QList>
+
+#include "HEVCParser.h"
+#include "recorders/recorderbase.h" // for FrameRate
+
+/// Writes the bits of a NAL unit the way an encoder does
+class BitWriter
+{
+  public:
+    BitWriter() : m_bits(0), m_acc(0) { }
+
+    void put(uint32_t value, int n)
+    {
+        while (n--)
+        {
+            m_acc = (m_acc << 1) | ((value >> n) & 1);
+            if (++m_bits == 8)
+            {
+                m_data.append((char)m_acc);
+                m_bits = m_acc = 0;
+            }
+        }
+    }
+
+    void ue(uint32_t value)
+    {
+        value++;
+        int n = 0;
+        while ((value >> n) > 1)
+            n++;
+        put(0, n);
+        put(value, n + 1);
+    }
+
+    void se(int value)
+    {
+        ue((value > 0) ? 2 * value - 1 : -2 * value);
+    }
+
+    /// rbsp_trailing_bits(), then the NAL unit in byte stream format,
+    /// with emulation prevention bytes where the payload needs them
+    QByteArray nal(int type, int layer = 0)
+    {
+        put(1, 1);
+        while (m_bits)
+            put(0, 1);
+
+        QByteArray out;
+        out.append('\0').append('\0').append('\0').append((char)1);
+        out.append((char)((type << 1) | (layer >> 5)));
+        out.append((char)(((layer & 0x1f) << 3) | 1));
+        int zeros = 0;
+        for (int i = 0; i < m_data.size(); i++)
+        {
+            uint8_t byte = m_data[i];
+            if (zeros >= 2 && byte <= 3)
+            {
+                out.append((char)3);
+                zeros = 0;
+            }
+            out.append((char)byte);
+            zeros = (byte) ? 0 : zeros + 1;
+        }
+        return out;
+    }
+
+  private:
+    QByteArray m_data;
+    int        m_bits;
+    uint32_t   m_acc;
+};
+
+/// What a sequence parameter set describes
+struct SPSInfo
+{
+    uint width, height, cropBottom;
+    uint sarIdc, sarWidth, sarHeight;
+    uint32_t tick, scale;
+    uint subLayers;
+};
+
+class TestHEVCParser : public QObject
+{
+    Q_OBJECT
+
+    /// Main profile, with the compatibility flags giving the zero runs
+    /// that need emulation prevention
+    static void profileTierLevel(BitWriter &w, uint subLayers)
+    {
+        w.put(0, 2);            // general_profile_space
+        w.put(0, 1);            // general_tier_flag
+        w.put(1, 5);            // general_profile_idc
+        w.put(0x6000, 16);      // general_profile_compatibility_flag
+        w.put(0, 16);
+        w.put(0xb, 4);          // progressive, frame only
+        w.put(0, 22);           // constraint flags
+        w.put(0, 22);
+        w.put(120, 8);          // general_level_idc
+        for (uint i = 0; i < subLayers; i++)
+            w.put(3, 2);        // sub_layer_profile/level_present_flag
+        if (subLayers)
+            for (uint i = subLayers; i < 8; i++)
+                w.put(0, 2);
+        for (uint i = 0; i < subLayers; i++)
+        {
+            w.put(0, 32);
+            w.put(0, 32);
+            w.put(0, 24);
+            w.put(90, 8);       // sub_layer_level_idc
+        }
+    }
+
+    static QByteArray vps(uint32_t tick, uint32_t scale)
+    {
+        BitWriter w;
+        w.put(0, 4);            // vps_video_parameter_set_id
+        w.put(3, 2);            // vps_base_layer_internal/available_flag
+        w.put(0, 6);            // vps_max_layers_minus1
+        w.put(0, 3);            // vps_max_sub_layers_minus1
+        w.put(1, 1);            // vps_temporal_id_nesting_flag
+        w.put(0xffff, 16);
+        profileTierLevel(w, 0);
+        w.put(1, 1);            // vps_sub_layer_ordering_info_present_flag
+        w.ue(4); w.ue(2); w.ue(0);
+        w.put(0, 6);            // vps_max_layer_id
+        w.ue(0);                // vps_num_layer_sets_minus1
+        w.put(scale ? 1 : 0, 1);
+        if (scale)
+        {
+            w.put(tick, 32);
+            w.put(scale, 32);
+            w.put(0, 1);        // vps_poc_proportional_to_timing_flag
+            w.ue(0);            // vps_num_hrd_parameters
+        }
+        w.put(0, 1);            // vps_extension_flag
+        return w.nal(HEVCParser::VPS_NUT);
+    }
+
+    /// An SPS using most of the syntax there is before the VUI
+    static QByteArray sps(const SPSInfo &info)
+    {
+        BitWriter w;
+        w.put(0, 4);            // sps_video_parameter_set_id
+        w.put(info.subLayers, 3);
+        w.put(1, 1);            // sps_temporal_id_nesting_flag
+        profileTierLevel(w, info.subLayers);
+        w.ue(0);                // sps_seq_parameter_set_id
+        w.ue(1);                // chroma_format_idc, 4:2:0
+        w.ue(info.width);
+        w.ue(info.height);
+        w.put(info.cropBottom ? 1 : 0, 1);
+        if (info.cropBottom)
+        {
+            w.ue(0); w.ue(0); w.ue(0);
+            w.ue(info.cropBottom / 2);  // in chroma samples
+        }
+        w.ue(2); w.ue(2);       // bit_depth_luma/chroma_minus8
+        w.ue(4);                // log2_max_pic_order_cnt_lsb_minus4
+        w.put(1, 1);            // sps_sub_layer_ordering_info_present_flag
+        for (uint i = 0; i <= info.subLayers; i++)
+        {
+            w.ue(4); w.ue(2); w.ue(0);
+        }
+        w.ue(0); w.ue(3); w.ue(0); w.ue(3); w.ue(1); w.ue(1);
+
+        w.put(1, 1);            // scaling_list_enabled_flag
+        w.put(1, 1);            // sps_scaling_list_data_present_flag
+        for (int sizeId = 0; sizeId < 4; sizeId++)
+        {
+            for (int matrixId = 0; matrixId < 6;
+                 matrixId += (sizeId == 3) ? 3 : 1)
+            {
+                w.put((sizeId + matrixId) & 1 ? 0 : 1, 1);
+                if ((sizeId + matrixId) & 1)
+                {
+                    w.ue(0);    // scaling_list_pred_matrix_id_delta
+                    continue;
+                }
+                if (sizeId > 1)
+                    w.se(8);    // scaling_list_dc_coef_minus8
+                int coefNum = qMin(64, 1 << (4 + (sizeId << 1)));
+                for (int i = 0; i < coefNum; i++)
+                    w.se(i % 3 - 1);
+            }
+        }
+
+        w.put(1, 1);            // amp_enabled_flag
+        w.put(1, 1);            // sample_adaptive_offset_enabled_flag
+        w.put(1, 1);            // pcm_enabled_flag
+        w.put(7, 4); w.put(7, 4); w.ue(0); w.ue(1); w.put(1, 1);
+
+        // Three short-term reference picture sets, the last two
+        // predicted from the one before them
+        w.ue(3);
+        w.ue(2); w.ue(1);       // num_negative_pics, num_positive_pics
+        for (int i = 0; i < 3; i++)
+        {
+            w.ue(i);
+            w.put(1, 1);
+        }
+        w.put(1, 1);            // inter_ref_pic_set_prediction_flag
+        w.put(0, 1); w.ue(0);   // delta_rps_sign, abs_delta_rps_minus1
+        w.put(1, 1);            // used_by_curr_pic_flag
+        w.put(0, 1); w.put(0, 1); // not used, use_delta_flag 0
+        w.put(0, 1); w.put(1, 1);
+        w.put(0, 1); w.put(1, 1); // so three delta POCs
+        w.put(1, 1);            // inter_ref_pic_set_prediction_flag
+        w.put(1, 1); w.ue(1);
+        for (int j = 0; j < 4; j++)
+            w.put(1, 1);        // used_by_curr_pic_flag
+
+        w.put(1, 1);            // long_term_ref_pics_present_flag
+        w.ue(2);
+        w.put(5, 8); w.put(1, 1);
+        w.put(3, 8); w.put(0, 1);
+
+        w.put(1, 1);            // sps_temporal_mvp_enabled_flag
+        w.put(1, 1);            // strong_intra_smoothing_enabled_flag
+
+        w.put(1, 1);            // vui_parameters_present_flag
+        w.put(info.sarIdc ? 1 : 0, 1);
+        if (info.sarIdc)
+        {
+            w.put(info.sarIdc, 8);
+            if (info.sarIdc == 255)
+            {
+                w.put(info.sarWidth, 16);
+                w.put(info.sarHeight, 16);
+            }
+        }
+        w.put(0, 1);            // overscan_info_present_flag
+        w.put(1, 1);            // video_signal_type_present_flag
+        w.put(5, 3); w.put(0, 1);
+        w.put(1, 1); w.put(1, 8); w.put(1, 8); w.put(1, 8);
+        w.put(0, 1);            // chroma_loc_info_present_flag
+        w.put(0, 3);            // neutral_chroma, field_seq, frame_field_info
+        w.put(1, 1);            // default_display_window_flag
+        w.ue(0); w.ue(0); w.ue(0); w.ue(0);
+        w.put(info.scale ? 1 : 0, 1);
+        if (info.scale)
+        {
+            w.put(info.tick, 32);
+            w.put(info.scale, 32);
+            w.put(0, 1);        // vui_poc_proportional_to_timing_flag
+            w.put(0, 1);        // vui_hrd_parameters_present_flag
+        }
+        w.put(0, 1);            // bitstream_restriction_flag
+        w.put(0, 1);            // sps_extension_present_flag
+        return w.nal(HEVCParser::SPS_NUT);
+    }
+
+    /// A slice segment, with a body that is only there to be skipped
+    static QByteArray slice(int type, bool first, int layer = 0)
+    {
+        BitWriter w;
+        w.put(first ? 1 : 0, 1); // first_slice_segment_in_pic_flag
+        w.put(0x155, 9);
+        for (int i = 0; i < 400; i++)
+            w.put((i & 1) ? 0 : 0x81, 8);
+        return w.nal(type, layer);
+    }
+
+    static QByteArray other(int type)
+    {
+        BitWriter w;
+        w.put(0x50, 8);
+        return w.nal(type);
+    }
+
+    static SPSInfo info1080p25(void)
+    {
+        SPSInfo info = { 1920, 1088, 8, 1, 0, 0, 1, 25, 0 };
+        return info;
+    }
+
+    /// Feeds \p es to \p parser \p chunk bytes at a time, like TS payloads,
+    /// collecting the offsets it gives the access units of the pictures
+    static void parse(HEVCParser &parser, const QByteArray &es, int chunk,
+                      QList<uint64_t> &frames, QList<uint64_t> &keyframes)
+    {
+        const uint8_t *buf = (const uint8_t*)es.constData();
+        for (int pos = 0; pos < es.size(); pos += chunk)
+        {
+            int len = qMin(chunk, es.size() - pos);
+            int used = 0;
+            while (used < len)
+            {
+                used += parser.addBytes(buf + pos + used, len - used, pos);
+                if (!parser.onFrameStart())
+                    continue;
+                frames << parser.frameAUstreamOffset();
+                if (parser.onKeyFrameStart())
+                    keyframes << parser.keyframeAUstreamOffset();
+            }
+        }
+    }
+
+    /// The offset passed along with the start code of the NAL unit at \p au
+    static uint64_t expectedOffset(int au, int chunk)
+    {
+        return ((au + 4) / chunk) * chunk;
+    }
+
+  private slots:
+    void sps_data(void)
+    {
+        QTest::addColumn<uint>("width");
+        QTest::addColumn<uint>("height");
+        QTest::addColumn<uint>("cropBottom");
+        QTest::addColumn<uint>("sarIdc");
+        QTest::addColumn<uint>("tick");
+        QTest::addColumn<uint>("scale");
+        QTest::addColumn<uint>("vpsTick");
+        QTest::addColumn<uint>("vpsScale");
+        QTest::addColumn<uint>("subLayers");
+        QTest::addColumn<uint>("pictureHeight");
+        QTest::addColumn<uint>("aspect");
+        QTest::addColumn<uint>("rateNum");
+        QTest::addColumn<uint>("rateDen");
+
+        QTest::newRow("1080p25 cropped from 1088")
+            << 1920u << 1088u << 8u << 1u << 1u << 25u << 0u << 0u << 0u
+            << 1080u << 3u << 25u << 1u;
+        QTest::newRow("576p25 4:3")
+            << 704u << 576u << 0u << 2u << 1u << 25u << 0u << 0u << 0u
+            << 576u << 2u << 25u << 1u;
+        QTest::newRow("1440x1080 anamorphic 16:9")
+            << 1440u << 1080u << 0u << 14u << 1001u << 30000u << 0u << 0u
+            << 1u << 1080u << 3u << 30000u << 1001u;
+        QTest::newRow("2160p50 with sub-layers")
+            << 3840u << 2160u << 0u << 1u << 1u << 50u << 0u << 0u << 3u
+            << 2160u << 3u << 50u << 1u;
+        QTest::newRow("720p59.94 timing in the VPS")
+            << 1280u << 720u << 0u << 1u << 0u << 0u << 1001u << 60000u
+            << 0u << 720u << 3u << 60000u << 1001u;
+        QTest::newRow("extended SAR")
+            << 1440u << 1080u << 0u << 255u << 1u << 25u << 0u << 0u << 0u
+            << 1080u << 3u << 25u << 1u;
+    }
+
+    void sps(void)
+    {
+        QFETCH(uint, width);
+        QFETCH(uint, height);
+        QFETCH(uint, cropBottom);
+        QFETCH(uint, sarIdc);
+        QFETCH(uint, tick);
+        QFETCH(uint, scale);
+        QFETCH(uint, vpsTick);
+        QFETCH(uint, vpsScale);
+        QFETCH(uint, subLayers);
+        QFETCH(uint, pictureHeight);
+        QFETCH(uint, aspect);
+        QFETCH(uint, rateNum);
+        QFETCH(uint, rateDen);
+
+        SPSInfo info = { width, height, cropBottom, sarIdc, 4, 3,
+                         tick, scale, subLayers };
+        QByteArray es = vps(vpsTick, vpsScale) + sps(info) +
+            other(HEVCParser::PPS_NUT) + slice(HEVCParser::IDR_W_RADL, true) +
+            slice(HEVCParser::TRAIL_R, true);
+
+        HEVCParser parser;
+        QList<uint64_t> frames, keyframes;
+        parse(parser, es, es.size(), frames, keyframes);
+
+        QVERIFY (parser.seen_SPS());
+        QCOMPARE (frames.size(), 2);
+        QCOMPARE (keyframes.size(), 1);
+        QCOMPARE (parser.pictureWidth(), width);
+        QCOMPARE (parser.pictureHeight(), pictureHeight);
+        QCOMPARE (parser.aspectRatio(), aspect);
+
+        FrameRate rate(0);
+        parser.getFrameRate(rate);
+        QCOMPARE (rate.getNum(), rateNum);
+        QCOMPARE (rate.getDen(), rateDen);
+    }
+
+    void keyframes_data(void)
+    {
+        QTest::addColumn<int>("chunk");
+        QTest::newRow("byte by byte") << 1;
+        QTest::newRow("7 bytes") << 7;
+        QTest::newRow("TS payloads") << 184;
+        QTest::newRow("all at once") << 1000000;
+    }
+
+    /**
+     * Three GOPs, starting with an IDR, a CRA and a BLA picture, of
+     * pictures made of two slices. Every picture is counted once, from
+     * where its access unit starts, and the IRAP pictures are keyframes.
+     */
+    void keyframes(void)
+    {
+        QFETCH(int, chunk);
+
+        const int irap[3] = { HEVCParser::IDR_W_RADL, HEVCParser::CRA_NUT,
+                              HEVCParser::BLA_W_LP };
+        QByteArray es;
+        QList<int> frameAUs, keyframeAUs;
+        for (int gop = 0; gop < 3; gop++)
+        {
+            keyframeAUs << es.size();
+            frameAUs << es.size();
+            es += other(HEVCParser::AUD_NUT) + vps(1, 25) + sps(info1080p25()) +
+                other(HEVCParser::PPS_NUT) + other(HEVCParser::PREFIX_SEI_NUT);
+            es += slice(irap[gop], true) + slice(irap[gop], false);
+            // An enhancement layer picture is not one of ours
+            es += slice(HEVCParser::IDR_W_RADL, true, 1);
+
+            for (int i = 0; i < 5; i++)
+            {
+                frameAUs << es.size();
+                if (i & 1)
+                    es += other(HEVCParser::AUD_NUT);
+                int type = (gop == 1 && i < 2) ?
+                    HEVCParser::RASL_N : HEVCParser::TRAIL_R;
+                es += slice(type, true) + slice(type, false);
+                es += other(HEVCParser::SUFFIX_SEI_NUT);
+            }
+        }
+        es += other(HEVCParser::EOB_NUT);
+
+        HEVCParser parser;
+        QList<uint64_t> frames, keyframes;
+        parse(parser, es, chunk, frames, keyframes);
+
+        QCOMPARE (frames.size(), frameAUs.size());
+        for (int i = 0; i < frames.size(); i++)
+            QCOMPARE (frames[i], expectedOffset(frameAUs[i], chunk));
+        QCOMPARE (keyframes.size(), keyframeAUs.size());
+        for (int i = 0; i < keyframes.size(); i++)
+            QCOMPARE (keyframes[i], expectedOffset(keyframeAUs[i], chunk));
+
+        QCOMPARE (parser.pictureWidth(), 1920u);
+        QCOMPARE (parser.pictureHeight(), 1080u);
+        QCOMPARE (parser.aspectRatio(), 3u);
+    }
+
+    /// Until it has seen an SPS the parser does not report any pictures
+    void no_sps(void)
+    {
+        QByteArray es = other(HEVCParser::PPS_NUT) +
+            slice(HEVCParser::IDR_W_RADL, true) +
+            slice(HEVCParser::TRAIL_R, true) +
+            slice(HEVCParser::TRAIL_R, true);
+
+        HEVCParser parser;
+        const uint8_t *buf = (const uint8_t*)es.constData();
+        int used = 0;
+        while (used < es.size())
+        {
+            used += parser.addBytes(buf + used, es.size() - used, 0);
+            QVERIFY (!parser.stateChanged());
+        }
+        QVERIFY (!parser.seen_SPS());
+        QCOMPARE (parser.pictureWidth(), 0u);
+    }
+};
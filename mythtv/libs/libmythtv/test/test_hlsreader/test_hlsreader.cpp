@@ -0,0 +1,8 @@
+#include "test_hlsreader.h"
+
+// The downloads need an event loop
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+QTEST_GUILESS_MAIN(TestHLSReader)
+#else
+QTEST_MAIN(TestHLSReader)
+#endif
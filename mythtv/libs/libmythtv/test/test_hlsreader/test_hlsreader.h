@@ -0,0 +1,245 @@
+/*
+ *  Class TestHLSReader
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QMutex>
+#include <QMap>
+
+#include "HLSReader.h"
+
+#define TS_SIZE 188
+
+/**
+ * Minimal HTTP/1.0 file server, answering each request from its own
+ * thread so slow answers do not hold up the others.
+ */
+class TestHTTPServer : public QTcpServer
+{
+  public:
+    void AddFile(const QString &path, const QByteArray &data,
+                 int delay = 0, bool fail_once = false)
+    {
+        QMutexLocker locker(&m_lock);
+        m_files[path] = data;
+        m_delays[path] = delay;
+        if (fail_once)
+            m_failures[path] = 1;
+    }
+
+    /// Returns the content of \p path, false for a 404 answer
+    bool Get(const QString &path, QByteArray &data, int &delay)
+    {
+        QMutexLocker locker(&m_lock);
+        m_requests[path]++;
+        delay = m_delays.value(path, 0);
+        if (!m_files.contains(path))
+            return false;
+        if (m_failures.value(path, 0) > 0)
+        {
+            m_failures[path]--;
+            return false;
+        }
+        data = m_files[path];
+        return true;
+    }
+
+    int Requests(const QString &path)
+    {
+        QMutexLocker locker(&m_lock);
+        return m_requests.value(path, 0);
+    }
+
+  protected:
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+    void incomingConnection(qintptr descriptor);
+#else
+    void incomingConnection(int descriptor);
+#endif
+
+  private:
+    QMutex                 m_lock;
+    QMap<QString, QByteArray> m_files;
+    QMap<QString, int>     m_delays;
+    QMap<QString, int>     m_failures;
+    QMap<QString, int>     m_requests;
+};
+
+class TestHTTPConnection : public QThread
+{
+  public:
+    TestHTTPConnection(TestHTTPServer *server, int descriptor) :
+        m_server(server), m_descriptor(descriptor) {}
+
+  protected:
+    void run(void)
+    {
+        QTcpSocket socket;
+        if (!socket.setSocketDescriptor(m_descriptor))
+            return;
+
+        QByteArray request;
+        while (!request.contains("\r\n\r\n") && socket.waitForReadyRead(5000))
+            request += socket.readAll();
+
+        QString path = QString(request).section(' ', 1, 1);
+        QByteArray data;
+        int delay = 0;
+        bool found = m_server->Get(path, data, delay);
+        if (delay > 0)
+            msleep(delay);
+
+        QByteArray reply(found ? "HTTP/1.0 200 OK\r\n"
+                               : "HTTP/1.0 404 Not Found\r\n");
+        reply += "Content-Length: " + QByteArray::number(data.size()) + "\r\n";
+        reply += "Connection: close\r\n\r\n";
+        reply += data;
+
+        socket.write(reply);
+        while (socket.bytesToWrite() > 0 && socket.waitForBytesWritten(5000))
+            ;
+        socket.disconnectFromHost();
+        if (socket.state() != QAbstractSocket::UnconnectedState)
+            socket.waitForDisconnected(5000);
+    }
+
+  private:
+    TestHTTPServer *m_server;
+    int             m_descriptor;
+};
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+inline void TestHTTPServer::incomingConnection(qintptr descriptor)
+#else
+inline void TestHTTPServer::incomingConnection(int descriptor)
+#endif
+{
+    TestHTTPConnection *connection = new TestHTTPConnection(this, descriptor);
+    connect(connection, SIGNAL(finished()), connection, SLOT(deleteLater()));
+    connection->start();
+}
+
+class TestHLSReader : public QObject
+{
+    Q_OBJECT
+
+    /// \p count TS packets of PID 0x100, with their continuity counter
+    /// following \p cc and the sequence and index of the packet as payload
+    static QByteArray makeSegment(int sequence, int count, uint &cc)
+    {
+        QByteArray segment;
+        for (int i = 0; i < count; i++)
+        {
+            QByteArray packet(TS_SIZE, (char)0xff);
+            packet[0] = 0x47;
+            packet[1] = 0x01;
+            packet[2] = 0x00;
+            packet[3] = 0x10 | (cc++ & 0xf);
+            packet[4] = sequence;
+            packet[5] = i >> 8;
+            packet[6] = i & 0xff;
+            segment += packet;
+        }
+        return segment;
+    }
+
+    /// Number of packets not following the continuity counter of the
+    /// previous one
+    static int discontinuities(const QByteArray &data)
+    {
+        int count = 0;
+        for (int i = TS_SIZE; i + TS_SIZE <= data.size(); i += TS_SIZE)
+        {
+            uint prev = data[i - TS_SIZE + 3] & 0xf;
+            uint cc   = data[i + 3] & 0xf;
+            if (cc != ((prev + 1) & 0xf))
+                count++;
+        }
+        return count;
+    }
+
+  private slots:
+    /**
+     * Records a short VOD playlist with a slow segment, and one failing
+     * the first time, and checks all the packets arrive once and in order.
+     */
+    void prefetch_test(void)
+    {
+        TestHTTPServer server;
+        QVERIFY (server.listen(QHostAddress::LocalHost));
+
+        const int segments = 6;
+        QByteArray expected;
+        QByteArray playlist("#EXTM3U\n"
+                            "#EXT-X-VERSION:3\n"
+                            "#EXT-X-TARGETDURATION:2\n"
+                            "#EXT-X-MEDIA-SEQUENCE:0\n");
+        uint cc = 0;
+        for (int seq = 0; seq < segments; seq++)
+        {
+            QString path = QString("/seg%1.ts").arg(seq);
+            QByteArray segment = makeSegment(seq, 200 + seq, cc);
+            server.AddFile(path, segment,
+                           (seq == 1) ? 1500 : 0,  // slow
+                           (seq == 3));            // fails once
+            expected += segment;
+            playlist += "#EXTINF:2,\n" + path.mid(1).toLatin1() + "\n";
+        }
+        playlist += "#EXT-X-ENDLIST\n";
+        server.AddFile("/live.m3u8", playlist);
+
+        HLSReader reader;
+        QVERIFY (reader.Open(QString("http://127.0.0.1:%1/live.m3u8")
+                             .arg(server.serverPort())));
+        reader.Throttle(false);
+
+        // Part of the first segment is read with Read(), the rest
+        // is handed over a segment at a time.
+        QByteArray data;
+        QByteArray segment;
+        uint8_t buffer[1000];
+        QTime timer;
+        timer.start();
+        while (data.size() < expected.size() && timer.elapsed() < 60000)
+        {
+            int len = 0;
+            if (data.isEmpty())
+            {
+                len = reader.Read(buffer, sizeof(buffer));
+                data.append((const char*)buffer, len);
+            }
+            else if ((len = reader.ReadSegment(segment)) > 0)
+                data += segment;
+
+            if (len == 0)
+                QTest::qWait(50);
+        }
+        reader.Close();
+
+        QCOMPARE (data.size(), expected.size());
+        QVERIFY (data == expected);
+        QCOMPARE (discontinuities(data), 0);
+
+        // Only the failed segment was downloaded twice
+        for (int seq = 0; seq < segments; seq++)
+            QCOMPARE (server.Requests(QString("/seg%1.ts").arg(seq)),
+                      (seq == 3) ? 2 : 1);
+    }
+};
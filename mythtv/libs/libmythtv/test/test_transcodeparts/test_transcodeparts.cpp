@@ -0,0 +1,3 @@
+#include "test_transcodeparts.h"
+
+QTEST_APPLESS_MAIN(TestTranscodeParts)
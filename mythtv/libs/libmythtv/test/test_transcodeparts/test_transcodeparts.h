@@ -0,0 +1,416 @@
+/*
+ *  Class TestTranscodeParts
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QDir>
+
+#include "transcodeparts.h"
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+}
+
+#define FRAMES      3000
+#define KEYINT      15
+#define FRAME_MS    40
+#define AUDIO_MS    24  // 1152 samples at 48kHz
+
+static const AVRational kMillis = { 1, 1000 };
+
+class TestTranscodeParts : public QObject
+{
+    Q_OBJECT
+
+    static frm_pos_map_t keyframes(void)
+    {
+        frm_pos_map_t keyMap;
+        for (int frame = 0; frame < FRAMES; frame += KEYINT)
+            keyMap[frame] = frame * 1000LL;
+        return keyMap;
+    }
+
+    /// Whether the cutlist drops \p frame, the way the player applies it
+    static bool isCut(const frm_dir_map_t &cutlist, uint64_t frame)
+    {
+        bool cut = !cutlist.isEmpty() &&
+                   cutlist.begin().value() == MARK_CUT_END;
+        frm_dir_map_t::const_iterator it = cutlist.begin();
+        for (; it != cutlist.end() && it.key() <= frame; ++it)
+            cut = (*it == MARK_CUT_START);
+        return cut;
+    }
+
+    /// What the serial transcode keeps, against what the parts keep
+    static void compareWithSerial(const frm_dir_map_t &deleteMap, uint count)
+    {
+        frm_pos_map_t keyMap = keyframes();
+        QList<TranscodePart> parts =
+            SplitForTranscode(keyMap, deleteMap, FRAMES, count);
+
+        QVERIFY (!parts.isEmpty());
+        QVERIFY ((uint)parts.size() <= count);
+        QCOMPARE (parts.first().start, (uint64_t)0);
+        QCOMPARE (parts.last().end, (uint64_t)TRANSCODE_PART_END);
+
+        uint64_t serial = 0;
+        for (uint64_t frame = 0; frame < FRAMES; frame++)
+            if (!isCut(deleteMap, frame))
+                serial++;
+        QCOMPARE (TranscodeKeptFrames(deleteMap, FRAMES), serial);
+
+        uint64_t sum = 0;
+        for (int i = 0; i < parts.size(); i++)
+        {
+            QVERIFY (parts[i].frames > 0);
+            QVERIFY (keyMap.contains(parts[i].start));
+            if (i > 0)
+                QCOMPARE (parts[i].start, parts[i - 1].end);
+            sum += parts[i].frames;
+        }
+        QCOMPARE (sum, serial);
+
+        // Every frame the serial transcode keeps is kept by one part,
+        // and the others by none
+        for (uint64_t frame = 0; frame < FRAMES; frame++)
+        {
+            int keptBy = 0;
+            for (int i = 0; i < parts.size(); i++)
+                if (!isCut(parts[i].cutlist, frame))
+                    keptBy++;
+            QCOMPARE (keptBy, isCut(deleteMap, frame) ? 0 : 1);
+        }
+    }
+
+    /// Frames of the recording the cutlist keeps, as a transcode writes them
+    static QVector<uint> keptFrames(const frm_dir_map_t &cutlist)
+    {
+        QVector<uint> frames;
+        for (uint frame = 0; frame < FRAMES; frame++)
+            if (!isCut(cutlist, frame))
+                frames.push_back(frame);
+        return frames;
+    }
+
+    /// Writes a video frame holding each of \p pictures and the audio
+    /// along them, with the timestamps starting at 1ms like AVFormatWriter
+    static bool writeFile(const QString &filename,
+                          const QVector<uint> &pictures)
+    {
+        int frames = pictures.size();
+        QByteArray fname = filename.toLocal8Bit();
+        AVFormatContext *oc = NULL;
+        if (avformat_alloc_output_context2(&oc, NULL, "nut",
+                                           fname.constData()) < 0)
+            return false;
+
+        AVStream *vst = avformat_new_stream(oc, NULL);
+        vst->codec->codec_type = AVMEDIA_TYPE_VIDEO;
+        vst->codec->codec_id   = AV_CODEC_ID_RAWVIDEO;
+        vst->codec->pix_fmt    = AV_PIX_FMT_GRAY8;
+        vst->codec->codec_tag  = avcodec_pix_fmt_to_codec_tag(AV_PIX_FMT_GRAY8);
+        vst->codec->width      = 16;
+        vst->codec->height     = 16;
+        vst->codec->time_base  = kMillis;
+        vst->time_base         = kMillis;
+
+        AVStream *ast = avformat_new_stream(oc, NULL);
+        ast->codec->codec_type  = AVMEDIA_TYPE_AUDIO;
+        ast->codec->codec_id    = AV_CODEC_ID_PCM_S16LE;
+        ast->codec->sample_fmt  = AV_SAMPLE_FMT_S16;
+        ast->codec->sample_rate = 48000;
+        ast->codec->channels    = 2;
+        ast->time_base          = kMillis;
+
+        if (avio_open(&oc->pb, fname.constData(), AVIO_FLAG_WRITE) < 0 ||
+            avformat_write_header(oc, NULL) < 0)
+            return false;
+
+        QByteArray picture(16 * 16, 0x10);
+        QByteArray samples(1152 * 4, 0);
+        int64_t audio = 1;
+        bool ok = true;
+        for (int i = 0; ok && i < frames; i++)
+        {
+            int64_t time = 1 + i * FRAME_MS;
+            for (; audio < time + FRAME_MS; audio += AUDIO_MS)
+            {
+                AVPacket pkt;
+                av_init_packet(&pkt);
+                pkt.data         = (uint8_t*)samples.data();
+                pkt.size         = samples.size();
+                pkt.stream_index = ast->index;
+                pkt.pts = pkt.dts = av_rescale_q(audio, kMillis,
+                                                 ast->time_base);
+                pkt.duration     = av_rescale_q(AUDIO_MS, kMillis,
+                                                ast->time_base);
+                pkt.flags       |= AV_PKT_FLAG_KEY;
+                ok = ok && av_interleaved_write_frame(oc, &pkt) >= 0;
+            }
+
+            memcpy(picture.data(), &pictures[i], sizeof(uint));
+
+            AVPacket pkt;
+            av_init_packet(&pkt);
+            pkt.data         = (uint8_t*)picture.data();
+            pkt.size         = picture.size();
+            pkt.stream_index = vst->index;
+            pkt.pts = pkt.dts = av_rescale_q(time, kMillis,
+                                             vst->time_base);
+            pkt.duration     = av_rescale_q(FRAME_MS, kMillis,
+                                            vst->time_base);
+            pkt.flags       |= AV_PKT_FLAG_KEY;
+            ok = ok && av_interleaved_write_frame(oc, &pkt) >= 0;
+        }
+
+        ok = ok && av_write_trailer(oc) >= 0;
+        avio_closep(&oc->pb);
+        avformat_free_context(oc);
+        return ok;
+    }
+
+    /// Number of video frames, their duration in ms, whether they follow
+    /// each other without a gap, and what their pictures hold
+    static bool readFile(const QString &filename, int &frames,
+                         int64_t &duration, bool &continuous,
+                         QVector<uint> &pictures)
+    {
+        QByteArray fname = filename.toLocal8Bit();
+        AVFormatContext *ic = NULL;
+        if (avformat_open_input(&ic, fname.constData(), NULL, NULL) ||
+            avformat_find_stream_info(ic, NULL) < 0)
+            return false;
+
+        int video = av_find_best_stream(ic, AVMEDIA_TYPE_VIDEO,
+                                        -1, -1, NULL, 0);
+        AVRational tb = ic->streams[video]->time_base;
+        QVector<int64_t> lastDts(ic->nb_streams, AV_NOPTS_VALUE);
+        int64_t first = AV_NOPTS_VALUE, last = AV_NOPTS_VALUE;
+
+        frames     = 0;
+        continuous = true;
+        pictures.clear();
+
+        AVPacket pkt;
+        av_init_packet(&pkt);
+        while (av_read_frame(ic, &pkt) >= 0)
+        {
+            int index = pkt.stream_index;
+            if (lastDts[index] != AV_NOPTS_VALUE && pkt.dts <= lastDts[index])
+                continuous = false;
+            lastDts[index] = pkt.dts;
+
+            if (index == video)
+            {
+                int64_t pts = av_rescale_q(pkt.pts, tb, kMillis);
+                if (first == AV_NOPTS_VALUE)
+                    first = pts;
+                else if (pts - last != FRAME_MS)
+                    continuous = false;
+                last = pts;
+                frames++;
+
+                uint picture = 0;
+                if (pkt.size >= (int)sizeof(uint))
+                    memcpy(&picture, pkt.data, sizeof(uint));
+                pictures.push_back(picture);
+            }
+            av_free_packet(&pkt);
+        }
+        avformat_close_input(&ic);
+
+        duration = (frames) ? last + FRAME_MS - first : 0;
+        return true;
+    }
+
+  private slots:
+    void initTestCase(void)
+    {
+        av_register_all();
+    }
+
+    void split_nocut_test(void)
+    {
+        frm_dir_map_t deleteMap;
+        for (uint count = 1; count <= 16; count++)
+            compareWithSerial(deleteMap, count);
+
+        // Without cuts the parts are as long as the keyframes allow
+        QList<TranscodePart> parts =
+            SplitForTranscode(keyframes(), deleteMap, FRAMES, 8);
+        QCOMPARE (parts.size(), 8);
+        for (int i = 0; i < parts.size(); i++)
+            QVERIFY (parts[i].frames <= FRAMES / 8 + KEYINT);
+    }
+
+    void split_cutlist_test(void)
+    {
+        frm_dir_map_t deleteMap;
+
+        // Commercials in the middle, not on keyframes
+        deleteMap[407]  = MARK_CUT_START;
+        deleteMap[1203] = MARK_CUT_END;
+        deleteMap[2001] = MARK_CUT_START;
+        deleteMap[2222] = MARK_CUT_END;
+        for (uint count = 2; count <= 16; count++)
+            compareWithSerial(deleteMap, count);
+
+        // Cut from the start, and up to the end
+        deleteMap.clear();
+        deleteMap[100]  = MARK_CUT_END;
+        deleteMap[2900] = MARK_CUT_START;
+        for (uint count = 2; count <= 16; count++)
+            compareWithSerial(deleteMap, count);
+
+        // An external cutlist ending past the end of the recording
+        deleteMap.clear();
+        deleteMap[0]    = MARK_CUT_START;
+        deleteMap[50]   = MARK_CUT_END;
+        deleteMap[1500] = MARK_CUT_START;
+        deleteMap[TRANSCODE_PART_END] = MARK_CUT_END;
+        for (uint count = 2; count <= 16; count++)
+            compareWithSerial(deleteMap, count);
+    }
+
+    void cutlist_string_test(void)
+    {
+        frm_dir_map_t deleteMap;
+        deleteMap[407]  = MARK_CUT_START;
+        deleteMap[1203] = MARK_CUT_END;
+
+        QList<TranscodePart> parts =
+            SplitForTranscode(keyframes(), deleteMap, FRAMES, 2);
+        QCOMPARE (parts.size(), 2);
+        QCOMPARE (parts[0].CutListString(),
+                  QString("407-1203 %1-%2").arg(parts[0].end)
+                  .arg(TRANSCODE_PART_END));
+        QCOMPARE (parts[1].CutListString(),
+                  QString("0-%1").arg(parts[1].start));
+    }
+
+    /**
+     * Joins parts transcoded separately, and checks the result has the
+     * frames and the duration of the same file transcoded at once.
+     */
+    void join_test(void)
+    {
+        QString base = QDir::tempPath() + QString("/test_transcodeparts_%1")
+            .arg(QCoreApplication::applicationPid());
+
+        const int sizes[] = { 100, 75, 1, 74 };
+        uint total = 0;
+        QStringList parts;
+        for (uint i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        {
+            QVector<uint> pictures;
+            for (int j = 0; j < sizes[i]; j++)
+                pictures.push_back(total++);
+            parts << base + QString(".part%1").arg(i);
+            QVERIFY (writeFile(parts.last(), pictures));
+        }
+        QVector<uint> all;
+        for (uint i = 0; i < total; i++)
+            all.push_back(i);
+        QVERIFY (writeFile(base + ".serial", all));
+        QVERIFY (JoinTranscodedParts(parts, base + ".joined", "nut"));
+
+        int serialFrames, joinedFrames;
+        int64_t serialDuration, joinedDuration;
+        bool serialContinuous, joinedContinuous;
+        QVector<uint> serialPictures, joinedPictures;
+        QVERIFY (readFile(base + ".serial", serialFrames, serialDuration,
+                          serialContinuous, serialPictures));
+        QVERIFY (readFile(base + ".joined", joinedFrames, joinedDuration,
+                          joinedContinuous, joinedPictures));
+
+        QCOMPARE (serialFrames, (int)total);
+        QVERIFY (serialContinuous);
+        QCOMPARE (joinedFrames, serialFrames);
+        QCOMPARE (joinedDuration, serialDuration);
+        QVERIFY (joinedContinuous);
+        QCOMPARE (joinedPictures, serialPictures);
+
+        parts << base + ".serial" << base + ".joined";
+        for (int i = 0; i < parts.size(); i++)
+            QFile::remove(parts[i]);
+    }
+
+    /**
+     * Splits a cutlist the way ParallelTranscode does, writes each part
+     * with the frames its cutlist keeps and joins them, and checks the
+     * result holds the same frames in the same order with the same timing
+     * as a file written from the whole cutlist at once. This covers
+     * SplitForTranscode and JoinTranscodedParts, the transcoder itself
+     * is not run.
+     */
+    void parallel_vs_serial_test(void)
+    {
+        QString base = QDir::tempPath() + QString("/test_transcodeparts_%1")
+            .arg(QCoreApplication::applicationPid());
+
+        frm_dir_map_t deleteMap;
+        deleteMap[0]    = MARK_CUT_START;
+        deleteMap[31]   = MARK_CUT_END;
+        deleteMap[407]  = MARK_CUT_START;
+        deleteMap[1203] = MARK_CUT_END;
+        deleteMap[2001] = MARK_CUT_START;
+        deleteMap[2222] = MARK_CUT_END;
+        deleteMap[2950] = MARK_CUT_START;
+
+        QVector<uint> serial = keptFrames(deleteMap);
+        QVERIFY (writeFile(base + ".serial", serial));
+
+        for (uint count = 2; count <= 6; count++)
+        {
+            QList<TranscodePart> split =
+                SplitForTranscode(keyframes(), deleteMap, FRAMES, count);
+            QVERIFY (split.size() > 1);
+
+            QStringList parts;
+            for (int i = 0; i < split.size(); i++)
+            {
+                parts << base + QString(".part%1").arg(i);
+                QVERIFY (writeFile(parts.last(),
+                                   keptFrames(split[i].cutlist)));
+            }
+            QVERIFY (JoinTranscodedParts(parts, base + ".joined", "nut"));
+
+            int serialFrames, joinedFrames;
+            int64_t serialDuration, joinedDuration;
+            bool serialContinuous, joinedContinuous;
+            QVector<uint> serialPictures, joinedPictures;
+            QVERIFY (readFile(base + ".serial", serialFrames, serialDuration,
+                              serialContinuous, serialPictures));
+            QVERIFY (readFile(base + ".joined", joinedFrames, joinedDuration,
+                              joinedContinuous, joinedPictures));
+
+            QCOMPARE (serialPictures, serial);
+            QCOMPARE (joinedFrames, serialFrames);
+            QCOMPARE (joinedDuration, serialDuration);
+            QVERIFY (joinedContinuous);
+            QCOMPARE (joinedPictures, serialPictures);
+
+            parts << base + ".joined";
+            for (int i = 0; i < parts.size(); i++)
+                QFile::remove(parts[i]);
+        }
+
+        QFile::remove(base + ".serial");
+    }
+};
@@ -0,0 +1,392 @@
+// C++ headers
+#include <algorithm>
+
+// Qt headers
+#include <QVector>
+#include <QPair>
+
+// MythTV headers
+#include "transcodeparts.h"
+#include "mythlogging.h"
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+#define LOC QString("TranscodeParts: ")
+
+/// Frames [first, second) of a recording
+typedef QPair<uint64_t, uint64_t> FrameRange;
+
+/// The frames left by the cutlist, the last range ends with the recording
+static QList<FrameRange> kept_ranges(const frm_dir_map_t &deleteMap)
+{
+    QList<FrameRange> kept;
+    uint64_t start = 0;
+    bool     cut   = !deleteMap.isEmpty() &&
+                     deleteMap.begin().value() == MARK_CUT_END;
+
+    frm_dir_map_t::const_iterator it = deleteMap.begin();
+    for (; it != deleteMap.end(); ++it)
+    {
+        if (*it == MARK_CUT_START && !cut)
+        {
+            if (it.key() > start)
+                kept.push_back(FrameRange(start, it.key()));
+            cut = true;
+        }
+        else if (*it == MARK_CUT_END && cut)
+        {
+            start = it.key();
+            cut = false;
+        }
+    }
+    if (!cut && start < TRANSCODE_PART_END)
+        kept.push_back(FrameRange(start, TRANSCODE_PART_END));
+
+    return kept;
+}
+
+static uint64_t kept_between(const QList<FrameRange> &kept,
+                             uint64_t start, uint64_t end)
+{
+    uint64_t frames = 0;
+    QList<FrameRange>::const_iterator it = kept.begin();
+    for (; it != kept.end(); ++it)
+    {
+        uint64_t s = std::max(it->first, start);
+        uint64_t e = std::min(it->second, end);
+        if (s < e)
+            frames += e - s;
+    }
+    return frames;
+}
+
+QString TranscodePart::CutListString(void) const
+{
+    QStringList cuts;
+    frm_dir_map_t::const_iterator it = cutlist.begin();
+    while (it != cutlist.end())
+    {
+        uint64_t start = it.key();
+        if (++it == cutlist.end())
+            break;
+        cuts << QString("%1-%2").arg(start).arg(it.key());
+        ++it;
+    }
+    return cuts.join(" ");
+}
+
+uint64_t TranscodeKeptFrames(const frm_dir_map_t &deleteMap,
+                             uint64_t totalFrames)
+{
+    return kept_between(kept_ranges(deleteMap), 0, totalFrames);
+}
+
+QList<TranscodePart> SplitForTranscode(
+    const frm_pos_map_t &keyMap, const frm_dir_map_t &deleteMap,
+    uint64_t totalFrames, uint count)
+{
+    QList<FrameRange> kept  = kept_ranges(deleteMap);
+    uint64_t          total = kept_between(kept, 0, totalFrames);
+
+    // Each part starts on the first keyframe past its share of the
+    // frames, the last one takes the rest.
+    QList<uint64_t> starts;
+    starts.push_back(0);
+    uint64_t before = 0;  // kept frames before the last start
+    frm_pos_map_t::const_iterator it = keyMap.begin();
+    for (; it != keyMap.end() && (uint)starts.size() < count; ++it)
+    {
+        uint64_t frame = it.key();
+        if (frame <= starts.last() || frame >= totalFrames)
+            continue;
+
+        uint64_t done = before + kept_between(kept, starts.last(), frame);
+        if (done <= before || done < total * starts.size() / count ||
+            done >= total)
+            continue;
+
+        starts.push_back(frame);
+        before = done;
+    }
+
+    QList<TranscodePart> parts;
+    for (int i = 0; i < starts.size(); i++)
+    {
+        TranscodePart part(starts[i], (i + 1 < starts.size()) ?
+                           starts[i + 1] : TRANSCODE_PART_END);
+        part.frames = kept_between(kept, part.start,
+                                   std::min(part.end, totalFrames));
+
+        // Cut everything but the kept frames of the part
+        uint64_t pos = 0;
+        QList<FrameRange>::const_iterator rit = kept.begin();
+        for (; rit != kept.end(); ++rit)
+        {
+            uint64_t s = std::max(rit->first, part.start);
+            uint64_t e = std::min(rit->second, part.end);
+            if (s >= e)
+                continue;
+            if (s > pos)
+            {
+                part.cutlist[pos] = MARK_CUT_START;
+                part.cutlist[s]   = MARK_CUT_END;
+            }
+            pos = e;
+        }
+        if (pos < TRANSCODE_PART_END)
+        {
+            part.cutlist[pos]                = MARK_CUT_START;
+            part.cutlist[TRANSCODE_PART_END] = MARK_CUT_END;
+        }
+
+        parts.push_back(part);
+    }
+
+    return parts;
+}
+
+static bool open_part(AVFormatContext **ic, const QString &filename)
+{
+    QByteArray fname = filename.toLocal8Bit();
+
+    int ret = avformat_open_input(ic, fname.constData(), NULL, NULL);
+    if (ret)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open %1, error #%2").arg(filename).arg(ret));
+        return false;
+    }
+
+    ret = avformat_find_stream_info(*ic, NULL);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't get stream info of %1, error #%2")
+            .arg(filename).arg(ret));
+        return false;
+    }
+
+    return true;
+}
+
+static bool open_output(AVFormatContext **oc, AVFormatContext *ic,
+                        const QString &outfile, const QString &container)
+{
+    QByteArray fname = outfile.toLocal8Bit();
+    QByteArray cname = container.toLatin1();
+
+    int ret = avformat_alloc_output_context2(
+        oc, NULL, container.isEmpty() ? NULL : cname.constData(),
+        fname.constData());
+    if (ret < 0 || !*oc)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't create %1, error #%2").arg(outfile).arg(ret));
+        return false;
+    }
+
+    for (uint i = 0; i < ic->nb_streams; i++)
+    {
+        AVStream *ist = ic->streams[i];
+        AVStream *ost = avformat_new_stream(*oc, NULL);
+        if (!ost || avcodec_copy_context(ost->codec, ist->codec) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Couldn't copy stream #%1").arg(i));
+            return false;
+        }
+
+        // Keep the tag unless the container has its own for the codec
+        unsigned int tag = ist->codec->codec_tag;
+        if ((*oc)->oformat->codec_tag &&
+            av_codec_get_id((*oc)->oformat->codec_tag, tag) !=
+            ist->codec->codec_id &&
+            av_codec_get_tag((*oc)->oformat->codec_tag,
+                             ist->codec->codec_id) > 0)
+            tag = 0;
+        ost->codec->codec_tag = tag;
+
+        if ((*oc)->oformat->flags & AVFMT_GLOBALHEADER)
+            ost->codec->flags |= CODEC_FLAG_GLOBAL_HEADER;
+        ost->time_base = ist->time_base;
+        ost->id = ist->id;
+        av_dict_copy(&ost->metadata, ist->metadata, 0);
+    }
+
+    ret = avio_open(&(*oc)->pb, fname.constData(), AVIO_FLAG_WRITE);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open %1, error #%2").arg(outfile).arg(ret));
+        return false;
+    }
+
+    ret = avformat_write_header(*oc, NULL);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't write the header, error #%1").arg(ret));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ *  The video of each part starts where the video of the previous one
+ *  ended, frame for frame, and its other streams move along with it.
+ *  Audio overlapping the end of the previous part is dropped.
+ */
+bool JoinTranscodedParts(const QStringList &parts, const QString &outfile,
+                         const QString &container)
+{
+    av_register_all();
+
+    AVFormatContext *oc       = NULL;
+    AVFormatContext *ic       = NULL;
+    int64_t          end      = 0;  // of the video so far, AV_TIME_BASE
+    QVector<int64_t> lastDts;       // per stream, AV_TIME_BASE
+    bool             ok       = true;
+    uint64_t         frames   = 0;
+
+    for (int i = 0; ok && i < parts.size(); i++)
+    {
+        if (!open_part(&ic, parts[i]))
+        {
+            ok = false;
+            break;
+        }
+
+        if (!oc)
+        {
+            if (!open_output(&oc, ic, outfile, container))
+            {
+                ok = false;
+                break;
+            }
+            lastDts.fill(AV_NOPTS_VALUE, oc->nb_streams);
+        }
+        else if (ic->nb_streams != oc->nb_streams)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("%1 has %2 streams instead of %3").arg(parts[i])
+                .arg(ic->nb_streams).arg(oc->nb_streams));
+            ok = false;
+            break;
+        }
+
+        int video = av_find_best_stream(ic, AVMEDIA_TYPE_VIDEO,
+                                        -1, -1, NULL, 0);
+        int64_t start = (ic->start_time != AV_NOPTS_VALUE) ?
+            ic->start_time : 0;
+        if (video >= 0 && ic->streams[video]->start_time != AV_NOPTS_VALUE)
+            start = av_rescale_q(ic->streams[video]->start_time,
+                                 ic->streams[video]->time_base,
+                                 AV_TIME_BASE_Q);
+        int64_t offset = (i == 0) ? 0 : end - start;
+
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Adding %1 at %2 ms").arg(parts[i]).arg(end / 1000));
+
+        AVPacket pkt;
+        av_init_packet(&pkt);
+        while (ok && av_read_frame(ic, &pkt) >= 0)
+        {
+            int       index = pkt.stream_index;
+            AVStream *ist   = ic->streams[index];
+            AVStream *ost   = oc->streams[index];
+
+            int64_t dts = (pkt.dts != AV_NOPTS_VALUE) ? pkt.dts : pkt.pts;
+            if (dts != AV_NOPTS_VALUE)
+            {
+                dts = av_rescale_q(dts, ist->time_base, AV_TIME_BASE_Q) +
+                      offset;
+                if (lastDts[index] != AV_NOPTS_VALUE && dts <= lastDts[index])
+                {
+                    if (index != video)
+                    {
+                        av_free_packet(&pkt);
+                        continue;
+                    }
+                    // Never expected, the video frames must all stay
+                    LOG(VB_GENERAL, LOG_WARNING, LOC +
+                        QString("Moving %1 by %2 us to keep the video going")
+                        .arg(parts[i]).arg(lastDts[index] + 1 - dts));
+                    offset += lastDts[index] + 1 - dts;
+                    dts = lastDts[index] + 1;
+                }
+                lastDts[index] = dts;
+            }
+
+            int64_t delta = av_rescale_q(offset, AV_TIME_BASE_Q,
+                                         ist->time_base);
+            if (pkt.pts != AV_NOPTS_VALUE)
+                pkt.pts += delta;
+            if (pkt.dts != AV_NOPTS_VALUE)
+                pkt.dts += delta;
+
+            if (index == video)
+            {
+                frames++;
+                if (pkt.pts != AV_NOPTS_VALUE)
+                {
+                    int64_t duration = pkt.duration;
+                    if (duration <= 0 && ist->avg_frame_rate.num)
+                        duration = av_rescale_q(1,
+                            av_inv_q(ist->avg_frame_rate), ist->time_base);
+                    end = std::max(end, av_rescale_q(pkt.pts + duration,
+                                                     ist->time_base,
+                                                     AV_TIME_BASE_Q));
+                }
+            }
+
+            if (pkt.pts != AV_NOPTS_VALUE)
+                pkt.pts = av_rescale_q(pkt.pts, ist->time_base,
+                                       ost->time_base);
+            if (pkt.dts != AV_NOPTS_VALUE)
+                pkt.dts = av_rescale_q(pkt.dts, ist->time_base,
+                                       ost->time_base);
+            pkt.duration = av_rescale_q(pkt.duration, ist->time_base,
+                                        ost->time_base);
+            pkt.pos = -1;
+
+            int ret = av_interleaved_write_frame(oc, &pkt);
+            av_free_packet(&pkt);
+            if (ret < 0)
+            {
+                LOG(VB_GENERAL, LOG_ERR, LOC +
+                    QString("Couldn't write a packet, error #%1").arg(ret));
+                ok = false;
+            }
+        }
+
+        avformat_close_input(&ic);
+        ic = NULL;
+    }
+
+    if (ic)
+        avformat_close_input(&ic);
+
+    if (oc)
+    {
+        if (ok && av_write_trailer(oc) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't write the end of the file");
+            ok = false;
+        }
+        if (oc->pb)
+            avio_closep(&oc->pb);
+        avformat_free_context(oc);
+    }
+
+    if (ok)
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Joined %1 parts, %2 video frames in %3 ms")
+            .arg(parts.size()).arg(frames).arg(end / 1000));
+    }
+
+    return ok;
+}
@@ -0,0 +1,51 @@
+#ifndef TRANSCODEPARTS_H_
+#define TRANSCODEPARTS_H_
+
+#include <QStringList>
+#include <QString>
+#include <QList>
+
+#include "mythtvexp.h"
+#include "programtypes.h"
+
+/// Frame number standing for the end of the recording in a cutlist
+#define TRANSCODE_PART_END 999999999ULL
+
+/** \class TranscodePart
+ *  \brief A part of a recording which can be transcoded on its own.
+ *
+ *  The part starts on a keyframe, and its cutlist drops everything
+ *  outside [start, end) as well as the cuts of the recording inside it.
+ */
+class MTV_PUBLIC TranscodePart
+{
+  public:
+    TranscodePart(uint64_t s, uint64_t e) : start(s), end(e), frames(0) {}
+
+    /// The cutlist as "start-end start-end...", the format of the
+    /// mythtranscode --honorcutlist argument
+    QString CutListString(void) const;
+
+    uint64_t      start;
+    uint64_t      end;     ///< TRANSCODE_PART_END for the last part
+    uint64_t      frames;  ///< frames left after the cuts
+    frm_dir_map_t cutlist;
+};
+
+/// Number of frames of the first \p totalFrames left by \p deleteMap
+MTV_PUBLIC uint64_t TranscodeKeptFrames(const frm_dir_map_t &deleteMap,
+                                        uint64_t totalFrames);
+
+/// Splits a recording at keyframes of \p keyMap into at most \p count
+/// parts with about the same number of frames left by \p deleteMap
+MTV_PUBLIC QList<TranscodePart> SplitForTranscode(
+    const frm_pos_map_t &keyMap, const frm_dir_map_t &deleteMap,
+    uint64_t totalFrames, uint count);
+
+/// Concatenates the transcoded \p parts into \p outfile with libavformat,
+/// moving the timestamps of each part to follow the previous one
+MTV_PUBLIC bool JoinTranscodedParts(const QStringList &parts,
+                                    const QString &outfile,
+                                    const QString &container);
+
+#endif // TRANSCODEPARTS_H_
@@ -8013,6 +8013,16 @@ void TV::UpdateOSDDebug(const PlayerContext *ctx)
     {
         InfoMap infoMap;
         ctx->player->GetPlaybackData(infoMap);
+
+        QStringList times;
+        for (int i = 0; i < ctx->lastTuningTimes.size(); i++)
+        {
+            times << QString("%1 %2 ms")
+                .arg(ctx->lastTuningTimes[i].section('=', 0, 0))
+                .arg(ctx->lastTuningTimes[i].section('=', 1));
+        }
+        infoMap["tuningtimes"] = times.join(", ");
+
         osd->ResetWindow("osd_debug");
         osd->SetText("osd_debug", infoMap, kOSDTimeout_None);
     }
@@ -9730,6 +9740,20 @@ void TV::customEvent(QEvent *e)
         ReturnPlayerLock(mctx);
     }
 
+    if (message.startsWith("TUNING_TIMES"))
+    {
+        cardnum = (tokens.size() >= 2) ? tokens[1].toUInt() : 0;
+
+        PlayerContext *mctx = GetPlayerReadLock(0, __FILE__, __LINE__);
+        for (uint i = 0; mctx && (i < player.size()); i++)
+        {
+            PlayerContext *ctx = GetPlayer(mctx, i);
+            if (ctx->recorder && (ctx->GetCardID() == cardnum))
+                ctx->lastTuningTimes = me->ExtraDataList();
+        }
+        ReturnPlayerLock(mctx);
+    }
+
     if (message.startsWith("NETWORK_CONTROL"))
     {
         if ((tokens.size() >= 2) &&
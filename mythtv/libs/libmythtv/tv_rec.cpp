@@ -31,6 +31,7 @@
 #include "mythconfig.h"
 #include "remoteutil.h"
 #include "ringbuffer.h"
+#include "psipcache.h"
 #include "v4lchannel.h"
 #include "dialogbox.h"
 #include "cardutil.h"
@@ -53,6 +54,9 @@ QMap<uint,TVRec*> TVRec::cards;
 static bool is_dishnet_eit(uint cardid);
 static int init_jobs(const RecordingInfo *rec, RecordingProfile &profile,
                      bool on_host, bool transcode_bfr_comm, bool on_line_comm);
+static bool is_realtime_commflag(const RecordingInfo *rec,
+                                 RecordingProfile &profile,
+                                 bool transcode_bfr_comm, bool on_line_comm);
 static void apply_broken_dvb_driver_crc_hack(ChannelBase*, MPEGStreamData*);
 static int eit_start_rand(uint cardid, int eitTransportTimeout);
 
@@ -103,7 +107,7 @@ TVRec::TVRec(int capturecardnum)
       pendingRecLock(QMutex::Recursive),
       internalState(kState_None), desiredNextState(kState_None),
       changeState(false), pauseNotify(true),
-      stateFlags(0), lastTuningRequest(0),
+      stateFlags(0), lastTuningRequest(0), psipSeeded(false),
       triggerEventLoopLock(QMutex::NonRecursive),
       triggerEventLoopSignal(false),
       triggerEventSleepLock(QMutex::NonRecursive),
@@ -832,6 +836,15 @@ void TVRec::StartedRecording(RecordingInfo *curRec)
     SendMythSystemRecEvent("REC_STARTED", curRec);
 }
 
+/// Whether the commercial flagging job of \p rec, if it has one, also
+/// saves the preview from the frames it decodes
+static bool commflag_saves_preview(const RecordingInfo *rec)
+{
+    int jobID = JobQueue::GetJobID(JOB_COMMFLAG, rec->GetChanID(),
+                                   rec->GetRecordingStartTime());
+    return (jobID >= 0) && (JobQueue::GetJobFlags(jobID) & JOB_PREVIEW);
+}
+
 /** \brief If not a premature stop, adds program to history of recorded
  *         programs. If the recording type is kOneRecord this find
  *         is removed.
@@ -945,13 +958,7 @@ void TVRec::FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq)
     if (!curRec->GetRecordingFile())
         curRec->LoadRecordingFile();
 
-    // Generate a preview
     uint64_t fsize = curRec->GetFilesize();
-    if (curRec->IsLocal() && (fsize >= 1000) &&
-        (curRec->GetRecordingStatus() == RecStatus::Recorded))
-    {
-        PreviewGeneratorQueue::GetPreviewImage(*curRec, "");
-    }
 
     // store recording in recorded table
     curRec->FinishedRecording(!is_good || (recgrp == "LiveTV"));
@@ -1007,6 +1014,15 @@ void TVRec::FinishedRecording(RecordingInfo *curRec, RecordingQuality *recq)
     if (*autoJob != JOB_NONE)
         JobQueue::QueueRecordingJobs(*curRec, *autoJob);
     autoRunJobs.erase(autoJob);
+
+    // Generate a preview, unless the commercial flagging job queued above
+    // or running since the start of the recording saves one
+    if (curRec->IsLocal() && (fsize >= 1000) &&
+        (curRec->GetRecordingStatus() == RecStatus::Recorded) &&
+        !commflag_saves_preview(curRec))
+    {
+        PreviewGeneratorQueue::GetPreviewImage(*curRec, "");
+    }
 }
 
 #define TRANSITION(ASTATE,BSTATE) \
@@ -1871,6 +1887,12 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
 
     const QString tuningmode = dtvchan->GetTuningMode();
 
+    // Tables of the multiplex seen the last time it was tuned, they save
+    // waiting for the next PAT, PMT and SDT before the signal is all good
+    psipCacheKey = PSIPCache::Key(dtvchan->GetCurrentSourceID(),
+                                  dtvchan->GetCurrentName());
+    psipSeeded = false;
+
     // Check if this is an ATSC Channel
     int major = dtvchan->GetMajorChannel();
     int minor = dtvchan->GetMinorChannel();
@@ -1898,6 +1920,8 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
         if (!ApplyCachedPids(sm, dtvchan))
             sm->AddFlags(SignalMonitor::kDTVSigMon_WaitForMGT);
 
+        psipSeeded = PSIPCache::Seed(psipCacheKey, sd) > 0;
+
         LOG(VB_RECORD, LOG_INFO, LOC +
             "Successfully set up ATSC table monitoring.");
         return true;
@@ -1935,6 +1959,8 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
                      SignalMonitor::kDVBSigMon_WaitForPos);
         sm->SetRotorTarget(1.0f);
 
+        psipSeeded = PSIPCache::Seed(psipCacheKey, sd) > 0;
+
         if (EITscan)
         {
             sm->GetStreamData()->SetVideoStreamsRequired(0);
@@ -1972,6 +1998,8 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
                      SignalMonitor::kDVBSigMon_WaitForPos);
         sm->SetRotorTarget(1.0f);
 
+        psipSeeded = PSIPCache::Seed(psipCacheKey, sd) > 0;
+
         if (EITscan)
         {
             sm->GetStreamData()->SetVideoStreamsRequired(0);
@@ -3533,6 +3561,9 @@ void TVRec::HandleTuning(void)
         LOG(VB_RECORD, LOG_INFO, LOC +
             "HandleTuning Request: " + request.toString());
 
+        tuningTimer.start();
+        tuningTimes.clear();
+
         QString input;
         request.channel = TuningGetChanNum(request, input);
         request.input   = input;
@@ -3541,6 +3572,7 @@ void TVRec::HandleTuning(void)
             LOG(VB_CHANNEL, LOG_INFO, LOC + "On same multiplex");
 
         TuningShutdowns(request);
+        TuningStageDone("shutdown");
 
         // The dequeue isn't safe to do until now because we
         // release the stateChangeLock to teardown a recorder
@@ -3555,6 +3587,7 @@ void TVRec::HandleTuning(void)
                 LOG(VB_RECORD, LOG_INFO, LOC +
                     "No recorder yet, calling TuningFrequency");
                 TuningFrequency(request);
+                TuningStageDone("tune");
             }
             else
             {
@@ -3577,12 +3610,18 @@ void TVRec::HandleTuning(void)
 #endif
         LOG(VB_RECORD, LOG_INFO, LOC +
             "Recorder paused, calling TuningFrequency");
+        TuningStageDone("pause");
         TuningFrequency(lastTuningRequest);
+        TuningStageDone("tune");
     }
 
     MPEGStreamData *streamData = NULL;
-    if (HasFlags(kFlagWaitingForSignal) && !(streamData = TuningSignalCheck()))
-        return;
+    if (HasFlags(kFlagWaitingForSignal))
+    {
+        if (!(streamData = TuningSignalCheck()))
+            return;
+        TuningStageDone("signal");
+    }
 
     if (HasFlags(kFlagNeedToStartRecorder))
     {
@@ -3590,6 +3629,8 @@ void TVRec::HandleTuning(void)
             TuningRestartRecorder();
         else
             TuningNewRecorder(streamData);
+        TuningStageDone("recorder");
+        TuningReportTimes();
 
 #if 0
         // If we got this far it is safe to set a new starting channel...
@@ -3599,6 +3640,45 @@ void TVRec::HandleTuning(void)
     }
 }
 
+/// Records the time taken by a step of the current tuning request
+void TVRec::TuningStageDone(const QString &stage)
+{
+    if (!tuningTimer.isRunning())
+        return;
+
+    tuningTimes << QString("%1=%2").arg(stage).arg(tuningTimer.restart());
+}
+
+/** \brief Logs how long each step of the last channel change took
+ *
+ *   For LiveTV the times are also sent to the frontends as a
+ *   "TUNING_TIMES <cardid>" event, with one "step=ms" string per step.
+ *   The frontend shows them in the playback debug OSD, so that slow
+ *   channel changes can be looked into there.
+ */
+void TVRec::TuningReportTimes(void)
+{
+    if (!tuningTimer.isRunning())
+        return;
+
+    uint total = 0;
+    QStringList::const_iterator it = tuningTimes.begin();
+    for (; it != tuningTimes.end(); ++it)
+        total += it->section('=', 1).toUInt();
+
+    LOG(VB_CHANNEL, LOG_INFO, LOC + QString("Tuned %1 in %2 ms (%3)")
+        .arg(lastTuningRequest.channel).arg(total)
+        .arg(tuningTimes.join(", ")));
+
+    if (lastTuningRequest.flags & kFlagLiveTV)
+    {
+        MythEvent me(QString("TUNING_TIMES %1").arg(cardid), tuningTimes);
+        gCoreContext->dispatch(me);
+    }
+
+    tuningTimer.stop();
+}
+
 /** \fn TVRec::TuningCheckForHWChange(const TuningRequest&,QString&,QString&)
  *  \brief Returns cardid for device info row in capturecard if it changes.
  */
@@ -3973,8 +4053,17 @@ MPEGStreamData *TVRec::TuningSignalCheck(void)
 {
     RecStatus::Type newRecStatus;
     bool          keep_trying  = false;
+    bool          good_signal  = signalMonitor->IsAllGood();
 
-    if (signalMonitor->IsAllGood())
+    // Tables seeded from the PSIPCache match at once, they don't show
+    // that the stream is flowing. Wait for one from the tuner as well.
+    if (good_signal && psipSeeded && GetDTVSignalMonitor())
+    {
+        MPEGStreamData *sd = GetDTVSignalMonitor()->GetStreamData();
+        good_signal = !sd || sd->HasReceivedTables();
+    }
+
+    if (good_signal)
     {
         LOG(VB_RECORD, LOG_INFO, LOC + "TuningSignalCheck: Good signal");
         if (curRecording && (MythDate::current() > startRecordingDeadline))
@@ -4093,6 +4182,10 @@ MPEGStreamData *TVRec::TuningSignalCheck(void)
     if (GetDTVSignalMonitor())
         streamData = GetDTVSignalMonitor()->GetStreamData();
 
+    // Only keep the tables of a tuning that worked
+    if (good_signal && streamData && !psipCacheKey.isEmpty())
+        PSIPCache::Save(psipCacheKey, streamData);
+
     if (!HasFlags(kFlagEITScannerRunning))
     {
         // shut down signal monitoring
@@ -4118,12 +4211,9 @@ MPEGStreamData *TVRec::TuningSignalCheck(void)
     return streamData;
 }
 
-static int init_jobs(const RecordingInfo *rec, RecordingProfile &profile,
-                      bool on_host, bool transcode_bfr_comm, bool on_line_comm)
+/// The jobs the recording asks for that the profile allows
+static int profile_jobs(const RecordingInfo *rec, RecordingProfile &profile)
 {
-    if (!rec)
-        return 0; // no jobs for Live TV recordings..
-
     int jobs = 0; // start with no jobs
 
     // grab standard jobs flags from program info
@@ -4138,6 +4228,38 @@ static int init_jobs(const RecordingInfo *rec, RecordingProfile &profile,
     if ((!autoTrans) || (autoTrans->getValue().toInt() == 0))
         JobQueue::RemoveJobsFromMask(JOB_TRANSCODE, jobs);
 
+    return jobs;
+}
+
+static bool realtime_commflag(int jobs, bool transcode_bfr_comm,
+                              bool on_line_comm)
+{
+    // is commercial flagging enabled, and is on-line comm flagging enabled?
+    bool rt = JobQueue::JobIsInMask(JOB_COMMFLAG, jobs) && on_line_comm;
+    // also, we either need transcoding to be disabled or
+    // we need to be allowed to commercial flag before transcoding?
+    rt &= JobQueue::JobIsNotInMask(JOB_TRANSCODE, jobs) ||
+        !transcode_bfr_comm;
+    return rt;
+}
+
+/// Whether the recording is flagged while it is being recorded
+static bool is_realtime_commflag(const RecordingInfo *rec,
+                                 RecordingProfile &profile,
+                                 bool transcode_bfr_comm, bool on_line_comm)
+{
+    return rec && realtime_commflag(profile_jobs(rec, profile),
+                                    transcode_bfr_comm, on_line_comm);
+}
+
+static int init_jobs(const RecordingInfo *rec, RecordingProfile &profile,
+                      bool on_host, bool transcode_bfr_comm, bool on_line_comm)
+{
+    if (!rec)
+        return 0; // no jobs for Live TV recordings..
+
+    int jobs = profile_jobs(rec, profile);
+
     bool ml = JobQueue::JobIsInMask(JOB_METADATA, jobs);
     if (ml)
     {
@@ -4154,20 +4276,15 @@ static int init_jobs(const RecordingInfo *rec, RecordingProfile &profile,
         JobQueue::RemoveJobsFromMask(JOB_METADATA, jobs);
     }
 
-    // is commercial flagging enabled, and is on-line comm flagging enabled?
-    bool rt = JobQueue::JobIsInMask(JOB_COMMFLAG, jobs) && on_line_comm;
-    // also, we either need transcoding to be disabled or
-    // we need to be allowed to commercial flag before transcoding?
-    rt &= JobQueue::JobIsNotInMask(JOB_TRANSCODE, jobs) ||
-        !transcode_bfr_comm;
-    if (rt)
+    if (realtime_commflag(jobs, transcode_bfr_comm, on_line_comm))
     {
         // queue up real-time (i.e. on-line) commercial flagging.
         QString host = (on_host) ? gCoreContext->GetHostName() : "";
         JobQueue::QueueJob(JOB_COMMFLAG,
                            rec->GetChanID(),
                            rec->GetRecordingStartTime(), "", "",
-                           host, JOB_LIVE_REC);
+                           host, JOB_LIVE_REC |
+                           JobQueue::GetCommFlagPassFlags());
 
         // don't do regular comm flagging, we won't need it.
         JobQueue::RemoveJobsFromMask(JOB_COMMFLAG, jobs);
@@ -4273,6 +4390,15 @@ void TVRec::TuningNewRecorder(MPEGStreamData *streamData)
             ClearFlags(kFlagPendingActions, __FILE__, __LINE__);
             goto err_ret;
         }
+
+        // Let the flagger follow the recording from memory when it
+        // is sure to run on this host
+        uint tapSize = gCoreContext->GetNumSetting("RecordingTapSize", 128);
+        if (wr && runJobOnHostOnly && tapSize &&
+            is_realtime_commflag(rec, profile, transcodeFirst, earlyCommFlag))
+        {
+            ringBuffer->StartRecordingTap(tapSize * 1024 * 1024);
+        }
 #ifdef CC_DUMP
         QString textfname = QString("%1.txd").arg(rec->GetPathname());
         genOpt.textfd = open(textfname.toAscii(),
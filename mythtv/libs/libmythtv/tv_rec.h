@@ -308,6 +308,8 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
                                 QString &channum,
                                 QString &inputname);
     bool TuningOnSameMultiplex(TuningRequest &request);
+    void TuningStageDone(const QString &stage);
+    void TuningReportTimes(void);
 
     void HandleStateChange(void);
     void ChangeState(TVState nextState);
@@ -393,6 +395,13 @@ class MTV_PUBLIC TVRec : public SignalMonitorListener, public QRunnable
     uint           stateFlags;
     TuningQueue    tuningRequests;
     TuningRequest  lastTuningRequest;
+    /// Time spent in each step of the last tuning, as "step=ms"
+    QStringList    tuningTimes;
+    MythTimer      tuningTimer;
+    /// PSIPCache key of the multiplex being monitored
+    QString        psipCacheKey;
+    /// Whether the stream data was seeded with cached tables
+    bool           psipSeeded;
     QDateTime      eitScanStartTime;
     mutable QMutex triggerEventLoopLock;
     QWaitCondition triggerEventLoopWait;
@@ -8,6 +8,7 @@
 
 // QT headers
 #include <QImageReader>
+#include <QBuffer>
 #include <QPainter>
 #include <QMatrix>
 #include <QNetworkReply>
@@ -25,6 +26,10 @@
 #include "mythmainwindow.h"
 
 MythUIHelper *MythImage::s_ui = NULL;
+QAtomicInt MythImage::s_NativeBytes(0);
+
+/// Limit of the memory held by converted copies waiting for their upload
+static const int kMaxNativeBytes = 32 * 1024 * 1024;
 
 MythImage::MythImage(MythPainter *parent, const char *name) :
     ReferenceCounter(name)
@@ -59,6 +64,9 @@ MythImage::~MythImage()
 {
     if (m_Parent)
         m_Parent->DeleteFormatImage(this);
+
+    QMutexLocker locker(&m_NativeLock);
+    ReleaseNativeImage();
 }
 
 int MythImage::IncrRef(void)
@@ -87,6 +95,56 @@ int MythImage::DecrRef(void)
     return cnt;
 }
 
+void MythImage::SetChanged(bool change)
+{
+    m_Changed = change;
+
+    if (change)
+    {
+        QMutexLocker locker(&m_NativeLock);
+        ReleaseNativeImage();
+    }
+}
+
+/**
+ *  \brief Whether a converted copy of \p image may be kept until its upload.
+ *
+ *  The copies double the memory of their images until the painter takes
+ *  them, so all of them together are limited to kMaxNativeBytes. Images
+ *  past that are converted by the painter while drawing, as before.
+ */
+bool MythImage::CanKeepNativeImage(const QImage &image)
+{
+    return s_NativeBytes.fetchAndAddOrdered(0) + image.byteCount() <=
+        kMaxNativeBytes;
+}
+
+/// Keeps a copy of the image converted for the painter, see
+/// MythPainter::PrepareImage()
+void MythImage::SetNativeImage(const QImage &native)
+{
+    QMutexLocker locker(&m_NativeLock);
+    ReleaseNativeImage();
+    m_NativeImage = native;
+    s_NativeBytes.fetchAndAddOrdered(m_NativeImage.byteCount());
+}
+
+/// Hands the converted copy, if any, over to the painter uploading it
+QImage MythImage::TakeNativeImage(void)
+{
+    QMutexLocker locker(&m_NativeLock);
+    QImage native = m_NativeImage;
+    ReleaseNativeImage();
+    return native;
+}
+
+/// Drops the converted copy, m_NativeLock must be held
+void MythImage::ReleaseNativeImage(void)
+{
+    s_NativeBytes.fetchAndAddOrdered(-m_NativeImage.byteCount());
+    m_NativeImage = QImage();
+}
+
 void MythImage::SetIsInCache(bool bCached)
 {
     IncrRef();
@@ -317,7 +375,42 @@ bool MythImage::Load(MythImageReader *reader)
     return false;
 }
 
-bool MythImage::Load(const QString &filename)
+/// Reads an image, letting the decoder scale it down first when it is larger
+/// than needed to cover targetSize. For JPEG this decodes at a fraction of
+/// the resolution, which is much faster for big cover art.
+static QImage *read_image(QImageReader &reader, const QSize &targetSize)
+{
+    if (targetSize.width() > 0 && targetSize.height() > 0)
+    {
+        QSize size = reader.size();
+        QSize scaledSize = size;
+        scaledSize.scale(targetSize, Qt::KeepAspectRatioByExpanding);
+
+        if (size.isValid() && scaledSize.width() < size.width() &&
+            scaledSize.height() < size.height())
+        {
+            reader.setScaledSize(scaledSize);
+        }
+    }
+
+    QImage *im = new QImage();
+    if (!reader.read(im))
+    {
+        delete im;
+        return NULL;
+    }
+
+    return im;
+}
+
+/**
+ *  \brief Loads a local, myth:// or remote image.
+ *
+ *  \param targetSize If valid, the size the image will be scaled to
+ *                    afterwards, the image may then be decoded at a lower
+ *                    resolution still covering it.
+ */
+bool MythImage::Load(const QString &filename, const QSize &targetSize)
 {
     if (filename.isEmpty())
         return false;
@@ -346,8 +439,9 @@ bool MythImage::Load(const QString &filename)
 
             if (ret)
             {
-                im = new QImage();
-                im->loadFromData(data);
+                QBuffer buffer(&data);
+                QImageReader reader(&buffer);
+                im = read_image(reader, targetSize);
             }
         }
 #if 0
@@ -365,8 +459,9 @@ bool MythImage::Load(const QString &filename)
         QByteArray data;
         if (GetMythDownloadManager()->download(filename, &data))
         {
-            im = new QImage();
-            im->loadFromData(data);
+            QBuffer buffer(&data);
+            QImageReader reader(&buffer);
+            im = read_image(reader, targetSize);
         }
     }
     else
@@ -374,7 +469,10 @@ bool MythImage::Load(const QString &filename)
         QString path = filename;
         if (path.startsWith('/') ||
             GetMythUI()->FindThemeFile(path))
-            im = new QImage(path);
+        {
+            QImageReader reader(path);
+            im = read_image(reader, targetSize);
+        }
     }
 
     if (im && im->isNull())
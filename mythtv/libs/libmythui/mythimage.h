@@ -5,6 +5,7 @@
 
 #include <QImage>
 #include <QMutex>
+#include <QAtomicInt>
 #include <QPixmap>
 #include <QImageReader>
 
@@ -40,9 +41,13 @@ class MUI_PUBLIC MythImage : public QImage, public ReferenceCounter
     virtual int IncrRef(void);
     virtual int DecrRef(void);
 
-    virtual void SetChanged(bool change = true) { m_Changed = change; }
+    virtual void SetChanged(bool change = true);
     bool IsChanged() const { return m_Changed; }
 
+    static bool CanKeepNativeImage(const QImage &image);
+    void SetNativeImage(const QImage &native);
+    QImage TakeNativeImage(void);
+
     bool IsGradient() const { return m_isGradient; }
     bool IsReflected() const { return m_isReflected; }
     bool IsOriented() const { return m_isOriented; }
@@ -54,7 +59,7 @@ class MUI_PUBLIC MythImage : public QImage, public ReferenceCounter
     void Assign(const QPixmap &pix);
 
     bool Load(MythImageReader *reader);
-    bool Load(const QString &filename);
+    bool Load(const QString &filename, const QSize &targetSize = QSize());
 
     void Orientation(int orientation);
     void Resize(const QSize &newSize, bool preserveAspect = false);
@@ -100,6 +105,13 @@ class MUI_PUBLIC MythImage : public QImage, public ReferenceCounter
     bool m_Changed;
     MythPainter *m_Parent;
 
+    void ReleaseNativeImage(void);
+
+    QMutex m_NativeLock;
+    QImage m_NativeImage;
+    /// Bytes held by the converted copies of all images
+    static QAtomicInt s_NativeBytes;
+
     bool m_isGradient;
     QColor m_gradBegin;
     QColor m_gradEnd;
@@ -24,6 +24,7 @@ using namespace std;
 #include <QEvent>
 #include <QKeyEvent>
 #include <QKeySequence>
+#include <QElapsedTimer>
 #include <QSize>
 
 // Platform headers
@@ -46,6 +47,7 @@ using namespace std;
 #include "mythmedia.h"
 #include "mythmiscutil.h"
 #include "mythdate.h"
+#include "mythtimer.h"
 
 // libmythui headers
 #include "myththemebase.h"
@@ -74,6 +76,7 @@ using namespace std;
 
 #include "mythscreentype.h"
 #include "mythpainter.h"
+#include "mythfontproperties.h"
 #ifdef USE_OPENGL_PAINTER
 #include "mythpainter_ogl.h"
 #endif
@@ -173,6 +176,11 @@ class MythMainWindowPrivate
 
         AllowInput(true),
 
+        repaintFrames(0),
+        repaintNsecs(0),
+        repaintMaxNsecs(0),
+        repaintPixels(0),
+
         gesture(MythGesture()),
         gestureTimer(NULL),
         hideMouseTimer(NULL),
@@ -262,6 +270,17 @@ class MythMainWindowPrivate
     bool AllowInput;
 
     QRegion repaintRegion;
+    /// Parts of the last frame drawn without some of their images, because
+    /// the painter ran out of its upload budget
+    QRegion deferredRegion;
+
+    // Statistics shown by the repaint debug overlay
+    uint      repaintFrames;
+    qint64    repaintNsecs;
+    qint64    repaintMaxNsecs;
+    qint64    repaintPixels;
+    MythTimer repaintStatsTimer;
+    QString   repaintStats;
 
     MythGesture gesture;
     QTimer *gestureTimer;
@@ -707,6 +726,74 @@ MythScreenStack* MythMainWindow::GetStackAt(int pos)
     return NULL;
 }
 
+/// Where the repaint debug overlay shows the render time statistics
+static QRect repaint_stats_rect(const QRect &screen)
+{
+    return QRect(screen.left() + 8, screen.top() + 8, 560, 32);
+}
+
+/**
+ *  Outlines an area redrawn in this frame in a colour changing with every
+ *  frame, so areas redrawn over and over again stand out, and shows the
+ *  render time statistics.
+ */
+static void DrawRepaintOverlay(MythMainWindowPrivate *d, const QRect &rect)
+{
+    static const QBrush nullbrush(Qt::NoBrush);
+
+    QPen pen(QColor::fromHsv((d->repaintFrames * 47) % 360, 255, 255));
+    pen.setWidth(2);
+    d->painter->DrawRect(rect.adjusted(1, 1, -1, -1), nullbrush, pen, 255);
+
+    QRect statsrect = repaint_stats_rect(d->uiScreenRect);
+    if (!rect.intersects(statsrect) || d->repaintStats.isEmpty())
+        return;
+
+    static const QBrush background(QColor(0, 0, 0, 192));
+    d->painter->DrawRect(statsrect, background, QPen(Qt::NoPen), 255);
+
+    MythFontProperties font;
+    font.SetFace(QFont("Droid Sans"));
+    font.SetColor(Qt::white);
+    font.SetPointSize(10);
+    d->painter->DrawText(statsrect.adjusted(6, 0, -6, 0), d->repaintStats,
+                         Qt::AlignLeft | Qt::AlignVCenter, font, 255,
+                         statsrect);
+}
+
+/// Sums up the render times of the last second for the debug overlay
+static void UpdateRepaintStats(MythMainWindowPrivate *d)
+{
+    if (!d->repaintStatsTimer.isRunning())
+        d->repaintStatsTimer.start();
+
+    int elapsed = d->repaintStatsTimer.elapsed();
+    if (elapsed < 1000)
+        return;
+
+    qint64 screen = (qint64)d->uiScreenRect.width() *
+                    d->uiScreenRect.height();
+    double avg = d->repaintFrames ?
+        d->repaintNsecs / (1000000.0 * d->repaintFrames) : 0.0;
+
+    d->repaintStats = QString("%1 frames/s, %2 ms avg, %3 ms max, "
+                              "%4% of the screen redrawn")
+        .arg(d->repaintFrames * 1000.0 / elapsed, 0, 'f', 1)
+        .arg(avg, 0, 'f', 2)
+        .arg(d->repaintMaxNsecs / 1000000.0, 0, 'f', 2)
+        .arg((screen && d->repaintFrames) ?
+             (100 * d->repaintPixels) / (screen * d->repaintFrames) : 0);
+
+    d->repaintFrames   = 0;
+    d->repaintNsecs    = 0;
+    d->repaintMaxNsecs = 0;
+    d->repaintPixels   = 0;
+    d->repaintStatsTimer.start();
+
+    d->repaintRegion = d->repaintRegion.united(
+        repaint_stats_rect(d->uiScreenRect));
+}
+
 void MythMainWindow::animate(void)
 {
     /* FIXME: remove */
@@ -720,6 +807,15 @@ void MythMainWindow::animate(void)
 
     bool redraw = false;
 
+    if (!d->deferredRegion.isEmpty())
+    {
+        d->repaintRegion = d->repaintRegion.united(d->deferredRegion);
+        d->deferredRegion = QRegion();
+    }
+
+    if (d->painter && d->painter->ShowRepaints())
+        UpdateRepaintStats(d);
+
     if (!d->repaintRegion.isEmpty())
         redraw = true;
 
@@ -816,16 +912,23 @@ void MythMainWindow::draw(void)
     if (!d->painter)
         return;
 
+    QElapsedTimer frametime;
+    frametime.start();
+
     d->painter->Begin(d->paintwin);
 
     QVector<QRect> rects = d->repaintRegion.rects();
 
+    // Painters keeping the last frame also need the clip rectangle
+    // to know what to clear
+    bool clipfullscreen = d->painter->SupportsClipping();
+
     for (int i = 0; i < rects.size(); i++)
     {
         if (rects[i].width() == 0 || rects[i].height() == 0)
             continue;
 
-        if (rects[i] != d->uiScreenRect)
+        if (rects[i] != d->uiScreenRect || clipfullscreen)
             d->painter->SetClipRect(rects[i]);
 
         QVector<MythScreenStack *>::Iterator it;
@@ -841,9 +944,26 @@ void MythMainWindow::draw(void)
                 (*screenit)->Draw(d->painter, 0, 0, 255, rects[i]);
             }
         }
+
+        if (d->painter->ShowRepaints())
+            DrawRepaintOverlay(d, rects[i]);
     }
 
     d->painter->End();
+
+    if (d->painter->ShowRepaints())
+    {
+        qint64 nsecs = frametime.nsecsElapsed();
+        d->repaintFrames++;
+        d->repaintNsecs += nsecs;
+        d->repaintMaxNsecs = max(d->repaintMaxNsecs, nsecs);
+        for (int i = 0; i < rects.size(); i++)
+            d->repaintPixels += rects[i].width() * rects[i].height();
+    }
+
+    // Draw again once the images which did not make it are uploaded
+    if (d->painter->UploadsDeferred())
+        d->deferredRegion = d->deferredRegion.united(d->repaintRegion);
 }
 
 void MythMainWindow::closeEvent(QCloseEvent *e)
@@ -1142,6 +1262,9 @@ void MythMainWindow::Init(QString forcedpainter)
         setAutoFillBackground(false);
     }
 
+    d->painter->SetMaximumUploadsPerFrame(
+        GetMythDB()->GetNumSetting("UIMaxUploadsPerFrame", 8));
+
     d->paintwin->move(0, 0);
     ResizePainterWindow(size());
     d->paintwin->raise();
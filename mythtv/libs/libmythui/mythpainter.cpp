@@ -19,8 +19,10 @@
 #include "mythpainter.h"
 
 MythPainter::MythPainter()
-  : m_Parent(0), m_HardwareCacheSize(0), m_SoftwareCacheSize(0),
-    m_showBorders(false), m_showNames(false)
+  : m_Parent(0), m_HardwareCacheSize(0),
+    m_UploadsThisFrame(0), m_MaxUploadsPerFrame(0), m_UploadsDeferred(false),
+    m_SoftwareCacheSize(0), m_showBorders(false), m_showNames(false),
+    m_showRepaints(false)
 {
     SetMaximumCacheSizes(96, 48);
 }
@@ -621,3 +623,23 @@ void MythPainter::SetMaximumCacheSizes(int hardware, int software)
         .arg(m_MaxHardwareCacheSize / (1024 * 1024))
         .arg(m_MaxSoftwareCacheSize / (1024 * 1024)));
 }
+
+/**
+ *  \brief Called by the painters before uploading an image which is not yet
+ *         known to the graphics hardware.
+ *
+ *  \return false if the upload budget of the current frame is spent, in
+ *          which case the image should be skipped, or its previous version
+ *          drawn, and the frame will be redrawn soon.
+ */
+bool MythPainter::AllowUpload(void)
+{
+    if (m_MaxUploadsPerFrame > 0 && m_UploadsThisFrame >= m_MaxUploadsPerFrame)
+    {
+        m_UploadsDeferred = true;
+        return false;
+    }
+
+    m_UploadsThisFrame++;
+    return true;
+}
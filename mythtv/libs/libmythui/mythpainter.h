@@ -47,7 +47,12 @@ class MUI_PUBLIC MythPainter
     virtual bool SupportsAlpha(void) = 0;
     virtual bool SupportsClipping(void) = 0;
     virtual void FreeResources(void) { }
-    virtual void Begin(QPaintDevice *parent) { m_Parent = parent; }
+    virtual void Begin(QPaintDevice *parent)
+    {
+        m_Parent = parent;
+        m_UploadsThisFrame = 0;
+        m_UploadsDeferred = false;
+    }
     virtual void End() { m_Parent = NULL; }
 
     virtual void SetClipRect(const QRect &clipRect);
@@ -87,6 +92,11 @@ class MUI_PUBLIC MythPainter
     MythImage *GetFormatImage();
     void DeleteFormatImage(MythImage *im);
 
+    /// Does the pixel conversion needed before the image can be uploaded
+    /// to the graphics hardware, so it need not be done when drawing.
+    /// \note Safe to call from any thread.
+    virtual void PrepareImage(MythImage *im) { (void)im; }
+
     void SetDebugMode(bool showBorders, bool showNames)
     {
         m_showBorders = showBorders;
@@ -96,8 +106,21 @@ class MUI_PUBLIC MythPainter
     bool ShowBorders(void) { return m_showBorders; }
     bool ShowTypeNames(void) { return m_showNames; }
 
+    /// Outlines the areas redrawn in each frame and shows the UI render
+    /// time, see MythMainWindow::draw()
+    void SetShowRepaints(bool showRepaints) { m_showRepaints = showRepaints; }
+    bool ShowRepaints(void) { return m_showRepaints; }
+
     void SetMaximumCacheSizes(int hardware, int software);
 
+    /// Limits the number of new images uploaded while drawing one frame,
+    /// 0 for no limit.
+    void SetMaximumUploadsPerFrame(int uploads)
+        { m_MaxUploadsPerFrame = uploads; }
+    /// True if images were left out of the last frame to stay in budget,
+    /// and so the frame needs to be drawn again.
+    bool UploadsDeferred(void) const { return m_UploadsDeferred; }
+
   protected:
     void DrawTextPriv(MythImage *im, const QString &msg, int flags,
                       const QRect &r, const MythFontProperties &font);
@@ -124,10 +147,14 @@ class MUI_PUBLIC MythPainter
     virtual void Teardown(void);
 
     void CheckFormatImage(MythImage *im);
+    bool AllowUpload(void);
 
     QPaintDevice *m_Parent;
     int m_HardwareCacheSize;
     int m_MaxHardwareCacheSize;
+    int m_UploadsThisFrame;
+    int m_MaxUploadsPerFrame;
+    bool m_UploadsDeferred;
 
   private:
     int64_t m_SoftwareCacheSize;
@@ -141,6 +168,7 @@ class MUI_PUBLIC MythPainter
 
     bool m_showBorders;
     bool m_showNames;
+    bool m_showRepaints;
 };
 
 #endif
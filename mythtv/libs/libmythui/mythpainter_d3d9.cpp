@@ -200,7 +200,8 @@ D3D9Image* MythD3D9Painter::GetImageFromCache(MythImage *im)
 {
     if (m_ImageBitmapMap.contains(im))
     {
-        if (!im->IsChanged())
+        // Keep showing the old surface when the upload budget is spent
+        if (!im->IsChanged() || !AllowUpload())
         {
             m_ImageExpireList.remove(im);
             m_ImageExpireList.push_back(im);
@@ -211,6 +212,10 @@ D3D9Image* MythD3D9Painter::GetImageFromCache(MythImage *im)
             DeleteFormatImagePriv(im);
         }
     }
+    else if (!AllowUpload())
+    {
+        return NULL;
+    }
 
     im->SetChanged(false);
     D3D9Image *newimage = NULL;
@@ -20,7 +20,8 @@ using namespace std;
 MythOpenGLPainter::MythOpenGLPainter(MythRenderOpenGL *render,
                                      QGLWidget *parent) :
     MythPainter(), realParent(parent), realRender(render),
-    target(0), swapControl(true)
+    target(0), swapControl(true),
+    m_uiTexture(0), m_uiFramebuffer(0), m_uiValid(false), m_retained(false)
 {
     if (realRender)
         LOG(VB_GENERAL, LOG_INFO,
@@ -39,6 +40,85 @@ void MythOpenGLPainter::FreeResources(void)
 {
     ClearCache();
     DeleteTextures();
+    DeleteRetainedBuffer();
+}
+
+/**
+ *  Partial updates need the previous frame, which is gone after swapping
+ *  the buffers, so the main UI is drawn into a framebuffer object which is
+ *  then copied to the screen. Only possible while this painter is in charge
+ *  of swapping, i.e. not while it draws the OSD of a video.
+ */
+bool MythOpenGLPainter::SupportsClipping(void)
+{
+    return m_uiValid && !target && swapControl && realParent &&
+           m_uiSize == realParent->size();
+}
+
+bool MythOpenGLPainter::CreateRetainedBuffer(const QSize &size)
+{
+    if (m_uiFramebuffer && m_uiSize == size)
+        return true;
+
+    DeleteRetainedBuffer();
+
+    if (!(realRender->GetFeatures() & kGLExtFBufObj))
+        return false;
+
+    m_uiTexture = realRender->CreateTexture(size, false, 0, GL_UNSIGNED_BYTE,
+                                            GL_RGBA, GL_RGBA8, GL_NEAREST);
+    if (!m_uiTexture)
+        return false;
+
+    if (!realRender->CreateFrameBuffer(m_uiFramebuffer, m_uiTexture))
+    {
+        LOG(VB_GENERAL, LOG_WARNING,
+            "OpenGL painter failed to create the UI framebuffer, "
+            "redrawing the whole screen for each update.");
+        realRender->DeleteTexture(m_uiTexture);
+        m_uiTexture = 0;
+        m_uiFramebuffer = 0;
+        return false;
+    }
+
+    m_uiSize = size;
+    return true;
+}
+
+void MythOpenGLPainter::DeleteRetainedBuffer(void)
+{
+    if (realRender)
+    {
+        if (m_uiFramebuffer)
+            realRender->DeleteFrameBuffer(m_uiFramebuffer);
+        if (m_uiTexture)
+            realRender->DeleteTexture(m_uiTexture);
+    }
+    m_uiFramebuffer = 0;
+    m_uiTexture     = 0;
+    m_uiSize        = QSize();
+    m_uiValid       = false;
+}
+
+/// Framebuffer everything is drawn into, the retained UI buffer if in use
+uint MythOpenGLPainter::DrawTarget(void) const
+{
+    return m_retained ? m_uiFramebuffer : target;
+}
+
+/**
+ *  Limits drawing to the area being redrawn, and clears it in the retained
+ *  buffer. MythMainWindow only calls this if SupportsClipping().
+ */
+void MythOpenGLPainter::SetClipRect(const QRect &clipRect)
+{
+    if (!realRender || !m_retained)
+        return;
+
+    realRender->SetScissor(clipRect);
+    realRender->SetAlphaWrites(true);
+    realRender->ClearFramebuffer();
+    realRender->SetAlphaWrites(false);
 }
 
 void MythOpenGLPainter::DeleteTextures(void)
@@ -100,7 +180,27 @@ void MythOpenGLPainter::Begin(QPaintDevice *parent)
     DeleteTextures();
     realRender->makeCurrent();
 
-    if (target || swapControl)
+    m_retained = !target && swapControl &&
+                 CreateRetainedBuffer(realParent->size());
+    if (!m_retained)
+        m_uiValid = false;
+
+    if (m_retained)
+    {
+        // The retained buffer is cleared to opaque black and its alpha is
+        // left alone while drawing, so it looks the same when copied to
+        // the screen as if it had been drawn there directly.
+        realRender->BindFramebuffer(m_uiFramebuffer);
+        realRender->SetViewPort(QRect(0, 0, realParent->width(), realParent->height()));
+        realRender->SetColor(255, 255, 255, 255);
+        realRender->SetBackground(0, 0, 0, 255);
+        realRender->SetScissor(QRect());
+        realRender->SetAlphaWrites(true);
+        if (!m_uiValid)
+            realRender->ClearFramebuffer();
+        realRender->SetAlphaWrites(false);
+    }
+    else if (target || swapControl)
     {
         realRender->BindFramebuffer(target);
         realRender->SetViewPort(QRect(0, 0, realParent->width(), realParent->height()));
@@ -119,6 +219,16 @@ void MythOpenGLPainter::End(void)
     }
     else
     {
+        if (m_retained)
+        {
+            QRect rect(QPoint(0, 0), m_uiSize);
+            realRender->SetScissor(QRect());
+            realRender->SetAlphaWrites(true);
+            realRender->DrawBitmap(m_uiTexture, 0, &rect, &rect, 0);
+            m_uiValid = true;
+            m_retained = false;
+        }
+
         realRender->Flush(false);
         if (target == 0 && swapControl)
             realRender->swapBuffers();
@@ -128,6 +238,14 @@ void MythOpenGLPainter::End(void)
     MythPainter::End();
 }
 
+/// Converts the image to the layout uploaded by GetTextureFromCache(),
+/// so image loader threads can do it instead of the UI thread.
+void MythOpenGLPainter::PrepareImage(MythImage *im)
+{
+    if (im && !im->isNull() && MythImage::CanKeepNativeImage(*im))
+        im->SetNativeImage(QGLWidget::convertToGLFormat(*im));
+}
+
 int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
 {
     if (!realRender)
@@ -135,7 +253,8 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
 
     if (m_ImageIntMap.contains(im))
     {
-        if (!im->IsChanged())
+        // Keep showing the old texture when the upload budget is spent
+        if (!im->IsChanged() || !AllowUpload())
         {
             m_ImageExpireList.remove(im);
             m_ImageExpireList.push_back(im);
@@ -146,10 +265,16 @@ int MythOpenGLPainter::GetTextureFromCache(MythImage *im)
             DeleteFormatImagePriv(im);
         }
     }
+    else if (!AllowUpload())
+    {
+        return 0;
+    }
 
+    QImage tx = im->TakeNativeImage();
     im->SetChanged(false);
 
-    QImage tx = QGLWidget::convertToGLFormat(*im);
+    if (tx.isNull())
+        tx = QGLWidget::convertToGLFormat(*im);
     GLuint tx_id =
         realRender->CreateTexture(tx.size(), false, 0,
                                   GL_UNSIGNED_BYTE, GL_RGBA, GL_RGBA8,
@@ -184,7 +309,7 @@ void MythOpenGLPainter::DrawImage(const QRect &r, MythImage *im,
                                   const QRect &src, int alpha)
 {
     if (realRender)
-        realRender->DrawBitmap(GetTextureFromCache(im), target,
+        realRender->DrawBitmap(GetTextureFromCache(im), DrawTarget(),
                                &src, &r, 0, alpha);
 }
 
@@ -194,7 +319,7 @@ void MythOpenGLPainter::DrawRect(const QRect &area, const QBrush &fillBrush,
     if ((fillBrush.style() == Qt::SolidPattern ||
          fillBrush.style() == Qt::NoBrush) && realRender)
     {
-        realRender->DrawRect(area, fillBrush, linePen, alpha);
+        realRender->DrawRect(area, fillBrush, linePen, alpha, DrawTarget());
         return;
     }
     MythPainter::DrawRect(area, fillBrush, linePen, alpha);
@@ -210,7 +335,7 @@ void MythOpenGLPainter::DrawRoundRect(const QRect &area, int cornerRadius,
             fillBrush.style() == Qt::NoBrush)
         {
             realRender->DrawRoundRect(area, cornerRadius, fillBrush,
-                                      linePen, alpha);
+                                      linePen, alpha, DrawTarget());
             return;
         }
     }
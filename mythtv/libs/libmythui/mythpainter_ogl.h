@@ -21,10 +21,12 @@ class MUI_PUBLIC MythOpenGLPainter : public MythPainter
     virtual QString GetName(void)        { return QString("OpenGL"); }
     virtual bool SupportsAnimation(void) { return true;              }
     virtual bool SupportsAlpha(void)     { return true;              }
-    virtual bool SupportsClipping(void)  { return false;             }
+    virtual bool SupportsClipping(void);
     virtual void FreeResources(void);
     virtual void Begin(QPaintDevice *parent);
     virtual void End();
+    virtual void PrepareImage(MythImage *im);
+    virtual void SetClipRect(const QRect &clipRect);
 
     virtual void DrawImage(const QRect &dest, MythImage *im, const QRect &src,
                            int alpha);
@@ -44,12 +46,22 @@ class MUI_PUBLIC MythOpenGLPainter : public MythPainter
     void       ClearCache(void);
     void       DeleteTextures(void);
     int        GetTextureFromCache(MythImage *im);
+    bool       CreateRetainedBuffer(const QSize &size);
+    void       DeleteRetainedBuffer(void);
+    uint       DrawTarget(void) const;
 
     QGLWidget        *realParent;
     MythRenderOpenGL *realRender;
     int               target;
     bool              swapControl;
 
+    // Retained copy of the UI for partial updates
+    uint              m_uiTexture;
+    uint              m_uiFramebuffer;
+    QSize             m_uiSize;
+    bool              m_uiValid;
+    bool              m_retained;
+
     QMap<MythImage *, uint>    m_ImageIntMap;
     std::list<MythImage *>     m_ImageExpireList;
     std::list<uint>            m_textureDeleteList;
@@ -128,9 +128,13 @@ void MythQtPainter::DrawImage(const QRect &r, MythImage *im,
 
     MythQtImage *qim = reinterpret_cast<MythQtImage *>(im);
 
-    if (qim->NeedsRegen())
+    // Keep showing the old pixmap when the upload budget is spent
+    if (qim->NeedsRegen() && AllowUpload())
         qim->RegeneratePixmap();
 
+    if (!qim->GetPixmap())
+        return;
+
     painter->setOpacity(static_cast<float>(alpha) / 255.0);
     painter->drawPixmap(r.topLeft(), *(qim->GetPixmap()), src);
     painter->setOpacity(1.0);
@@ -133,8 +133,12 @@ void MythVDPAUPainter::DeleteBitmaps(void)
 void MythVDPAUPainter::DrawImage(const QRect &r, MythImage *im,
                                  const QRect &src, int alpha)
 {
-    if (m_render)
-        m_render->DrawBitmap(GetTextureFromCache(im), m_target,
+    if (!m_render)
+        return;
+
+    uint bitmap = GetTextureFromCache(im);
+    if (bitmap)
+        m_render->DrawBitmap(bitmap, m_target,
                              &src, &r /*dst*/, kVDPBlendNormal,
                              alpha, 255, 255, 255);
 }
@@ -154,7 +158,8 @@ uint MythVDPAUPainter::GetTextureFromCache(MythImage *im)
 {
     if (m_ImageBitmapMap.contains(im))
     {
-        if (!im->IsChanged())
+        // Keep showing the old surface when the upload budget is spent
+        if (!im->IsChanged() || !AllowUpload())
         {
             m_ImageExpireList.remove(im);
             m_ImageExpireList.push_back(im);
@@ -165,6 +170,10 @@ uint MythVDPAUPainter::GetTextureFromCache(MythImage *im)
             DeleteFormatImagePriv(im);
         }
     }
+    else if (!AllowUpload())
+    {
+        return 0;
+    }
 
     im->SetChanged(false);
     uint newbitmap = 0;
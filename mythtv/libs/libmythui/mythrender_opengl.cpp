@@ -281,6 +281,40 @@ void MythRenderOpenGL::SetBackground(int r, int g, int b, int a)
     doneCurrent();
 }
 
+/**
+ *  Limits drawing and clearing to the given rectangle of the viewport,
+ *  an empty rectangle draws everywhere again.
+ */
+void MythRenderOpenGL::SetScissor(const QRect &rect)
+{
+    if (rect == m_scissor)
+        return;
+
+    makeCurrent();
+    if (rect.isEmpty())
+    {
+        glDisable(GL_SCISSOR_TEST);
+    }
+    else
+    {
+        // OpenGL counts from the bottom
+        glScissor(rect.left(), m_viewport.height() - rect.bottom() - 1,
+                  rect.width(), rect.height());
+        if (m_scissor.isEmpty())
+            glEnable(GL_SCISSOR_TEST);
+    }
+    m_scissor = rect;
+    doneCurrent();
+}
+
+/// Whether drawing may change the alpha channel of the framebuffer
+void MythRenderOpenGL::SetAlphaWrites(bool enable)
+{
+    makeCurrent();
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, enable ? GL_TRUE : GL_FALSE);
+    doneCurrent();
+}
+
 void MythRenderOpenGL::SetFence(void)
 {
     makeCurrent();
@@ -745,20 +779,27 @@ void MythRenderOpenGL::DrawBitmap(uint *textures, uint texture_count,
 }
 
 void MythRenderOpenGL::DrawRect(const QRect &area, const QBrush &fillBrush,
-                                const QPen &linePen, int alpha)
+                                const QPen &linePen, int alpha, uint target)
 {
+    if (target && !m_framebuffers.contains(target))
+        target = 0;
+
     makeCurrent();
-    BindFramebuffer(0);
+    BindFramebuffer(target);
     DrawRectPriv(area, fillBrush, linePen, alpha);
     doneCurrent();
 }
 
 void MythRenderOpenGL::DrawRoundRect(const QRect &area, int cornerRadius,
                                      const QBrush &fillBrush,
-                                     const QPen &linePen, int alpha)
+                                     const QPen &linePen, int alpha,
+                                     uint target)
 {
+    if (target && !m_framebuffers.contains(target))
+        target = 0;
+
     makeCurrent();
-    BindFramebuffer(0);
+    BindFramebuffer(target);
     DrawRoundRectPriv(area, cornerRadius, fillBrush, linePen, alpha);
     doneCurrent();
 }
@@ -1012,6 +1053,7 @@ void MythRenderOpenGL::ResetVars(void)
     m_active_fb       = 0;
     m_blend           = false;
     m_background      = 0x00000000;
+    m_scissor         = QRect();
 }
 
 void MythRenderOpenGL::ResetProcs(void)
@@ -130,6 +130,8 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
     void  SetBlend(bool enable);
     virtual void SetColor(int r, int g, int b, int a) { }
     void  SetBackground(int r, int g, int b, int a);
+    void  SetScissor(const QRect &rect);
+    void  SetAlphaWrites(bool enable);
     void  SetFence(void);
 
     void* GetTextureBuffer(uint tex, bool create_buffer = true);
@@ -166,10 +168,10 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
     void DrawBitmap(uint *textures, uint texture_count, uint target,
                     const QRectF *src, const QRectF *dst, uint prog);
     void DrawRect(const QRect &area, const QBrush &fillBrush,
-                  const QPen &linePen, int alpha);
+                  const QPen &linePen, int alpha, uint target = 0);
     void DrawRoundRect(const QRect &area, int cornerRadius,
                        const QBrush &fillBrush, const QPen &linePen,
-                       int alpha);
+                       int alpha, uint target = 0);
     virtual bool RectanglesAreAccelerated(void) { return false; }
 
   protected:
@@ -237,6 +239,7 @@ class MUI_PUBLIC MythRenderOpenGL : public QGLContext, public MythRender
     int      m_active_fb;
     bool     m_blend;
     uint32_t m_background;
+    QRect    m_scissor;
 
     // vertex cache
     QMap<uint64_t,GLfloat*> m_cachedVertices;
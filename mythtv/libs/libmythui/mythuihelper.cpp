@@ -1,6 +1,7 @@
 #include "mythuihelper.h"
 
 #include <cmath>
+#include <cstring>
 
 #include <QImage>
 #include <QPixmap>
@@ -16,6 +17,7 @@
 #include <QSize>
 #include <QFile>
 #include <QAtomicInt>
+#include <QtEndian>
 #include <QEventLoop>
 #include <QTimer>
 
@@ -121,6 +123,10 @@ public:
     QAtomicInt m_cacheSize;
     QAtomicInt m_maxCacheSize;
 
+    QMutex  m_diskCacheLock;
+    qint64  m_diskCacheSize;     ///< bytes in themecachedir, -1 if unknown
+    qint64  m_maxDiskCacheSize;
+
     // The part of the screen(s) allocated for the GUI. Unless
     // overridden by the user, defaults to drawable area above.
     int m_screenxbase, m_screenybase;
@@ -165,6 +171,7 @@ MythUIHelperPrivate::MythUIHelperPrivate(MythUIHelper *p)
       m_baseWidth(800), m_baseHeight(600), m_isWide(false),
       m_cacheLock(new QMutex(QMutex::Recursive)),
       m_cacheSize(0), m_maxCacheSize(30 * 1024 * 1024),
+      m_diskCacheSize(-1), m_maxDiskCacheSize(256 * 1024 * 1024),
       m_screenxbase(0), m_screenybase(0), m_screenwidth(0), m_screenheight(0),
       screensaver(NULL), screensaverEnabled(false), display_res(NULL),
       screenSetup(false), m_imageThreadPool(new MThreadPool("MythUIHelper")),
@@ -435,6 +442,11 @@ void MythUIHelper::Init(MythUIMenuCallbacks &cbs)
     LOG(VB_GUI, LOG_INFO, LOC +
         QString("MythUI Image Cache size set to %1 bytes")
         .arg(d->m_maxCacheSize.fetchAndAddRelease(0)));
+
+    QMutexLocker locker(&d->m_diskCacheLock);
+    d->m_maxDiskCacheSize =
+        (qint64)GetMythDB()->GetNumSetting("UIDiskCacheSize", 256) *
+        1024 * 1024;
 }
 
 MythUIMenuCallbacks *MythUIHelper::GetMenuCBs(void)
@@ -582,6 +594,131 @@ void MythUIHelper::ExcludeFromCacheSize(MythImage *im)
         d->m_cacheSize.fetchAndAddOrdered(-im->byteCount());
 }
 
+/// Identifies theme cache files holding raw pixels, rather than a PNG
+static const char kRawImageMagic[4] = { 'M', 'Y', 'R', 'I' };
+static const quint32 kRawImageVersion = 2;
+
+/// Pixel formats of raw cache files. These are stored rather than
+/// QImage::Format values, so the files don't depend on the Qt version.
+enum RawImageFormat
+{
+    kRawRGB32 = 1,
+    kRawARGB32,
+    kRawARGB32Premultiplied,
+};
+
+/// Byte order of the 32 bit pixels, which QImage keeps in host order
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+static const quint32 kRawByteOrder = 0;
+#else
+static const quint32 kRawByteOrder = 1;
+#endif
+
+/** \brief Saves the pixels of an image as they are in memory.
+ *
+ *  The images in the theme cache are already scaled to the screen, saving
+ *  them uncompressed means loading them again needs no decoding at all.
+ *
+ *  The header is little endian. The pixels are stored as 32 bit values in
+ *  the byte order of this machine, which the header records, so a cache
+ *  shared with a machine of the other byte order is just not used.
+ */
+static bool save_raw_image(const QImage &src, const QString &filename)
+{
+    QImage im = src;
+    quint32 format = kRawARGB32;
+    if (im.format() == QImage::Format_RGB32)
+        format = kRawRGB32;
+    else if (im.format() == QImage::Format_ARGB32_Premultiplied)
+        format = kRawARGB32Premultiplied;
+    else if (im.format() != QImage::Format_ARGB32)
+        im = im.convertToFormat(QImage::Format_ARGB32);
+
+    QString tmpfile = filename + ".tmp";
+    QFile file(tmpfile);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    quint32 header[6] = { kRawImageVersion,
+                          (quint32)im.width(), (quint32)im.height(),
+                          format, (quint32)im.bytesPerLine(),
+                          kRawByteOrder };
+    for (uint i = 0; i < sizeof(header) / sizeof(header[0]); i++)
+        header[i] = qToLittleEndian(header[i]);
+    qint64 datasize = (qint64)im.bytesPerLine() * im.height();
+
+    bool ok =
+        file.write(kRawImageMagic, sizeof(kRawImageMagic)) ==
+            (qint64)sizeof(kRawImageMagic) &&
+        file.write((const char*)header, sizeof(header)) ==
+            (qint64)sizeof(header) &&
+        file.write((const char*)im.constBits(), datasize) == datasize;
+    file.close();
+
+    // Readers must never see a partly written file
+    QFile::remove(filename);
+    if (!ok || !QFile::rename(tmpfile, filename))
+    {
+        QFile::remove(tmpfile);
+        return false;
+    }
+
+    return true;
+}
+
+/// Loads a file written by save_raw_image(), fails for any other file
+static bool load_raw_image(QImage &im, const QString &filename)
+{
+    QFile file(filename);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    char magic[sizeof(kRawImageMagic)];
+    quint32 header[6];
+
+    if (file.read(magic, sizeof(magic)) != (qint64)sizeof(magic) ||
+        memcmp(magic, kRawImageMagic, sizeof(magic)) != 0 ||
+        file.read((char*)header, sizeof(header)) != (qint64)sizeof(header))
+    {
+        return false;
+    }
+
+    for (uint i = 0; i < sizeof(header) / sizeof(header[0]); i++)
+        header[i] = qFromLittleEndian(header[i]);
+
+    if (header[0] != kRawImageVersion || header[5] != kRawByteOrder)
+        return false;
+
+    QImage::Format format;
+    switch (header[3])
+    {
+        case kRawRGB32:
+            format = QImage::Format_RGB32;
+            break;
+        case kRawARGB32:
+            format = QImage::Format_ARGB32;
+            break;
+        case kRawARGB32Premultiplied:
+            format = QImage::Format_ARGB32_Premultiplied;
+            break;
+        default:
+            return false;
+    }
+
+    QImage tmp((int)header[1], (int)header[2], format);
+    if (tmp.isNull() || (quint32)tmp.bytesPerLine() != header[4])
+        return false;
+
+    qint64 datasize = (qint64)tmp.bytesPerLine() * tmp.height();
+    if (file.read((char*)tmp.bits(), datasize) != datasize)
+        return false;
+
+    im = tmp;
+    return true;
+}
+
 MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
                                     bool nodisk)
 {
@@ -603,7 +740,7 @@ MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
             themedir.mkdir(GetMythUI()->GetThemeCacheDir());
 
         // Save to disk cache
-        im->save(dstfile, "PNG");
+        SaveToDiskCache(*im, dstfile);
     }
 
     // delete the oldest cached images until we fall below threshold.
@@ -768,6 +905,11 @@ void MythUIHelper::ClearOldImageCache(void)
 
     d->themecachedir = GetThemeCacheDir();
 
+    {
+        QMutexLocker locker(&d->m_diskCacheLock);
+        d->m_diskCacheSize = -1;
+    }
+
     QDir dir(cachedirname);
 
     if (!dir.exists())
@@ -826,6 +968,78 @@ void MythUIHelper::ClearOldImageCache(void)
     }
 }
 
+/// Saves an image to the theme disk cache, keeping the cache below
+/// UIDiskCacheSize megabytes
+void MythUIHelper::SaveToDiskCache(const QImage &im, const QString &filename)
+{
+    qint64 oldsize = QFileInfo(filename).size();
+
+    if (!save_raw_image(im, filename))
+    {
+        LOG(VB_GUI | VB_FILE, LOG_WARNING, LOC +
+            QString("Failed to save %1 to the disk cache").arg(filename));
+        return;
+    }
+
+    QMutexLocker locker(&d->m_diskCacheLock);
+
+    if (d->m_diskCacheSize < 0)
+    {
+        locker.unlock();
+        PruneDiskCache();
+        return;
+    }
+
+    d->m_diskCacheSize += QFileInfo(filename).size() - oldsize;
+    if (d->m_diskCacheSize > d->m_maxDiskCacheSize)
+    {
+        locker.unlock();
+        PruneDiskCache();
+    }
+}
+
+/** \brief Totals the size of the theme disk cache, and deletes the images
+ *         saved longest ago while it is over UIDiskCacheSize megabytes.
+ *
+ *  The cache is pruned down to 3/4 of its limit, so this runs rarely.
+ */
+void MythUIHelper::PruneDiskCache(void)
+{
+    QMutexLocker locker(&d->m_diskCacheLock);
+
+    QDir dir(d->themecachedir);
+    QFileInfoList list = dir.entryInfoList(QDir::Files, QDir::Time);
+
+    qint64 total = 0;
+    QFileInfoList::const_iterator it = list.begin();
+    for (; it != list.end(); ++it)
+        total += it->size();
+
+    if (total > d->m_maxDiskCacheSize)
+    {
+        qint64 target = d->m_maxDiskCacheSize / 4 * 3;
+        int removed = 0;
+
+        // Sorted newest first, so remove from the back
+        QFileInfoList::const_iterator rit = list.end();
+        while (rit != list.begin() && total > target)
+        {
+            --rit;
+            if (QFile::remove(rit->absoluteFilePath()))
+            {
+                total -= rit->size();
+                removed++;
+            }
+        }
+
+        LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
+            QString("Pruned %1 images from the disk cache, %2 MB left")
+            .arg(removed).arg(total / (1024 * 1024)));
+    }
+
+    d->m_diskCacheSize = total;
+}
+
 void MythUIHelper::RemoveCacheDir(const QString &dirname)
 {
     QString cachedirname = GetConfDir() + "/cache/themecache/";
@@ -1661,13 +1875,24 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
                 {
                     ret = painter->GetFormatImage();
 
-                    // Load file from disk cache to memory cache
-                    if (ret->Load(cachefilepath))
+                    // Load file from disk cache to memory cache, files
+                    // saved as PNG by older versions are decoded and
+                    // rewritten raw
+                    QImage raw;
+                    if (load_raw_image(raw, cachefilepath))
                     {
+                        ret->Assign(raw);
+                        painter->PrepareImage(ret);
                         // Add to ram cache, and skip saving to disk since that is
                         // where we found this in the first place.
                         CacheImage(label, ret, true);
                     }
+                    else if (ret->Load(cachefilepath))
+                    {
+                        painter->PrepareImage(ret);
+                        SaveToDiskCache(*ret, cachefilepath);
+                        CacheImage(label, ret, true);
+                    }
                     else
                     {
                         LOG(VB_GUI | VB_FILE, LOG_WARNING, LOC +
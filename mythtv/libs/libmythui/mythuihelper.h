@@ -151,6 +151,8 @@ class MUI_PUBLIC MythUIHelper
 
     void ClearOldImageCache(void);
     void RemoveCacheDir(const QString &dirname);
+    void SaveToDiskCache(const QImage &im, const QString &filename);
+    void PruneDiskCache(void);
 
     MythUIHelperPrivate *d;
 
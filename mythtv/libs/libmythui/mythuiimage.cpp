@@ -300,6 +300,8 @@ class ImageLoader
 
             if (imageReader)
                 ok = image->Load(imageReader);
+            else if (bResize && w > 0 && h > 0)
+                ok = image->Load(filename, QSize(w, h));
             else
                 ok = image->Load(filename);
 
@@ -378,8 +380,13 @@ class ImageLoader
                 GetMythUI()->CacheImage(cacheKey, image);
         }
 
-        if (image)
+        // An image found in the memory cache may already be on the GPU, only
+        // freshly loaded ones need to be converted and uploaded
+        if (image && !bFoundInCache)
+        {
             image->SetChanged();
+            painter->PrepareImage(image);
+        }
 
         PostLoad(cacheKey);
 
@@ -420,7 +420,8 @@ qint64 HTTPRequest::SendResponse( void )
 
     QBuffer compBuffer;
 
-    if (( nContentLen > 0 ) && m_mapHeaders[ "accept-encoding" ].contains( "gzip" ))
+    if (( nContentLen > 0 ) && m_mapHeaders[ "accept-encoding" ].contains( "gzip" ) &&
+        !m_sResponseTypeText.startsWith( "image/" ))
     {
         QByteArray compressed = gzipCompress( m_response.buffer() );
         compBuffer.setData( compressed );
@@ -939,6 +940,26 @@ void HTTPRequest::FormatFileResponse( const QString &sFileName )
     }
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Responds with the content of a file already in memory, the ETag must
+// change whenever the content does
+/////////////////////////////////////////////////////////////////////////////
+
+void HTTPRequest::FormatDataResponse( const QString    &sFileName,
+                                      const QByteArray &data,
+                                      const QString    &sETag )
+{
+    m_sFileName         = sFileName;
+    m_eResponseType     = ResponseTypeOther;
+    m_sResponseTypeText = GetMimeType( QFileInfo( sFileName ).suffix() );
+    m_nResponseStatus   = 200; // OK
+
+    SetResponseHeader("ETag", sETag, true);
+    SetResponseHeader("Cache-Control", "no-cache=\"Ext\", max-age = 7200"); // 2 Hours
+
+    m_response.buffer() = data;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
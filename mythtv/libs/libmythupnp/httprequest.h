@@ -213,6 +213,9 @@ class UPNP_PUBLIC HTTPRequest
         void            FormatActionResponse( Serializer *ser );
         void            FormatActionResponse( const NameValues &pArgs );
         void            FormatFileResponse  ( const QString &sFileName );
+        void            FormatDataResponse  ( const QString &sFileName,
+                                              const QByteArray &data,
+                                              const QString &sETag );
         void            FormatRawResponse   ( const QString &sXML );
 
         qint64          SendResponse    ( void );
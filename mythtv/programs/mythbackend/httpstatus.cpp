@@ -178,6 +178,13 @@ static QString setting_to_localtime(const char *setting)
     return MythDate::toString(origDate, MythDate::kDateTimeFull);
 }
 
+static QString format_duration(int secs)
+{
+    return QString("%1:%2:%3").arg(secs / 3600)
+        .arg((secs / 60) % 60, 2, 10, QChar('0'))
+        .arg(secs % 60, 2, 10, QChar('0'));
+}
+
 void HttpStatus::FillStatusXML( QDomDocument *pDoc )
 {
     QDateTime qdtNow          = MythDate::current();
@@ -408,6 +415,8 @@ void HttpStatus::FillStatusXML( QDomDocument *pDoc )
                          (*it).statustime.toString(Qt::ISODate));
         job.setAttribute("schedTime" ,
                          (*it).schedruntime.toString(Qt::ISODate));
+        job.setAttribute("waitTime"  , JobQueue::GetJobWaitTime(*it));
+        job.setAttribute("runTime"   , JobQueue::GetJobRunTime(*it));
         job.setAttribute("args"      , (*it).args       );
 
         if ((*it).hostname.isEmpty())
@@ -1136,6 +1145,8 @@ int HttpStatus::PrintJobQueue( QTextStream &os, QDomElement jobs )
                     QDateTime statusTime   = MythDate::fromString( e.attribute( "statusTime","" ));
                     QDateTime schedRunTime = MythDate::fromString( e.attribute( "schedTime","" ));
                     QString   sHostname    = e.attribute( "hostname", "master" );
+                    int       nWaitTime    = e.attribute( "waitTime", "0" ).toInt();
+                    int       nRunTime     = e.attribute( "runTime" , "0" ).toInt();
                     QString   sComment     = "";
 
                     QDomText  text         = e.firstChild().toText();
@@ -1175,6 +1186,16 @@ int HttpStatus::PrintJobQueue( QTextStream &os, QDomElement jobs )
                     if ( nStatus != JOB_QUEUED)
                         os << "Host: " << sHostname << "<br />";
 
+                    if (nWaitTime > 0)
+                        os << "Wait Time: "
+                           << format_duration(nWaitTime)
+                           << "<br />";
+
+                    if (nRunTime > 0)
+                        os << "Run Time: "
+                           << format_duration(nRunTime)
+                           << "<br />";
+
                     if (!sComment.isEmpty())
                         os << "<br />Comments:<br />" << sComment << "<br />";
 
@@ -24,6 +24,7 @@
 #include <QMap>
 
 #include "tv_rec.h"
+#include "recorders/positionmapwriter.h"
 #include "scheduledrecording.h"
 #include "autoexpire.h"
 #include "scheduler.h"
@@ -264,6 +265,8 @@ void cleanup(void)
         delete rec;
     }
 
+    PositionMapWriter::TeardownPositionMapWriter();
+
 
     delete gContext;
     gContext = NULL;
@@ -600,6 +603,8 @@ int run_backend(MythBackendCommandLineParser &cmdline)
 
     print_warnings(cmdline);
 
+    PositionMapWriter::CreatePositionMapWriter();
+
     bool fatal_error = false;
     bool runsched = setupTVs(ismaster, fatal_error);
     if (fatal_error)
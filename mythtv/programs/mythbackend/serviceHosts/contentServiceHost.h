@@ -30,6 +30,7 @@
 
 #include "servicehost.h"
 #include "services/content.h"
+#include "artworkcache.h"
 
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
@@ -54,6 +55,25 @@ class ContentServiceHost : public ServiceHost
         virtual ~ContentServiceHost()
         {
         }
+
+        using ServiceHost::FormatResponse;
+
+        // Resized images are served from the memory of the artwork cache
+        virtual bool FormatResponse( HTTPRequest *pRequest, QFileInfo oInfo )
+        {
+            QByteArray data;
+            QString    sETag;
+
+            if (ArtworkCache::GetCache()->GetData( oInfo.absoluteFilePath(),
+                                                   data, sETag ))
+            {
+                pRequest->FormatDataResponse( oInfo.absoluteFilePath(),
+                                              data, sETag );
+                return true;
+            }
+
+            return ServiceHost::FormatResponse( pRequest, oInfo );
+        }
 };
 
 #endif
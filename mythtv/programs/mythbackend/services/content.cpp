@@ -27,6 +27,7 @@
 
 #include <QDir>
 #include <QImage>
+#include <QImageReader>
 #include <QImageWriter>
 
 #include <math.h>
@@ -42,6 +43,7 @@
 #include "mythdate.h"
 #include "mythdownloadmanager.h"
 #include "metadataimagehelper.h"
+#include "artworkcache.h"
 #include "musicmetadata.h"
 #include "videometadatalistmanager.h"
 #include "HLS/httplivestream.h"
@@ -163,48 +165,15 @@ QFileInfo Content::GetImageFile( const QString &sStorageGroup,
         return QFileInfo( sFullFileName );
 
     // ----------------------------------------------------------------------
-    // Create a filename for the scaled copy
+    // Use the smallest cached size at least as large as asked for
     // ----------------------------------------------------------------------
-    QString sNewFileName = QString( "%1.%2x%3.jpg" )
-                              .arg( sFullFileName )
-                              .arg( nWidth    )
-                              .arg( nHeight   );
 
-    // ----------------------------------------------------------------------
-    // check to see if image is already created.
-    // ----------------------------------------------------------------------
-
-    if (QFile::exists( sNewFileName ))
-        return QFileInfo( sNewFileName );
-
-    // ----------------------------------------------------------------------
-    // Must generate Generate Image and save.
-    // ----------------------------------------------------------------------
-
-    float fAspect = 0.0;
-
-    QImage *pImage = new QImage( sFullFileName );
-
-    if (!pImage || pImage->isNull())
+    QString sNewFileName = ArtworkCache::GetCache()->GetImage( sFullFileName,
+                                                               nWidth,
+                                                               nHeight );
+    if (sNewFileName.isEmpty())
         return QFileInfo();
 
-    if (fAspect <= 0)
-           fAspect = (float)(pImage->width()) / pImage->height();
-
-    if ( nWidth == 0 )
-        nWidth = (int)rint(nHeight * fAspect);
-
-    if ( nHeight == 0 )
-        nHeight = (int)rint(nWidth / fAspect);
-
-    QImage img = pImage->scaled( nWidth, nHeight, Qt::KeepAspectRatio,
-                                Qt::SmoothTransformation);
-
-    QByteArray fname = sNewFileName.toLatin1();
-    img.save( fname.constData(), "JPG", 60 );
-
-    delete pImage;
-
     return QFileInfo( sNewFileName );
 }
 
@@ -408,77 +377,20 @@ QFileInfo Content::GetAlbumArt( int nTrackId, int nWidth, int nHeight )
     if (!RemoteFile::Exists(sFullFileName))
         return QFileInfo();
 
-    QString sNewFileName = QString( "/tmp/%1.%2x%3.jpg" )
-                              .arg( QFileInfo(sFullFileName).fileName() )
-                              .arg( nWidth    )
-                              .arg( nHeight   );
-
-    // ----------------------------------------------------------------------
-    // check to see if albumart image is already created.
-    // ----------------------------------------------------------------------
-
-    if (QFile::exists( sNewFileName ))
-        return QFileInfo( sNewFileName );
-
     // ----------------------------------------------------------------------
-    // Must generate Albumart Image, Generate Image and save.
+    // Use the smallest cached size at least as large as asked for, or the
+    // full size image if it is smaller. Use JPG not PNG for compatibility
+    // with the most uPnP devices and faster loading (smaller file to send
+    // over network)
+    // NOTE: If this behaviour is changed, for example making it optional,
+    //       then upnp code will need changing to compensate
     // ----------------------------------------------------------------------
 
-
-    QImage img;
-    if (sFullFileName.startsWith("myth://"))
-    {
-        RemoteFile rf(sFullFileName, false, false, 0);
-        QByteArray data;
-        rf.SaveAs(data);
-
-        img.loadFromData(data);
-    }
-    else
-        img.load(sFullFileName);
-
-    if (img.isNull())
-        return QFileInfo();
-
-    // We don't need to scale if no height and width were specified
-    // but still need to save as jpg if it's in another format
-    if ((nWidth == 0) && (nHeight == 0))
-    {
-        if (!sFullFileName.startsWith("myth://"))
-        {
-            QFileInfo fi(sFullFileName);
-            if (fi.suffix().toLower() == "jpg")
-                return fi;
-        }
-    }
-    else if (nWidth > img.width() && nHeight > img.height())
-    {
-        // Requested dimensions are larger than the source image, so instead of
-        // scaling up which will produce horrible results return the fullsize
-        // image and the user can scale further if they want instead
-        // NOTE: If this behaviour is changed, for example making it optional,
-        //       then upnp code will need changing to compensate
-    }
-    else
-    {
-        float fAspect = 0.0;
-        if (fAspect <= 0)
-            fAspect = (float)(img.width()) / img.height();
-
-        if ( nWidth == 0 || nWidth > img.width() )
-            nWidth = (int)rint(nHeight * fAspect);
-
-        if ( nHeight == 0 || nHeight > img.height() )
-            nHeight = (int)rint(nWidth / fAspect);
-
-        img = img.scaled( nWidth, nHeight, Qt::KeepAspectRatio,
-                                           Qt::SmoothTransformation);
-    }
-
-    QString fname = sNewFileName.toLatin1().constData();
-    // Use JPG not PNG for compatibility with the most uPnP devices and
-    // faster loading (smaller file to send over network)
-    if (!img.save( fname, "JPG" ))
+    QString sNewFileName = ArtworkCache::GetCache()->GetImage( sFullFileName,
+                                                               nWidth,
+                                                               nHeight,
+                                                               "jpg" );
+    if (sNewFileName.isEmpty())
         return QFileInfo();
 
     return QFileInfo( sNewFileName );
@@ -586,57 +498,27 @@ QFileInfo Content::GetPreviewImage(        int        nRecordedId,
 
     bool bDefaultPixmap = (nWidth == 0) && (nHeight == 0);
 
-    QString sNewFileName;
-
     if (bDefaultPixmap)
-        sNewFileName = sPreviewFileName;
-    else
-    {
-        sNewFileName = QString( "%1.%2.%3x%4.%5" )
-                          .arg( sFileName )
-                          .arg( nSecsIn   )
-                          .arg( nWidth == 0 ? -1 : nWidth )
-                          .arg( nHeight == 0 ? -1 : nHeight )
-                          .arg( sImageFormat.toLower() );
-
-        // ----------------------------------------------------------------------
-        // check to see if scaled preview image is already created and isn't
-        // out of date
-        // ----------------------------------------------------------------------
-        if (QFile::exists( sNewFileName ))
-        {
-            if (QFileInfo(sPreviewFileName).lastModified() <=
-                QFileInfo(sNewFileName).lastModified())
-                return QFileInfo( sNewFileName );
-        }
+        return QFileInfo( sPreviewFileName );
 
-        QImage image = QImage(sPreviewFileName);
+    // ----------------------------------------------------------------------
+    // We can just re-scale the default (full-size version) to avoid
+    // a preview generator run, use the smallest cached size at least as
+    // large as asked for
+    // ----------------------------------------------------------------------
 
-        if (image.isNull())
-            return QFileInfo();
+    QString sNewFileName = ArtworkCache::GetCache()->GetImage(
+        sPreviewFileName, nWidth, nHeight, sImageFormat.toLower() );
 
-        // We can just re-scale the default (full-size version) to avoid
-        // a preview generator run
-        if ( nWidth <= 0 )
-            image = image.scaledToHeight(nHeight, Qt::SmoothTransformation);
-        else if ( nHeight <= 0 )
-            image = image.scaledToWidth(nWidth, Qt::SmoothTransformation);
-        else
-            image = image.scaled(nWidth, nHeight, Qt::IgnoreAspectRatio,
-                                        Qt::SmoothTransformation);
-
-        image.save(sNewFileName, sImageFormat.toUpper().toLocal8Bit());
-
-        // Let anybody update it
-        bool ret = makeFileAccessible(sNewFileName.toLocal8Bit().constData());
-        if (!ret)
-        {
-            LOG(VB_GENERAL, LOG_ERR, "Unable to change permissions on "
-                                     "preview image. Backends and frontends "
-                                     "running under different users will be "
-                                     "unable to access it");
-        }
-    }
+    if (!sNewFileName.isEmpty())
+        return QFileInfo( sNewFileName );
+
+    sNewFileName = QString( "%1.%2.%3x%4.%5" )
+                      .arg( sFileName )
+                      .arg( nSecsIn   )
+                      .arg( nWidth == 0 ? -1 : nWidth )
+                      .arg( nHeight == 0 ? -1 : nHeight )
+                      .arg( sImageFormat.toLower() );
 
     if (QFile::exists( sNewFileName ))
         return QFileInfo( sNewFileName );
@@ -860,10 +742,14 @@ bool Content::DownloadFile( const QString &sURL, const QString &sStorageGroup )
 
     outFile = outDir + "/" + filename;
 
-    if (GetMythDownloadManager()->download(sURL, outFile))
-        return true;
+    if (!GetMythDownloadManager()->download(sURL, outFile))
+        return false;
+
+    // Have the sizes clients ask for ready when they first ask
+    if (!QImageReader::imageFormat(outFile).isEmpty())
+        ArtworkCache::GetCache()->Pregenerate(outFile);
 
-    return false;
+    return true;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -101,6 +101,8 @@ DTC::ProgramList* Dvr::GetRecordedList( bool           bDescending,
 
     QRegExp rTitleRegEx        = QRegExp(sTitleRegEx, Qt::CaseInsensitive);
 
+    QList< ProgramInfo* > page;
+
     for( unsigned int n = 0; n < progList.size(); n++)
     {
         ProgramInfo *pInfo = progList[ n ];
@@ -121,9 +123,19 @@ DTC::ProgramList* Dvr::GetRecordedList( bool           bDescending,
         ++nAvailable;
         ++nCount;
 
+        page.push_back(pInfo);
+    }
+
+    // Look up the artwork, channels and cast of the whole page at once
+    ProgramListPrefetch prefetch;
+    prefetch.Load(page, true, true);
+
+    QList< ProgramInfo* >::const_iterator pit = page.begin();
+    for (; pit != page.end(); ++pit)
+    {
         DTC::Program *pProgram = pPrograms->AddNewProgram();
 
-        FillProgramInfo( pProgram, pInfo, true );
+        FillProgramInfo( pProgram, *pit, true, true, true, &prefetch );
     }
 
     // ----------------------------------------------------------------------
@@ -32,6 +32,8 @@
 #include "recordingtypes.h"
 #include "channelutil.h"
 #include "channelinfo.h"
+#include "mythdb.h"
+#include "mythdate.h"
 #include "videoutils.h"
 #include "metadataimagehelper.h"
 #include "cardutil.h"
@@ -45,7 +47,8 @@ void FillProgramInfo( DTC::Program *pProgram,
                       ProgramInfo  *pInfo,
                       bool          bIncChannel /* = true */,
                       bool          bDetails    /* = true */,
-                      bool          bIncCast    /* = true */)
+                      bool          bIncCast    /* = true */,
+                      const ProgramListPrefetch *pPrefetch /* = NULL */)
 {
     if ((pProgram == NULL) || (pInfo == NULL))
         return;
@@ -97,15 +100,32 @@ void FillProgramInfo( DTC::Program *pProgram,
     pProgram->setSerializeCast(bIncCast);
     if (bIncCast)
     {
-        FillCastMemberList( pProgram->Cast(), pInfo );
+        if (pPrefetch)
+            FillCastMemberList( pProgram->Cast(),
+                                pPrefetch->cast.value(CastKey(pInfo->GetChanID(),
+                                                 pInfo->GetScheduledStartTime())));
+        else
+            FillCastMemberList( pProgram->Cast(), pInfo );
     }
 
     pProgram->setSerializeChannel( bIncChannel );
 
     if ( bIncChannel )
     {
+        bool bFound;
+        if (pPrefetch)
+        {
+            QMap< uint, ChannelInfo >::const_iterator cit =
+                pPrefetch->channels.find(pInfo->GetChanID());
+            bFound = (cit != pPrefetch->channels.end()) &&
+                     FillChannelInfo( pProgram->Channel(), *cit, bDetails );
+        }
+        else
+            bFound = FillChannelInfo( pProgram->Channel(), pInfo->GetChanID(),
+                                      bDetails );
+
         // Build Channel Child Element
-        if (!FillChannelInfo( pProgram->Channel(), pInfo->GetChanID(), bDetails ))
+        if (!bFound)
         {
             // The channel associated with a given recording may no longer exist
             // however the ChanID is one half of the unique identifier for the
@@ -161,8 +181,15 @@ void FillProgramInfo( DTC::Program *pProgram,
     {
         pProgram->setSerializeArtwork( true );
 
-        FillArtworkInfoList( pProgram->Artwork(), pInfo->GetInetRef(),
-                             pInfo->GetSeason());
+        // Lists prefetch the artwork of all their programs at once
+        if (pPrefetch)
+            FillArtworkInfoList( pProgram->Artwork(),
+                                 pPrefetch->artwork.value(
+                                     ArtworkKey(pInfo->GetInetRef(),
+                                                pInfo->GetSeason())));
+        else
+            FillArtworkInfoList( pProgram->Artwork(), pInfo->GetInetRef(),
+                                 pInfo->GetSeason());
     }
 }
 
@@ -310,8 +337,12 @@ void FillArtworkInfoList( DTC::ArtworkInfoList *pArtworkInfoList,
                           const QString        &sInetref,
                           uint                  nSeason )
 {
-    ArtworkMap map = GetArtwork(sInetref, nSeason);
+    FillArtworkInfoList( pArtworkInfoList, GetArtwork(sInetref, nSeason) );
+}
 
+void FillArtworkInfoList( DTC::ArtworkInfoList *pArtworkInfoList,
+                          const ArtworkMap     &map )
+{
     for (ArtworkMap::const_iterator i = map.begin();
          i != map.end(); ++i)
     {
@@ -458,6 +489,26 @@ void FillInputInfo(DTC::Input* input, InputInfo inputInfo)
 //
 /////////////////////////////////////////////////////////////////////////////
 
+/* The people.name column uses utf8_bin collation.
+ * Qt-MySQL drivers use QVariant::ByteArray for string-type
+ * MySQL fields marked with the BINARY attribute (those using a
+ * *_bin collation) and QVariant::String for all others.
+ * Since QVariant::toString() uses QString::fromAscii()
+ * (through QVariant::convert()) when the QVariant's type is
+ * QVariant::ByteArray, we have to use QString::fromUtf8()
+ * explicitly to prevent corrupting characters.
+ * The following code should be changed to use the simpler
+ * toString() approach if we do a DB update to
+ * coalesce the people.name values that differ only in case and
+ * change the collation to utf8_general_ci, to match the
+ * majority of other columns, or we'll have the same problem in
+ * reverse.
+ */
+static QString people_name(const QVariant &value)
+{
+    return QString::fromUtf8(value.toByteArray().constData());
+}
+
 void FillCastMemberList(DTC::CastMemberList* pCastMemberList,
                         ProgramInfo* pInfo)
 {
@@ -481,51 +532,129 @@ void FillCastMemberList(DTC::CastMemberList* pCastMemberList,
     query.bindValue(":CHANID",    pInfo->GetChanID());
     query.bindValue(":STARTTIME", pInfo->GetScheduledStartTime());
 
-    if (query.exec() && query.size() > 0)
+    CastList cast;
+    if (query.exec())
     {
-        QMap<QString, QString> translations;
-        translations["ACTOR"] = QObject::tr("Actors");
-        translations["DIRECTOR"] = QObject::tr("Director");
-        translations["PRODUCER"] = QObject::tr("Producer");
-        translations["EXECUTIVE_PRODUCER"] = QObject::tr("Executive Producer");
-        translations["WRITER"] = QObject::tr("Writer");
-        translations["GUEST_STAR"] = QObject::tr("Guest Star");
-        translations["HOST"] = QObject::tr("Host");
-        translations["ADAPTER"] = QObject::tr("Adapter");
-        translations["PRESENTER"] = QObject::tr("Presenter");
-        translations["COMMENTATOR"] = QObject::tr("Commentator");
-        translations["GUEST"] = QObject::tr("Guest");
-
         while (query.next())
+            cast.push_back(qMakePair(query.value(0).toString(),
+                                     people_name(query.value(1))));
+    }
+
+    FillCastMemberList(pCastMemberList, cast);
+}
+
+void FillCastMemberList(DTC::CastMemberList* pCastMemberList,
+                        const CastList &cast)
+{
+    if (!pCastMemberList || cast.isEmpty())
+        return;
+
+    QMap<QString, QString> translations;
+    translations["ACTOR"] = QObject::tr("Actors");
+    translations["DIRECTOR"] = QObject::tr("Director");
+    translations["PRODUCER"] = QObject::tr("Producer");
+    translations["EXECUTIVE_PRODUCER"] = QObject::tr("Executive Producer");
+    translations["WRITER"] = QObject::tr("Writer");
+    translations["GUEST_STAR"] = QObject::tr("Guest Star");
+    translations["HOST"] = QObject::tr("Host");
+    translations["ADAPTER"] = QObject::tr("Adapter");
+    translations["PRESENTER"] = QObject::tr("Presenter");
+    translations["COMMENTATOR"] = QObject::tr("Commentator");
+    translations["GUEST"] = QObject::tr("Guest");
+
+    CastList::const_iterator it = cast.begin();
+    for (; it != cast.end(); ++it)
+    {
+        DTC::CastMember *pCastMember = pCastMemberList->AddNewCastMember();
+
+        pCastMember->setRole(it->first);
+        pCastMember->setTranslatedRole(translations.value(it->first.toUpper()));
+        pCastMember->setName(it->second);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+/// Looks up the cast of \p programs from \p table, a few hundred at a time
+static void load_cast(const QList< ProgramInfo* > &programs,
+                      const QString &table,
+                      QMap< CastKey, CastList > &cast)
+{
+    const int kBatch = 200;
+
+    for (int start = 0; start < programs.size(); start += kBatch)
+    {
+        QList< ProgramInfo* > batch = programs.mid(start, kBatch);
+        QStringList where;
+        for (int i = 0; i < batch.size(); ++i)
+            where << QString("(credits.chanid = :CHANID%1 AND "
+                             "credits.starttime = :STARTTIME%1)").arg(i);
+
+        MSqlQuery query(MSqlQuery::InitCon());
+        query.prepare(QString("SELECT credits.chanid, credits.starttime, "
+                              "role, people.name FROM %1 AS credits "
+                              "LEFT JOIN people "
+                              "ON credits.person = people.person "
+                              "WHERE %2 ORDER BY role;")
+                      .arg(table).arg(where.join(" OR ")));
+        for (int i = 0; i < batch.size(); ++i)
         {
-            DTC::CastMember *pCastMember = pCastMemberList->AddNewCastMember();
-
-            QString role = query.value(0).toString();
-            pCastMember->setRole(role);
-            pCastMember->setTranslatedRole(translations.value(role.toUpper()));
-            /* The people.name column uses utf8_bin collation.
-                * Qt-MySQL drivers use QVariant::ByteArray for string-type
-                * MySQL fields marked with the BINARY attribute (those using a
-                * *_bin collation) and QVariant::String for all others.
-                * Since QVariant::toString() uses QString::fromAscii()
-                * (through QVariant::convert()) when the QVariant's type is
-                * QVariant::ByteArray, we have to use QString::fromUtf8()
-                * explicitly to prevent corrupting characters.
-                * The following code should be changed to use the simpler
-                * toString() approach, as above, if we do a DB update to
-                * coalesce the people.name values that differ only in case and
-                * change the collation to utf8_general_ci, to match the
-                * majority of other columns, or we'll have the same problem in
-                * reverse.
-                */
-            pCastMember->setName(QString::fromUtf8(query.value(1)
-                                        .toByteArray().constData()));
+            query.bindValue(QString(":CHANID%1").arg(i),
+                            batch[i]->GetChanID());
+            query.bindValue(QString(":STARTTIME%1").arg(i),
+                            batch[i]->GetScheduledStartTime());
+        }
+
+        if (!query.exec())
+        {
+            MythDB::DBError("load_cast", query);
+            return;
+        }
 
+        while (query.next())
+        {
+            CastKey key(query.value(0).toUInt(),
+                        MythDate::as_utc(query.value(1).toDateTime()));
+            cast[key].push_back(qMakePair(query.value(2).toString(),
+                                          people_name(query.value(3))));
         }
     }
+}
+
+void ProgramListPrefetch::Load(const QList< ProgramInfo* > &programs,
+                               bool bIncChannel, bool bIncCast)
+{
+    QList< ArtworkKey >   artworkKeys;
+    QList< uint >         chanids;
+    QList< ProgramInfo* > recorded, scheduled;
+
+    QList< ProgramInfo* >::const_iterator it = programs.begin();
+    for (; it != programs.end(); ++it)
+    {
+        if (!(*it)->GetInetRef().isEmpty())
+            artworkKeys.push_back(ArtworkKey((*it)->GetInetRef(),
+                                             (*it)->GetSeason()));
+        chanids.push_back((*it)->GetChanID());
+
+        // Same test as FillCastMemberList()
+        if ((*it)->GetFilesize() > 0)
+            recorded.push_back(*it);
+        else
+            scheduled.push_back(*it);
+    }
 
-    //pCastMemberList->setCount(query.size());
-    //pCastMemberList->setTotalAvailable(query.size());
+    artwork = GetArtworkList(artworkKeys);
+
+    if (bIncChannel)
+        channels = ChannelInfo::LoadList(chanids);
+
+    if (bIncCast)
+    {
+        load_cast(recorded, "recordedcredits", cast);
+        load_cast(scheduled, "credits", cast);
+    }
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -42,12 +42,34 @@
 #include "inputinfo.h"
 #include "channelinfo.h"
 #include "recordinginfo.h"
+#include "metadataimagehelper.h"
+
+/// Role and name of each cast member of a program
+typedef QList< QPair< QString, QString > > CastList;
+/// Chanid and scheduled start time of a program
+typedef QPair< uint, QDateTime > CastKey;
+
+/** \class ProgramListPrefetch
+ *  \brief What FillProgramInfo() looks up for each program, looked up
+ *         for a whole page of programs at once.
+ */
+class ProgramListPrefetch
+{
+  public:
+    void Load(const QList< ProgramInfo* > &programs,
+              bool bIncChannel, bool bIncCast);
+
+    QMap< ArtworkKey, ArtworkMap > artwork;
+    QMap< uint, ChannelInfo >      channels;
+    QMap< CastKey, CastList >      cast;
+};
 
 void FillProgramInfo( DTC::Program *pProgram,
                       ProgramInfo  *pInfo,
                       bool          bIncChannel = true,
                       bool          bDetails    = true,
-                      bool          bIncCast    = true);
+                      bool          bIncCast    = true,
+                      const ProgramListPrefetch *pPrefetch = NULL);
 
 bool FillChannelInfo( DTC::ChannelInfo *pChannel,
                       uint              nChanID,
@@ -66,6 +88,9 @@ void FillArtworkInfoList( DTC::ArtworkInfoList *pArtworkInfoList,
                           const QString        &sInetref,
                           uint                  nSeason );
 
+void FillArtworkInfoList( DTC::ArtworkInfoList *pArtworkInfoList,
+                          const ArtworkMap     &map );
+
 void FillVideoMetadataInfo (
                       DTC::VideoMetadataInfo *pVideoMetadataInfo,
                       VideoMetadataListManager::VideoMetadataPtr pMetadata,
@@ -76,6 +101,9 @@ void FillInputInfo( DTC::Input *input, InputInfo inputInfo);
 void FillCastMemberList( DTC::CastMemberList *pCastMemberList,
                          ProgramInfo  *pInfo);
 
+void FillCastMemberList( DTC::CastMemberList *pCastMemberList,
+                         const CastList      &cast );
+
 void FillCutList( DTC::CutList* pCutList, RecordingInfo* rInfo, int marktype);
 
 void FillCommBreak( DTC::CutList* pCutList, RecordingInfo* rInfo, int marktype);
@@ -29,6 +29,8 @@ using namespace std;
 #include "mythdb.h"
 #include "mythversion.h"
 #include "mythcommflagplayer.h"
+#include "mythccextractorplayer.h"
+#include "previewgenerator.h"
 #include "programinfo.h"
 #include "remoteutil.h"
 #include "remotefile.h"
@@ -483,6 +485,10 @@ static void commDetectorGotNewCommercialBreakList(void)
         QString("mythcommflag sending update: %1").arg(message));
 
     gCoreContext->SendMessage(message);
+
+    // So players that start later can skip the breaks found so far
+    if (watchingRecording)
+        global_program_info->SaveCommBreakList(newCommercialMap);
 }
 
 static void incomingCustomEvent(QEvent* e)
@@ -561,6 +567,10 @@ static int DoFlagCommercials(
     if (useDB)
         program_info->SaveCommFlagged(COMM_FLAG_PROCESSING);
 
+    // Publish the breaks as they are found rather than when a player asks
+    if (watchingRecording)
+        commDetector->requestCommBreakMapUpdate();
+
     CustomEventRelayer *cer = new CustomEventRelayer(incomingCustomEvent);
     SlotRelayer *a = new SlotRelayer(commDetectorBreathe);
     SlotRelayer *b = new SlotRelayer(commDetectorStatusUpdate);
@@ -729,6 +739,53 @@ static bool IsMarked(uint chanid, QDateTime starttime)
     return true;
 }
 
+/// Whether the seek table in the database covers all the frames the
+/// flagger decoded, within a few seconds
+static bool IsSeekTableComplete(ProgramInfo *program_info,
+                                MythCommFlagPlayer *cfp)
+{
+    frm_pos_map_t posMap;
+    program_info->QueryPositionMap(posMap, MARK_GOP_BYFRAME);
+    if (posMap.isEmpty())
+        program_info->QueryPositionMap(posMap, MARK_GOP_START);
+    if (posMap.isEmpty())
+        program_info->QueryPositionMap(posMap, MARK_KEYFRAME);
+
+    DecoderBase *decoder = cfp->GetDecoder();
+    if (posMap.isEmpty() || !decoder)
+    {
+        LOG(VB_GENERAL, LOG_NOTICE, "The recording has no seek table");
+        return false;
+    }
+
+    // The decoder has the seek table from the database in frames
+    long long last   = decoder->GetLastFrameInPosMap();
+    long long frames = decoder->GetFramesRead();
+    if (last + (long long)(cfp->GetFrameRate() * 10) < frames)
+    {
+        LOG(VB_GENERAL, LOG_NOTICE,
+            QString("The seek table ends at frame %1 of %2")
+                .arg(last).arg(frames));
+        return false;
+    }
+
+    return true;
+}
+
+static int RebuildSeekTable(ProgramInfo *pginfo, int jobid);
+
+/// Saves the preview the backend left to this job. The flagger decodes
+/// at reduced quality, so only the preview frame is decoded again, at
+/// full quality, while the recording is still in the page cache.
+static void SavePreview(ProgramInfo *program_info)
+{
+    PreviewGenerator *previewgen = new PreviewGenerator(
+        program_info, QString(), PreviewGenerator::kLocalAndRemote);
+    if (!previewgen->Run())
+        LOG(VB_GENERAL, LOG_ERR, "Unable to save the preview");
+    previewgen->deleteLater();
+}
+
 static int FlagCommercials(ProgramInfo *program_info, int jobid,
             const QString &outputfilename, bool useDB, bool fullSpeed)
 {
@@ -884,6 +941,15 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
         }
     }
 
+    // What else the job does along with the flagging
+    int passFlags = (jobid > 0) ? JobQueue::GetJobFlags(jobid) : JOB_NO_FLAGS;
+    if ((passFlags & JOB_CAPTIONS) && filename.startsWith("myth://"))
+    {
+        LOG(VB_GENERAL, LOG_WARNING, "The recording is not stored locally, "
+            "leaving the captions to their own job.");
+        passFlags &= ~JOB_CAPTIONS;
+    }
+
     PlayerFlags flags = (PlayerFlags)(kAudioMuted   |
                                       kVideoIsNull  |
                                       kDecodeLowRes |
@@ -897,7 +963,13 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
         flags = (PlayerFlags) (flags | kDecodeFewBlocks);
     }
 
-    MythCommFlagPlayer *cfp = new MythCommFlagPlayer(flags);
+    MythCommFlagPlayer    *cfp = NULL;
+    MythCCExtractorPlayer *ccp = NULL;
+    if (passFlags & JOB_CAPTIONS)
+        cfp = ccp = new MythCCExtractorPlayer(flags, false, filename);
+    else
+        cfp = new MythCommFlagPlayer(flags);
+
     PlayerContext *ctx = new PlayerContext(kFlaggerInUseID);
     ctx->SetPlayingInfo(program_info);
     ctx->SetRingBuffer(tmprbuf);
@@ -921,6 +993,11 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
                     QString("mythcommflag will flag recording "
                             "currently in progress on cardid %1")
                         .arg(recorderNum));
+
+                // Read what the recorder still has in memory from there
+                if (tmprbuf->AttachRecordingTap())
+                    LOG(VB_COMMFLAG, LOG_INFO,
+                        "mythcommflag is reading from the recorder's tap");
             }
             else
             {
@@ -947,9 +1024,28 @@ static int FlagCommercials(ProgramInfo *program_info, int jobid,
     LOG(VB_GENERAL, LOG_NOTICE, QString("Finished, %1 break(s) found.")
         .arg(breaksFound));
 
+    if (ccp)
+        ccp->FinishCaptions();
+
+    // Only a pass through the whole finished recording can tell
+    bool rebuild = false;
+    if ((passFlags & JOB_SEEKTABLE) && !watchingRecording &&
+        cfp->GetEof() != kEofStateNone)
+    {
+        rebuild = !IsSeekTableComplete(program_info, cfp);
+        if (!rebuild)
+            cfp->SaveTotalFrames();
+    }
+
     delete ctx;
     global_program_info = NULL;
 
+    if (rebuild)
+        RebuildSeekTable(program_info, jobid);
+
+    if (passFlags & JOB_PREVIEW)
+        SavePreview(program_info);
+
     return breaksFound;
 }
 
@@ -0,0 +1,209 @@
+// C++ headers
+#include <algorithm>
+using namespace std;
+
+// Qt headers
+#include <QStringList>
+
+// MythTV headers
+#include "guidedatacache.h"
+#include "mythlogging.h"
+#include "mythdbcon.h"
+
+#define LOC QString("GuideDataCache: ")
+
+const int GuideDataCache::kMaxChannels = 256;
+const int GuideDataCache::kMaxAge      = 10 * 60 * 1000;
+
+/// The program table is queried with whole minutes, so are we
+static inline QDateTime to_minute(const QDateTime &ts)
+{
+    return ts.addSecs(0 - ts.time().second());
+}
+
+/// Same overlap test as the query in GuideDataCache::Load()
+static inline bool in_window(const ProgramInfo *pginfo,
+                             const QDateTime &start, const QDateTime &end)
+{
+    return pginfo->GetScheduledEndTime()   >= start &&
+           pginfo->GetScheduledStartTime() <= end   &&
+           pginfo->GetScheduledStartTime() >= start.addDays(-1);
+}
+
+/** \brief Copies the programs of a channel in the given window to proglist.
+ *  \return false if the window is not cached for the channel, in which
+ *          case proglist is left alone.
+ */
+bool GuideDataCache::Get(uint chanid,
+                         const QDateTime &start, const QDateTime &end,
+                         ProgramList &proglist)
+{
+    QDateTime startts = to_minute(start);
+    QDateTime endts   = to_minute(end);
+
+    QMutexLocker locker(&m_lock);
+
+    const Entry *entry = m_entries.value(chanid);
+    if (!IsCovered(entry, startts, endts))
+        return false;
+
+    QMap<QDateTime, ProgramInfo*>::const_iterator it =
+        entry->programs.begin();
+    for (; it != entry->programs.end(); ++it)
+    {
+        if (in_window(*it, startts, endts))
+            proglist.push_back(new ProgramInfo(**it));
+    }
+
+    Touch(chanid);
+
+    return true;
+}
+
+bool GuideDataCache::Contains(uint chanid,
+                              const QDateTime &start,
+                              const QDateTime &end) const
+{
+    QMutexLocker locker(&m_lock);
+    return IsCovered(m_entries.value(chanid), to_minute(start), to_minute(end));
+}
+
+/** \brief Loads the given window for all channels which do not have it
+ *         cached yet, using a single query.
+ */
+void GuideDataCache::Load(const QVector<uint> &chanids,
+                          const QDateTime &start, const QDateTime &end,
+                          const ProgramList &schedList)
+{
+    QDateTime startts = to_minute(start);
+    QDateTime endts   = to_minute(end);
+
+    QStringList missing;
+    {
+        QMutexLocker locker(&m_lock);
+        for (int i = 0; i < chanids.size(); ++i)
+        {
+            if (!IsCovered(m_entries.value(chanids[i]), startts, endts) &&
+                !missing.contains(QString::number(chanids[i])))
+            {
+                missing << QString::number(chanids[i]);
+            }
+        }
+    }
+
+    if (missing.empty())
+        return;
+
+    MythTimer timer;
+    timer.start();
+
+    ProgramList proglist;
+    MSqlBindings bindings;
+    QString querystr = QString(
+        "WHERE program.chanid IN (%1) "
+        "  AND program.endtime >= :STARTTS "
+        "  AND program.starttime <= :ENDTS "
+        "  AND program.starttime >= :STARTLIMITTS "
+        "  AND program.manualid = 0 ").arg(missing.join(","));
+    bindings[":STARTTS"]      = startts;
+    bindings[":STARTLIMITTS"] = startts.addDays(-1);
+    bindings[":ENDTS"]        = endts;
+
+    if (!LoadFromProgram(proglist, querystr, bindings, schedList))
+        return;
+
+    // The programs are handed over to the cache entries
+    proglist.setAutoDelete(false);
+
+    QMap<uint, QList<ProgramInfo*> > bychan;
+    ProgramList::iterator it = proglist.begin();
+    for (; it != proglist.end(); ++it)
+        bychan[(*it)->GetChanID()].push_back(*it);
+
+    QMutexLocker locker(&m_lock);
+
+    for (int i = 0; i < missing.size(); ++i)
+    {
+        uint chanid = missing[i].toUInt();
+        Merge(chanid, startts, endts, bychan.value(chanid));
+    }
+
+    while (m_lru.size() > kMaxChannels)
+        delete m_entries.take(m_lru.takeFirst());
+
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Loaded %1 programs on %2 channels in %3 ms")
+            .arg(proglist.size()).arg(missing.size()).arg(timer.elapsed()));
+}
+
+/// Drops everything, e.g. when the recording status of programs changed
+void GuideDataCache::Clear(void)
+{
+    QMutexLocker locker(&m_lock);
+    qDeleteAll(m_entries);
+    m_entries.clear();
+    m_lru.clear();
+}
+
+bool GuideDataCache::IsCovered(const Entry *entry,
+                               const QDateTime &start,
+                               const QDateTime &end) const
+{
+    return entry && entry->from <= start && end <= entry->to &&
+           entry->age.elapsed() < kMaxAge;
+}
+
+/** \brief Adds freshly loaded programs of a channel.
+ *
+ *  A window overlapping or touching the span already cached extends it,
+ *  replacing the programs in the window, otherwise it replaces the entry.
+ */
+void GuideDataCache::Merge(uint chanid,
+                           const QDateTime &start, const QDateTime &end,
+                           const QList<ProgramInfo*> &programs)
+{
+    Entry *entry = m_entries.value(chanid);
+
+    if (entry && entry->age.elapsed() < kMaxAge &&
+        start <= entry->to && end >= entry->from)
+    {
+        QMap<QDateTime, ProgramInfo*>::iterator it = entry->programs.begin();
+        while (it != entry->programs.end())
+        {
+            if (in_window(*it, start, end))
+            {
+                delete *it;
+                it = entry->programs.erase(it);
+            }
+            else
+                ++it;
+        }
+        entry->from = min(entry->from, start);
+        entry->to   = max(entry->to, end);
+    }
+    else
+    {
+        delete entry;
+        entry = new Entry();
+        entry->from = start;
+        entry->to   = end;
+        entry->age.start();
+        m_entries[chanid] = entry;
+    }
+
+    for (int i = 0; i < programs.size(); ++i)
+    {
+        ProgramInfo *&slot =
+            entry->programs[programs[i]->GetScheduledStartTime()];
+        delete slot;
+        slot = programs[i];
+    }
+
+    Touch(chanid);
+}
+
+void GuideDataCache::Touch(uint chanid)
+{
+    m_lru.removeOne(chanid);
+    m_lru.push_back(chanid);
+}
@@ -0,0 +1,76 @@
+// -*- Mode: c++ -*-
+#ifndef _GUIDE_DATA_CACHE_H_
+#define _GUIDE_DATA_CACHE_H_
+
+// Qt headers
+#include <QDateTime>
+#include <QVector>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QMap>
+
+// MythTV headers
+#include "programinfo.h"
+#include "mythtimer.h"
+
+/** \class GuideDataCache
+ *  \brief Recently shown program guide data, per channel.
+ *
+ *  The program guide used to run one LoadFromProgram() query per visible
+ *  channel each time it scrolled. This cache keeps the programs of each
+ *  channel for the span of time which has been loaded for it, so scrolling
+ *  back and forth over already seen data does not touch the database, and
+ *  Load() fetches the data of all channels missing from the cache with a
+ *  single query.
+ *
+ *  The least recently used channels are evicted once more than
+ *  kMaxChannels are cached, and the data of a channel is reloaded after
+ *  kMaxAge, so updated listings eventually show up.
+ *
+ *  All methods are thread-safe.
+ */
+class GuideDataCache
+{
+  public:
+    GuideDataCache() {}
+    ~GuideDataCache() { Clear(); }
+
+    bool Get(uint chanid, const QDateTime &start, const QDateTime &end,
+             ProgramList &proglist);
+    bool Contains(uint chanid, const QDateTime &start,
+                  const QDateTime &end) const;
+    void Load(const QVector<uint> &chanids,
+              const QDateTime &start, const QDateTime &end,
+              const ProgramList &schedList);
+    void Clear(void);
+
+  private:
+    class Entry
+    {
+      public:
+        ~Entry() { qDeleteAll(programs); }
+        QDateTime                       from;
+        QDateTime                       to;
+        QMap<QDateTime, ProgramInfo*>   programs;
+        MythTimer                       age;
+    };
+
+    bool IsCovered(const Entry *entry,
+                   const QDateTime &start, const QDateTime &end) const;
+    void Merge(uint chanid, const QDateTime &start, const QDateTime &end,
+               const QList<ProgramInfo*> &programs);
+    void Touch(uint chanid);
+
+    mutable QMutex      m_lock;
+    QHash<uint, Entry*> m_entries;
+    /// chanids, least recently used first
+    QList<uint>         m_lru;
+
+    /// Number of channels above which the least recently used are dropped
+    static const int kMaxChannels;
+    /// Milliseconds after which the data of a channel is reloaded
+    static const int kMaxAge;
+};
+
+#endif // _GUIDE_DATA_CACHE_H_
@@ -279,18 +279,31 @@ public:
         // Don't bother to do any work if the starting coordinates of
         // the guide have changed while the thread was waiting to
         // start.
-        if (m_currentStartChannel != m_guide->GetCurrentStartChannel() ||
-            m_currentStartTime != m_guide->GetCurrentStartTime())
+        if (!IsCurrent())
         {
+            DeleteProgramLists();
             return false;
         }
 
+        // Fetch the rows which are not cached with a single query
+        QVector<int> missing;
+        for (unsigned int i = 0; i < m_numRows; ++i)
+        {
+            if (!m_proglists[i])
+                missing.push_back(m_channums[i]);
+        }
+        if (!missing.empty())
+            m_guide->fetchProgramLists(missing, m_currentStartTime,
+                                       m_currentEndTime);
+
         for (unsigned int i = 0; i < m_numRows; ++i)
         {
             unsigned int row = i + m_firstRow;
             if (!m_proglists[i])
                 m_proglists[i] =
-                    m_guide->getProgramListFromProgram(m_channums[i]);
+                    m_guide->getProgramListFromProgram(m_channums[i],
+                                                       m_currentStartTime,
+                                                       m_currentEndTime);
             fillProgramRowInfosWith(row, m_channums[i],
                                     m_currentStartTime,
                                     m_proglists[i]);
@@ -299,12 +312,32 @@ public:
     }
     virtual void ExecuteUI(void)
     {
+        // The guide may have been scrolled again while this was loading
+        if (!IsCurrent())
+        {
+            DeleteProgramLists();
+            return;
+        }
+
         m_guide->updateProgramsUI(m_firstRow, m_numRows,
                                   m_progPast, m_proglists,
                                   m_programInfos, m_result);
     }
 
 private:
+    bool IsCurrent(void) const
+    {
+        return m_currentStartChannel == m_guide->GetCurrentStartChannel() &&
+               m_currentStartTime == m_guide->GetCurrentStartTime();
+    }
+    void DeleteProgramLists(void)
+    {
+        for (int i = 0; i < m_proglists.size(); ++i)
+        {
+            delete m_proglists[i];
+            m_proglists[i] = NULL;
+        }
+    }
     void fillProgramRowInfosWith(int row, int chanNum, QDateTime start,
                                  ProgramList *proglist);
 
@@ -353,6 +386,33 @@ public:
     QVector<bool> m_unavailables;
 };
 
+// GuidePrefetch loads the guide data next to what is shown into the
+// cache, so the next scroll in the same direction does not have to wait
+// for the database.
+class GuidePrefetch : public GuideUpdaterBase
+{
+public:
+    GuidePrefetch(GuideGrid *guide, const QVector<int> &channums,
+                  const QDateTime &start, const QDateTime &end,
+                  uint generation)
+        : GuideUpdaterBase(guide), m_channums(channums),
+          m_start(start), m_end(end), m_generation(generation) {}
+    virtual bool ExecuteNonUI(void)
+    {
+        // Skip it if the guide has been scrolled on since
+        if (m_generation == m_guide->GetPrefetchGeneration())
+            m_guide->fetchProgramLists(m_channums, m_start, m_end);
+        return false;
+    }
+    virtual void ExecuteUI(void) {}
+
+private:
+    const QVector<int> m_channums;
+    const QDateTime m_start;
+    const QDateTime m_end;
+    const uint m_generation;
+};
+
 class UpdateGuideEvent : public QEvent
 {
 public:
@@ -511,6 +571,9 @@ GuideGrid::GuideGrid(MythScreenStack *parent,
            m_channelCount(5),
            m_timeCount(30),
            m_verticalLayout(false),
+           m_lastMove(kScrollDown),
+           m_prefetchGeneration(0),
+           m_shownStartChannel(0),
            m_player(player),
            m_usingNullVideo(false),
            m_embedVideo(embedVideo),
@@ -608,6 +671,7 @@ void GuideGrid::Load(void)
     setStartChannel((int)(m_currentStartChannel) - (int)(m_channelCount / 2));
     m_channelCount = min(m_channelCount, maxchannel + 1);
 
+    QVector<int> chanNums;
     for (int y = 0; y < m_channelCount; ++y)
     {
         int chanNum = y + m_currentStartChannel;
@@ -619,8 +683,17 @@ void GuideGrid::Load(void)
         if (chanNum < 0)
             chanNum = 0;
 
+        chanNums.push_back(chanNum);
+    }
+
+    fetchProgramLists(chanNums, m_currentStartTime, m_currentEndTime);
+
+    for (int y = 0; y < chanNums.size(); ++y)
+    {
         delete m_programs[y];
-        m_programs[y] = getProgramListFromProgram(chanNum);
+        m_programs[y] = getProgramListFromProgram(chanNums[y],
+                                                  m_currentStartTime,
+                                                  m_currentEndTime);
     }
 }
 
@@ -1005,25 +1078,22 @@ int GuideGrid::GetStartChannelOffset(int row) const
 ProgramList GuideGrid::GetProgramList(uint chanid) const
 {
     ProgramList proglist;
-    MSqlBindings bindings;
-    QString querystr =
-        "WHERE program.chanid     = :CHANID       AND "
-        "      program.endtime   >= :STARTTS      AND "
-        "      program.starttime <= :ENDTS        AND "
-        "      program.starttime >= :STARTLIMITTS AND "
-        "      program.manualid   = 0 ";
-    QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-    bindings[":STARTTS"] = starttime;
-    bindings[":STARTLIMITTS"] = starttime.addDays(-1);
-    bindings[":ENDTS"] = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
-    bindings[":CHANID"]  = chanid;
-
-    ProgramList dummy;
-    LoadFromProgram(proglist, querystr, bindings, dummy);
-
+    LoadProgramList(chanid, m_currentStartTime, m_currentEndTime, proglist);
     return proglist;
 }
 
+/// Copies the programs of a channel from the cache, loading them if needed
+void GuideGrid::LoadProgramList(uint chanid, const QDateTime &start,
+                                const QDateTime &end,
+                                ProgramList &proglist) const
+{
+    if (!m_guideCache.Get(chanid, start, end, proglist))
+    {
+        m_guideCache.Load(QVector<uint>() << chanid, start, end, m_recList);
+        m_guideCache.Get(chanid, start, end, proglist);
+    }
+}
+
 static ProgramList *CopyProglist(ProgramList *proglist)
 {
     if (!proglist)
@@ -1353,30 +1423,31 @@ void GuideGrid::fillProgramInfos(bool useExistingData)
     fillProgramRowInfos(-1, useExistingData);
 }
 
-ProgramList *GuideGrid::getProgramListFromProgram(int chanNum)
+ProgramList *GuideGrid::getProgramListFromProgram(int chanNum,
+                                                  const QDateTime &start,
+                                                  const QDateTime &end)
 {
     ProgramList *proglist = new ProgramList();
 
     if (proglist)
-    {
-        MSqlBindings bindings;
-        QString querystr = "WHERE program.chanid = :CHANID "
-                           "  AND program.endtime >= :STARTTS "
-                           "  AND program.starttime <= :ENDTS "
-                           "  AND program.starttime >= :STARTLIMITTS "
-                           "  AND program.manualid = 0 ";
-        QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-        bindings[":CHANID"]  = GetChannelInfo(chanNum)->chanid;
-        bindings[":STARTTS"] = starttime;
-        bindings[":STARTLIMITTS"] = starttime.addDays(-1);
-        bindings[":ENDTS"] = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
-
-        LoadFromProgram(*proglist, querystr, bindings, m_recList);
-    }
+        LoadProgramList(GetChannelInfo(chanNum)->chanid, start, end,
+                        *proglist);
 
     return proglist;
 }
 
+/// Loads the programs of all the channels not yet cached in one go
+void GuideGrid::fetchProgramLists(const QVector<int> &chanNums,
+                                  const QDateTime &start,
+                                  const QDateTime &end)
+{
+    QVector<uint> chanids;
+    for (int i = 0; i < chanNums.size(); ++i)
+        chanids.push_back(GetChannelInfo(chanNums[i])->chanid);
+
+    m_guideCache.Load(chanids, start, end, m_recList);
+}
+
 void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
 {
     bool allRows = false;
@@ -1418,6 +1489,17 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
         ProgramList *proglist = NULL;
         if (useExistingData)
             proglist = CopyProglist(m_programs[row]);
+        if (!proglist)
+        {
+            proglist = new ProgramList();
+            if (!m_guideCache.Get(GetChannelInfo(chanNum)->chanid,
+                                  m_currentStartTime, m_currentEndTime,
+                                  *proglist))
+            {
+                delete proglist;
+                proglist = NULL;
+            }
+        }
         chanNums.push_back(chanNum);
         proglists.push_back(proglist);
     }
@@ -1431,6 +1513,65 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
             m_guideGrid->ResetRow(i);
         }
     }
+
+    // Rows which are cached are laid out right away, the rows between
+    // the first and the last uncached one are filled in by the helper
+    // thread once their data has been loaded. Until then they are blanked
+    // if the guide has been scrolled, so no other channel's programs show.
+    bool moved = m_shownStartChannel != m_currentStartChannel ||
+                 m_shownStartTime != m_currentStartTime;
+    m_shownStartChannel = m_currentStartChannel;
+    m_shownStartTime    = m_currentStartTime;
+
+    int firstMiss = -1, lastMiss = -1;
+    for (int i = 0; i < proglists.size(); ++i)
+    {
+        if (!proglists[i])
+        {
+            if (firstMiss < 0)
+                firstMiss = i;
+            lastMiss = i;
+        }
+    }
+
+    if (firstMiss < 0)
+    {
+        startProgramRowUpdate(firstRow, chanNums, proglists, false);
+    }
+    else
+    {
+        if (moved)
+        {
+            for (int i = firstMiss; i <= lastMiss; ++i)
+            {
+                if (!proglists[i])
+                    m_guideGrid->ResetRow(firstRow + i);
+            }
+            m_guideGrid->SetRedraw();
+        }
+
+        if (firstMiss > 0)
+            startProgramRowUpdate(firstRow, chanNums.mid(0, firstMiss),
+                                  proglists.mid(0, firstMiss), false);
+        if (lastMiss + 1 < proglists.size())
+            startProgramRowUpdate(firstRow + lastMiss + 1,
+                                  chanNums.mid(lastMiss + 1),
+                                  proglists.mid(lastMiss + 1), false);
+        startProgramRowUpdate(firstRow + firstMiss,
+                              chanNums.mid(firstMiss, lastMiss - firstMiss + 1),
+                              proglists.mid(firstMiss, lastMiss - firstMiss + 1),
+                              true);
+    }
+
+    if (allRows)
+        prefetchProgramInfos();
+}
+
+void GuideGrid::startProgramRowUpdate(unsigned int firstRow,
+                                      const QVector<int> &chanNums,
+                                      const QVector<ProgramList*> &proglists,
+                                      bool inBackground)
+{
     GuideStatus gs(firstRow, chanNums.size(), chanNums, m_channelInfos.size(),
                    m_guideGrid->GetArea(), m_guideGrid->getChannelCount(),
                    m_currentStartTime, m_currentEndTime, m_currentStartChannel,
@@ -1438,7 +1579,65 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
                    m_verticalLayout, m_firstTime, m_lastTime);
     GuideUpdateProgramRow *updater =
         new GuideUpdateProgramRow(this, gs, proglists);
-    m_threadPool.start(new GuideHelper(this, updater), "GuideHelper");
+
+    if (inBackground)
+    {
+        m_threadPool.start(new GuideHelper(this, updater), "GuideHelper");
+        return;
+    }
+
+    // Everything is at hand, so only the layout remains to be done
+    if (updater->ExecuteNonUI())
+        updater->ExecuteUI();
+    delete updater;
+}
+
+/** \brief Queues loading of the page next to the visible one, in the
+ *         direction the guide was last scrolled in.
+ */
+void GuideGrid::prefetchProgramInfos(void)
+{
+    int chancnt = GetChannelCount();
+    if (!chancnt || !m_channelCount)
+        return;
+
+    QDateTime start = m_currentStartTime;
+    QDateTime end   = m_currentEndTime;
+    int firstChan   = m_currentStartChannel;
+    int span        = m_currentStartTime.secsTo(m_currentEndTime);
+
+    switch (m_lastMove)
+    {
+        case kScrollLeft :
+        case kPageLeft :
+        case kDayLeft :
+            start = start.addSecs(-span);
+            end   = end.addSecs(-span);
+            break;
+        case kScrollRight :
+        case kPageRight :
+        case kDayRight :
+            start = start.addSecs(span);
+            end   = end.addSecs(span);
+            break;
+        case kScrollUp :
+        case kPageUp :
+            firstChan -= m_channelCount;
+            break;
+        case kScrollDown :
+        case kPageDown :
+        default :
+            firstChan += m_channelCount;
+            break;
+    }
+
+    QVector<int> chanNums;
+    for (int i = 0; i < m_channelCount && i < chancnt; ++i)
+        chanNums.push_back(((firstChan + i) % chancnt + chancnt) % chancnt);
+
+    GuidePrefetch *prefetch = new GuidePrefetch(this, chanNums, start, end,
+                                                ++m_prefetchGeneration);
+    m_threadPool.start(new GuideHelper(this, prefetch), "GuidePrefetch", 1);
 }
 
 void GuideUpdateProgramRow::fillProgramRowInfosWith(int row, int chanNum,
@@ -1684,6 +1883,7 @@ void GuideGrid::customEvent(QEvent *event)
 
         if (message == "SCHEDULE_CHANGE")
         {
+            m_guideCache.Clear();
             LoadFromScheduler(m_recList);
             fillProgramInfos();
         }
@@ -2075,6 +2275,7 @@ void GuideGrid::generateListings()
     maxchannel = max((int)GetChannelCount() - 1, 0);
     m_channelCount = min(m_guideGrid->getChannelCount(), maxchannel + 1);
 
+    m_guideCache.Clear();
     LoadFromScheduler(m_recList);
     fillProgramInfos();
 }
@@ -2280,6 +2481,7 @@ void GuideGrid::moveLeftRight(MoveVector movement)
             break;
     }
 
+    m_lastMove = movement;
     fillTimeInfos();
     fillProgramInfos();
     updateDateText();
@@ -2305,6 +2507,7 @@ void GuideGrid::moveUpDown(MoveVector movement)
             break;
     }
 
+    m_lastMove = movement;
     fillProgramInfos();
     updateChannels();
 }
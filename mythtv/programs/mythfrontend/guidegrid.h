@@ -23,6 +23,7 @@ using namespace std;
 
 // mythfrontend
 #include "schedulecommon.h"
+#include "guidedatacache.h"
 
 using namespace std;
 
@@ -207,9 +208,19 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
     void fillProgramInfos(bool useExistingData = false);
     // Set row=-1 to fill all rows.
     void fillProgramRowInfos(int row, bool useExistingData);
+    void startProgramRowUpdate(unsigned int firstRow,
+                               const QVector<int> &chanNums,
+                               const QVector<ProgramList*> &proglists,
+                               bool inBackground);
+    void prefetchProgramInfos(void);
 public:
     // These need to be public so that the helper classes can operate.
-    ProgramList *getProgramListFromProgram(int chanNum);
+    ProgramList *getProgramListFromProgram(int chanNum,
+                                           const QDateTime &start,
+                                           const QDateTime &end);
+    void fetchProgramLists(const QVector<int> &chanNums,
+                           const QDateTime &start, const QDateTime &end);
+    uint GetPrefetchGeneration(void) const { return m_prefetchGeneration; }
     void updateProgramsUI(unsigned int firstRow, unsigned int numRows,
                           int progPast,
                           const QVector<ProgramList*> &proglists,
@@ -229,6 +240,8 @@ private:
     int                  GetStartChannelOffset(int row = -1) const;
 
     ProgramList GetProgramList(uint chanid) const;
+    void LoadProgramList(uint chanid, const QDateTime &start,
+                         const QDateTime &end, ProgramList &proglist) const;
     uint GetAlternateChannelIndex(uint chan_idx, bool with_same_channum) const;
     void updateDateText(void);
 
@@ -242,6 +255,7 @@ private:
     vector<ProgramList*> m_programs;
     ProgInfoGuideArray m_programInfos;
     ProgramList  m_recList;
+    mutable GuideDataCache m_guideCache;
 
     QDateTime m_originalStartTime;
     QDateTime m_currentStartTime;
@@ -259,6 +273,11 @@ private:
     int  m_timeCount;
     bool m_verticalLayout;
 
+    MoveVector m_lastMove;
+    uint       m_prefetchGeneration;
+    uint       m_shownStartChannel;
+    QDateTime  m_shownStartTime;
+
     QDateTime m_firstTime;
     QDateTime m_lastTime;
 
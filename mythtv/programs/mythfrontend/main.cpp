@@ -1318,6 +1318,15 @@ static void setDebugShowNames(void)
         GetMythMainWindow()->GetMainStack()->GetTopScreen()->SetRedraw();
 }
 
+static void setDebugShowRepaints(void)
+{
+    MythPainter *p = GetMythPainter();
+    p->SetShowRepaints(!p->ShowRepaints());
+
+    if (GetMythMainWindow()->GetMainStack()->GetTopScreen())
+        GetMythMainWindow()->GetMainStack()->GetTopScreen()->SetRedraw();
+}
+
 static void InitJumpPoints(void)
 {
      REG_JUMP(QT_TRANSLATE_NOOP("MythControls", "Reload Theme"),
@@ -1367,6 +1376,8 @@ static void InitJumpPoints(void)
          "", "", setDebugShowBorders, false);
      REG_JUMPEX(QT_TRANSLATE_NOOP("MythControls", "Toggle Show Widget Names"),
          "", "", setDebugShowNames, false);
+     REG_JUMPEX(QT_TRANSLATE_NOOP("MythControls", "Toggle Show Repaint Regions"),
+         "", "", setDebugShowRepaints, false);
      REG_JUMPEX(QT_TRANSLATE_NOOP("MythControls", "Reset All Keys"),
          QT_TRANSLATE_NOOP("MythControls", "Reset all keys to defaults"),
          "", resetAllKeys, false);
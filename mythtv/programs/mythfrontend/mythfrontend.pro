@@ -38,7 +38,7 @@ HEADERS += statusbox.h networkcontrol.h custompriority.h
 HEADERS += mediarenderer.h mythfexml.h playbackboxlistitem.h
 HEADERS += exitprompt.h
 HEADERS += action.h mythcontrols.h keybindings.h keygrabber.h
-HEADERS += progfind.h guidegrid.h customedit.h
+HEADERS += progfind.h guidegrid.h guidedatacache.h customedit.h
 HEADERS += schedulecommon.h progdetails.h scheduleeditor.h
 HEADERS += backendconnectionmanager.h   programinfocache.h
 HEADERS += proglist.h                   proglist_helpers.h
@@ -63,7 +63,7 @@ SOURCES += channelrecpriority.cpp statusbox.cpp networkcontrol.cpp
 SOURCES += mediarenderer.cpp mythfexml.cpp playbackboxlistitem.cpp
 SOURCES += custompriority.cpp exitprompt.cpp
 SOURCES += action.cpp actionset.cpp  mythcontrols.cpp keybindings.cpp
-SOURCES += keygrabber.cpp progfind.cpp guidegrid.cpp
+SOURCES += keygrabber.cpp progfind.cpp guidegrid.cpp guidedatacache.cpp
 SOURCES += customedit.cpp schedulecommon.cpp progdetails.cpp scheduleeditor.cpp
 SOURCES += backendconnectionmanager.cpp programinfocache.cpp
 SOURCES += proglist.cpp                 proglist_helpers.cpp
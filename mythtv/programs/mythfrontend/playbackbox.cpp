@@ -37,6 +37,7 @@
 #include "mythdbcon.h"
 #include "mythevent.h"                  // for MythEvent, etc
 #include "playgroup.h"
+#include "posmapcache.h"
 #include "mythdb.h"
 #include "mythdate.h"
 #include "tv.h"
@@ -2553,6 +2554,7 @@ void PlaybackBox::RemoveProgram( uint recordingID, bool forgetHistory,
     delItem->SetAvailableStatus(asPendingDelete, "RemoveProgram");
     m_helper.DeleteRecording( delItem->GetRecordingID(),
                               forceMetadataDelete, forgetHistory);
+    PositionMapCache::Remove(*delItem);
 
     // if the item is in the current recording list UI then delete it.
     MythUIButtonListItem *uiItem =
@@ -89,12 +89,23 @@ void MythTranscodeCommandLineParser::LoadArguments(void)
             "profile to the jobqueue. Accepts an optional string to define "
             "the hostname.", "");
 
-//    add("--container", "container", "", "Output file container format", "")
-//        ->SetChildOf("avf");
-//    add("--acodec", "acodec", "", "Output file audio codec", "")
-//        ->SetChildOf("avf");
-//    add("--vcodec", "vcodec", "", "Output file video codec", "")
-//        ->SetChildOf("avf");
+    add("--container", "container", "", "Output file container format", "")
+        ->SetChildOf("avf");
+    add("--acodec", "acodec", "", "Output file audio codec", "")
+        ->SetChildOf("avf");
+    add("--vcodec", "vcodec", "", "Output file video codec", "")
+        ->SetChildOf("avf");
+    add("--parallel", "parallel", 0,
+            "Transcode this many parts of the file at the same time.",
+            "Splits the recording at keyframes of its position map, "
+            "transcodes the parts in separate processes and joins them. "
+            "The job queue does not pass this option, it is only used "
+            "when mythtranscode is run by hand.")
+        ->SetChildOf("avf");
+    add("--parallelpart", "parallelpart", false,
+            "Used by --parallel for each part, leaves the recording "
+            "and its markup as they are.", "")
+        ->SetChildOf("avf");
     add("--width", "width", 0, "Output Video Width", "")
         ->SetChildOf("avf")
         ->SetChildOf("hls");
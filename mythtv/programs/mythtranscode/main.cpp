@@ -22,6 +22,8 @@ using namespace std;
 #include "mythdate.h"
 #include "transcode.h"
 #include "mpeg2fix.h"
+#include "streamcopycutter.h"
+#include "paralleltranscode.h"
 #include "remotefile.h"
 #include "mythtranslation.h"
 #include "mythlogging.h"
@@ -472,6 +474,12 @@ int main(int argc, char *argv[])
         cerr << "--cleancut is pointless without --honorcutlist" << endl;
         return GENERIC_EXIT_INVALID_CMDLINE;
     }
+    if (cmdline.toBool("parallel") &&
+        (cmdline.toBool("hls") || !fifodir.isEmpty() || outfile == "-"))
+    {
+        cerr << "--parallel needs an output file" << endl;
+        return GENERIC_EXIT_INVALID_CMDLINE;
+    }
 
     if (fifo_info)
     {
@@ -617,11 +625,63 @@ int main(int argc, char *argv[])
     int result = 0;
     if ((!mpeg2 && !build_index) || cmdline.toBool("hls"))
     {
-        result = transcode->TranscodeFile(infile, outfile,
-                                          profilename, useCutlist,
-                                          (fifosync || keyframesonly), jobID,
-                                          fifodir, fifo_info, cleanCut, deleteMap,
-                                          AudioTrackNo, passthru);
+        ParallelTranscode *split = NULL;
+        if (cmdline.toInt("parallel") > 1)
+        {
+            // Each part gets the same encoding options
+            QStringList partArgs;
+            partArgs << "--avf" << "--profile" << profilename;
+            if (cmdline.toBool("container"))
+                partArgs << "--container" << cmdline.toString("container");
+            if (cmdline.toBool("acodec"))
+                partArgs << "--acodec" << cmdline.toString("acodec");
+            if (cmdline.toBool("vcodec"))
+                partArgs << "--vcodec" << cmdline.toString("vcodec");
+            if (cmdline.toBool("width"))
+                partArgs << "--width" << cmdline.toString("width");
+            if (cmdline.toBool("height"))
+                partArgs << "--height" << cmdline.toString("height");
+            if (cmdline.toBool("bitrate"))
+                partArgs << "--bitrate" << cmdline.toString("bitrate");
+            if (cmdline.toBool("audiobitrate"))
+                partArgs << "--audiobitrate"
+                         << cmdline.toString("audiobitrate");
+            if (!recorderOptions.isEmpty())
+                partArgs << "--recorderOptions" << recorderOptions;
+            if (AudioTrackNo > -1)
+                partArgs << "--audiotrack" << QString::number(AudioTrackNo);
+            if (passthru)
+                partArgs << "--passthrough";
+            if (keyframesonly)
+                partArgs << "--allkeys";
+            if (isVideo)
+                partArgs << "--video";
+
+            split = new ParallelTranscode(pginfo, partArgs);
+            if (!split->Split(cmdline.toInt("parallel"), useCutlist,
+                              deleteMap))
+            {
+                delete split;
+                split = NULL;
+            }
+        }
+
+        if (split)
+        {
+            result = split->TranscodeFile(infile, outfile,
+                                          cmdline.toString("container"),
+                                          jobID);
+            delete split;
+        }
+        else
+        {
+            result = transcode->TranscodeFile(infile, outfile,
+                                              profilename, useCutlist,
+                                              (fifosync || keyframesonly),
+                                              jobID, fifodir, fifo_info,
+                                              cleanCut, deleteMap,
+                                              AudioTrackNo, passthru);
+        }
 
         if ((result == REENCODE_OK) && (jobID >= 0))
         {
@@ -713,6 +773,46 @@ int main(int argc, char *argv[])
         delete m2f;
         m2f = NULL;
     }
+    else if (result == REENCODE_STREAMCOPY)
+    {
+        void (*update_func)(float) = NULL;
+        int (*check_func)() = NULL;
+        if (useCutlist)
+        {
+            LOG(VB_GENERAL, LOG_INFO, "Honoring the cutlist while copying");
+            if (deleteMap.isEmpty())
+                pginfo->QueryCutList(deleteMap);
+        }
+        if (jobID >= 0)
+        {
+           glbl_jobID = jobID;
+           update_func = &UpdateJobQueue;
+           check_func = &CheckJobQueue;
+        }
+
+        // Keyframes of the recording, only the frames between them and
+        // the cuts are re-encoded
+        frm_pos_map_t keyMap;
+        pginfo->QueryPositionMap(keyMap, MARK_GOP_BYFRAME);
+
+        StreamCopyCutter cutter(infile, outfile, deleteMap, keyMap,
+                                showprogress, update_func, check_func);
+        result = cutter.Start();
+        if (result == REENCODE_OK)
+        {
+            cutter.GetPositionMap(posMap, durMap);
+            if (update_index)
+                UpdatePositionMap(posMap, durMap, NULL, pginfo);
+            else
+                UpdatePositionMap(posMap, durMap, outfile + QString(".map"),
+                                  pginfo);
+
+            RecordingInfo recInfo(*pginfo);
+            RecordingFile *recFile = recInfo.GetRecordingFile();
+            recFile->m_containerFormat = formatMPEG2_TS;
+            recFile->Save();
+        }
+    }
 
     if (result == REENCODE_OK)
     {
@@ -748,7 +848,8 @@ int main(int argc, char *argv[])
         exitcode = result;
     }
 
-    if (!cmdline.toBool("hls"))
+    // A part of a parallel transcode leaves the recording alone
+    if (!cmdline.toBool("hls") && !cmdline.toBool("parallelpart"))
         CompleteJob(jobID, pginfo, useCutlist, &deleteMap, exitcode, result);
 
     transcode->deleteLater();
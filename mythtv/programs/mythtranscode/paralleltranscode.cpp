@@ -0,0 +1,289 @@
+// POSIX headers
+#include <unistd.h> // for sleep(), unlink()
+
+// Qt headers
+#include <QDateTime>
+
+// MythTV headers
+#include "paralleltranscode.h"
+#include "mythsystemlegacy.h"
+#include "transcodedefs.h"
+#include "programinfo.h"
+#include "mythlogging.h"
+#include "exitcodes.h"
+#include "jobqueue.h"
+#include "mythdirs.h"
+#include "mythdate.h"
+
+#define LOC QString("ParallelTranscode: ")
+
+ParallelTranscode::ParallelTranscode(ProgramInfo *pginfo,
+                                     const QStringList &partArgs) :
+    m_proginfo(pginfo), m_partArgs(partArgs), m_honorCutList(false)
+{
+}
+
+ParallelTranscode::~ParallelTranscode()
+{
+    StopParts();
+}
+
+/**
+ *  Plans up to \p count parts from the position map of the recording,
+ *  returns false when there is not more than one, the recording is then
+ *  better transcoded as usual.
+ */
+bool ParallelTranscode::Split(uint count, bool honorCutList,
+                              frm_dir_map_t &deleteMap)
+{
+    frm_dir_map_t cutlist;
+    m_honorCutList = honorCutList;
+    if (honorCutList)
+    {
+        if (deleteMap.isEmpty())
+            m_proginfo->QueryCutList(deleteMap);
+        cutlist = deleteMap;
+    }
+
+    frm_pos_map_t keyMap;
+    m_proginfo->QueryPositionMap(keyMap, MARK_GOP_BYFRAME);
+    if (keyMap.isEmpty())
+        m_proginfo->QueryPositionMap(keyMap, MARK_KEYFRAME);
+    if (keyMap.size() < 2)
+    {
+        LOG(VB_GENERAL, LOG_NOTICE, LOC +
+            "No position map, transcoding the recording in one piece");
+        return false;
+    }
+
+    int64_t totalFrames = m_proginfo->QueryTotalFrames();
+    if (totalFrames <= keyMap.lastKey())
+        totalFrames = keyMap.lastKey() + 1;
+
+    m_parts = SplitForTranscode(keyMap, cutlist, totalFrames, count);
+    if (m_parts.size() < 2)
+    {
+        LOG(VB_GENERAL, LOG_NOTICE, LOC +
+            "Too few frames to split, transcoding in one piece");
+        m_parts.clear();
+        return false;
+    }
+
+    for (int i = 0; i < m_parts.size(); i++)
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Part %1: %2 frames from frame %3, cutlist %4")
+            .arg(i).arg(m_parts[i].frames).arg(m_parts[i].start)
+            .arg(m_parts[i].CutListString()));
+    }
+
+    return true;
+}
+
+int ParallelTranscode::TranscodeFile(const QString &inputname,
+                                     const QString &outputname,
+                                     const QString &container, int jobID)
+{
+    if (jobID >= 0)
+        JobQueue::ChangeJobComment(jobID, "0% " + QObject::tr("Completed"));
+
+    LOG(VB_GENERAL, LOG_NOTICE, LOC +
+        QString("Transcoding %1 in %2 parts").arg(inputname)
+        .arg(m_parts.size()));
+
+    if (m_honorCutList && m_proginfo)
+    {
+        if (m_proginfo->QueryIsEditing() ||
+            JobQueue::IsJobRunning(JOB_COMMFLAG, *m_proginfo))
+        {
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                "Transcoding aborted, cutlist changed");
+            return REENCODE_CUTLIST_CHANGE;
+        }
+        m_proginfo->ClearMarkupFlag(MARK_UPDATED_CUT);
+    }
+
+    uint64_t totalFrames = 0;
+    for (int i = 0; i < m_parts.size(); i++)
+    {
+        m_partFiles << outputname + QString(".part%1").arg(i);
+        totalFrames += m_parts[i].frames;
+        if (!StartPart(i, inputname))
+        {
+            StopParts();
+            RemoveParts();
+            return REENCODE_ERROR;
+        }
+    }
+
+    QDateTime statustime = MythDate::current().addSecs(20);
+    QDateTime curtime    = MythDate::current().addSecs(60);
+    QDateTime starttime  = MythDate::current();
+    int       running    = m_processes.size();
+
+    while (running)
+    {
+        sleep(1);
+
+        running = 0;
+        uint64_t doneFrames = 0;
+        for (int i = 0; i < m_processes.size(); i++)
+        {
+            uint status = m_processes[i]->GetStatus();
+            if (status == GENERIC_EXIT_START || status == GENERIC_EXIT_RUNNING)
+            {
+                running++;
+                continue;
+            }
+
+            if (status == GENERIC_EXIT_RESTART)
+            {
+                LOG(VB_GENERAL, LOG_NOTICE, LOC +
+                    QString("Part %1 stopped, the cutlist changed").arg(i));
+                StopParts();
+                RemoveParts();
+                return REENCODE_CUTLIST_CHANGE;
+            }
+
+            if (status != GENERIC_EXIT_OK)
+            {
+                LOG(VB_GENERAL, LOG_ERR, LOC +
+                    QString("Part %1 failed with exit code %2")
+                    .arg(i).arg(status));
+                StopParts();
+                RemoveParts();
+                return REENCODE_ERROR;
+            }
+            doneFrames += m_parts[i].frames;
+        }
+
+        if (MythDate::current() > curtime)
+        {
+            if (CutListChanged())
+            {
+                LOG(VB_GENERAL, LOG_NOTICE, LOC +
+                    "Transcoding aborted, cutlist updated");
+                StopParts();
+                RemoveParts();
+                return REENCODE_CUTLIST_CHANGE;
+            }
+            curtime = MythDate::current().addSecs(60);
+        }
+
+        if (jobID >= 0 && JobQueue::GetJobCmd(jobID) == JOB_STOP)
+        {
+            LOG(VB_GENERAL, LOG_NOTICE, LOC + "Transcoding STOPped by JobQueue");
+            StopParts();
+            RemoveParts();
+            return REENCODE_STOPPED;
+        }
+
+        if (MythDate::current() > statustime)
+        {
+            int   percentage = totalFrames ? doneFrames * 100 / totalFrames : 0;
+            float elapsed    = starttime.secsTo(MythDate::current());
+            float flagFPS    = elapsed ? doneFrames / elapsed : 0.0;
+
+            if (jobID >= 0)
+                JobQueue::ChangeJobComment(jobID,
+                          QObject::tr("%1% Completed @ %2 fps.")
+                                      .arg(percentage).arg(flagFPS));
+            else
+                LOG(VB_GENERAL, LOG_INFO,
+                    QString("mythtranscode: %1 of %2 parts done, %3% "
+                            "Completed @ %4 fps.")
+                        .arg(m_processes.size() - running)
+                        .arg(m_processes.size())
+                        .arg(percentage).arg(flagFPS));
+
+            statustime = MythDate::current().addSecs(20);
+        }
+    }
+
+    StopParts();
+
+    if (CutListChanged())
+    {
+        LOG(VB_GENERAL, LOG_NOTICE, LOC + "Transcoding aborted, cutlist updated");
+        RemoveParts();
+        return REENCODE_CUTLIST_CHANGE;
+    }
+
+    if (jobID >= 0)
+        JobQueue::ChangeJobComment(jobID, QObject::tr("Joining the parts"));
+
+    bool ok = JoinTranscodedParts(m_partFiles, outputname, container);
+    RemoveParts();
+
+    if (!ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't join the transcoded parts");
+        unlink(outputname.toLocal8Bit().constData());
+        return REENCODE_ERROR;
+    }
+
+    return REENCODE_OK;
+}
+
+bool ParallelTranscode::StartPart(int index, const QString &inputname)
+{
+    QStringList args;
+    args << "--infile"  << inputname
+         << "--outfile" << m_partFiles[index]
+         << "--parallelpart"
+         << "--honorcutlist" << m_parts[index].CutListString()
+         << m_partArgs;
+
+    QString command = GetAppBinDir() + "mythtranscode";
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Starting part %1: %2 %3")
+        .arg(index).arg(command).arg(args.join(" ")));
+
+    MythSystemLegacy *ms = new MythSystemLegacy(command, args,
+                                                kMSDontBlockInputDevs |
+                                                kMSPropagateLogs);
+    m_processes.push_back(ms);
+    ms->Run();
+
+    if (ms->GetStatus() != GENERIC_EXIT_START &&
+        ms->GetStatus() != GENERIC_EXIT_RUNNING)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't start part %1, error %2")
+            .arg(index).arg(ms->GetStatus()));
+        return false;
+    }
+
+    return true;
+}
+
+/// Whether the cutlist the parts were given is out of date
+bool ParallelTranscode::CutListChanged(void) const
+{
+    return m_honorCutList && m_proginfo &&
+           m_proginfo->QueryMarkupFlag(MARK_UPDATED_CUT);
+}
+
+/// Kills the parts still running, and forgets about all of them
+void ParallelTranscode::StopParts(void)
+{
+    while (!m_processes.isEmpty())
+    {
+        MythSystemLegacy *ms = m_processes.takeFirst();
+        if (ms->GetStatus() == GENERIC_EXIT_RUNNING)
+        {
+            ms->Term(true);
+            ms->Wait();
+        }
+        delete ms;
+    }
+}
+
+void ParallelTranscode::RemoveParts(void)
+{
+    QStringList::const_iterator it = m_partFiles.begin();
+    for (; it != m_partFiles.end(); ++it)
+        unlink(it->toLocal8Bit().constData());
+    m_partFiles.clear();
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,54 @@
+#ifndef PARALLELTRANSCODE_H
+#define PARALLELTRANSCODE_H
+
+// Qt
+#include <QStringList>
+#include <QString>
+#include <QList>
+
+// MythTV
+#include "transcodeparts.h"
+#include "programtypes.h"
+
+class ProgramInfo;
+class MythSystemLegacy;
+
+/** \class ParallelTranscode
+ *  \brief Transcodes a recording in parts at the same time.
+ *
+ *  Transcode decodes and encodes the whole file in one loop, and
+ *  libavcodec calls are serialized within a process, so a transcode
+ *  keeps only a few cores busy. This splits the recording at keyframes
+ *  of its position map, runs a mythtranscode --parallelpart process for
+ *  each part and joins their libavformat output files.
+ *
+ *  The parts are given their cutlists on the command line and know
+ *  nothing of the recording, so it is this process which watches the
+ *  cutlist of the recording and stops them when it changes.
+ */
+class ParallelTranscode
+{
+  public:
+    /// \p partArgs are the encoding arguments given to every part
+    ParallelTranscode(ProgramInfo *pginfo, const QStringList &partArgs);
+    ~ParallelTranscode();
+
+    bool Split(uint count, bool honorCutList, frm_dir_map_t &deleteMap);
+    int  TranscodeFile(const QString &inputname, const QString &outputname,
+                       const QString &container, int jobID);
+
+  private:
+    bool StartPart(int index, const QString &inputname);
+    bool CutListChanged(void) const;
+    void StopParts(void);
+    void RemoveParts(void);
+
+    ProgramInfo              *m_proginfo;
+    QStringList               m_partArgs;
+    bool                      m_honorCutList;
+    QList<TranscodePart>      m_parts;
+    QStringList               m_partFiles;
+    QList<MythSystemLegacy*>  m_processes;
+};
+
+#endif // PARALLELTRANSCODE_H
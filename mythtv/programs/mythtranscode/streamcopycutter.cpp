@@ -0,0 +1,1068 @@
+// C++ headers
+#include <climits>
+#include <cstring>
+
+extern "C"
+{
+#include "libavutil/opt.h"
+}
+
+// Qt headers
+#include <QFileInfo>
+
+// MythTV headers
+#include "streamcopycutter.h"
+#include "mythlogging.h"
+#include "mythdate.h"
+
+#define LOC QString("StreamCopy: ")
+
+/// Cuts shorter than this many frames are read through, not seeked over
+static const int64_t kSeekFrames = 300;
+
+StreamCopyCutter::StreamCopyCutter(const QString &inf, const QString &outf,
+                                   const frm_dir_map_t &deleteMap,
+                                   const frm_pos_map_t &posMap,
+                                   bool showprog,
+                                   void (*update_func)(float),
+                                   int (*check_func)()) :
+    m_infile(inf), m_outfile(outf), m_deleteMap(deleteMap), m_posMap(posMap),
+    m_inputFC(NULL), m_outputFC(NULL), m_videoIndex(-1),
+    m_decoder(NULL), m_encoder(NULL), m_hasPending(false), m_resync(false),
+    m_stopped(false), m_failed(false), m_frame(0),
+    m_videoTime(AV_NOPTS_VALUE), m_lastEnd(AV_NOPTS_VALUE), m_offset(0),
+    m_dtsDelay(0), m_outFrame(0), m_outDuration(0.0), m_frameMS(40.0),
+    m_encodedFrames(0),
+    m_showprogress(showprog), m_update_status(update_func),
+    m_check_abort(check_func), m_status_update_time(update_func ? 20 : 5),
+    m_filesize(QFileInfo(inf).size())
+{
+    av_register_all();
+}
+
+StreamCopyCutter::~StreamCopyCutter()
+{
+    Close();
+}
+
+int StreamCopyCutter::Start(void)
+{
+    if (!OpenInput())
+        return REENCODE_ERROR;
+
+    if (m_posMap.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            "No position map, looking for the keyframes");
+        if (!ScanKeyframes())
+        {
+            Close();
+            return REENCODE_ERROR;
+        }
+    }
+
+    BuildRegions();
+    if (m_regions.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "The cutlist leaves nothing to copy");
+        Close();
+        return REENCODE_ERROR;
+    }
+
+    if (!OpenOutput())
+    {
+        Close();
+        return REENCODE_ERROR;
+    }
+
+    if (m_showprogress || m_update_status)
+    {
+        if (m_update_status)
+            m_update_status(0);
+        m_statustime = MythDate::current().addSecs(m_status_update_time);
+    }
+
+    AVStream *vst   = m_inputFC->streams[m_videoIndex];
+    AVRational rate = vst->avg_frame_rate.num ? vst->avg_frame_rate
+                                              : vst->r_frame_rate;
+    if (rate.num)
+        m_frameMS = 1000.0 / av_q2d(rate);
+
+    bool ok = true;
+    for (int i = 0; ok && i < m_regions.size(); i++)
+    {
+        ok = m_regions[i].encode ? EncodeRegion(m_regions[i])
+                                 : CopyRegion(m_regions[i]);
+    }
+
+    if (m_stopped)
+    {
+        Close();
+        return REENCODE_STOPPED;
+    }
+
+    if (ok)
+        ok = FlushQueue(AV_NOPTS_VALUE);
+
+    if (ok && av_write_trailer(m_outputFC) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't write the end of the file");
+        ok = false;
+    }
+
+    Close();
+
+    if (!ok)
+        return REENCODE_ERROR;
+
+    LOG(VB_GENERAL, LOG_NOTICE, LOC +
+        QString("Wrote %1 frames in %2 ranges, %3 of them re-encoded, "
+                "%4 keyframes")
+        .arg(m_outFrame).arg(m_ranges.size()).arg(m_encodedFrames)
+        .arg(m_outPosMap.size()));
+
+    if (m_update_status)
+        m_update_status(100);
+
+    return REENCODE_OK;
+}
+
+/** \fn StreamCopyCutter::CanCopy(const QString&)
+ *  \brief Returns true if the file is in a container the cutter can write
+ *         back out, only MPEG-TS is, and its video can be re-encoded
+ *         around the cuts.
+ *
+ *  Whether the video is H.264 or HEVC is not checked here, Transcode
+ *  already knows it.
+ */
+bool StreamCopyCutter::CanCopy(const QString &filename)
+{
+    av_register_all();
+
+    AVFormatContext *fc = NULL;
+    QByteArray fname = filename.toLocal8Bit();
+    if (avformat_open_input(&fc, fname.constData(), NULL, NULL))
+        return false;
+
+    bool ok = !strcmp(fc->iformat->name, "mpegts") &&
+              avformat_find_stream_info(fc, NULL) >= 0;
+    if (ok)
+    {
+        int video = av_find_best_stream(fc, AVMEDIA_TYPE_VIDEO,
+                                        -1, -1, NULL, 0);
+        AVCodecID id = (video >= 0) ? fc->streams[video]->codec->codec_id
+                                    : AV_CODEC_ID_NONE;
+        if (!avcodec_find_encoder(id))
+        {
+            LOG(VB_GENERAL, LOG_NOTICE, LOC +
+                QString("No %1 encoder, the cuts can't be re-encoded")
+                .arg(avcodec_get_name(id)));
+            ok = false;
+        }
+    }
+
+    avformat_close_input(&fc);
+    return ok;
+}
+
+bool StreamCopyCutter::OpenInput(void)
+{
+    QByteArray fname = m_infile.toLocal8Bit();
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Opening %1").arg(m_infile));
+
+    int ret = avformat_open_input(&m_inputFC, fname.constData(), NULL, NULL);
+    if (ret)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open input file, error #%1").arg(ret));
+        return false;
+    }
+
+    ret = avformat_find_stream_info(m_inputFC, NULL);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't get stream info, error #%1").arg(ret));
+        return false;
+    }
+
+    if (strcmp(m_inputFC->iformat->name, "mpegts"))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Only MPEG-TS recordings can be copied, not %1")
+            .arg(m_inputFC->iformat->name));
+        return false;
+    }
+
+    m_videoIndex = av_find_best_stream(m_inputFC, AVMEDIA_TYPE_VIDEO,
+                                       -1, -1, NULL, 0);
+    if (m_videoIndex < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No video stream");
+        return false;
+    }
+
+    return true;
+}
+
+bool StreamCopyCutter::OpenOutput(void)
+{
+    QByteArray fname = m_outfile.toLocal8Bit();
+
+    int ret = avformat_alloc_output_context2(&m_outputFC, NULL, "mpegts",
+                                             fname.constData());
+    if (ret < 0 || !m_outputFC)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't create the output, error #%1").arg(ret));
+        return false;
+    }
+
+    m_streamMap.fill(-1, m_inputFC->nb_streams);
+    m_lastWritten.fill(AV_NOPTS_VALUE, m_inputFC->nb_streams);
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        AVStream *ist = m_inputFC->streams[i];
+        AVMediaType type = ist->codec->codec_type;
+
+        if ((int)i != m_videoIndex && type != AVMEDIA_TYPE_AUDIO &&
+            type != AVMEDIA_TYPE_SUBTITLE)
+            continue;
+        if (ist->codec->codec_id == AV_CODEC_ID_NONE)
+            continue;
+
+        AVStream *ost = avformat_new_stream(m_outputFC, NULL);
+        if (!ost || avcodec_copy_context(ost->codec, ist->codec) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Couldn't copy stream #%1").arg(i));
+            return false;
+        }
+
+        ost->codec->codec_tag = 0;
+        ost->time_base = ist->time_base;
+        ost->id = ist->id;  // keep the PIDs
+        av_dict_copy(&ost->metadata, ist->metadata, 0);
+
+        m_streamMap[i] = ost->index;
+
+        LOG(VB_GENERAL, LOG_INFO, LOC + QString("Copying stream #%1 (%2)")
+            .arg(i).arg(avcodec_get_name(ist->codec->codec_id)));
+    }
+
+    ret = avio_open(&m_outputFC->pb, fname.constData(), AVIO_FLAG_WRITE);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open %1, error #%2").arg(m_outfile).arg(ret));
+        return false;
+    }
+
+    ret = avformat_write_header(m_outputFC, NULL);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't write the header, error #%1").arg(ret));
+        return false;
+    }
+
+    return true;
+}
+
+void StreamCopyCutter::Close(void)
+{
+    CloseCodecs();
+
+    if (m_hasPending)
+    {
+        av_free_packet(&m_pending);
+        m_hasPending = false;
+    }
+
+    while (!m_queue.isEmpty())
+    {
+        AVPacket pkt = m_queue.dequeue();
+        av_free_packet(&pkt);
+    }
+
+    if (m_inputFC)
+        avformat_close_input(&m_inputFC);
+
+    if (m_outputFC)
+    {
+        if (m_outputFC->pb)
+            avio_closep(&m_outputFC->pb);
+        avformat_free_context(m_outputFC);
+        m_outputFC = NULL;
+    }
+}
+
+/// Builds the keyframe map when the recording has none, then rewinds
+bool StreamCopyCutter::ScanKeyframes(void)
+{
+    AVPacket pkt;
+    av_init_packet(&pkt);
+
+    int64_t frame = 0;
+    while (av_read_frame(m_inputFC, &pkt) >= 0)
+    {
+        if (pkt.stream_index == m_videoIndex)
+        {
+            if (pkt.flags & AV_PKT_FLAG_KEY)
+                m_posMap[frame] = pkt.pos;
+            frame++;
+        }
+        av_free_packet(&pkt);
+    }
+
+    avformat_close_input(&m_inputFC);
+    m_inputFC = NULL;
+
+    if (m_posMap.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No keyframes found");
+        return false;
+    }
+
+    return OpenInput();
+}
+
+/**
+ *  Turns the cutlist into the list of regions to write. The frames
+ *  between the first and the last keyframe of each kept part are copied,
+ *  those before and after them are re-encoded.
+ */
+void StreamCopyCutter::BuildRegions(void)
+{
+    QList<Region> wanted;
+    int64_t start = 0;
+    bool    cut   = !m_deleteMap.isEmpty() &&
+                    m_deleteMap.begin().value() == MARK_CUT_END;
+
+    frm_dir_map_t::const_iterator it = m_deleteMap.begin();
+    for (; it != m_deleteMap.end(); ++it)
+    {
+        if (*it == MARK_CUT_START && !cut)
+        {
+            if ((int64_t)it.key() > start)
+                wanted.push_back(Region(start, start, it.key(), false));
+            cut = true;
+        }
+        else if (*it == MARK_CUT_END && cut)
+        {
+            start = it.key();
+            cut = false;
+        }
+    }
+    if (!cut)
+        wanted.push_back(Region(start, start, INT64_MAX, false));
+
+    QList<Region>::const_iterator rit = wanted.begin();
+    for (; rit != wanted.end(); ++rit)
+    {
+        int64_t first = rit->start;
+        int64_t end   = rit->end;
+
+        // Nothing before the first keyframe can be decoded
+        frm_pos_map_t::const_iterator key = m_posMap.upperBound(first);
+        if (key == m_posMap.begin())
+        {
+            first = key.key();
+            if (first >= end)
+                continue;
+            key++;
+        }
+
+        // Up to the first keyframe of the part, from the one before it
+        int64_t before = (key - 1).key();
+        if (before != first)
+        {
+            int64_t next = (key != m_posMap.end()) ? key.key() : INT64_MAX;
+            if (next >= end)
+            {
+                m_regions.push_back(Region(before, first, end, true));
+                continue;
+            }
+            m_regions.push_back(Region(before, first, next, true, true));
+            first = next;
+        }
+
+        if (end == INT64_MAX)
+        {
+            m_regions.push_back(Region(first, first, end, false));
+            continue;
+        }
+
+        // From the last keyframe of the part
+        int64_t last = (m_posMap.upperBound(end) - 1).key();
+        if (last == end)
+        {
+            m_regions.push_back(Region(first, first, end, false));
+            continue;
+        }
+        if (last > first)
+            m_regions.push_back(Region(first, first, last, false));
+        m_regions.push_back(Region(last, last, end, true));
+    }
+
+    for (rit = m_regions.begin(); rit != m_regions.end(); ++rit)
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC + QString("%1 frames %2 to %3")
+            .arg(rit->encode ? "Re-encoding" : "Copying")
+            .arg(rit->start)
+            .arg(rit->end == INT64_MAX ? QString("the end")
+                                       : QString::number(rit->end - 1)));
+    }
+}
+
+/**
+ *  Copies the packets of a region that starts and ends on keyframes.
+ *  Returns false on errors, or when the job was stopped.
+ */
+bool StreamCopyCutter::CopyRegion(const Region &region)
+{
+    if (!SeekTo(region.key))
+        return false;
+
+    AVStream *vst     = m_inputFC->streams[m_videoIndex];
+    bool      copying = false;
+    int64_t   keyPts  = AV_NOPTS_VALUE;
+    AVPacket  pkt;
+    av_init_packet(&pkt);
+
+    while (ReadVideo(pkt))
+    {
+        bool key = pkt.flags & AV_PKT_FLAG_KEY;
+        int64_t time = PacketTime(pkt);
+        if (time == AV_NOPTS_VALUE)
+            time = m_videoTime;
+
+        if (copying && key && m_frame >= region.end)
+        {
+            // The next region may start at this keyframe
+            UnreadVideo(pkt);
+            CloseRange(time);
+
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                QString("Cutting from frame %1").arg(m_frame));
+
+            return time == AV_NOPTS_VALUE || FlushQueue(time);
+        }
+
+        if (!copying && key && m_frame >= region.start)
+        {
+            OpenRange(time);
+            copying = true;
+            keyPts  = pkt.pts;
+
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                QString("Copying from frame %1").arg(m_frame));
+        }
+        else if (key)
+            keyPts = AV_NOPTS_VALUE;
+
+        if (pkt.dts != AV_NOPTS_VALUE)
+            m_videoTime = av_rescale_q(pkt.dts, vst->time_base,
+                                       AV_TIME_BASE_Q);
+        else if (time != AV_NOPTS_VALUE)
+            m_videoTime = time;
+        m_frame++;
+
+        // Pictures shown before the first keyframe belong to what was cut,
+        // or to the frames re-encoded before it
+        bool leading = !key && keyPts != AV_NOPTS_VALUE &&
+                       pkt.pts != AV_NOPTS_VALUE && pkt.pts < keyPts;
+
+        if (copying && !leading)
+        {
+            if (!WriteVideo(pkt))
+                return false;
+        }
+        else
+            av_free_packet(&pkt);
+
+        // Everything before this frame has been decided
+        if (m_videoTime != AV_NOPTS_VALUE && !FlushQueue(m_videoTime))
+            return false;
+    }
+
+    return !m_stopped && !m_failed;
+}
+
+/**
+ *  Decodes a region from the keyframe before it, and encodes the frames
+ *  kept again. This is done for the frames between a cut and the nearest
+ *  keyframe, so the cuts are where they were marked.
+ *
+ *  Returns false on errors, or when the job was stopped.
+ */
+bool StreamCopyCutter::EncodeRegion(const Region &region)
+{
+    if (!SeekTo(region.key))
+        return false;
+
+    if (!OpenDecoder())
+    {
+        CloseCodecs();
+        return false;
+    }
+
+    AVStream *vst     = m_inputFC->streams[m_videoIndex];
+    AVRational rate   = vst->avg_frame_rate.num ? vst->avg_frame_rate
+                                                : vst->r_frame_rate;
+    int64_t   ticks   = rate.num ? av_rescale_q(1, av_inv_q(rate),
+                                                vst->time_base) : 0;
+    AVFrame  *frame   = av_frame_alloc();
+    bool      ok      = (frame != NULL);
+    bool      started = false;  // the keyframe was read
+    bool      ended   = false;  // the keyframe at the end was read
+    bool      drain   = false;  // all the packets needed were read
+    bool      opened  = false;  // the range was opened
+    bool      first   = true;
+    int64_t   number  = region.key;      // of the next frame shown
+    int64_t   keyPts  = AV_NOPTS_VALUE;  // the keyframe decoded from
+    int64_t   endPts  = AV_NOPTS_VALUE;  // the keyframe at the end
+    int64_t   nextPts = AV_NOPTS_VALUE;  // the first frame after the region
+    int64_t   lastPts = AV_NOPTS_VALUE;  // the last frame shown
+    AVPacket  pkt;
+
+    while (ok)
+    {
+        av_init_packet(&pkt);
+        pkt.data = NULL;
+        pkt.size = 0;
+
+        if (!drain && !ReadVideo(pkt))
+        {
+            if (m_stopped || m_failed)
+            {
+                ok = false;
+                break;
+            }
+            drain = true;  // end of the file
+            av_init_packet(&pkt);
+            pkt.data = NULL;
+            pkt.size = 0;
+        }
+
+        if (!drain)
+        {
+            bool key  = pkt.flags & AV_PKT_FLAG_KEY;
+            bool stop = false;
+
+            if (!started)
+            {
+                if (!key || m_frame < region.key)
+                {
+                    av_free_packet(&pkt);
+                    m_frame++;
+                    continue;
+                }
+                started = true;
+                keyPts  = pkt.pts;
+            }
+            else if (region.endKey && !ended)
+            {
+                // The pictures shown before the keyframe at the end are
+                // decoded after it, so it is decoded too
+                if (key && m_frame >= region.end)
+                {
+                    ended  = true;
+                    endPts = pkt.pts;
+                }
+            }
+            else if (region.endKey)
+            {
+                stop = key || pkt.pts == AV_NOPTS_VALUE ||
+                       endPts == AV_NOPTS_VALUE || pkt.pts >= endPts;
+            }
+            else
+            {
+                stop = nextPts != AV_NOPTS_VALUE ||
+                       (key && m_frame >= region.end);
+            }
+
+            if (stop)
+            {
+                UnreadVideo(pkt);
+                drain = true;
+                av_init_packet(&pkt);
+                pkt.data = NULL;
+                pkt.size = 0;
+            }
+        }
+
+        int got = 0;
+        int ret = avcodec_decode_video2(m_decoder, frame, &got, &pkt);
+        if (pkt.data)
+        {
+            av_free_packet(&pkt);
+            m_frame++;
+        }
+
+        if (ret < 0)
+        {
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                QString("Couldn't decode a frame, error #%1").arg(ret));
+        }
+
+        if (!got)
+        {
+            if (drain)
+                break;
+            continue;
+        }
+
+        int64_t pts = av_frame_get_best_effort_timestamp(frame);
+        if (pts == AV_NOPTS_VALUE && lastPts != AV_NOPTS_VALUE)
+            pts = lastPts + ticks;
+        lastPts = pts;
+
+        // Pictures shown before the keyframe need the GOP before it
+        if (pts != AV_NOPTS_VALUE && keyPts != AV_NOPTS_VALUE &&
+            pts < keyPts)
+            continue;
+
+        int64_t n    = number++;
+        int64_t time = (pts != AV_NOPTS_VALUE) ?
+            av_rescale_q(pts, vst->time_base, AV_TIME_BASE_Q) : m_videoTime;
+        bool after   = region.endKey ?
+            (pts != AV_NOPTS_VALUE && endPts != AV_NOPTS_VALUE &&
+             pts >= endPts) : n >= region.end;
+
+        if (after)
+        {
+            if (nextPts == AV_NOPTS_VALUE)
+                nextPts = pts;
+            continue;
+        }
+
+        if (n >= region.start)
+        {
+            if (!opened)
+            {
+                OpenRange(time);
+                opened = true;
+
+                LOG(VB_GENERAL, LOG_INFO, LOC +
+                    QString("Re-encoding from frame %1").arg(n));
+            }
+
+            if (!m_encoder && !OpenEncoder(frame))
+            {
+                ok = false;
+                break;
+            }
+
+            frame->pts       = pts;
+            frame->pict_type = first ? AV_PICTURE_TYPE_I
+                                     : AV_PICTURE_TYPE_NONE;
+            first = false;
+
+            ok = EncodeFrame(frame);
+            m_encodedFrames++;
+        }
+
+        m_videoTime = time;
+        if (ok && m_videoTime != AV_NOPTS_VALUE)
+            ok = FlushQueue(m_videoTime);
+    }
+
+    if (ok && m_encoder)
+        ok = EncodeFrame(NULL);
+
+    if (ok && opened)
+    {
+        int64_t end = (endPts != AV_NOPTS_VALUE) ? endPts :
+                      (nextPts != AV_NOPTS_VALUE) ? nextPts :
+                      (lastPts != AV_NOPTS_VALUE) ? lastPts + ticks :
+                      AV_NOPTS_VALUE;
+        if (end != AV_NOPTS_VALUE)
+            end = av_rescale_q(end, vst->time_base, AV_TIME_BASE_Q);
+        CloseRange(end);
+        if (end != AV_NOPTS_VALUE)
+            ok = FlushQueue(end);
+    }
+
+    av_frame_free(&frame);
+    CloseCodecs();
+
+    return ok;
+}
+
+bool StreamCopyCutter::OpenDecoder(void)
+{
+    AVCodecContext *ctx = m_inputFC->streams[m_videoIndex]->codec;
+    AVCodec *codec = avcodec_find_decoder(ctx->codec_id);
+    if (!codec)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("No %1 decoder")
+            .arg(avcodec_get_name(ctx->codec_id)));
+        return false;
+    }
+
+    m_decoder = avcodec_alloc_context3(codec);
+    if (!m_decoder || avcodec_copy_context(m_decoder, ctx) < 0 ||
+        avcodec_open2(m_decoder, codec, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open the %1 decoder").arg(codec->name));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ *  Opens an encoder for pictures like \p frame. Each re-encoded region
+ *  gets its own, so it starts with an IDR picture carrying its parameter
+ *  sets, and it uses no B-frames, so the decoding times can follow those
+ *  of the copied pictures.
+ */
+bool StreamCopyCutter::OpenEncoder(const AVFrame *frame)
+{
+    AVStream *vst = m_inputFC->streams[m_videoIndex];
+    AVCodec *codec = avcodec_find_encoder(vst->codec->codec_id);
+    if (!codec)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("No %1 encoder")
+            .arg(avcodec_get_name(vst->codec->codec_id)));
+        return false;
+    }
+
+    m_encoder = avcodec_alloc_context3(codec);
+    if (!m_encoder)
+        return false;
+
+    m_encoder->width               = frame->width;
+    m_encoder->height              = frame->height;
+    m_encoder->pix_fmt             = (AVPixelFormat)frame->format;
+    m_encoder->sample_aspect_ratio = frame->sample_aspect_ratio;
+    m_encoder->time_base           = vst->time_base;
+    m_encoder->gop_size            = INT_MAX;
+    m_encoder->max_b_frames        = 0;
+    if (frame->interlaced_frame)
+    {
+        m_encoder->flags |= CODEC_FLAG_INTERLACED_DCT |
+                            CODEC_FLAG_INTERLACED_ME;
+        m_encoder->field_order = frame->top_field_first ? AV_FIELD_TT
+                                                        : AV_FIELD_BB;
+    }
+
+    // A few frames among copied ones, they should look the same
+    av_opt_set(m_encoder->priv_data, "crf", "18", 0);
+    av_opt_set(m_encoder->priv_data, "preset", "fast", 0);
+
+    if (avcodec_open2(m_encoder, codec, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open the %1 encoder").arg(codec->name));
+        return false;
+    }
+
+    return true;
+}
+
+/// Encodes \p frame and writes what the encoder returns, drains the
+/// encoder when \p frame is NULL
+bool StreamCopyCutter::EncodeFrame(AVFrame *frame)
+{
+    while (true)
+    {
+        AVPacket pkt;
+        av_init_packet(&pkt);
+        pkt.data = NULL;
+        pkt.size = 0;
+
+        int got = 0;
+        int ret = avcodec_encode_video2(m_encoder, &pkt, frame, &got);
+        if (ret < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Couldn't encode a frame, error #%1").arg(ret));
+            return false;
+        }
+        if (!got)
+            return true;
+
+        // Without B-frames the pictures are decoded when they are shown,
+        // less the delay of the copied ones
+        if (pkt.pts != AV_NOPTS_VALUE)
+            pkt.dts = pkt.pts - m_dtsDelay;
+        pkt.stream_index = m_videoIndex;
+
+        if (!WriteVideo(pkt))
+            return false;
+        if (frame)
+            return true;
+    }
+}
+
+void StreamCopyCutter::CloseCodecs(void)
+{
+    if (m_decoder)
+        avcodec_free_context(&m_decoder);
+    if (m_encoder)
+        avcodec_free_context(&m_encoder);
+}
+
+/// Gets ready to read from the keyframe \p key, seeking to it unless it
+/// is just ahead
+bool StreamCopyCutter::SeekTo(int64_t key)
+{
+    if (m_frame <= key && key - m_frame <= kSeekFrames)
+        return true;
+
+    if (m_hasPending)
+    {
+        av_free_packet(&m_pending);
+        m_hasPending = false;
+    }
+
+    if (!FlushQueue(AV_NOPTS_VALUE) || !Seek(key))
+        return false;
+
+    m_frame  = key;
+    m_resync = true;
+    return true;
+}
+
+/**
+ *  Reads the next video packet, queueing the packets of the other streams
+ *  on the way. Returns false at the end of the file, and when the job was
+ *  stopped or a packet couldn't be queued.
+ */
+bool StreamCopyCutter::ReadVideo(AVPacket &pkt)
+{
+    if (m_hasPending)
+    {
+        pkt = m_pending;
+        m_hasPending = false;
+        return true;
+    }
+
+    while (av_read_frame(m_inputFC, &pkt) >= 0)
+    {
+        if (!UpdateStatus(pkt.pos))
+        {
+            av_free_packet(&pkt);
+            m_stopped = true;
+            return false;
+        }
+
+        if (pkt.stream_index != m_videoIndex)
+        {
+            if (pkt.stream_index >= m_streamMap.size() ||
+                m_streamMap[pkt.stream_index] < 0)
+                av_free_packet(&pkt);
+            else if (!QueuePacket(pkt))
+            {
+                m_failed = true;
+                return false;
+            }
+            continue;
+        }
+
+        // Skip to a keyframe after seeking
+        bool key = pkt.flags & AV_PKT_FLAG_KEY;
+        if (m_resync && !key)
+        {
+            av_free_packet(&pkt);
+            continue;
+        }
+        m_resync = false;
+
+        if (key && pkt.pts != AV_NOPTS_VALUE && pkt.dts != AV_NOPTS_VALUE)
+            m_dtsDelay = pkt.pts - pkt.dts;
+
+        return true;
+    }
+
+    return false;
+}
+
+/// Puts back a video packet for the next ReadVideo()
+void StreamCopyCutter::UnreadVideo(AVPacket &pkt)
+{
+    if (av_dup_packet(&pkt) < 0)
+    {
+        av_free_packet(&pkt);
+        return;
+    }
+
+    m_pending    = pkt;
+    m_hasPending = true;
+}
+
+/// Starts a range of the output at the input time \p time, taking out
+/// the gap since the last one
+void StreamCopyCutter::OpenRange(int64_t time)
+{
+    if (m_lastEnd != AV_NOPTS_VALUE && time != AV_NOPTS_VALUE)
+        m_offset += time - m_lastEnd;
+    m_ranges.push_back(Range(time, m_offset));
+}
+
+void StreamCopyCutter::CloseRange(int64_t time)
+{
+    m_ranges.last().end = time;
+    m_lastEnd = time;
+}
+
+/// Writes a video packet of the range being written, noting the keyframes
+bool StreamCopyCutter::WriteVideo(AVPacket &pkt)
+{
+    AVStream *vst = m_inputFC->streams[m_videoIndex];
+
+    if (pkt.flags & AV_PKT_FLAG_KEY)
+    {
+        m_outPosMap[m_outFrame] = avio_tell(m_outputFC->pb);
+        m_outDurMap[m_outFrame] = (int64_t)m_outDuration;
+    }
+    m_outDuration += (pkt.duration > 0) ?
+        av_q2d(vst->time_base) * pkt.duration * 1000 : m_frameMS;
+    m_outFrame++;
+
+    return WritePacket(pkt, m_ranges.last().offset);
+}
+
+bool StreamCopyCutter::Seek(int64_t frame)
+{
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Seeking to frame %1 at %2")
+        .arg(frame).arg(m_posMap[frame]));
+
+    if (av_seek_frame(m_inputFC, -1, m_posMap[frame], AVSEEK_FLAG_BYTE) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't seek to frame %1").arg(frame));
+        return false;
+    }
+
+    return true;
+}
+
+bool StreamCopyCutter::QueuePacket(AVPacket &pkt)
+{
+    if (av_dup_packet(&pkt) < 0)
+    {
+        av_free_packet(&pkt);
+        return false;
+    }
+
+    m_queue.enqueue(pkt);
+    return true;
+}
+
+/// Writes or drops the queued packets before \p until, all of them
+/// when it is AV_NOPTS_VALUE
+bool StreamCopyCutter::FlushQueue(int64_t until)
+{
+    while (!m_queue.isEmpty())
+    {
+        int64_t time = PacketTime(m_queue.head());
+        if (until != AV_NOPTS_VALUE && time != AV_NOPTS_VALUE &&
+            time >= until)
+            break;
+
+        AVPacket pkt = m_queue.dequeue();
+        const Range *range = FindRange(time);
+
+        // Packets read again after seeking back were written already
+        if (!range || (time != AV_NOPTS_VALUE &&
+                       time <= m_lastWritten[pkt.stream_index]))
+        {
+            av_free_packet(&pkt);
+            continue;
+        }
+
+        if (time != AV_NOPTS_VALUE)
+            m_lastWritten[pkt.stream_index] = time;
+        if (!WritePacket(pkt, range->offset))
+            return false;
+    }
+
+    return true;
+}
+
+bool StreamCopyCutter::WritePacket(AVPacket &pkt, int64_t offset)
+{
+    AVStream *ist = m_inputFC->streams[pkt.stream_index];
+    AVStream *ost = m_outputFC->streams[m_streamMap[pkt.stream_index]];
+    int64_t delta = av_rescale_q(offset, AV_TIME_BASE_Q, ist->time_base);
+
+    if (pkt.pts != AV_NOPTS_VALUE)
+        pkt.pts = av_rescale_q(pkt.pts - delta, ist->time_base, ost->time_base);
+    if (pkt.dts != AV_NOPTS_VALUE)
+        pkt.dts = av_rescale_q(pkt.dts - delta, ist->time_base, ost->time_base);
+    pkt.duration = av_rescale_q(pkt.duration, ist->time_base, ost->time_base);
+    pkt.stream_index = ost->index;
+    pkt.pos = -1;
+
+    int ret = av_write_frame(m_outputFC, &pkt);
+    av_free_packet(&pkt);
+
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't write a packet, error #%1").arg(ret));
+        return false;
+    }
+
+    return true;
+}
+
+int64_t StreamCopyCutter::PacketTime(const AVPacket &pkt) const
+{
+    int64_t ts = (pkt.pts != AV_NOPTS_VALUE) ? pkt.pts : pkt.dts;
+    if (ts == AV_NOPTS_VALUE)
+        return AV_NOPTS_VALUE;
+    return av_rescale_q(ts, m_inputFC->streams[pkt.stream_index]->time_base,
+                        AV_TIME_BASE_Q);
+}
+
+/// Returns the copied range holding \p time, packets without a time
+/// belong to the range being copied
+const StreamCopyCutter::Range *StreamCopyCutter::FindRange(int64_t time) const
+{
+    if (m_ranges.isEmpty())
+        return NULL;
+
+    if (time == AV_NOPTS_VALUE)
+        return (m_ranges.last().end == INT64_MAX) ? &m_ranges.last() : NULL;
+
+    for (int i = m_ranges.size() - 1; i >= 0; i--)
+    {
+        if (m_ranges[i].start <= time && time < m_ranges[i].end)
+            return &m_ranges[i];
+        if (m_ranges[i].end <= time)
+            break;
+    }
+
+    return NULL;
+}
+
+/// Reports the progress, returns false if the job was stopped
+bool StreamCopyCutter::UpdateStatus(int64_t pos)
+{
+    if ((!m_showprogress && !m_update_status) ||
+        MythDate::current() <= m_statustime)
+        return true;
+
+    float percent_done = (m_filesize > 0 && pos >= 0) ?
+        100.0 * pos / m_filesize : 0.0;
+    if (m_update_status)
+        m_update_status(percent_done);
+    if (m_showprogress)
+        LOG(VB_GENERAL, LOG_INFO, QString("%1% complete")
+            .arg(percent_done, 0, 'f', 1));
+    if (m_check_abort && m_check_abort())
+        return false;
+
+    m_statustime = MythDate::current().addSecs(m_status_update_time);
+    return true;
+}
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
@@ -0,0 +1,150 @@
+#ifndef STREAMCOPYCUTTER_H
+#define STREAMCOPYCUTTER_H
+
+extern "C"
+{
+#include "libavformat/avformat.h"
+}
+
+// Qt
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+#include <QQueue>
+#include <QList>
+
+// MythTV
+#include "transcodedefs.h"
+#include "programtypes.h"
+
+/** \class StreamCopyCutter
+ *  \brief Applies a cutlist to an MPEG-TS recording without re-encoding it.
+ *
+ *  MPEG2fixup can only cut MPEG-2 video, H.264 and HEVC recordings had to be
+ *  re-encoded by Transcode to drop the commercials. This copies
+ *  the packets of the recording as they are into a new MPEG-TS file,
+ *  except for the frames between a cut and the nearest keyframe: those
+ *  are decoded from the keyframe before them and encoded again, so the
+ *  cuts stay on the frames they were marked at.
+ *
+ *  The position map of the recording gives the keyframes, and lets the
+ *  long cuts be skipped by seeking instead of reading them. The position
+ *  map of the new file is built while it is written.
+ */
+class StreamCopyCutter
+{
+  public:
+    StreamCopyCutter(const QString &inf, const QString &outf,
+                     const frm_dir_map_t &deleteMap,
+                     const frm_pos_map_t &posMap,
+                     bool showprog = false,
+                     void (*update_func)(float) = NULL,
+                     int (*check_func)() = NULL);
+    ~StreamCopyCutter();
+
+    int Start(void);
+
+    static bool CanCopy(const QString &filename);
+
+    /// Keyframe positions and durations of the new file, once Start()
+    /// returned REENCODE_OK
+    void GetPositionMap(frm_pos_map_t &posMap, frm_pos_map_t &durMap) const
+        { posMap = m_outPosMap; durMap = m_outDurMap; }
+
+  private:
+    /// Video frames [start, end) of the input written to the output,
+    /// reading from the keyframe \p key. Copied regions start and end on
+    /// keyframes, the others are re-encoded.
+    class Region
+    {
+      public:
+        Region(int64_t k, int64_t s, int64_t e, bool enc, bool ek = false) :
+            key(k), start(s), end(e), encode(enc), endKey(ek) {}
+        int64_t key, start, end;
+        bool    encode;
+        bool    endKey;  ///< end is a keyframe
+    };
+
+    /// Input times [start, end) of a copied region, and what is taken
+    /// off them so the output has no gap, in AV_TIME_BASE units
+    class Range
+    {
+      public:
+        Range(int64_t s, int64_t o) : start(s), end(INT64_MAX), offset(o) {}
+        int64_t start, end, offset;
+    };
+
+    bool OpenInput(void);
+    bool OpenOutput(void);
+    void Close(void);
+    bool ScanKeyframes(void);
+    void BuildRegions(void);
+    bool CopyRegion(const Region &region);
+    bool EncodeRegion(const Region &region);
+    bool OpenDecoder(void);
+    bool OpenEncoder(const AVFrame *frame);
+    bool EncodeFrame(AVFrame *frame);
+    void CloseCodecs(void);
+    bool SeekTo(int64_t key);
+    bool Seek(int64_t frame);
+    bool ReadVideo(AVPacket &pkt);
+    void UnreadVideo(AVPacket &pkt);
+    void OpenRange(int64_t time);
+    void CloseRange(int64_t time);
+    bool WriteVideo(AVPacket &pkt);
+    bool QueuePacket(AVPacket &pkt);
+    bool FlushQueue(int64_t until);
+    bool WritePacket(AVPacket &pkt, int64_t offset);
+    int64_t PacketTime(const AVPacket &pkt) const;
+    const Range *FindRange(int64_t time) const;
+    bool UpdateStatus(int64_t pos);
+
+    QString              m_infile;
+    QString              m_outfile;
+    frm_dir_map_t        m_deleteMap;
+    frm_pos_map_t        m_posMap;
+
+    AVFormatContext     *m_inputFC;
+    AVFormatContext     *m_outputFC;
+    int                  m_videoIndex;
+    /// Output stream of each input stream, -1 if not copied
+    QVector<int>         m_streamMap;
+    /// Time of the last packet written of each input stream
+    QVector<int64_t>     m_lastWritten;
+    AVCodecContext      *m_decoder;
+    AVCodecContext      *m_encoder;
+
+    /// Video packet put back to be read again
+    AVPacket             m_pending;
+    bool                 m_hasPending;
+    bool                 m_resync;    ///< skip to a keyframe after seeking
+    bool                 m_stopped;
+    bool                 m_failed;
+    int64_t              m_frame;     ///< next input video frame
+    int64_t              m_videoTime;
+    int64_t              m_lastEnd;   ///< input time the last range ended
+    int64_t              m_offset;
+    /// How long the copied pictures are decoded before they are shown
+    int64_t              m_dtsDelay;
+    int64_t              m_outFrame;
+    double               m_outDuration;  ///< msec
+    double               m_frameMS;
+    int64_t              m_encodedFrames;
+
+    QList<Region>        m_regions;
+    QList<Range>         m_ranges;
+    /// Packets of the other streams waiting for the video to pass them
+    QQueue<AVPacket>     m_queue;
+
+    frm_pos_map_t        m_outPosMap;
+    frm_pos_map_t        m_outDurMap;
+
+    bool                 m_showprogress;
+    void               (*m_update_status)(float);
+    int                (*m_check_abort)();
+    int                  m_status_update_time;
+    QDateTime            m_statustime;
+    int64_t              m_filesize;
+};
+
+#endif // STREAMCOPYCUTTER_H
@@ -33,6 +33,7 @@
 #include "videodecodebuffer.h"
 #include "cutter.h"
 #include "audioreencodebuffer.h"
+#include "streamcopycutter.h"
 
 extern "C" {
 #include "libavcodec/avcodec.h"
@@ -684,6 +685,27 @@ int Transcode::TranscodeFile(const QString &inputname,
             return REENCODE_MPEG2TRANS;
         }
 
+        if (get_int_option(m_recProfile, "transcodelossless"))
+        {
+            // Decide on the codec itself, GetEncodingType() has no
+            // name for HEVC
+            QString rawType = dec ? dec->GetRawEncodingType() : QString();
+            if (rawType == "H264" || rawType == "H265")
+            {
+                if (StreamCopyCutter::CanCopy(inputname))
+                {
+                    LOG(VB_GENERAL, LOG_NOTICE,
+                        "Switching to stream copy cutter.");
+                    SetPlayerContext(NULL);
+                    return REENCODE_STREAMCOPY;
+                }
+                LOG(VB_GENERAL, LOG_NOTICE,
+                    QString("%1 recording can't be stream copied, it is "
+                            "not MPEG-TS or there is no encoder for the "
+                            "cuts").arg(rawType));
+            }
+        }
+
         // Recorder setup
         if (get_int_option(m_recProfile, "transcodelossless"))
         {
@@ -1,6 +1,7 @@
 #ifndef TRANSCODEDEFS_H_
 #define TRANSCODEDEFS_H_
 
+#define REENCODE_STREAMCOPY      3
 #define REENCODE_MPEG2TRANS      2
 #define REENCODE_CUTLIST_CHANGE  1
 #define REENCODE_OK              0
@@ -503,6 +503,68 @@ static HostSpinBox *JobQueueMaxSimultaneousJobs()
     return gc;
 };
 
+static HostSpinBox *JobQueueMaxTypeJobs(const QString &setting,
+                                        const QString &label)
+{
+    HostSpinBox *gc = new HostSpinBox(setting, 0, 10, 1);
+    gc->setLabel(label);
+    gc->setHelpText(QObject::tr("The Job Queue will run at most this many "
+                    "jobs of this type at the same time on this backend. "
+                    "Set to 0 to only use the overall limit."));
+    gc->setValue(0);
+    return gc;
+};
+
+static HostSpinBox *JobQueueMaxCPULoad()
+{
+    HostSpinBox *gc = new HostSpinBox("JobQueueMaxCPULoad", 0, 100, 5);
+    gc->setLabel(QObject::tr("Maximum CPU load for new jobs (%)"));
+    gc->setHelpText(QObject::tr("While a job is running and the CPU load of "
+                    "this backend is above this percentage, no further "
+                    "commercial detection, transcoding or user jobs will be "
+                    "started. Set to 0 to disable this check."));
+    gc->setValue(90);
+    return gc;
+};
+
+static HostSpinBox *JobQueueMaxIOLoad()
+{
+    HostSpinBox *gc = new HostSpinBox("JobQueueMaxIOLoad", 0, 100, 5);
+    gc->setLabel(QObject::tr("Maximum storage load for new jobs (%)"));
+    gc->setHelpText(QObject::tr("While a job is running and one of the disks "
+                    "holding this backend's storage groups is busy for more "
+                    "than this percentage of the time, no further "
+                    "commercial detection, transcoding or user jobs will be "
+                    "started. Set to 0 to disable this check."));
+    gc->setValue(80);
+    return gc;
+};
+
+static HostSpinBox *JobQueueMaxActiveRecordings()
+{
+    HostSpinBox *gc = new HostSpinBox("JobQueueMaxActiveRecordings", 0, 20, 1);
+    gc->setLabel(QObject::tr("Defer jobs while recording"));
+    gc->setHelpText(QObject::tr("While this many or more recordings are in "
+                    "progress on this backend, no commercial detection, "
+                    "transcoding or user jobs will be started. Set to 0 to "
+                    "start jobs regardless of recordings."));
+    gc->setValue(0);
+    return gc;
+};
+
+static HostSpinBox *JobQueuePriorityAging()
+{
+    HostSpinBox *gc = new HostSpinBox("JobQueuePriorityAging", 0, 120, 1);
+    gc->setLabel(QObject::tr("Job priority aging (mins)"));
+    gc->setHelpText(QObject::tr("Metadata lookups are started before "
+                    "commercial detection, which is started before "
+                    "transcoding and user jobs. A queued job gains one "
+                    "priority step every this many minutes, so older jobs "
+                    "are not starved by newer ones. Set to 0 to disable."));
+    gc->setValue(6);
+    return gc;
+};
+
 static HostSpinBox *JobQueueCheckFrequency()
 {
     HostSpinBox *gc = new HostSpinBox("JobQueueCheckFrequency", 5, 300, 5);
@@ -513,6 +575,19 @@ static HostSpinBox *JobQueueCheckFrequency()
     return gc;
 };
 
+static HostSpinBox *JobQueueRecordingTapSize()
+{
+    HostSpinBox *gc = new HostSpinBox("RecordingTapSize", 0, 1024, 16);
+    gc->setLabel(QObject::tr("Memory shared with realtime flagging (MB)"));
+    gc->setHelpText(QObject::tr("When commercial detection runs while "
+                    "recording and jobs run only on the recording backend, "
+                    "this much of each recording in progress is kept in "
+                    "memory for the flagger to read. Set to 0 to have the "
+                    "flagger read the recording back from disk."));
+    gc->setValue(128);
+    return gc;
+};
+
 static HostComboBox *JobQueueCPU()
 {
     HostComboBox *gc = new HostComboBox("JobQueueCPU");
@@ -584,6 +659,33 @@ static GlobalCheckBox *AutoCommflagWhileRecording()
     return gc;
 };
 
+static GlobalCheckBox *CommFlagSinglePass()
+{
+    GlobalCheckBox *gc = new GlobalCheckBox("CommFlagSinglePass");
+    gc->setLabel(QObject::tr("Make previews and check seek tables while "
+                             "detecting commercials"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, commercial detection jobs also "
+                                "check the seek table of the recording "
+                                "instead of reading it again, and save its "
+                                "preview image once they are done. The seek "
+                                "table is only rebuilt when it turns out to "
+                                "be incomplete."));
+    return gc;
+};
+
+static GlobalCheckBox *CommFlagExtractCaptions()
+{
+    GlobalCheckBox *gc = new GlobalCheckBox("CommFlagExtractCaptions");
+    gc->setLabel(QObject::tr("Extract captions while detecting commercials"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, commercial detection jobs also "
+                                "save the closed captions, teletext and DVB "
+                                "subtitles of the recording as SRT files "
+                                "next to it, like mythccextractor."));
+    return gc;
+};
+
 static GlobalLineEdit *UserJob(uint job_num)
 {
     GlobalLineEdit *gc = new GlobalLineEdit(QString("UserJob%1").arg(job_num));
@@ -914,6 +1016,7 @@ BackendSettings::BackendSettings() {
     group5->setLabel(QObject::tr("Job Queue (Backend-Specific)"));
     group5->addChild(JobQueueMaxSimultaneousJobs());
     group5->addChild(JobQueueCheckFrequency());
+    group5->addChild(JobQueueRecordingTapSize());
 
     HorizontalConfigurationGroup* group5a =
               new HorizontalConfigurationGroup(false, false);
@@ -937,10 +1040,26 @@ BackendSettings::BackendSettings() {
     group5->addChild(group5a);
     addChild(group5);
 
+    VerticalConfigurationGroup* group5b = new VerticalConfigurationGroup(false);
+    group5b->setLabel(QObject::tr("Job Queue Scheduling (Backend-Specific)"));
+    group5b->addChild(JobQueueMaxTypeJobs("JobQueueMaxCommFlagJobs",
+        QObject::tr("Maximum simultaneous commercial detection jobs")));
+    group5b->addChild(JobQueueMaxTypeJobs("JobQueueMaxTranscodeJobs",
+        QObject::tr("Maximum simultaneous transcoding jobs")));
+    group5b->addChild(JobQueueMaxTypeJobs("JobQueueMaxUserJobs",
+        QObject::tr("Maximum simultaneous user jobs")));
+    group5b->addChild(JobQueueMaxCPULoad());
+    group5b->addChild(JobQueueMaxIOLoad());
+    group5b->addChild(JobQueueMaxActiveRecordings());
+    group5b->addChild(JobQueuePriorityAging());
+    addChild(group5b);
+
     VerticalConfigurationGroup* group6 = new VerticalConfigurationGroup(false);
     group6->setLabel(QObject::tr("Job Queue (Global)"));
     group6->addChild(JobsRunOnRecordHost());
     group6->addChild(AutoCommflagWhileRecording());
+    group6->addChild(CommFlagSinglePass());
+    group6->addChild(CommFlagExtractCaptions());
     group6->addChild(JobQueueCommFlagCommand());
     group6->addChild(JobQueueTranscodeCommand());
     group6->addChild(AutoTranscodeBeforeAutoCommflag());
@@ -38,6 +38,9 @@ void MythTVSetupCommandLineParser::LoadArguments(void)
             "Specify which input to scan for, if specified card "
             "supports multiple.");
     add("--FTAonly", "ftaonly", false, "", "Only import 'Free To Air' channels.");
+    add("--scan-all-tuners", "scanalltuners", false, "",
+            "Share the frequencies to scan between all the idle tuners "
+            "of the same type connected to the video source.");
     add("--service-type", "servicetype", "all", "",
             "To be used with channel scanning or importing, specify "
             "the type of services to import. Select from the following, "
@@ -50,6 +53,7 @@ void MythTVSetupCommandLineParser::LoadArguments(void)
         ->SetParentOf("inputname")
         ->SetParentOf("ftaonly")
         ->SetParentOf("servicetype")
+        ->SetParentOf("scanalltuners")
         ->SetBlocks("importscan");
 
     add("--scan-import", "importscan", 0U, "",
@@ -247,6 +247,7 @@ int main(int argc, char *argv[])
     bool    expertMode = false;
     uint    scanImport = 0;
     bool    scanFTAOnly = false;
+    bool    scanAllTuners = false;
     ServiceRequirements scanServiceRequirements = kRequireAV;
     uint    scanCardId = 0;
     QString scanTableName = "atsc-vsb8-us";
@@ -322,6 +323,8 @@ int main(int argc, char *argv[])
         scanImport = cmdline.toUInt("importscan");
     if (cmdline.toBool("ftaonly"))
         scanFTAOnly = true;
+    if (cmdline.toBool("scanalltuners"))
+        scanAllTuners = true;
     if (cmdline.toBool("servicetype"))
     {
         scanServiceRequirements = kRequireNothing;
@@ -457,6 +460,7 @@ int main(int argc, char *argv[])
         QMap<QString,QString> startChan;
         {
             ChannelScannerCLI scanner(doScanSaveOnly, scanInteractive);
+            scanner.SetUseAllTuners(scanAllTuners);
             scanner.Scan(
                 (freq_std=="atsc") ?
                 ScanTypeSetting::FullScan_ATSC :